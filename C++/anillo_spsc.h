@@ -0,0 +1,91 @@
+#ifndef ANILLO_SPSC_H
+#define ANILLO_SPSC_H
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+// Anillo de un productor y un consumidor (SPSC), sin bloqueos.
+// Es el canal entre hilos que no comparten nada ms: cada extremo escribe solo su
+// ndice, y los dos ndices viven en lneas de cach distintas para que el productor
+// y el consumidor no se invaliden mutuamente. Cada extremo guarda una copia del ndice
+// del otro y solo lo vuelve a leer cuando esa copia indica lleno o vaco.
+//
+// La capacidad se redondea a una potencia de 2. Un solo hilo puede encolar y un solo
+// hilo puede desencolar; los dos pueden ser distintos.
+template <class T>
+class AnilloSPSC {
+public:
+    explicit AnilloSPSC(std::size_t capacidadMinima = 1024)
+        : escritura(0), lecturaVista(0), lectura(0), escrituraVista(0) {
+        std::size_t capacidad = 2;
+        while (capacidad < capacidadMinima) {
+            capacidad *= 2;
+        }
+        ranuras.resize(capacidad);
+        mascara = capacidad - 1;
+    }
+
+    AnilloSPSC(const AnilloSPSC&) = delete;
+    AnilloSPSC& operator=(const AnilloSPSC&) = delete;
+
+    // Lado del productor. Devuelve false si el anillo est lleno (valor queda intacto).
+    bool intentarEncolar(T& valor) {
+        std::size_t e = escritura.load(std::memory_order_relaxed);
+        if (e - lecturaVista > mascara) {
+            lecturaVista = lectura.load(std::memory_order_acquire);
+            if (e - lecturaVista > mascara) {
+                return false;
+            }
+        }
+        ranuras[e & mascara] = std::move(valor);
+        escritura.store(e + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool intentarEncolar(const T& valor) {
+        T copia(valor);
+        return intentarEncolar(copia);
+    }
+
+    // Lado del consumidor. Devuelve false si el anillo est vaco.
+    bool intentarDesencolar(T& valor) {
+        std::size_t l = lectura.load(std::memory_order_relaxed);
+        if (l == escrituraVista) {
+            escrituraVista = escritura.load(std::memory_order_acquire);
+            if (l == escrituraVista) {
+                return false;
+            }
+        }
+        valor = std::move(ranuras[l & mascara]);
+        lectura.store(l + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Aproximados si se consultan desde un hilo distinto del dueo del ndice.
+    std::size_t tamano() const {
+        return escritura.load(std::memory_order_acquire) - lectura.load(std::memory_order_acquire);
+    }
+    bool vacio() const { return tamano() == 0; }
+    std::size_t capacidad() const { return mascara + 1; }
+
+private:
+    static const std::size_t LINEA_CACHE = 64;
+
+    // Solo lectura despus de construir.
+    std::vector<T> ranuras;
+    std::size_t mascara;
+    char relleno0[LINEA_CACHE];
+
+    // Extremo del productor.
+    std::atomic<std::size_t> escritura;
+    std::size_t lecturaVista; // ltima lectura observada.
+    char relleno1[LINEA_CACHE];
+
+    // Extremo del consumidor.
+    std::atomic<std::size_t> lectura;
+    std::size_t escrituraVista; // ltima escritura observada.
+    char relleno2[LINEA_CACHE];
+};
+
+#endif
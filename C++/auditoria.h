@@ -0,0 +1,823 @@
+#ifndef AUDITORIA_H
+#define AUDITORIA_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+#include "estructuras.h"
+#include "protocolo_binario.h"
+#include "traza.h"
+#include "compresion_bloques.h"
+
+// Registro de auditora
+// Archivo al que solo se agregan datos, con cada modificacin hecha a travs de
+// SistemaGestion (fijarAuditoria): altas, bajas y deshacer del inventario, catlogos
+// cargados, solicitudes y clientes que entran y salen de las colas. A diferencia del
+// historial de cambios no se deshace ni se vaca; leer_auditoria lo decodifica.
+//
+//   cabecera:  "SGA1"
+//   bloque:    "SGAB" | u32 bytes guardados | u32 bytes originales | u32 registros |
+//              u64 instante base (s desde 1970) | u64 resumen | datos
+//   cierre:    "SGAC" | u32 0 | u64 bloques desde el principio del archivo |
+//              u64 instante | u64 resumen
+//
+// Los datos van comprimidos con compresion_bloques.h, o tal cual si no se achican (en
+// ese caso bytes guardados == bytes originales). El resumen es XXH64 de los 24 bytes
+// de cabecera que lo preceden y de los datos guardados, con el resumen del bloque
+// anterior como semilla (0 en el primero): cambiar, quitar o reordenar un bloque
+// rompe la cadena desde ese bloque en adelante.
+//
+// La cadena solo mira hacia atrs: si se cortan bloques enteros del final, los que
+// quedan siguen verificando. Por eso cerrar() agrega una marca de cierre, encadenada
+// como un bloque sin datos, con la cantidad de bloques escritos hasta ah. Un registro
+// est completo si termina en una marca de cierre que cuenta todos sus bloques; si no
+// termina en una, sigue abierto, el proceso termin sin cerrarlo o le falta el final.
+// Al volver a abrirlo se agrega despus de la marca y la cadena sigue.
+//
+//   registro:  varint  s desde el registro anterior (el primero, desde el instante base)
+//              u8      operacin
+//              nombre  almacn
+//              segn la operacin:
+//                altas, bajas y deshacer   producto (nombre), precio (f64 LE),
+//                                          cantidad (varint zigzag)
+//                solicitud registrada      id, descripcin (texto)
+//                solicitud procesada       id
+//                cliente registrado        id, nombre
+//                cliente atendido          id
+//                catlogo cargado          ruta (texto), productos (varint)
+//
+// Un texto es varint longitud + bytes. Los nombres (almacenes, productos y clientes)
+// se internan por bloque: varint 0 seguido del texto define el siguiente nmero, y
+// varint n > 0 repite el nombre n - 1. Los id son varint zigzag de la diferencia con
+// el id anterior del mismo tipo en el bloque. Cada bloque empieza sin nombres ni id
+// previos, as que se decodifica solo. Un alta tpica ocupa 12 bytes antes de comprimir.
+//
+// El registro se comparte entre los almacenes del proceso y tiene su propio cerrojo;
+// los registros se escriben en el orden en que se toma ese cerrojo, con el de la
+// estructura modificada todava tomado. Registrar solo codifica en el bloque en curso;
+// comprimir, calcular el resumen y escribir lo hace un hilo aparte. Un bloque se
+// cierra al llenarse, en volcar() o tras un segundo sin que se llene otro.
+
+static const char MAGICO_AUDITORIA[4] = {'S', 'G', 'A', '1'};
+static const char MAGICO_BLOQUE_AUDITORIA[4] = {'S', 'G', 'A', 'B'};
+static const char MAGICO_CIERRE_AUDITORIA[4] = {'S', 'G', 'A', 'C'};
+static const std::size_t CABECERA_BLOQUE_AUDITORIA = 32;
+static const std::size_t BLOQUE_AUDITORIA = 64 * 1024;            // Datos originales por bloque.
+static const std::size_t MAXIMO_BLOQUE_AUDITORIA = 16 * 1024 * 1024; // Cota al leer, ante cabeceras daadas.
+
+enum OperacionAuditoria {
+    AuditoriaProductoRegistrado = 1,
+    AuditoriaProductoEliminado,
+    AuditoriaAgregadoDeshecho,
+    AuditoriaEliminacionDeshecha,
+    AuditoriaSolicitudRegistrada,
+    AuditoriaSolicitudProcesada,
+    AuditoriaClienteRegistrado,
+    AuditoriaClienteAtendido,
+    AuditoriaCatalogoCargado,
+    FIN_OPERACIONES_AUDITORIA
+};
+
+inline const char* nombreOperacionAuditoria(int operacion) {
+    static const char* const nombres[] = {"?", "registrarProducto", "eliminarProducto", "deshacerAgregado",
+                                          "deshacerEliminacion", "registrarSolicitud", "procesarSolicitud",
+                                          "registrarCliente", "atenderCliente", "cargarCatalogo"};
+    return operacion > 0 && operacion < FIN_OPERACIONES_AUDITORIA ? nombres[operacion] : nombres[0];
+}
+
+inline bool esOperacionProducto(int operacion) {
+    return operacion >= AuditoriaProductoRegistrado && operacion <= AuditoriaEliminacionDeshecha;
+}
+
+inline uint64_t instanteAuditoria() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                     std::chrono::system_clock::now().time_since_epoch())
+                                     .count());
+}
+
+// Resumen encadenado de un bloque: su cabecera sin el resumen y sus datos guardados.
+inline uint64_t resumenBloqueAuditoria(const char* cabecera, const char* datos, std::size_t guardados, uint64_t anterior) {
+    return resumenXXH64(datos, guardados, resumenXXH64(cabecera, CABECERA_BLOQUE_AUDITORIA - 8, anterior));
+}
+
+class RegistroAuditoria {
+public:
+    RegistroAuditoria()
+        : instanteBase(0), ultimo(0), registrosBloque(0), ultimaSolicitud(0), ultimoCliente(0), cantidadNombres(0),
+          registros(0), activo(false), resumenAnterior(0), entregados(0), escritos(0), bloquesArchivo(0), bloques(0),
+          bytesOriginales(0), bytesGuardados(0), terminar(false), fallo(false) {
+        tablaNombres.resize(1024);
+    }
+    ~RegistroAuditoria() { cerrar(); }
+
+    // Abre el registro para agregar al final; lo crea si no existe. Falla si el archivo
+    // no es un registro de auditora o termina en un bloque incompleto.
+    bool abrir(const std::string& ruta) {
+        std::lock_guard<std::mutex> guardia(cerrojo);
+        if (archivo.is_open()) {
+            return false;
+        }
+        bool nuevo;
+        if (!buscarFinal(ruta, nuevo)) {
+            return false;
+        }
+        archivo.open(ruta.c_str(), std::ios::binary | std::ios::app);
+        if (!archivo) {
+            return false;
+        }
+        if (nuevo) {
+            archivo.write(MAGICO_AUDITORIA, sizeof(MAGICO_AUDITORIA));
+            archivo.flush();
+        }
+        terminar = false;
+        escritor = std::thread(&RegistroAuditoria::escribir, this);
+        activo = true;
+        return static_cast<bool>(archivo);
+    }
+
+    bool abierto() const {
+        std::lock_guard<std::mutex> guardia(cerrojo);
+        return activo;
+    }
+
+    // Alta, baja o deshacer de un producto, con los datos que quedaron o se quitaron.
+    void producto(OperacionAuditoria operacion, const VistaNombre& almacen, const VistaNombre& nombre, double precio,
+                  int cantidad) {
+        std::lock_guard<std::mutex> guardia(cerrojo);
+        if (!empezarRegistro(operacion, almacen)) {
+            return;
+        }
+        agregarNombre(nombre);
+        agregarPrecio(precio);
+        agregarVarint(pendiente, zigzag(cantidad));
+        terminarRegistro();
+    }
+
+    // descripcion solo se guarda al registrar.
+    void solicitud(OperacionAuditoria operacion, const VistaNombre& almacen, int id, const VistaNombre& descripcion) {
+        std::lock_guard<std::mutex> guardia(cerrojo);
+        if (!empezarRegistro(operacion, almacen)) {
+            return;
+        }
+        agregarId(ultimaSolicitud, id);
+        if (operacion == AuditoriaSolicitudRegistrada) {
+            agregarTexto(descripcion);
+        }
+        terminarRegistro();
+    }
+
+    // nombre solo se guarda al registrar.
+    void cliente(OperacionAuditoria operacion, const VistaNombre& almacen, int id, const VistaNombre& nombre) {
+        std::lock_guard<std::mutex> guardia(cerrojo);
+        if (!empezarRegistro(operacion, almacen)) {
+            return;
+        }
+        agregarId(ultimoCliente, id);
+        if (operacion == AuditoriaClienteRegistrado) {
+            agregarNombre(nombre);
+        }
+        terminarRegistro();
+    }
+
+    void catalogoCargado(const VistaNombre& almacen, const VistaNombre& ruta, uint64_t productos) {
+        std::lock_guard<std::mutex> guardia(cerrojo);
+        if (!empezarRegistro(AuditoriaCatalogoCargado, almacen)) {
+            return;
+        }
+        agregarTexto(ruta);
+        agregarVarint(pendiente, productos);
+        terminarRegistro();
+    }
+
+    // Cierra el bloque en curso aunque no est lleno y espera a que est en disco: lo
+    // registrado hasta aqu sobrevive a una cada del proceso.
+    void volcar() {
+        std::unique_lock<std::mutex> guardia(cerrojo);
+        if (!activo) {
+            return;
+        }
+        entregarBloque();
+        std::unique_lock<std::mutex> guardiaCola(cerrojoCola);
+        uint64_t objetivo = entregados;
+        guardiaCola.unlock();
+        guardia.unlock(); // Los dems siguen registrando mientras se espera.
+        guardiaCola.lock();
+        bloqueEscrito.wait(guardiaCola, [this, objetivo] { return escritos >= objetivo; });
+    }
+
+    // Escribe lo pendiente y la marca de cierre. Lo que se registre despus se descarta.
+    void cerrar() {
+        volcar();
+        std::unique_lock<std::mutex> guardia(cerrojo);
+        if (!activo) {
+            return;
+        }
+        activo = false;
+        entregarBloque(); // Lo registrado desde volcar().
+        {
+            std::lock_guard<std::mutex> guardiaCola(cerrojoCola);
+            terminar = true;
+        }
+        // El escritor puede estar esperando cerrojo antes de ver terminar: no se lo
+        // espera con cerrojo tomado.
+        guardia.unlock();
+        hayBloques.notify_one();
+        escritor.join();
+        escribirCierre();
+        archivo.close();
+    }
+
+    // Cifras de lo ya escrito; se pueden leer desde cualquier hilo.
+    unsigned long long cantidadRegistros() const {
+        std::lock_guard<std::mutex> guardia(cerrojo);
+        return registros;
+    }
+    unsigned long long cantidadBloques() const { return leerCifra(bloques); }
+    unsigned long long bytesSinComprimir() const { return leerCifra(bytesOriginales); }
+    unsigned long long bytesEnDisco() const { return leerCifra(bytesGuardados); }
+    bool fallaEscritura() const { // El archivo rechaz una escritura (disco lleno, ...).
+        std::lock_guard<std::mutex> guardia(cerrojoCola);
+        return fallo;
+    }
+
+private:
+    // Bloque cerrado que espera al hilo escritor.
+    struct BloqueCerrado {
+        std::string datos;
+        uint32_t registros;
+        uint64_t instanteBase;
+    };
+
+    // Un nombre internado: su nmero en el bloque ms uno (0 es una entrada libre).
+    struct EntradaNombre {
+        uint32_t hash;
+        uint32_t numero;
+    };
+
+    // Dnde qued el texto de un nombre dentro del bloque en curso.
+    struct PosicionNombre {
+        uint32_t desplazamiento;
+        uint32_t longitud;
+    };
+
+    // Recorre las cabeceras de un registro existente hasta el final para seguir la
+    // cadena de resmenes; no relee los datos.
+    bool buscarFinal(const std::string& ruta, bool& nuevo) {
+        resumenAnterior = 0;
+        bloquesArchivo = 0;
+        std::ifstream existente(ruta.c_str(), std::ios::binary | std::ios::ate);
+        uint64_t tamano = existente ? static_cast<uint64_t>(existente.tellg()) : 0;
+        nuevo = tamano == 0;
+        if (nuevo) {
+            return true;
+        }
+        char magico[sizeof(MAGICO_AUDITORIA)];
+        existente.seekg(0);
+        if (!existente.read(magico, sizeof(magico)) || std::memcmp(magico, MAGICO_AUDITORIA, sizeof(magico)) != 0) {
+            return false;
+        }
+        char cabecera[CABECERA_BLOQUE_AUDITORIA];
+        for (uint64_t posicion = sizeof(magico); posicion < tamano;) {
+            existente.seekg(static_cast<std::streamoff>(posicion));
+            if (tamano - posicion < CABECERA_BLOQUE_AUDITORIA || !existente.read(cabecera, sizeof(cabecera))) {
+                return false;
+            }
+            if (std::memcmp(cabecera, MAGICO_BLOQUE_AUDITORIA, 4) == 0) {
+                posicion += CABECERA_BLOQUE_AUDITORIA + leerU32(cabecera + 4);
+                ++bloquesArchivo;
+            } else if (std::memcmp(cabecera, MAGICO_CIERRE_AUDITORIA, 4) == 0) {
+                posicion += CABECERA_BLOQUE_AUDITORIA;
+            } else {
+                return false;
+            }
+            if (posicion > tamano) {
+                return false;
+            }
+            resumenAnterior = leerU64(cabecera + 24);
+        }
+        return true;
+    }
+
+    bool empezarRegistro(OperacionAuditoria operacion, const VistaNombre& almacen) {
+        if (!activo) {
+            return false;
+        }
+        uint64_t instante = instanteAuditoria();
+        if (registrosBloque == 0) {
+            instanteBase = instante;
+            ultimo = instante;
+        }
+        agregarVarint(pendiente, instante > ultimo ? instante - ultimo : 0);
+        if (instante > ultimo) {
+            ultimo = instante;
+        }
+        pendiente.push_back(static_cast<char>(operacion));
+        agregarNombre(almacen);
+        return true;
+    }
+
+    void terminarRegistro() {
+        ++registrosBloque;
+        ++registros;
+        if (pendiente.size() >= BLOQUE_AUDITORIA) {
+            entregarBloque();
+        }
+    }
+
+    void agregarTexto(const VistaNombre& texto) {
+        agregarVarint(pendiente, texto.longitud);
+        pendiente.append(texto.datos, texto.longitud);
+    }
+
+    // Los nombres ya vistos en el bloque se buscan en una tabla de direccionamiento
+    // abierto; su texto est en el propio bloque (posicionesNombres), as que internar
+    // un nombre nuevo no reserva memoria.
+    void agregarNombre(const VistaNombre& nombre) {
+        uint32_t hash = static_cast<uint32_t>(hashNombre(nombre.datos, nombre.longitud));
+        std::size_t mascara = tablaNombres.size() - 1;
+        std::size_t i = hash & mascara;
+        for (; tablaNombres[i].numero != 0; i = (i + 1) & mascara) {
+            const EntradaNombre& entrada = tablaNombres[i];
+            if (entrada.hash == hash) {
+                const PosicionNombre& visto = posicionesNombres[entrada.numero - 1];
+                if (visto.longitud == nombre.longitud &&
+                    std::memcmp(pendiente.data() + visto.desplazamiento, nombre.datos, nombre.longitud) == 0) {
+                    agregarVarint(pendiente, entrada.numero);
+                    return;
+                }
+            }
+        }
+        pendiente.push_back(0);
+        agregarVarint(pendiente, nombre.longitud);
+        PosicionNombre posicion = {static_cast<uint32_t>(pendiente.size()), static_cast<uint32_t>(nombre.longitud)};
+        pendiente.append(nombre.datos, nombre.longitud);
+        if (cantidadNombres >= posicionesNombres.size()) {
+            posicionesNombres.resize(posicionesNombres.size() * 2 + 64);
+        }
+        posicionesNombres[cantidadNombres++] = posicion;
+        EntradaNombre entrada = {hash, static_cast<uint32_t>(cantidadNombres)};
+        tablaNombres[i] = entrada;
+        if (cantidadNombres * 2 > tablaNombres.size()) {
+            crecerTablaNombres();
+        }
+    }
+
+    void crecerTablaNombres() {
+        std::vector<EntradaNombre> anterior(tablaNombres.size() * 2);
+        anterior.swap(tablaNombres);
+        std::size_t mascara = tablaNombres.size() - 1;
+        for (const EntradaNombre& entrada : anterior) {
+            if (entrada.numero != 0) {
+                std::size_t i = entrada.hash & mascara;
+                while (tablaNombres[i].numero != 0) {
+                    i = (i + 1) & mascara;
+                }
+                tablaNombres[i] = entrada;
+            }
+        }
+    }
+
+    void agregarPrecio(double precio) {
+        uint64_t bits;
+        std::memcpy(&bits, &precio, sizeof(bits));
+        char bytes[8];
+        escribirU64(bytes, bits);
+        pendiente.append(bytes, sizeof(bytes));
+    }
+
+    void agregarId(int& anterior, int id) {
+        agregarVarint(pendiente, zigzag(static_cast<int64_t>(id) - anterior));
+        anterior = id;
+    }
+
+    // Pasa el bloque en curso al hilo escritor y empieza uno vaco. Si el escritor va
+    // atrasado ms de MAXIMO_COLA_AUDITORIA bloques, espera: no se descarta nada. El
+    // propio escritor no puede esperarse a s mismo: con esperar = false, si la cola
+    // est llena no entrega.
+    void entregarBloque(bool esperar = true) {
+        if (registrosBloque == 0) {
+            return;
+        }
+        {
+            std::unique_lock<std::mutex> guardiaCola(cerrojoCola);
+            if (!esperar && entregados - escritos >= MAXIMO_COLA_AUDITORIA) {
+                return;
+            }
+            bloqueEscrito.wait(guardiaCola, [this] { return entregados - escritos < MAXIMO_COLA_AUDITORIA; });
+            cola.push_back(BloqueCerrado());
+            BloqueCerrado& bloque = cola.back();
+            bloque.datos.swap(pendiente);
+            bloque.registros = registrosBloque;
+            bloque.instanteBase = instanteBase;
+            ++entregados;
+            if (!libres.empty()) {
+                pendiente.swap(libres.back()); // Reusa la memoria de un bloque ya escrito.
+                libres.pop_back();
+            }
+        }
+        hayBloques.notify_one();
+        pendiente.clear();
+        std::fill(tablaNombres.begin(), tablaNombres.end(), EntradaNombre());
+        cantidadNombres = 0;
+        registrosBloque = 0;
+        ultimaSolicitud = 0;
+        ultimoCliente = 0;
+    }
+
+    // Hilo escritor: comprime, encadena y escribe los bloques en el orden en que llegan.
+    void escribir() {
+        std::vector<BloqueCerrado> lote;
+        std::string salidaLote;
+        std::string comprimido;
+        std::unique_lock<std::mutex> guardiaCola(cerrojoCola);
+        for (;;) {
+            if (!hayBloques.wait_for(guardiaCola, std::chrono::seconds(1), [this] { return terminar || !cola.empty(); })) {
+                // Un segundo sin bloques llenos: lo registrado hasta aqu se escribe igual.
+                // Si cerrojo est tomado, quien lo tiene est registrando o cerrando (y
+                // puede estar esperando a este hilo): se deja para el prximo segundo.
+                guardiaCola.unlock();
+                {
+                    std::unique_lock<std::mutex> guardia(cerrojo, std::try_to_lock);
+                    if (guardia.owns_lock()) {
+                        entregarBloque(false);
+                    }
+                }
+                guardiaCola.lock();
+                continue;
+            }
+            if (cola.empty()) {
+                return; // terminar y no queda nada.
+            }
+            lote.swap(cola);
+            guardiaCola.unlock();
+
+            salidaLote.clear();
+            unsigned long long originales = 0;
+            for (BloqueCerrado& bloque : lote) {
+                comprimirBloqueAuditoria(bloque, comprimido);
+                salidaLote += comprimido;
+                originales += bloque.datos.size();
+            }
+            archivo.write(salidaLote.data(), static_cast<std::streamsize>(salidaLote.size()));
+            archivo.flush();
+            bool correcto = static_cast<bool>(archivo);
+
+            guardiaCola.lock();
+            fallo = fallo || !correcto;
+            escritos += lote.size();
+            bloquesArchivo += lote.size();
+            bloques += lote.size();
+            bytesOriginales += originales;
+            bytesGuardados += salidaLote.size();
+            for (BloqueCerrado& bloque : lote) {
+                libres.push_back(std::string());
+                libres.back().swap(bloque.datos);
+            }
+            lote.clear();
+            bloqueEscrito.notify_all();
+        }
+    }
+
+    // Cabecera y datos de un bloque como van al archivo.
+    void comprimirBloqueAuditoria(const BloqueCerrado& bloque, std::string& destino) {
+        const std::string& datosOriginales = bloque.datos;
+        destino.resize(CABECERA_BLOQUE_AUDITORIA + cotaComprimido(datosOriginales.size()));
+        char* datos = &destino[CABECERA_BLOQUE_AUDITORIA];
+        std::size_t guardados = comprimirBloque(datosOriginales.data(), datosOriginales.size(), datos);
+        if (guardados >= datosOriginales.size()) {
+            guardados = datosOriginales.size();
+            std::memcpy(datos, datosOriginales.data(), guardados);
+        }
+        char* cabecera = &destino[0];
+        std::memcpy(cabecera, MAGICO_BLOQUE_AUDITORIA, 4);
+        escribirU32(cabecera + 4, static_cast<uint32_t>(guardados));
+        escribirU32(cabecera + 8, static_cast<uint32_t>(datosOriginales.size()));
+        escribirU32(cabecera + 12, bloque.registros);
+        escribirU64(cabecera + 16, bloque.instanteBase);
+        resumenAnterior = resumenBloqueAuditoria(cabecera, datos, guardados, resumenAnterior);
+        escribirU64(cabecera + 24, resumenAnterior);
+        destino.resize(CABECERA_BLOQUE_AUDITORIA + guardados);
+    }
+
+    // Con el escritor ya terminado, el archivo es de quien cierra.
+    void escribirCierre() {
+        char cierre[CABECERA_BLOQUE_AUDITORIA];
+        std::memcpy(cierre, MAGICO_CIERRE_AUDITORIA, 4);
+        escribirU32(cierre + 4, 0);
+        escribirU64(cierre + 8, bloquesArchivo);
+        escribirU64(cierre + 16, instanteAuditoria());
+        resumenAnterior = resumenBloqueAuditoria(cierre, cierre, 0, resumenAnterior);
+        escribirU64(cierre + 24, resumenAnterior);
+        archivo.write(cierre, sizeof(cierre));
+        archivo.flush();
+        std::lock_guard<std::mutex> guardiaCola(cerrojoCola);
+        fallo = fallo || !archivo;
+    }
+
+    unsigned long long leerCifra(const unsigned long long& cifra) const {
+        std::lock_guard<std::mutex> guardia(cerrojoCola);
+        return cifra;
+    }
+
+    static const uint64_t MAXIMO_COLA_AUDITORIA = 64;
+
+    // Estado del bloque en curso; lo protege cerrojo.
+    mutable std::mutex cerrojo;
+    std::string pendiente; // Registros del bloque en curso, sin comprimir.
+    uint64_t instanteBase;
+    uint64_t ultimo;
+    uint32_t registrosBloque;
+    int ultimaSolicitud;
+    int ultimoCliente;
+    std::vector<EntradaNombre> tablaNombres;   // Potencia de 2, ocupada a lo sumo a la mitad.
+    std::vector<PosicionNombre> posicionesNombres;
+    std::size_t cantidadNombres;
+    unsigned long long registros;
+    bool activo; // Entre abrir() y cerrar().
+
+    // Cola hacia el hilo escritor; la protege cerrojoCola. El archivo y resumenAnterior
+    // son del hilo escritor mientras est en marcha.
+    mutable std::mutex cerrojoCola;
+    std::condition_variable hayBloques;
+    std::condition_variable bloqueEscrito;
+    std::vector<BloqueCerrado> cola;
+    std::vector<std::string> libres;
+    std::thread escritor;
+    std::ofstream archivo;
+    uint64_t resumenAnterior;
+    uint64_t entregados;
+    uint64_t escritos;
+    uint64_t bloquesArchivo; // Incluye los que ya tena el archivo, para la marca de cierre.
+    unsigned long long bloques;
+    unsigned long long bytesOriginales;
+    unsigned long long bytesGuardados;
+    bool terminar;
+    bool fallo;
+};
+
+// Un registro decodificado. Las vistas apuntan al bloque en curso del lector: valen
+// hasta la siguiente llamada a siguiente().
+struct EventoAuditoria {
+    uint64_t instante; // s desde 1970.
+    int operacion;
+    VistaNombre almacen;
+    VistaNombre nombre; // Producto o cliente.
+    VistaNombre texto;  // Descripcin de la solicitud o ruta del catlogo.
+    double precio;
+    int cantidad;
+    int id;
+    uint64_t productos;
+};
+
+// Lee un registro de auditora bloque a bloque: en memoria solo est el bloque en
+// curso, as que sirve para registros de cualquier tamao. Comprueba la cadena de
+// resmenes antes de descomprimir cada bloque, y las marcas de cierre.
+class LectorAuditoria {
+public:
+    LectorAuditoria()
+        : posicion(0), siguientePosicion(0), bloques(0), bytesOriginales(0), bytesGuardados(0), resumenAnterior(0), instante(0),
+          ultimaSolicitud(0), ultimoCliente(0), restantes(0), cierre(false), dano(nullptr) {}
+
+    bool abrir(const std::string& ruta) {
+        archivo.open(ruta.c_str(), std::ios::binary);
+        char magico[sizeof(MAGICO_AUDITORIA)];
+        if (!archivo || !archivo.read(magico, sizeof(magico)) ||
+            std::memcmp(magico, MAGICO_AUDITORIA, sizeof(magico)) != 0) {
+            return false;
+        }
+        siguientePosicion = sizeof(magico);
+        return true;
+    }
+
+    // Lee el siguiente registro; devuelve false al final o si el registro est daado
+    // (en ese caso danado() es true y error() dice qu fall).
+    bool siguiente(EventoAuditoria& evento) {
+        while (restantes == 0) {
+            if (dano || !leerBloque()) {
+                return false;
+            }
+        }
+        uint64_t delta, valor;
+        if (!leerEntero(delta) || p == fin) {
+            return marcarDanado("registro truncado");
+        }
+        instante += delta;
+        evento.instante = instante;
+        evento.operacion = static_cast<uint8_t>(*p++);
+        if (!leerNombre(evento.almacen)) {
+            return marcarDanado("nombre de almacn invlido");
+        }
+        switch (evento.operacion) {
+            case AuditoriaProductoRegistrado:
+            case AuditoriaProductoEliminado:
+            case AuditoriaAgregadoDeshecho:
+            case AuditoriaEliminacionDeshecha: {
+                if (!leerNombre(evento.nombre) || fin - p < 8) {
+                    return marcarDanado("producto invlido");
+                }
+                uint64_t bits = leerU64(p);
+                p += 8;
+                std::memcpy(&evento.precio, &bits, sizeof(bits));
+                if (!leerEntero(valor)) {
+                    return marcarDanado("cantidad invlida");
+                }
+                evento.cantidad = static_cast<int>(desdeZigzag(valor));
+                break;
+            }
+            case AuditoriaSolicitudRegistrada:
+            case AuditoriaSolicitudProcesada:
+                if (!leerId(ultimaSolicitud, evento.id) ||
+                    (evento.operacion == AuditoriaSolicitudRegistrada && !leerTexto(evento.texto))) {
+                    return marcarDanado("solicitud invlida");
+                }
+                break;
+            case AuditoriaClienteRegistrado:
+            case AuditoriaClienteAtendido:
+                if (!leerId(ultimoCliente, evento.id) ||
+                    (evento.operacion == AuditoriaClienteRegistrado && !leerNombre(evento.nombre))) {
+                    return marcarDanado("cliente invlido");
+                }
+                break;
+            case AuditoriaCatalogoCargado:
+                if (!leerTexto(evento.texto) || !leerEntero(evento.productos)) {
+                    return marcarDanado("catlogo invlido");
+                }
+                break;
+            default:
+                return marcarDanado("operacin desconocida");
+        }
+        --restantes;
+        if (restantes == 0 && p != fin) {
+            return marcarDanado("sobran bytes al final del bloque");
+        }
+        return true;
+    }
+
+    bool danado() const { return dano != nullptr; }
+    // Lo ledo hasta aqu termina en una marca de cierre vlida. Al final del archivo,
+    // false quiere decir que no se puede asegurar que est completo.
+    bool cerrado() const { return cierre; }
+    const char* error() const { return dano ? dano : ""; }
+    uint64_t posicionBloque() const { return posicion; } // Byte donde empieza el bloque en curso.
+    unsigned long long cantidadBloques() const { return bloques; }
+    unsigned long long bytesSinComprimir() const { return bytesOriginales; }
+    unsigned long long bytesEnDisco() const { return bytesGuardados; }
+
+private:
+    // Lee, verifica y descomprime el siguiente bloque. false al final del archivo o si
+    // el bloque est daado.
+    bool leerBloque() {
+        posicion = siguientePosicion;
+        guardado.resize(CABECERA_BLOQUE_AUDITORIA);
+        archivo.read(&guardado[0], static_cast<std::streamsize>(CABECERA_BLOQUE_AUDITORIA));
+        if (archivo.gcount() == 0) {
+            return false; // Final del registro.
+        }
+        if (static_cast<std::size_t>(archivo.gcount()) < CABECERA_BLOQUE_AUDITORIA) {
+            return marcarDanado("cabecera de bloque incompleta");
+        }
+        const char* cabecera = guardado.data();
+        if (std::memcmp(cabecera, MAGICO_CIERRE_AUDITORIA, 4) == 0) {
+            return leerCierre(cabecera);
+        }
+        uint32_t guardados = leerU32(cabecera + 4);
+        uint32_t originales = leerU32(cabecera + 8);
+        if (std::memcmp(cabecera, MAGICO_BLOQUE_AUDITORIA, 4) != 0 || guardados > originales ||
+            originales > MAXIMO_BLOQUE_AUDITORIA) {
+            return marcarDanado("cabecera de bloque invlida");
+        }
+        guardado.resize(CABECERA_BLOQUE_AUDITORIA + guardados);
+        archivo.read(&guardado[CABECERA_BLOQUE_AUDITORIA], guardados);
+        if (static_cast<uint32_t>(archivo.gcount()) != guardados) {
+            return marcarDanado("bloque incompleto");
+        }
+        cabecera = guardado.data();
+        const char* datos = cabecera + CABECERA_BLOQUE_AUDITORIA;
+        uint64_t resumen = leerU64(cabecera + 24);
+        if (resumenBloqueAuditoria(cabecera, datos, guardados, resumenAnterior) != resumen) {
+            return marcarDanado("el resumen no coincide (bloque alterado o fuera de orden)");
+        }
+
+        if (guardados == originales) {
+            p = datos;
+        } else {
+            bloque.resize(originales);
+            std::size_t escritos;
+            if (!descomprimirBloque(datos, guardados, &bloque[0], originales, escritos) || escritos != originales) {
+                return marcarDanado("datos comprimidos invlidos");
+            }
+            p = bloque.data();
+        }
+        fin = p + originales;
+        siguientePosicion = posicion + CABECERA_BLOQUE_AUDITORIA + guardados;
+        resumenAnterior = resumen;
+        restantes = leerU32(cabecera + 12);
+        instante = leerU64(cabecera + 16);
+        ultimaSolicitud = 0;
+        ultimoCliente = 0;
+        nombres.clear();
+        cierre = false;
+        ++bloques;
+        bytesOriginales += originales;
+        bytesGuardados += CABECERA_BLOQUE_AUDITORIA + guardados;
+        return true;
+    }
+
+    // La marca cuenta los bloques desde el principio del archivo y sigue la cadena.
+    bool leerCierre(const char* cabecera) {
+        uint64_t resumen = leerU64(cabecera + 24);
+        if (leerU64(cabecera + 8) != bloques || resumenBloqueAuditoria(cabecera, cabecera, 0, resumenAnterior) != resumen) {
+            return marcarDanado("la marca de cierre no coincide con los bloques anteriores");
+        }
+        siguientePosicion = posicion + CABECERA_BLOQUE_AUDITORIA;
+        resumenAnterior = resumen;
+        bytesGuardados += CABECERA_BLOQUE_AUDITORIA;
+        cierre = true;
+        return true;
+    }
+
+    // La mayora de los varint de un registro ocupan un byte: ese caso no entra al bucle.
+    bool leerEntero(uint64_t& valor) {
+        if (p < fin && !(*p & 0x80)) {
+            valor = static_cast<uint8_t>(*p++);
+            return true;
+        }
+        return leerVarint(p, fin, valor);
+    }
+
+    bool leerTexto(VistaNombre& texto) {
+        uint64_t longitud;
+        if (!leerEntero(longitud) || longitud > static_cast<uint64_t>(fin - p)) {
+            return false;
+        }
+        texto.datos = p;
+        texto.longitud = static_cast<std::size_t>(longitud);
+        p += longitud;
+        return true;
+    }
+
+    bool leerNombre(VistaNombre& nombre) {
+        uint64_t referencia;
+        if (!leerEntero(referencia)) {
+            return false;
+        }
+        if (referencia == 0) {
+            if (!leerTexto(nombre)) {
+                return false;
+            }
+            nombres.push_back(nombre);
+            return true;
+        }
+        if (referencia > nombres.size()) {
+            return false;
+        }
+        nombre = nombres[static_cast<std::size_t>(referencia - 1)];
+        return true;
+    }
+
+    bool leerId(int& anterior, int& id) {
+        uint64_t valor;
+        if (!leerEntero(valor)) {
+            return false;
+        }
+        id = static_cast<int>(anterior + desdeZigzag(valor));
+        anterior = id;
+        return true;
+    }
+
+    bool marcarDanado(const char* motivo) {
+        dano = motivo;
+        restantes = 0;
+        return false;
+    }
+
+    std::ifstream archivo;
+    std::string guardado; // Cabecera y datos del bloque tal como estn en el archivo.
+    std::string bloque;   // Datos descomprimidos.
+    std::vector<VistaNombre> nombres;
+    const char* p;
+    const char* fin;
+    uint64_t posicion;
+    uint64_t siguientePosicion;
+    unsigned long long bloques;
+    unsigned long long bytesOriginales;
+    unsigned long long bytesGuardados;
+    uint64_t resumenAnterior;
+    uint64_t instante;
+    int ultimaSolicitud;
+    int ultimoCliente;
+    uint32_t restantes;
+    bool cierre;
+    const char* dano;
+};
+
+#endif
@@ -0,0 +1,534 @@
+#ifndef AUTOCOMPLETADO_H
+#define AUTOCOMPLETADO_H
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+#include <stdint.h>
+
+#include "estructuras.h"
+#include "memoria_estructuras.h"
+
+// Autocompletado de nombres de producto
+// rbol radix compacto (un trie en el que las cadenas de nodos de un solo hijo se
+// fusionan en una etiqueta) sobre los nombres distintos del inventario. Cada nodo
+// guarda las SUGERENCIAS_AUTOCOMPLETADO mejores compleciones de su subrbol, ordenadas
+// por consultas (bsquedas que encontraron el nombre) y, entre iguales, por nombre.
+// Completar un prefijo es bajar por el rbol y copiar la lista del nodo donde termina:
+// no se recorre el subrbol, as que el costo depende del largo del prefijo y no de la
+// cantidad de nombres.
+//
+// Las listas se mantienen en cada cambio:
+//   - una consulta ms solo puede subir a un nombre: se ofrece a los nodos de su
+//     camino, de abajo hacia la raz, hasta el primero que no lo acepta (un ancestro
+//     compite con ms nombres, as que tampoco lo aceptara);
+//   - un nombre nuevo se ofrece igual, despus de dividir la etiqueta donde se separa;
+//   - un nombre que se va sale de las listas que lo tenan, que se recalculan con las
+//     de los hijos, y su nodo se fusiona con el hijo si queda con uno solo.
+//
+// Para que el rbol ocupe poco:
+//   - un nombre que no es prefijo de otro (casi todos) es una hoja: cuelga de su padre
+//     sin nodo propio, porque su lista sera l mismo;
+//   - las etiquetas no se copian: la de una hoja es el final de su nombre y la de un
+//     nodo, bytes del nombre de su primera sugerencia, que est en su subrbol y por lo
+//     tanto empieza con el camino hasta l.
+//
+// El inventario admite nombres repetidos: cada nombre cuenta sus copias y sale del
+// ndice cuando se va la ltima.
+//
+// Las consultas de un nombre que sale se pierden; SistemaGestion las guarda en el
+// historial y, si se deshace la baja, lo vuelve a agregar con ellas.
+
+static const std::size_t SUGERENCIAS_AUTOCOMPLETADO = 8;
+
+class IndiceAutocompletado {
+public:
+    IndiceAutocompletado() : ranuras(16, 0), ocupadas(0) { nodos.push_back(NodoAutocompletado()); }
+
+    // Una copia ms del nombre; si es nuevo entra con las consultas indicadas.
+    void agregar(const VistaNombre& nombre, uint32_t consultasIniciales = 0) {
+        uint64_t hash = hashNombre(nombre.datos, nombre.longitud);
+        std::size_t ranura = ranuraDe(nombre, hash);
+        if (ranuras[ranura] != 0) {
+            ++entradas[ranuras[ranura] - 1].copias;
+            return;
+        }
+        // Factor de carga mximo de 0.5.
+        if ((ocupadas + 1) * 2 > ranuras.size()) {
+            crecer();
+            ranura = ranuraDe(nombre, hash);
+        }
+        uint32_t entrada = nuevaEntrada(nombre, hash, consultasIniciales);
+        ranuras[ranura] = entrada + 1;
+        ++ocupadas;
+        ofrecerHastaRaiz(insertarEnArbol(entrada), entrada);
+    }
+
+    // Una copia menos del nombre; con la ltima sale del ndice.
+    void quitar(const VistaNombre& nombre) {
+        std::size_t ranura = ranuraDe(nombre, hashNombre(nombre.datos, nombre.longitud));
+        if (ranuras[ranura] == 0) {
+            return;
+        }
+        uint32_t entrada = ranuras[ranura] - 1;
+        if (--entradas[entrada].copias > 0) {
+            return;
+        }
+        liberarRanura(ranura);
+        --ocupadas;
+        for (uint32_t nodo = quitarDelArbol(entrada); nodo != NINGUNO && contiene(nodos[nodo], entrada);
+             nodo = nodos[nodo].padre) {
+            recalcular(nodo);
+        }
+        // Recin ahora nadie usa el nombre como etiqueta.
+        std::string().swap(entradas[entrada].nombre);
+        entradasLibres.push_back(entrada);
+    }
+
+    // Suma una consulta al nombre, si est.
+    void anotarConsulta(const VistaNombre& nombre) {
+        uint32_t valor = ranuras[ranuraDe(nombre, hashNombre(nombre.datos, nombre.longitud))];
+        if (valor == 0 || entradas[valor - 1].consultas == UINT32_MAX) {
+            return;
+        }
+        EntradaAutocompletado& entrada = entradas[valor - 1];
+        ++entrada.consultas;
+        ofrecerHastaRaiz(entrada.nodo != NINGUNO ? entrada.nodo : entrada.padre, valor - 1);
+    }
+
+    uint32_t consultas(const VistaNombre& nombre) const {
+        uint32_t valor = ranuras[ranuraDe(nombre, hashNombre(nombre.datos, nombre.longitud))];
+        return valor == 0 ? 0 : entradas[valor - 1].consultas;
+    }
+
+    // Llama a f(const VistaNombre& nombre, uint32_t consultas) con hasta limite nombres
+    // que empiezan con prefijo, de ms a menos consultados; devuelve cuntos fueron.
+    // limite no puede superar SUGERENCIAS_AUTOCOMPLETADO.
+    template <class F>
+    std::size_t completar(const VistaNombre& prefijo, std::size_t limite, F f) const {
+        uint32_t referencia = RAIZ;
+        std::size_t posicion = 0;
+        while (posicion < prefijo.longitud) {
+            if (referencia & HOJA) {
+                return 0; // El prefijo sigue despus del nombre.
+            }
+            const std::vector<HijoAutocompletado>& hijos = nodos[referencia].hijos;
+            unsigned char byte = static_cast<unsigned char>(prefijo.datos[posicion]);
+            std::vector<HijoAutocompletado>::const_iterator hijo = buscarHijo(hijos, byte);
+            if (hijo == hijos.end() || hijo->byte != byte) {
+                return 0;
+            }
+            referencia = hijo->referencia;
+            // El primer byte ya coincidi; el prefijo puede terminar a mitad de la etiqueta.
+            std::size_t comparar = std::min(longitudEtiqueta(referencia), prefijo.longitud - posicion);
+            if (std::memcmp(etiquetaDe(referencia) + 1, prefijo.datos + posicion + 1, comparar - 1) != 0) {
+                return 0;
+            }
+            posicion += comparar;
+        }
+        if (referencia & HOJA) {
+            if (limite == 0) {
+                return 0;
+            }
+            const EntradaAutocompletado& entrada = entradas[referencia & ~HOJA];
+            f(vistaDe(entrada.nombre), entrada.consultas);
+            return 1;
+        }
+        const NodoAutocompletado& encontrado = nodos[referencia];
+        std::size_t cantidad = std::min<std::size_t>(limite, encontrado.cantidadMejores);
+        for (std::size_t i = 0; i < cantidad; ++i) {
+            f(vistaDe(entradas[encontrado.mejores[i].entrada].nombre), encontrado.mejores[i].consultas);
+        }
+        return cantidad;
+    }
+
+    std::size_t tamano() const { return ocupadas; }
+
+    // Recorre los nodos y los nombres: para los reportes, no para cada operacin.
+    MemoriaEstructura memoria() const {
+        MemoriaEstructura memoria;
+        memoria.elementos = static_cast<int64_t>(ocupadas);
+        memoria += bloqueMonton(nodos.capacity() * sizeof(NodoAutocompletado));
+        memoria += bloqueMonton(entradas.capacity() * sizeof(EntradaAutocompletado));
+        memoria += bloqueMonton(ranuras.capacity() * sizeof(uint32_t));
+        memoria += bloqueMonton(nodosLibres.capacity() * sizeof(uint32_t));
+        memoria += bloqueMonton(entradasLibres.capacity() * sizeof(uint32_t));
+        memoria += bloqueMonton(candidatos.capacity() * sizeof(MejorAutocompletado));
+        for (const NodoAutocompletado& nodo : nodos) {
+            memoria += bloqueMonton(nodo.hijos.capacity() * sizeof(HijoAutocompletado));
+        }
+        for (const EntradaAutocompletado& entrada : entradas) {
+            contarCadena(memoria, entrada.nombre);
+        }
+        return memoria;
+    }
+
+private:
+    static const uint32_t NINGUNO = 0xFFFFFFFFu;
+    static const uint32_t RAIZ = 0;
+    static const uint32_t HOJA = 0x80000000u; // Marca de un hijo que es una entrada y no un nodo.
+
+    struct EntradaAutocompletado {
+        std::string nombre;
+        uint64_t hash;
+        uint32_t nodo;        // Nodo donde termina el nombre, o NINGUNO si es una hoja.
+        uint32_t padre;       // Si es una hoja, el nodo del que cuelga
+        uint32_t profundidad; // y dnde empieza su etiqueta.
+        uint32_t copias;      // Productos del inventario con este nombre.
+        uint32_t consultas;   // Se satura en UINT32_MAX.
+    };
+
+    struct MejorAutocompletado {
+        uint32_t entrada;
+        uint32_t consultas; // Copia de la de la entrada, para ordenar sin ir a buscarla.
+    };
+
+    struct HijoAutocompletado {
+        unsigned char byte;  // Primer byte de la etiqueta del hijo.
+        uint32_t referencia; // Nodo, o entrada | HOJA.
+    };
+
+    struct NodoAutocompletado {
+        NodoAutocompletado()
+            : padre(NINGUNO), entrada(NINGUNO), profundidad(0), longitud(0), cantidadMejores(0), mejores() {}
+        uint32_t padre;
+        uint32_t entrada;     // Nombre que termina en este nodo, o NINGUNO.
+        uint32_t profundidad; // Bytes del camino antes de la etiqueta.
+        uint32_t longitud;    // Bytes de la etiqueta.
+        uint32_t cantidadMejores;
+        MejorAutocompletado mejores[SUGERENCIAS_AUTOCOMPLETADO];
+        std::vector<HijoAutocompletado> hijos; // Ordenados por byte.
+    };
+
+    // Etiqueta de un hijo (un nodo que no es la raz, o una hoja) y su largo.
+    const char* etiquetaDe(uint32_t referencia) const {
+        if (referencia & HOJA) {
+            const EntradaAutocompletado& entrada = entradas[referencia & ~HOJA];
+            return entrada.nombre.data() + entrada.profundidad;
+        }
+        const NodoAutocompletado& nodo = nodos[referencia];
+        return entradas[nodo.mejores[0].entrada].nombre.data() + nodo.profundidad;
+    }
+
+    std::size_t longitudEtiqueta(uint32_t referencia) const {
+        if (referencia & HOJA) {
+            const EntradaAutocompletado& entrada = entradas[referencia & ~HOJA];
+            return entrada.nombre.size() - entrada.profundidad;
+        }
+        return nodos[referencia].longitud;
+    }
+
+    static std::vector<HijoAutocompletado>::const_iterator buscarHijo(const std::vector<HijoAutocompletado>& hijos,
+                                                                      unsigned char byte) {
+        return std::lower_bound(hijos.begin(), hijos.end(), byte,
+                                [](const HijoAutocompletado& hijo, unsigned char b) { return hijo.byte < b; });
+    }
+
+    // Orden de las sugerencias: ms consultas primero y, si empatan, el nombre menor.
+    bool antes(const MejorAutocompletado& a, const MejorAutocompletado& b) const {
+        if (a.consultas != b.consultas) {
+            return a.consultas > b.consultas;
+        }
+        return entradas[a.entrada].nombre < entradas[b.entrada].nombre;
+    }
+
+    static bool contiene(const NodoAutocompletado& nodo, uint32_t entrada) {
+        for (uint32_t i = 0; i < nodo.cantidadMejores; ++i) {
+            if (nodo.mejores[i].entrada == entrada) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Pone la entrada en la lista del nodo si le corresponde, o la reubica si ya estaba;
+    // su puntaje solo puede haber subido. Devuelve si qued en la lista.
+    bool ofrecer(NodoAutocompletado& nodo, const MejorAutocompletado& candidato) const {
+        uint32_t i = 0;
+        while (i < nodo.cantidadMejores && nodo.mejores[i].entrada != candidato.entrada) {
+            ++i;
+        }
+        if (i == nodo.cantidadMejores) {
+            if (i == SUGERENCIAS_AUTOCOMPLETADO) {
+                if (!antes(candidato, nodo.mejores[i - 1])) {
+                    return false;
+                }
+                --i; // Reemplaza a la ltima.
+            } else {
+                ++nodo.cantidadMejores;
+            }
+        }
+        nodo.mejores[i] = candidato;
+        for (; i > 0 && antes(nodo.mejores[i], nodo.mejores[i - 1]); --i) {
+            std::swap(nodo.mejores[i], nodo.mejores[i - 1]);
+        }
+        return true;
+    }
+
+    void ofrecerHastaRaiz(uint32_t nodo, uint32_t entrada) {
+        MejorAutocompletado candidato = {entrada, entradas[entrada].consultas};
+        for (; nodo != NINGUNO && ofrecer(nodos[nodo], candidato); nodo = nodos[nodo].padre) {
+        }
+    }
+
+    // Rehace la lista del nodo con su propio nombre, sus hojas y las listas de sus hijos.
+    void recalcular(uint32_t indice) {
+        NodoAutocompletado& nodo = nodos[indice];
+        candidatos.clear();
+        if (nodo.entrada != NINGUNO) {
+            MejorAutocompletado propio = {nodo.entrada, entradas[nodo.entrada].consultas};
+            candidatos.push_back(propio);
+        }
+        for (const HijoAutocompletado& hijo : nodo.hijos) {
+            if (hijo.referencia & HOJA) {
+                uint32_t entrada = hijo.referencia & ~HOJA;
+                MejorAutocompletado hoja = {entrada, entradas[entrada].consultas};
+                candidatos.push_back(hoja);
+            } else {
+                const NodoAutocompletado& h = nodos[hijo.referencia];
+                candidatos.insert(candidatos.end(), h.mejores, h.mejores + h.cantidadMejores);
+            }
+        }
+        std::size_t cantidad = std::min(SUGERENCIAS_AUTOCOMPLETADO, candidatos.size());
+        std::partial_sort(candidatos.begin(), candidatos.begin() + cantidad, candidatos.end(),
+                          [this](const MejorAutocompletado& a, const MejorAutocompletado& b) { return antes(a, b); });
+        std::copy(candidatos.begin(), candidatos.begin() + cantidad, nodo.mejores);
+        nodo.cantidadMejores = static_cast<uint32_t>(cantidad);
+    }
+
+    // Baja por el nombre de la entrada, dividiendo la etiqueta donde se separa, y lo
+    // cuelga como hoja o lo deja en el nodo donde termina. Devuelve el primer nodo cuya
+    // lista puede recibirlo; las listas se completan despus.
+    uint32_t insertarEnArbol(uint32_t entrada) {
+        const std::string& nombre = entradas[entrada].nombre;
+        uint32_t nodo = RAIZ;
+        std::size_t posicion = 0;
+        for (;;) {
+            if (posicion == nombre.size()) {
+                nodos[nodo].entrada = entrada;
+                entradas[entrada].nodo = nodo;
+                return nodo;
+            }
+            unsigned char byte = static_cast<unsigned char>(nombre[posicion]);
+            std::vector<HijoAutocompletado>& hijos = nodos[nodo].hijos;
+            std::vector<HijoAutocompletado>::const_iterator hijo = buscarHijo(hijos, byte);
+            if (hijo == hijos.end() || hijo->byte != byte) {
+                HijoAutocompletado hoja = {byte, entrada | HOJA};
+                hijos.insert(hijos.begin() + (hijo - hijos.begin()), hoja);
+                colgar(entrada, nodo, posicion);
+                return nodo;
+            }
+            uint32_t siguiente = hijo->referencia;
+            const char* etiqueta = etiquetaDe(siguiente);
+            std::size_t longitud = longitudEtiqueta(siguiente);
+            std::size_t maximo = std::min(longitud, nombre.size() - posicion);
+            std::size_t comun = 1;
+            while (comun < maximo && etiqueta[comun] == nombre[posicion + comun]) {
+                ++comun;
+            }
+            // Una hoja necesita un nodo aunque el nombre nuevo la contenga entera.
+            if (comun < longitud || (siguiente & HOJA)) {
+                siguiente = dividir(siguiente, nodo, comun);
+            }
+            nodo = siguiente;
+            posicion += comun;
+        }
+    }
+
+    // Pone un nodo nuevo con los primeros corte bytes de la etiqueta del hijo, entre el
+    // hijo y su padre, y lo devuelve.
+    uint32_t dividir(uint32_t hijo, uint32_t padre, std::size_t corte) {
+        const char* etiqueta = etiquetaDe(hijo);
+        std::size_t longitud = longitudEtiqueta(hijo);
+        unsigned char byteHijo = corte < longitud ? static_cast<unsigned char>(etiqueta[corte]) : 0;
+        std::size_t profundidad = etiqueta - (hijo & HOJA ? entradas[hijo & ~HOJA].nombre.data()
+                                                          : entradas[nodos[hijo].mejores[0].entrada].nombre.data());
+        uint32_t medio = nuevoNodo(padre, profundidad, corte);
+        NodoAutocompletado& arriba = nodos[medio];
+        if (hijo & HOJA) {
+            uint32_t entrada = hijo & ~HOJA;
+            MejorAutocompletado unica = {entrada, entradas[entrada].consultas};
+            arriba.mejores[0] = unica;
+            arriba.cantidadMejores = 1;
+            if (corte == longitud) {
+                // El nombre de la hoja termina en el nodo nuevo.
+                arriba.entrada = entrada;
+                entradas[entrada].nodo = medio;
+            } else {
+                HijoAutocompletado abajo = {byteHijo, hijo};
+                arriba.hijos.push_back(abajo);
+                colgar(entrada, medio, profundidad + corte);
+            }
+        } else {
+            NodoAutocompletado& abajo = nodos[hijo];
+            std::copy(abajo.mejores, abajo.mejores + abajo.cantidadMejores, arriba.mejores);
+            arriba.cantidadMejores = abajo.cantidadMejores;
+            HijoAutocompletado nuevo = {byteHijo, hijo};
+            arriba.hijos.push_back(nuevo);
+            abajo.profundidad += static_cast<uint32_t>(corte);
+            abajo.longitud -= static_cast<uint32_t>(corte);
+            abajo.padre = medio;
+        }
+        reemplazarHijo(padre, hijo, medio);
+        return medio;
+    }
+
+    // Saca el nombre de la entrada del rbol y devuelve el nodo ms bajo cuya lista
+    // puede tenerlo.
+    uint32_t quitarDelArbol(uint32_t entrada) {
+        EntradaAutocompletado& e = entradas[entrada];
+        uint32_t nodo;
+        if (e.nodo != NINGUNO) {
+            nodo = e.nodo;
+            nodos[nodo].entrada = NINGUNO;
+        } else {
+            nodo = e.padre;
+            std::vector<HijoAutocompletado>& hijos = nodos[nodo].hijos;
+            uint32_t referencia = entrada | HOJA;
+            hijos.erase(std::find_if(hijos.begin(), hijos.end(),
+                                     [referencia](const HijoAutocompletado& hijo) { return hijo.referencia == referencia; }));
+        }
+        if (nodo == RAIZ) {
+            return nodo;
+        }
+        NodoAutocompletado& n = nodos[nodo];
+        uint32_t padre = n.padre;
+        if (n.entrada == NINGUNO && n.hijos.size() == 1) {
+            // Un nodo sin nombre propio y con un solo hijo sobra: el hijo ocupa su lugar.
+            uint32_t unico = n.hijos[0].referencia;
+            if (unico & HOJA) {
+                colgar(unico & ~HOJA, padre, n.profundidad);
+            } else {
+                NodoAutocompletado& h = nodos[unico];
+                h.profundidad = n.profundidad;
+                h.longitud += n.longitud;
+                h.padre = padre;
+            }
+            reemplazarHijo(padre, nodo, unico);
+            liberarNodo(nodo);
+            return padre;
+        }
+        if (n.entrada != NINGUNO && n.hijos.empty()) {
+            // Qued solo su nombre: pasa a ser una hoja.
+            uint32_t propia = n.entrada;
+            colgar(propia, padre, n.profundidad);
+            reemplazarHijo(padre, nodo, propia | HOJA);
+            liberarNodo(nodo);
+            return padre;
+        }
+        return nodo;
+    }
+
+    void colgar(uint32_t entrada, uint32_t padre, std::size_t profundidad) {
+        EntradaAutocompletado& e = entradas[entrada];
+        e.nodo = NINGUNO;
+        e.padre = padre;
+        e.profundidad = static_cast<uint32_t>(profundidad);
+    }
+
+    // El primer byte de la etiqueta no cambia: el lugar entre los hermanos tampoco.
+    void reemplazarHijo(uint32_t padre, uint32_t anterior, uint32_t nuevo) {
+        for (HijoAutocompletado& hijo : nodos[padre].hijos) {
+            if (hijo.referencia == anterior) {
+                hijo.referencia = nuevo;
+                return;
+            }
+        }
+    }
+
+    uint32_t nuevoNodo(uint32_t padre, std::size_t profundidad, std::size_t longitud) {
+        uint32_t nodo;
+        if (nodosLibres.empty()) {
+            nodo = static_cast<uint32_t>(nodos.size());
+            nodos.push_back(NodoAutocompletado());
+        } else {
+            nodo = nodosLibres.back();
+            nodosLibres.pop_back();
+        }
+        nodos[nodo].padre = padre;
+        nodos[nodo].profundidad = static_cast<uint32_t>(profundidad);
+        nodos[nodo].longitud = static_cast<uint32_t>(longitud);
+        return nodo;
+    }
+
+    void liberarNodo(uint32_t nodo) {
+        nodos[nodo] = NodoAutocompletado(); // Suelta tambin el arreglo de hijos.
+        nodosLibres.push_back(nodo);
+    }
+
+    uint32_t nuevaEntrada(const VistaNombre& nombre, uint64_t hash, uint32_t consultasIniciales) {
+        uint32_t entrada;
+        if (entradasLibres.empty()) {
+            entrada = static_cast<uint32_t>(entradas.size());
+            entradas.push_back(EntradaAutocompletado());
+        } else {
+            entrada = entradasLibres.back();
+            entradasLibres.pop_back();
+        }
+        EntradaAutocompletado& e = entradas[entrada];
+        e.nombre.assign(nombre.datos, nombre.longitud);
+        e.hash = hash;
+        e.nodo = NINGUNO;
+        e.padre = NINGUNO;
+        e.profundidad = 0;
+        e.copias = 1;
+        e.consultas = consultasIniciales;
+        return entrada;
+    }
+
+    // Tabla de nombres con direccionamiento abierto (sondeo lineal): entrada + 1, o 0
+    // si la ranura est libre. Devuelve la ranura del nombre o la libre donde ira.
+    std::size_t ranuraDe(const VistaNombre& nombre, uint64_t hash) const {
+        std::size_t mascara = ranuras.size() - 1;
+        for (std::size_t i = hash & mascara;; i = (i + 1) & mascara) {
+            uint32_t valor = ranuras[i];
+            if (valor == 0) {
+                return i;
+            }
+            const EntradaAutocompletado& entrada = entradas[valor - 1];
+            if (entrada.hash == hash && vistaDe(entrada.nombre) == nombre) {
+                return i;
+            }
+        }
+    }
+
+    // Borra la ranura desplazando hacia atrs las siguientes, as no quedan lpidas.
+    void liberarRanura(std::size_t libre) {
+        std::size_t mascara = ranuras.size() - 1;
+        for (std::size_t i = (libre + 1) & mascara; ranuras[i] != 0; i = (i + 1) & mascara) {
+            std::size_t ideal = entradas[ranuras[i] - 1].hash & mascara;
+            if (((i - ideal) & mascara) >= ((i - libre) & mascara)) {
+                ranuras[libre] = ranuras[i];
+                libre = i;
+            }
+        }
+        ranuras[libre] = 0;
+    }
+
+    void crecer() {
+        std::vector<uint32_t> anteriores(ranuras.size() * 2, 0);
+        anteriores.swap(ranuras);
+        std::size_t mascara = ranuras.size() - 1;
+        for (uint32_t valor : anteriores) {
+            if (valor != 0) {
+                std::size_t i = entradas[valor - 1].hash & mascara;
+                while (ranuras[i] != 0) {
+                    i = (i + 1) & mascara;
+                }
+                ranuras[i] = valor;
+            }
+        }
+    }
+
+    std::vector<NodoAutocompletado> nodos; // nodos[RAIZ] es la raz (etiqueta vaca).
+    std::vector<EntradaAutocompletado> entradas;
+    std::vector<uint32_t> ranuras;
+    std::vector<uint32_t> nodosLibres;
+    std::vector<uint32_t> entradasLibres;
+    std::vector<MejorAutocompletado> candidatos; // Espacio de trabajo de recalcular.
+    std::size_t ocupadas;                        // Nombres distintos.
+};
+
+#endif
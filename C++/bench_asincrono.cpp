@@ -0,0 +1,101 @@
+// Benchmark de la API asncrona (C++20)
+// Suspende muchos consumidores con co_await atenderClienteAsync() y despus registra
+// un cliente por consumidor desde otro hilo. Mide cunto tarda en atenderlos a todos
+// con el ejecutor de un hilo y con el grupo de hilos: los consumidores suspendidos no
+// ocupan hilos, solo su marco de corrutina.
+//
+// Uso: bench_asincrono [consumidores] [hilos]
+//      Por defecto: 100000 consumidores y un hilo por ncleo para EjecutorHilos.
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <atomic>
+
+#include "sistema_asincrono.h"
+
+static std::atomic<long> atendidos(0);
+static std::atomic<long long> sumaIds(0);
+
+static Tarea<> consumidor(SistemaAsincrono<>& sistema) {
+    Cliente cliente = co_await sistema.atenderClienteAsync();
+    sumaIds.fetch_add(cliente.id, std::memory_order_relaxed);
+    atendidos.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void registrar(SistemaAsincrono<>& sistema, long cantidad) {
+    for (long i = 1; i <= cantidad; ++i) {
+        sistema.registrarClienteEnEspera(Cliente{static_cast<int>(i), "cliente-" + std::to_string(i)});
+    }
+}
+
+static bool comprobar(long consumidores) {
+    long long esperado = static_cast<long long>(consumidores) * (consumidores + 1) / 2;
+    return atendidos.load() == consumidores && sumaIds.load() == esperado;
+}
+
+static double unHilo(long consumidores) {
+    atendidos = 0;
+    sumaIds = 0;
+    SistemaAsincrono<> sistema(nullptr);
+    EjecutorUnHilo ejecutor;
+    for (long i = 0; i < consumidores; ++i) {
+        lanzar(ejecutor, consumidor(sistema));
+    }
+    ejecutor.ejecutarPendientes(); // Todos quedan suspendidos.
+    std::printf("  esperando: %zu consumidores\n", sistema.esperandoClientes());
+
+    auto inicio = std::chrono::steady_clock::now();
+    std::thread productor(registrar, std::ref(sistema), consumidores);
+    while (atendidos.load(std::memory_order_relaxed) < consumidores) {
+        if (ejecutor.ejecutarPendientes() == 0) std::this_thread::yield();
+    }
+    productor.join();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+}
+
+static double variosHilos(long consumidores, unsigned hilos) {
+    atendidos = 0;
+    sumaIds = 0;
+    SistemaAsincrono<> sistema(nullptr);
+    EjecutorHilos ejecutor(hilos);
+    std::printf("EjecutorHilos (%u hilos), %ld consumidores\n", ejecutor.tamano(), consumidores);
+    for (long i = 0; i < consumidores; ++i) {
+        lanzar(ejecutor, consumidor(sistema));
+    }
+    while (sistema.esperandoClientes() < static_cast<std::size_t>(consumidores)) {
+        std::this_thread::yield();
+    }
+
+    auto inicio = std::chrono::steady_clock::now();
+    std::thread productor(registrar, std::ref(sistema), consumidores);
+    while (atendidos.load(std::memory_order_relaxed) < consumidores) {
+        std::this_thread::yield();
+    }
+    productor.join();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+}
+
+int main(int argc, char** argv) {
+    long consumidores = argc > 1 ? std::atol(argv[1]) : 100000;
+    int hilos = argc > 2 ? std::atoi(argv[2]) : 0;
+    if (consumidores < 1 || hilos < 0) {
+        std::cerr << "Uso: " << argv[0] << " [consumidores] [hilos]" << std::endl;
+        return 2;
+    }
+
+    std::printf("EjecutorUnHilo, %ld consumidores\n", consumidores);
+    double segundos = unHilo(consumidores);
+    std::printf("  %.3f s, %.0f ns por cliente, %s\n", segundos, 1e9 * segundos / consumidores,
+                comprobar(consumidores) ? "correcto" : "ERROR");
+    bool correcto = comprobar(consumidores);
+
+    segundos = variosHilos(consumidores, static_cast<unsigned>(hilos));
+    std::printf("  %.3f s, %.0f ns por cliente, %s\n", segundos, 1e9 * segundos / consumidores,
+                comprobar(consumidores) ? "correcto" : "ERROR");
+    correcto = correcto && comprobar(consumidores);
+    return correcto ? 0 : 1;
+}
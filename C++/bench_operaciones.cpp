@@ -0,0 +1,516 @@
+// Benchmark de cada operacin de SistemaGestion
+// Mide por separado cada operacin del sistema con 10, 100, ..., hasta 10^7 elementos
+// ya cargados, e informa ns/op, asignaciones/op y bytes/op. Las asignaciones se
+// cuentan reemplazando operator new en este programa.
+//
+// Uso: bench_operaciones [--almacen lista|hash|soa] [--maximo N] [--json archivo] [--sin-mensajes]
+//                        [--autocompletado] [--sugerencias] [--indice-solicitudes] [--filtro]
+//                        [--normalizados] [--traza archivo]
+//      Por defecto: almacn hash, hasta 10^7 elementos y mensajes formateados en un
+//      sumidero que los descarta (se mide el formateo pero no la terminal). Con
+//      --sin-mensajes el sistema no tiene salida y no formatea nada. Con
+//      --autocompletado el inventario mantiene el ndice de prefijos (autocompletado.h),
+//      as las altas, bajas y consultas miden tambin su costo, y se miden adems
+//      completarProducto y autocompletarProducto con prefijos de 1 a 4 bytes. Con
+//      --sugerencias mantiene adems el ndice de bsqueda aproximada
+//      (busqueda_aproximada.h) y mide sugerirProducto y consultarProducto con nombres
+//      que no estn por un byte cambiado. Con --indice-solicitudes las solicitudes
+//      mantienen el ndice invertido (indice_solicitudes.h); buscarSolicitudes se mide
+//      siempre, con una palabra que tiene una de cada 1000 pendientes, as se compara
+//      el ndice con leer toda la cola. buscarProductoAusente y eliminarProductoAusente
+//      se miden siempre con nombres que no estn; con --filtro pasan primero por el
+//      filtro de ausentes (filtro_ausentes.h) y se informan sus falsos positivos. Con
+//      --normalizados mantiene el ndice de nombres normalizados (nombres_normalizados.h)
+//      y mide consultarProductoNormalizado con nombres del inventario en maysculas.
+//
+// Cada medicin repite lotes de la operacin, duplicando el lote, hasta acumular
+// TIEMPO_MINIMO. Entre lotes se deja el sistema como estaba sin medir: las altas y bajas
+// de productos se revierten con deshacerUltimaAccion (por eso el historial es un anillo
+// de 1024 cambios y el lote de esas operaciones no pasa de ese tamao), las colas se
+// rellenan o vacan hasta volver a N elementos.
+//
+// Con --traza ejecuta una traza (traza.h, por ejemplo de generador_carga) lo ms rpido
+// posible, con el historial completo, y agrupa las mediciones por operacin; en ese modo
+// el tamao informado es la cantidad de productos al terminar. Cada comando se mide por
+// separado y se descuenta el costo de leer el reloj.
+//
+// El JSON sirve para comparar resultados entre commits:
+//   {"almacen": "...", "mensajes": true, "autocompletado": false, "sugerencias": false, "indice_solicitudes": false,
+//    "filtro": false, "normalizados": false, "resultados": [{"operacion": "...", "tamano": N,
+//    "ns_op": x, "asignaciones_op": x, "bytes_op": x, "repeticiones": N}, ...]}
+
+#include <iostream>
+#include <fstream>
+#include <streambuf>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "sistema_gestion.h"
+#include "traza.h"
+
+// Este operator delete libera con free lo que este operator new reserv con malloc; GCC
+// no lo ve al analizar cada llamada y advierte de una pareja distinta.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+// Contadores de asignaciones (el programa es de un solo hilo mientras mide).
+static unsigned long long asignaciones = 0;
+static unsigned long long bytesAsignados = 0;
+
+void* operator new(std::size_t bytes) {
+    INSTRUMENTAR(InstrReservas);
+    ++asignaciones;
+    bytesAsignados += bytes;
+    void* memoria = std::malloc(bytes ? bytes : 1);
+    if (!memoria) throw std::bad_alloc();
+    return memoria;
+}
+void* operator new[](std::size_t bytes) { return operator new(bytes); }
+void* operator new(std::size_t bytes, const std::nothrow_t&) noexcept {
+    INSTRUMENTAR(InstrReservas);
+    ++asignaciones;
+    bytesAsignados += bytes;
+    return std::malloc(bytes ? bytes : 1);
+}
+void* operator new[](std::size_t bytes, const std::nothrow_t& nt) noexcept { return operator new(bytes, nt); }
+void operator delete(void* memoria) noexcept { std::free(memoria); }
+void operator delete[](void* memoria) noexcept { std::free(memoria); }
+void operator delete(void* memoria, std::size_t) noexcept { std::free(memoria); }
+void operator delete[](void* memoria, std::size_t) noexcept { std::free(memoria); }
+
+// Flujo que descarta lo que recibe.
+class SumideroSalida : public std::streambuf {
+protected:
+    int_type overflow(int_type c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+typedef std::chrono::steady_clock Reloj;
+
+static const double TIEMPO_MINIMO = 0.1;           // Segundos por medicin.
+static const std::size_t LOTE_HISTORIAL = 1024;    // Capacidad del historial en anillo.
+static const std::size_t LOTE_MAXIMO = 1 << 16;
+
+struct Resultado {
+    std::string operacion;
+    std::size_t tamano;
+    double nsOp;
+    double asignacionesOp;
+    double bytesOp;
+    unsigned long long repeticiones;
+};
+
+// Mide operar(i) en lotes. preparar(lote) y restaurar(lote) corren fuera de la medicin.
+template <class Preparar, class Operar, class Restaurar>
+static Resultado medir(const char* operacion, std::size_t tamano, std::size_t limiteLote, Preparar preparar, Operar operar,
+                       Restaurar restaurar) {
+    Resultado resultado = {operacion, tamano, 0, 0, 0, 0};
+    double segundos = 0;
+    unsigned long long asignacionesTotales = 0, bytesTotales = 0;
+    std::size_t lote = 1;
+    while (segundos < TIEMPO_MINIMO) {
+        preparar(lote);
+        unsigned long long asignacionesAntes = asignaciones, bytesAntes = bytesAsignados;
+        Reloj::time_point inicio = Reloj::now();
+        for (std::size_t i = 0; i < lote; ++i) {
+            operar(i);
+        }
+        Reloj::time_point fin = Reloj::now();
+        asignacionesTotales += asignaciones - asignacionesAntes;
+        bytesTotales += bytesAsignados - bytesAntes;
+        segundos += std::chrono::duration<double>(fin - inicio).count();
+        resultado.repeticiones += lote;
+        restaurar(lote);
+        if (lote < limiteLote) {
+            lote = std::min(lote * 2, limiteLote);
+        }
+    }
+    resultado.nsOp = 1e9 * segundos / resultado.repeticiones;
+    resultado.asignacionesOp = static_cast<double>(asignacionesTotales) / resultado.repeticiones;
+    resultado.bytesOp = static_cast<double>(bytesTotales) / resultado.repeticiones;
+    return resultado;
+}
+
+static void nada(std::size_t) {}
+
+static void imprimir(const Resultado& r) {
+    std::printf("%-30s %10zu %14.1f %10.2f %12.1f\n", r.operacion.c_str(), r.tamano, r.nsOp, r.asignacionesOp, r.bytesOp);
+    std::fflush(stdout);
+}
+
+// Nombres cortos para que quepan en el bfer interno de std::string.
+static std::string nombreProducto(char prefijo, std::size_t i) {
+    char texto[24];
+    std::snprintf(texto, sizeof(texto), "%c%zu", prefijo, i);
+    return texto;
+}
+
+template <class Almacen>
+class Bancada {
+public:
+    typedef SistemaGestionT<Almacen, ColaAnillo, HistorialAnillo<LOTE_HISTORIAL> > Sistema;
+
+    Bancada(std::ostream* salida, bool autocompletado, bool sugerencias, bool indiceSolicitudes, bool filtro,
+            bool normalizados, std::vector<Resultado>& resultados)
+        : salida(salida), autocompletado(autocompletado), sugerencias(sugerencias), indiceSolicitudes(indiceSolicitudes),
+          filtro(filtro), normalizados(normalizados), resultados(resultados) {
+        for (std::size_t i = 0; i < LOTE_HISTORIAL; ++i) {
+            nuevos.push_back(nombreProducto('q', i));
+        }
+        for (std::size_t i = 0; i < LOTE_MAXIMO; ++i) {
+            ausentes.push_back(nombreProducto('z', i));
+        }
+    }
+
+    void productos(std::size_t n) {
+        Sistema sistema(salida);
+        if (autocompletado) {
+            sistema.activarAutocompletado();
+        }
+        if (sugerencias) {
+            sistema.activarSugerencias();
+        }
+        if (filtro) {
+            sistema.activarFiltroAusentes();
+        }
+        if (normalizados) {
+            sistema.activarNombresNormalizados();
+        }
+        std::vector<std::string> nombres(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            nombres[i] = nombreProducto('p', i);
+            sistema.registrarProducto({nombres[i], 1.0 + i % 100, static_cast<int>(i % 1000)});
+        }
+        std::size_t lote = std::min(n, LOTE_HISTORIAL);
+        std::size_t cursor = 0;
+        // 7919 es primo: i * 7919 % n recorre nombres distintos dentro de un lote.
+        auto salteado = [&](std::size_t i) -> const std::string& { return nombres[(cursor + i * 7919) % n]; };
+        auto deshacer = [&](std::size_t k) {
+            for (std::size_t i = 0; i < k; ++i) sistema.deshacerUltimaAccion();
+        };
+
+        agregar(medir("registrarProducto", n, LOTE_HISTORIAL, nada,
+                      [&](std::size_t i) { sistema.registrarProducto({nuevos[i], 2.5, 3}); }, deshacer));
+        agregar(medir("eliminarProducto", n, lote, nada, [&](std::size_t i) { sistema.eliminarProducto(salteado(i)); },
+                      [&](std::size_t k) {
+                          deshacer(k);
+                          cursor += k;
+                      }));
+        agregar(medir("consultarProducto", n, LOTE_MAXIMO, nada, [&](std::size_t i) { sistema.consultarProducto(salteado(i)); },
+                      [&](std::size_t k) { cursor += k; }));
+        if (autocompletado) {
+            // Las consultas anteriores dejaron nombres ms populares que otros.
+            auto prefijo = [&](std::size_t i) {
+                const std::string& nombre = salteado(i);
+                VistaNombre vista = {nombre.data(), std::min<std::size_t>(nombre.size(), 1 + i % 4)};
+                return vista;
+            };
+            std::size_t sugeridos = 0;
+            agregar(medir("completarProducto", n, LOTE_MAXIMO, nada,
+                          [&](std::size_t i) {
+                              sugeridos += sistema.completarProducto(prefijo(i), SUGERENCIAS_AUTOCOMPLETADO,
+                                                                     [](const VistaNombre&, uint32_t) {});
+                          },
+                          [&](std::size_t k) { cursor += k; }));
+            agregar(medir("autocompletarProducto", n, LOTE_MAXIMO, nada,
+                          [&](std::size_t i) {
+                              VistaNombre vista = prefijo(i);
+                              sistema.autocompletarProducto(std::string(vista.datos, vista.longitud));
+                          },
+                          [&](std::size_t k) { cursor += k; }));
+            if (sugeridos == 0) std::abort(); // Cada prefijo es de un nombre que est.
+        }
+        if (sugerencias) {
+            // Un nombre del inventario con el ltimo byte cambiado: est a distancia 1.
+            std::string errado;
+            auto cambiado = [&](std::size_t i) -> const std::string& {
+                errado = salteado(i);
+                errado.back() = 'x';
+                return errado;
+            };
+            agregar(medir("sugerirProducto", n, LOTE_MAXIMO, nada,
+                          [&](std::size_t i) {
+                              sistema.sugerirProducto(vistaDe(cambiado(i)), SUGERENCIAS_APROXIMADAS,
+                                                      [](const VistaNombre&, std::size_t) {});
+                          },
+                          [&](std::size_t k) { cursor += k; }));
+            agregar(medir("consultarProductoAusente", n, LOTE_MAXIMO, nada,
+                          [&](std::size_t i) { sistema.consultarProducto(cambiado(i)); },
+                          [&](std::size_t k) { cursor += k; }));
+        }
+        if (normalizados) {
+            // "P123" no est; se encuentra "p123" por su clave.
+            std::string mayusculas;
+            agregar(medir("consultarProductoNormalizado", n, LOTE_MAXIMO, nada,
+                          [&](std::size_t i) {
+                              mayusculas = salteado(i);
+                              mayusculas[0] = 'P';
+                              sistema.consultarProducto(mayusculas);
+                          },
+                          [&](std::size_t k) { cursor += k; }));
+        }
+        agregar(medir("buscarProductoAusente", n, LOTE_MAXIMO, nada,
+                      [&](std::size_t i) { sistema.buscarProducto(vistaDe(ausentes[i]), [](const VistaProducto&) {}); },
+                      nada));
+        agregar(medir("eliminarProductoAusente", n, LOTE_MAXIMO, nada,
+                      [&](std::size_t i) { sistema.eliminarProducto(ausentes[i]); }, nada));
+        if (filtro) {
+            EstadoFiltroAusentes estado = sistema.estadoFiltroAusentes();
+            std::printf("  filtro: %zu nombres en %lld bytes, falsos positivos %.3f%% estimados, %.3f%% observados\n",
+                        estado.nombres, static_cast<long long>(estado.bytes), estado.tasaEstimada * 100,
+                        estado.tasaObservada() * 100);
+        }
+        agregar(medir("listarProductos", n, LOTE_MAXIMO, nada, [&](std::size_t) { sistema.listarProductos(); }, nada));
+        agregar(medir("deshacerUltimaAccion", n, LOTE_HISTORIAL,
+                      [&](std::size_t k) {
+                          for (std::size_t i = 0; i < k; ++i) sistema.registrarProducto({nuevos[i], 2.5, 3});
+                      },
+                      [&](std::size_t) { sistema.deshacerUltimaAccion(); }, nada));
+    }
+
+    void colas(std::size_t n) {
+        Sistema sistema(salida);
+        if (indiceSolicitudes) {
+            sistema.activarIndiceSolicitudes();
+        }
+        Solicitud solicitud = {0, "reponer estante"};
+        Solicitud garantia = {0, "cambio por garanta"};
+        Cliente cliente = {0, "cliente"};
+        for (std::size_t i = 0; i < n; ++i) {
+            sistema.registrarSolicitud(i % 1000 == 0 ? garantia : solicitud);
+            sistema.registrarClienteEnEspera(cliente);
+        }
+        std::size_t lote = std::min(n, LOTE_MAXIMO);
+        Solicitud tomada;
+        Cliente tomado;
+
+        // Antes de que las dems mediciones cambien el frente de la cola: una de cada 1000
+        // pendientes, empezando por la primera, es de garanta.
+        agregar(medir("buscarSolicitudes", n, LOTE_MAXIMO, nada,
+                      [&](std::size_t) { sistema.buscarSolicitudes(vistaDe(garantia.descripcion), [](const Solicitud&) {}); },
+                      nada));
+        agregar(medir("buscarSolicitudesPendientes", n, LOTE_MAXIMO, nada,
+                      [&](std::size_t) { sistema.buscarSolicitudesPendientes("garanta"); }, nada));
+        agregar(medir("registrarSolicitud", n, LOTE_MAXIMO, nada, [&](std::size_t) { sistema.registrarSolicitud(solicitud); },
+                      [&](std::size_t k) {
+                          for (std::size_t i = 0; i < k; ++i) sistema.tomarSolicitud(tomada);
+                      }));
+        agregar(medir("procesarSolicitud", n, lote, nada, [&](std::size_t) { sistema.procesarSolicitud(); },
+                      [&](std::size_t k) {
+                          for (std::size_t i = 0; i < k; ++i) sistema.registrarSolicitud(solicitud);
+                      }));
+        agregar(medir("consultarSolicitudEnProceso", n, LOTE_MAXIMO, nada,
+                      [&](std::size_t) { sistema.consultarSolicitudEnProceso(); }, nada));
+        agregar(medir("listarSolicitudesPendientes", n, LOTE_MAXIMO, nada,
+                      [&](std::size_t) { sistema.listarSolicitudesPendientes(); }, nada));
+        agregar(medir("registrarClienteEnEspera", n, LOTE_MAXIMO, nada,
+                      [&](std::size_t) { sistema.registrarClienteEnEspera(cliente); },
+                      [&](std::size_t k) {
+                          for (std::size_t i = 0; i < k; ++i) sistema.tomarCliente(tomado);
+                      }));
+        agregar(medir("atenderCliente", n, lote, nada, [&](std::size_t) { sistema.atenderCliente(); },
+                      [&](std::size_t k) {
+                          for (std::size_t i = 0; i < k; ++i) sistema.registrarClienteEnEspera(cliente);
+                      }));
+        agregar(medir("consultarListaDeEspera", n, LOTE_MAXIMO, nada, [&](std::size_t) { sistema.consultarListaDeEspera(); },
+                      nada));
+    }
+
+private:
+    void agregar(const Resultado& resultado) {
+        imprimir(resultado);
+        resultados.push_back(resultado);
+    }
+
+    std::ostream* salida;
+    bool autocompletado;
+    bool sugerencias;
+    bool indiceSolicitudes;
+    bool filtro;
+    bool normalizados;
+    std::vector<Resultado>& resultados;
+    std::vector<std::string> nuevos;   // Nombres que no estn en el inventario, para agregarlos.
+    std::vector<std::string> ausentes; // Nombres que nunca estn en el inventario.
+};
+
+template <class Almacen>
+static void correr(std::size_t maximo, std::ostream* salida, bool autocompletado, bool sugerencias,
+                   bool indiceSolicitudes, bool filtro, bool normalizados, std::vector<Resultado>& resultados) {
+    Bancada<Almacen> bancada(salida, autocompletado, sugerencias, indiceSolicitudes, filtro, normalizados, resultados);
+    for (std::size_t n = 10; n <= maximo; n *= 10) {
+        bancada.productos(n);
+        bancada.colas(n);
+    }
+}
+
+// Lo que cuesta leer el reloj dos veces, para descontarlo de cada comando.
+static double costoReloj() {
+    const int vueltas = 100000;
+    Reloj::time_point inicio = Reloj::now();
+    for (int i = 0; i < vueltas; ++i) {
+        Reloj::time_point a = Reloj::now();
+        Reloj::time_point b = Reloj::now();
+        if (b < a) std::abort();
+    }
+    return std::chrono::duration<double, std::nano>(Reloj::now() - inicio).count() / vueltas;
+}
+
+template <class Almacen>
+static bool correrTraza(const std::string& ruta, std::ostream* salida, std::vector<Resultado>& resultados) {
+    LectorTraza lector;
+    if (!lector.cargar(ruta)) {
+        return false;
+    }
+    SistemaGestionT<Almacen, ColaAnillo, HistorialVector> sistema(salida);
+    std::ostream descarte(nullptr); // Errores del protocolo: no se miden.
+    std::vector<double> nanos(16, 0.0);
+    std::vector<unsigned long long> cuentas(16, 0), asignacionesPorOpcion(16, 0), bytesPorOpcion(16, 0);
+    double reloj = costoReloj();
+    int siguienteId = 1;
+    EventoTraza evento;
+    while (lector.siguiente(evento)) {
+        if (evento.comando.opcion == 16 || evento.comando.opcion == 18) {
+            continue; // Escribiran archivos o memoria compartida; no se miden.
+        }
+        int opcion = evento.comando.opcion > 0 && evento.comando.opcion < 16 ? evento.comando.opcion : 0;
+        unsigned long long asignacionesAntes = asignaciones, bytesAntes = bytesAsignados;
+        Reloj::time_point inicio = Reloj::now();
+        ejecutarComandoTexto(sistema, evento.comando, descarte, siguienteId);
+        Reloj::time_point fin = Reloj::now();
+        asignacionesPorOpcion[opcion] += asignaciones - asignacionesAntes;
+        bytesPorOpcion[opcion] += bytesAsignados - bytesAntes;
+        nanos[opcion] += std::chrono::duration<double, std::nano>(fin - inicio).count() - reloj;
+        ++cuentas[opcion];
+    }
+    if (lector.danada()) {
+        std::cerr << "La traza " << ruta << " est daada; se midi hasta el ltimo comando vlido." << std::endl;
+    }
+
+    std::size_t productos = 0;
+    sistema.recorrerProductos([&productos](const VistaProducto&) { ++productos; });
+    for (int opcion = 0; opcion < 16; ++opcion) {
+        if (cuentas[opcion] == 0) continue;
+        double n = static_cast<double>(cuentas[opcion]);
+        Resultado resultado = {nombreOperacionTraza(opcion), productos, std::max(0.0, nanos[opcion] / n),
+                               asignacionesPorOpcion[opcion] / n, bytesPorOpcion[opcion] / n, cuentas[opcion]};
+        imprimir(resultado);
+        resultados.push_back(resultado);
+    }
+    return true;
+}
+
+static bool escribirJson(const std::string& ruta, const std::string& almacen, bool mensajes, bool autocompletado,
+                         bool sugerencias, bool indiceSolicitudes, bool filtro, bool normalizados,
+                         const std::vector<Resultado>& resultados) {
+    std::ofstream archivo(ruta.c_str());
+    if (!archivo) {
+        return false;
+    }
+    archivo << "{\"almacen\": \"" << almacen << "\", \"mensajes\": " << (mensajes ? "true" : "false")
+            << ", \"autocompletado\": " << (autocompletado ? "true" : "false")
+            << ", \"sugerencias\": " << (sugerencias ? "true" : "false")
+            << ", \"indice_solicitudes\": " << (indiceSolicitudes ? "true" : "false")
+            << ", \"filtro\": " << (filtro ? "true" : "false")
+            << ", \"normalizados\": " << (normalizados ? "true" : "false") << ", \"resultados\": [";
+    char linea[256];
+    for (std::size_t i = 0; i < resultados.size(); ++i) {
+        const Resultado& r = resultados[i];
+        std::snprintf(linea, sizeof(linea),
+                      "%s\n  {\"operacion\": \"%s\", \"tamano\": %zu, \"ns_op\": %.2f, \"asignaciones_op\": %.3f, "
+                      "\"bytes_op\": %.1f, \"repeticiones\": %llu}",
+                      i ? "," : "", r.operacion.c_str(), r.tamano, r.nsOp, r.asignacionesOp, r.bytesOp, r.repeticiones);
+        archivo << linea;
+    }
+    archivo << "\n]}\n";
+    return static_cast<bool>(archivo);
+}
+
+int main(int argc, char** argv) {
+    std::string almacen = "hash";
+    std::size_t maximo = 10000000;
+    std::string rutaJson;
+    std::string rutaTraza;
+    bool mensajes = true;
+    bool autocompletado = false;
+    bool sugerencias = false;
+    bool indiceSolicitudes = false;
+    bool filtro = false;
+    bool normalizados = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string argumento = argv[i];
+        if (argumento == "--almacen" && i + 1 < argc) {
+            almacen = argv[++i];
+        } else if (argumento == "--maximo" && i + 1 < argc) {
+            maximo = std::strtoull(argv[++i], nullptr, 10);
+        } else if (argumento == "--json" && i + 1 < argc) {
+            rutaJson = argv[++i];
+        } else if (argumento == "--traza" && i + 1 < argc) {
+            rutaTraza = argv[++i];
+        } else if (argumento == "--sin-mensajes") {
+            mensajes = false;
+        } else if (argumento == "--autocompletado") {
+            autocompletado = true;
+        } else if (argumento == "--sugerencias") {
+            sugerencias = true;
+        } else if (argumento == "--indice-solicitudes") {
+            indiceSolicitudes = true;
+        } else if (argumento == "--filtro") {
+            filtro = true;
+        } else if (argumento == "--normalizados") {
+            normalizados = true;
+        } else {
+            almacen.clear();
+            break;
+        }
+    }
+    if (almacen != "lista" && almacen != "hash" && almacen != "soa") {
+        std::cerr << "Uso: " << argv[0] << " [--almacen lista|hash|soa] [--maximo N] [--json archivo] [--sin-mensajes]"
+                  << " [--autocompletado] [--sugerencias] [--indice-solicitudes] [--filtro] [--normalizados]"
+                  << " [--traza archivo]" << std::endl;
+        return 2;
+    }
+
+    SumideroSalida sumidero;
+    std::ostream flujo(&sumidero);
+    std::ostream* salida = mensajes ? &flujo : nullptr;
+    std::vector<Resultado> resultados;
+
+    std::printf("almacen=%s mensajes=%s autocompletado=%s sugerencias=%s indice_solicitudes=%s filtro=%s "
+                "normalizados=%s\n",
+                almacen.c_str(), mensajes ? "si" : "no", autocompletado ? "si" : "no", sugerencias ? "si" : "no",
+                indiceSolicitudes ? "si" : "no", filtro ? "si" : "no", normalizados ? "si" : "no");
+    std::printf("%-30s %10s %14s %10s %12s\n", "operacion", "tamano", "ns/op", "asig/op", "bytes/op");
+    if (!rutaTraza.empty()) {
+        bool cargada = almacen == "lista" ? correrTraza<AlmacenLista>(rutaTraza, salida, resultados)
+                       : almacen == "hash" ? correrTraza<AlmacenHashPlano>(rutaTraza, salida, resultados)
+                                           : correrTraza<AlmacenSoA>(rutaTraza, salida, resultados);
+        if (!cargada) {
+            std::cerr << "No se pudo leer la traza " << rutaTraza << std::endl;
+            return 1;
+        }
+    } else if (almacen == "lista") {
+        correr<AlmacenLista>(maximo, salida, autocompletado, sugerencias, indiceSolicitudes, filtro, normalizados,
+                             resultados);
+    } else if (almacen == "hash") {
+        correr<AlmacenHashPlano>(maximo, salida, autocompletado, sugerencias, indiceSolicitudes, filtro, normalizados,
+                                 resultados);
+    } else {
+        correr<AlmacenSoA>(maximo, salida, autocompletado, sugerencias, indiceSolicitudes, filtro, normalizados,
+                           resultados);
+    }
+
+    imprimirInstrumentacion(std::cout); // Solo con -DINSTRUMENTACION.
+
+    if (!rutaJson.empty() && !escribirJson(rutaJson, almacen, mensajes, autocompletado, sugerencias, indiceSolicitudes,
+                                           filtro, normalizados, resultados)) {
+        std::cerr << "No se pudo escribir " << rutaJson << std::endl;
+        return 1;
+    }
+    return 0;
+}
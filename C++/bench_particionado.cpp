@@ -0,0 +1,160 @@
+// Benchmark del motor particionado
+// Mide el rendimiento total (operaciones/s) del motor con 1, 2, 4, ... particiones,
+// hasta el nmero de ncleos, y lo compara con un solo SistemaGestion protegido por
+// un mutex y usado por la misma cantidad de hilos.
+//
+// Uso: bench_particionado [productos] [operaciones] [clientes]
+//      Por defecto: 100000 productos, 2000000 operaciones y un hilo cliente por cada
+//      dos particiones (clientes = 0). Cada cliente mantiene 64 peticiones en vuelo.
+//
+// La mezcla es 90% consultas, 5% altas y 5% bajas: solo operaciones de inventario,
+// que son las que se reparten entre particiones.
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <thread>
+#include <random>
+
+#include "motor_particionado.h"
+
+typedef SistemaGestionT<AlmacenHashPlano, ColaAnillo, HistorialVector, BloqueoMutex> SistemaCompartido;
+
+static const std::size_t VENTANA = 64;
+
+static std::vector<std::string> generarNombres(int productos) {
+    std::vector<std::string> nombres(productos);
+    for (int i = 0; i < productos; ++i) {
+        nombres[i] = "producto-" + std::to_string(i);
+    }
+    return nombres;
+}
+
+// Cada cliente recorre su parte de las operaciones con su propia semilla.
+template <class F>
+static void mezcla(unsigned semilla, long operaciones, int productos, F f) {
+    std::mt19937 azar(semilla);
+    for (long i = 0; i < operaciones; ++i) {
+        unsigned tipo = azar() % 100;
+        int operacion = tipo < 90 ? MotorConsultarProducto : (tipo < 95 ? MotorRegistrarProducto : MotorEliminarProducto);
+        f(operacion, static_cast<int>(azar() % productos));
+    }
+}
+
+template <class F>
+static double medir(unsigned hilos, F cuerpo) {
+    std::vector<std::thread> trabajadores;
+    auto inicio = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < hilos; ++t) {
+        trabajadores.emplace_back(cuerpo, t);
+    }
+    for (auto& trabajador : trabajadores) {
+        trabajador.join();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+}
+
+static double correrMotor(unsigned particiones, unsigned clientes, const std::vector<std::string>& nombres, long operaciones) {
+    MotorParticionado<> motor(particiones);
+    std::vector<MotorParticionado<>::Sesion*> sesiones;
+    for (unsigned c = 0; c < clientes; ++c) {
+        sesiones.push_back(motor.abrirSesion(nullptr));
+    }
+
+    // Carga inicial por la primera sesin.
+    RespuestaMotor respuesta;
+    for (const auto& nombre : nombres) {
+        PeticionMotor peticion;
+        peticion.operacion = MotorRegistrarProducto;
+        peticion.mensajes = false;
+        peticion.producto.nombre = nombre;
+        peticion.producto.precio = 1.5;
+        peticion.producto.cantidad = 10;
+        sesiones[0]->enviar(peticion);
+        while (sesiones[0]->enVuelo() >= VENTANA) {
+            if (!sesiones[0]->recibir(respuesta)) std::this_thread::yield();
+        }
+    }
+    while (sesiones[0]->enVuelo() > 0) {
+        if (!sesiones[0]->recibir(respuesta)) std::this_thread::yield();
+    }
+
+    int productos = static_cast<int>(nombres.size());
+    long porCliente = operaciones / clientes;
+    double segundos = medir(clientes, [&](unsigned c) {
+        MotorParticionado<>::Sesion& sesion = *sesiones[c];
+        RespuestaMotor recibida;
+        mezcla(c + 1, porCliente, productos, [&](int operacion, int indice) {
+            PeticionMotor peticion;
+            peticion.operacion = operacion;
+            peticion.mensajes = false;
+            peticion.producto.nombre = nombres[indice];
+            peticion.producto.precio = 9.5;
+            peticion.producto.cantidad = 3;
+            sesion.enviar(peticion);
+            while (sesion.enVuelo() >= VENTANA) {
+                if (!sesion.recibir(recibida)) std::this_thread::yield();
+            }
+        });
+        while (sesion.enVuelo() > 0) {
+            if (!sesion.recibir(recibida)) std::this_thread::yield();
+        }
+    });
+    return porCliente * clientes / segundos;
+}
+
+static double correrCompartido(unsigned hilos, const std::vector<std::string>& nombres, long operaciones) {
+    SistemaCompartido sistema(nullptr);
+    for (const auto& nombre : nombres) {
+        sistema.registrarProducto({nombre, 1.5, 10});
+    }
+    int productos = static_cast<int>(nombres.size());
+    long porHilo = operaciones / hilos;
+    double segundos = medir(hilos, [&](unsigned t) {
+        double suma = 0;
+        mezcla(t + 1, porHilo, productos, [&](int operacion, int indice) {
+            if (operacion == MotorConsultarProducto) {
+                sistema.buscarProducto(vistaDe(nombres[indice]), [&suma](const VistaProducto& producto) { suma += producto.precio; });
+            } else if (operacion == MotorRegistrarProducto) {
+                sistema.registrarProducto({nombres[indice], 9.5, 3});
+            } else {
+                sistema.eliminarProducto(nombres[indice]);
+            }
+        });
+        if (suma < 0) std::printf("%f", suma); // Evita que se descarten las consultas.
+    });
+    return porHilo * hilos / segundos;
+}
+
+int main(int argc, char** argv) {
+    int productos = argc > 1 ? std::atoi(argv[1]) : 100000;
+    long operaciones = argc > 2 ? std::atol(argv[2]) : 2000000;
+    int clientesPedidos = argc > 3 ? std::atoi(argv[3]) : 0;
+    if (productos < 1 || operaciones < 1 || clientesPedidos < 0) {
+        std::cerr << "Uso: " << argv[0] << " [productos] [operaciones] [clientes]" << std::endl;
+        return 2;
+    }
+    unsigned nucleos = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::string> nombres = generarNombres(productos);
+
+    std::vector<unsigned> configuraciones;
+    for (unsigned n = 1; n < nucleos; n *= 2) {
+        configuraciones.push_back(n);
+    }
+    configuraciones.push_back(nucleos);
+
+    std::printf("nucleos=%u productos=%d operaciones=%ld\n", nucleos, productos, operaciones);
+    std::printf("%-12s %-8s %14s %9s %18s\n", "particiones", "clientes", "motor op/s", "escala", "mutex op/s (hilos)");
+    double base = 0;
+    for (unsigned particiones : configuraciones) {
+        unsigned clientes = clientesPedidos > 0 ? static_cast<unsigned>(clientesPedidos) : std::max(1u, particiones / 2);
+        double motor = correrMotor(particiones, clientes, nombres, operaciones);
+        double compartido = correrCompartido(particiones, nombres, operaciones);
+        if (base == 0) base = motor;
+        std::printf("%-12u %-8u %14.0f %8.2fx %14.0f (%u)\n", particiones, clientes, motor, motor / base, compartido, particiones);
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+// Matriz de benchmarks de polticas
+// Instancia SistemaGestionT con todas las combinaciones de almacn, cola, historial
+// y bloqueo, y mide el costo por operacin (ns/op) de la misma carga en cada una.
+//
+// Uso: bench_politicas [productos]   (por defecto 2000)
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "sistema_gestion.h"
+
+// Lista de tipos para recorrer las polticas en tiempo de compilacin.
+template <class... T>
+struct Tipos {};
+
+typedef Tipos<AlmacenLista, AlmacenHashPlano, AlmacenSoA> Almacenes;
+typedef Tipos<ColaLista, ColaAnillo, ColaSinBloqueo> Colas;
+typedef Tipos<HistorialLista, HistorialVector, HistorialAnillo<1024> > Historiales;
+typedef Tipos<SinBloqueo, BloqueoSpin, BloqueoMutex> Bloqueos;
+
+typedef std::chrono::steady_clock Reloj;
+
+static double nsPorOperacion(Reloj::time_point inicio, Reloj::time_point fin, std::size_t operaciones) {
+    if (operaciones == 0) {
+        return 0.0;
+    }
+    return std::chrono::duration<double, std::nano>(fin - inicio).count() / operaciones;
+}
+
+// Ejecuta la carga sobre una combinacin de polticas e imprime una fila de la matriz.
+template <class A, class C, class H, class B>
+void medir(const std::vector<std::string>& nombres) {
+    const std::size_t n = nombres.size();
+    SistemaGestionT<A, C, H, B> sistema(nullptr); // Sin salida: solo se mide el trabajo.
+
+    Reloj::time_point t0 = Reloj::now();
+    for (std::size_t i = 0; i < n; ++i) {
+        sistema.registrarProducto({nombres[i], 1.0 + i, static_cast<int>(i)});
+    }
+    Reloj::time_point t1 = Reloj::now();
+    for (std::size_t i = 0; i < n; ++i) {
+        sistema.consultarProducto(nombres[(i * 7919) % n]);
+    }
+    Reloj::time_point t2 = Reloj::now();
+    sistema.listarProductos();
+    Reloj::time_point t3 = Reloj::now();
+    for (std::size_t i = 0; i < n; ++i) {
+        sistema.registrarSolicitud({static_cast<int>(i), "solicitud"});
+        sistema.registrarClienteEnEspera({static_cast<int>(i), "cliente"});
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        sistema.procesarSolicitud();
+        sistema.atenderCliente();
+    }
+    Reloj::time_point t4 = Reloj::now();
+    for (std::size_t i = 0; i < n / 2; ++i) {
+        sistema.eliminarProducto(nombres[(i * 7919) % n]);
+    }
+    Reloj::time_point t5 = Reloj::now();
+    for (std::size_t i = 0; i < n; ++i) {
+        sistema.deshacerUltimaAccion();
+    }
+    Reloj::time_point t6 = Reloj::now();
+
+    std::printf("%-11s %-12s %-9s %-12s %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                A::nombre(), C::nombre(), H::nombre(), B::nombre(),
+                nsPorOperacion(t0, t1, n), nsPorOperacion(t1, t2, n), nsPorOperacion(t2, t3, n),
+                nsPorOperacion(t3, t4, 4 * n), nsPorOperacion(t4, t5, n / 2), nsPorOperacion(t5, t6, n));
+}
+
+// Producto cartesiano de las listas de polticas.
+template <class A, class C, class H, class Lista>
+struct RecorrerBloqueos;
+
+template <class A, class C, class H, class... B>
+struct RecorrerBloqueos<A, C, H, Tipos<B...> > {
+    static void ejecutar(const std::vector<std::string>& nombres) {
+        int expandir[] = {0, (medir<A, C, H, B>(nombres), 0)...};
+        (void)expandir;
+    }
+};
+
+template <class A, class C, class Lista>
+struct RecorrerHistoriales;
+
+template <class A, class C, class... H>
+struct RecorrerHistoriales<A, C, Tipos<H...> > {
+    static void ejecutar(const std::vector<std::string>& nombres) {
+        int expandir[] = {0, (RecorrerBloqueos<A, C, H, Bloqueos>::ejecutar(nombres), 0)...};
+        (void)expandir;
+    }
+};
+
+template <class A, class Lista>
+struct RecorrerColas;
+
+template <class A, class... C>
+struct RecorrerColas<A, Tipos<C...> > {
+    static void ejecutar(const std::vector<std::string>& nombres) {
+        int expandir[] = {0, (RecorrerHistoriales<A, C, Historiales>::ejecutar(nombres), 0)...};
+        (void)expandir;
+    }
+};
+
+template <class Lista>
+struct RecorrerAlmacenes;
+
+template <class... A>
+struct RecorrerAlmacenes<Tipos<A...> > {
+    static void ejecutar(const std::vector<std::string>& nombres) {
+        int expandir[] = {0, (RecorrerColas<A, Colas>::ejecutar(nombres), 0)...};
+        (void)expandir;
+    }
+};
+
+int main(int argc, char** argv) {
+    std::size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    if (n == 0) {
+        n = 1;
+    }
+
+    std::vector<std::string> nombres(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        nombres[i] = "producto-" + std::to_string(i);
+    }
+
+    std::printf("Productos: %zu (ns/op)\n", n);
+    std::printf("%-11s %-12s %-9s %-12s %10s %10s %10s %10s %10s %10s\n",
+                "almacen", "cola", "historial", "bloqueo",
+                "registrar", "consultar", "listar", "colas", "eliminar", "deshacer");
+    RecorrerAlmacenes<Almacenes>::ejecutar(nombres);
+    return 0;
+}
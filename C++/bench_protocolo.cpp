@@ -0,0 +1,206 @@
+// Benchmark de los protocolos del modo servidor
+// Compara el protocolo de texto con el binario sobre la misma carga, sin sockets:
+// mide decodificar la peticin, ejecutarla y codificar la respuesta, que es el trabajo
+// del servidor por peticin. Para el costo de extremo a extremo, ver carga_servidor -b.
+//
+// Uso: bench_protocolo [productos] [peticiones]
+//      Por defecto: 10000 productos y 1000000 peticiones.
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <random>
+
+#include "sistema_gestion.h"
+#include "servidor.h"
+
+typedef SistemaGestionT<AlmacenHashPlano, ColaAnillo, HistorialVector> SistemaBench;
+
+// Peticiones que llegan juntas, como con pipelining; tras cada lote se descarta la salida.
+static const int LOTE = 16;
+
+// Una peticin de la carga, independiente del protocolo.
+struct Peticion {
+    int operacion;
+    std::string nombre;
+};
+
+// Misma mezcla que carga_servidor: 90% consultas, 4% altas, 4% bajas, 2% colas.
+static std::vector<Peticion> generarMezcla(int productos, int peticiones) {
+    std::vector<Peticion> carga;
+    carga.reserve(peticiones);
+    std::mt19937 azar(12345);
+    unsigned long long altas = 0;
+    for (int i = 0; i < peticiones; ++i) {
+        unsigned tipo = azar() % 100;
+        Peticion peticion;
+        if (tipo < 90) {
+            peticion.operacion = 3;
+            peticion.nombre = "producto-" + std::to_string(azar() % productos);
+        } else if (tipo < 94) {
+            peticion.operacion = 1;
+            peticion.nombre = "nuevo-" + std::to_string(altas++);
+        } else if (tipo < 98) {
+            peticion.operacion = 2;
+            peticion.nombre = "nuevo-" + std::to_string(altas > 0 ? azar() % altas : 0ULL);
+        } else if (tipo == 98) {
+            peticion.operacion = 9;
+            peticion.nombre = "cliente-" + std::to_string(azar() % 1000);
+        } else {
+            peticion.operacion = 10;
+        }
+        carga.push_back(peticion);
+    }
+    return carga;
+}
+
+static std::string codificarTexto(const std::vector<Peticion>& carga) {
+    std::string texto;
+    for (const auto& peticion : carga) {
+        texto += std::to_string(peticion.operacion);
+        if (!peticion.nombre.empty()) {
+            texto += ' ';
+            texto += peticion.nombre;
+        }
+        if (peticion.operacion == 1) {
+            texto += " 9.5 3";
+        }
+        texto += '\n';
+    }
+    return texto;
+}
+
+static std::string codificarBinario(const std::vector<Peticion>& carga) {
+    std::string binario;
+    CodificadorPeticiones peticiones(binario);
+    for (const auto& peticion : carga) {
+        switch (peticion.operacion) {
+            case 1: peticiones.registrarProducto(peticion.nombre, 9.5, 3); break;
+            case 2: peticiones.eliminarProducto(peticion.nombre); break;
+            case 3: peticiones.consultarProducto(peticion.nombre); break;
+            case 9: peticiones.registrarClienteEnEspera(peticion.nombre); break;
+            default: peticiones.operacion(static_cast<uint8_t>(peticion.operacion));
+        }
+    }
+    return binario;
+}
+
+static void cargarInventario(SistemaBench& sistema, int productos, std::size_t largoNombre) {
+    for (int i = 0; i < productos; ++i) {
+        std::string nombre = "producto-" + std::to_string(i);
+        if (nombre.size() < largoNombre) {
+            nombre.append(largoNombre - nombre.size(), 'x');
+        }
+        sistema.registrarProducto({nombre, 1.5, 10});
+    }
+}
+
+struct Resultado {
+    double nsPorPeticion;
+    double bytesRespuesta; // Por peticin.
+};
+
+// Ejecuta el flujo de texto como lo hace el servidor: lnea a lnea, con los mensajes
+// redirigidos a un bfer de salida.
+static Resultado correrTexto(SistemaBench& sistema, const std::string& entrada, std::size_t peticiones) {
+    BufferSalida buffer;
+    std::ostream flujo(&buffer);
+    std::string salida;
+    buffer.redirigir(&salida);
+    sistema.fijarSalida(&flujo);
+    int siguienteId = 1;
+    unsigned long long bytes = 0;
+    int enLote = 0;
+
+    auto inicio = std::chrono::steady_clock::now();
+    std::size_t consumidos = 0;
+    for (;;) {
+        std::size_t finLinea = entrada.find('\n', consumidos);
+        if (finLinea == std::string::npos) break;
+        ejecutarPeticionTexto(sistema, entrada.data() + consumidos, finLinea - consumidos, flujo, siguienteId);
+        consumidos = finLinea + 1;
+        if (++enLote == LOTE) {
+            bytes += salida.size();
+            salida.clear();
+            enLote = 0;
+        }
+    }
+    bytes += salida.size();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - inicio).count();
+    sistema.fijarSalida(nullptr);
+    Resultado resultado = {ns / peticiones, static_cast<double>(bytes) / peticiones};
+    return resultado;
+}
+
+// Ejecuta el flujo binario: tramas decodificadas en el lugar y respuestas en una
+// SalidaVectorial, que se recorre como lo hara writev.
+static Resultado correrBinario(SistemaBench& sistema, const std::string& entrada, std::size_t peticiones) {
+    SalidaVectorial salida;
+    sistema.fijarSalida(nullptr);
+    int siguienteId = 1;
+    unsigned long long bytes = 0;
+    int enLote = 0;
+    auto vaciar = [&]() {
+        salida.recorrer([&bytes](const char*, std::size_t longitud) { bytes += longitud; });
+        salida.limpiar();
+    };
+
+    auto inicio = std::chrono::steady_clock::now();
+    std::size_t consumidos = 0;
+    while (entrada.size() - consumidos >= 4) {
+        uint32_t longitud = leerU32(entrada.data() + consumidos);
+        ejecutarTramaBinaria(sistema, entrada.data() + consumidos + 4, longitud, salida, siguienteId);
+        consumidos += 4 + longitud;
+        if (++enLote == LOTE) {
+            vaciar();
+            enLote = 0;
+        }
+    }
+    vaciar();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - inicio).count();
+    Resultado resultado = {ns / peticiones, static_cast<double>(bytes) / peticiones};
+    return resultado;
+}
+
+static void comparar(const char* carga, int productos, std::size_t largoNombre, const std::vector<Peticion>& peticiones) {
+    std::string texto = codificarTexto(peticiones);
+    std::string binario = codificarBinario(peticiones);
+    Resultado resultados[2];
+    {
+        SistemaBench sistema(nullptr);
+        cargarInventario(sistema, productos, largoNombre);
+        resultados[0] = correrTexto(sistema, texto, peticiones.size());
+    }
+    {
+        SistemaBench sistema(nullptr);
+        cargarInventario(sistema, productos, largoNombre);
+        resultados[1] = correrBinario(sistema, binario, peticiones.size());
+    }
+    double n = static_cast<double>(peticiones.size());
+    std::printf("%-8s %-8s %10.1f ns/op %8.1f B/peticion %10.1f B/respuesta\n", carga, "texto",
+                resultados[0].nsPorPeticion, texto.size() / n, resultados[0].bytesRespuesta);
+    std::printf("%-8s %-8s %10.1f ns/op %8.1f B/peticion %10.1f B/respuesta  (%.2fx)\n", carga, "binario",
+                resultados[1].nsPorPeticion, binario.size() / n, resultados[1].bytesRespuesta,
+                resultados[0].nsPorPeticion / resultados[1].nsPorPeticion);
+}
+
+int main(int argc, char** argv) {
+    int productos = argc > 1 ? std::atoi(argv[1]) : 10000;
+    int peticiones = argc > 2 ? std::atoi(argv[2]) : 1000000;
+    if (productos < 1 || peticiones < 1) {
+        std::cerr << "Uso: " << argv[0] << " [productos] [peticiones]" << std::endl;
+        return 2;
+    }
+
+    // La mezcla de carga_servidor, dominada por consultas pequeas.
+    comparar("mezcla", productos, 0, generarMezcla(productos, peticiones));
+
+    // Listados completos de un inventario pequeo con nombres largos: el caso en que
+    // la salida vectorial referencia los nombres en lugar de copiarlos.
+    std::vector<Peticion> listados(std::max(1, peticiones / 10000), Peticion{4, std::string()});
+    comparar("listado", 1000, 300, listados);
+    return 0;
+}
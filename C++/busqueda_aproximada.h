@@ -0,0 +1,403 @@
+#ifndef BUSQUEDA_APROXIMADA_H
+#define BUSQUEDA_APROXIMADA_H
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+#include <stdint.h>
+
+#include "estructuras.h"
+#include "memoria_estructuras.h"
+
+// Bsqueda aproximada de nombres de producto
+// Cuando una consulta exacta falla, sugiere los nombres a menor distancia de edicin
+// (Levenshtein: inserciones, borrados y reemplazos de un byte). Comparar contra todo el
+// inventario tarda segundos con 10^6 nombres, as que se hace en dos pasos:
+//
+//   1. Filtro de candidatos con trigramas. Se indexan los trigramas de cada nombre,
+//      completado con dos bytes 0 a cada lado (un nombre de L bytes tiene L + 2). Una
+//      edicin rompe a lo sumo 3 trigramas, as que un nombre a distancia d o menos
+//      conserva al menos L + 2 - 3d de los de la consulta; eligiendo 3d + 1 de ellos,
+//      contiene por fuerza alguno (eligiendo 3d + t, contiene t). Se eligen los de
+//      listas ms cortas, se cuenta cuntos de ellos tiene cada nombre de esas listas y
+//      solo se verifican los que llegan: los trigramas comunes a todo el inventario
+//      ("pro", "uct") nunca se recorren.
+//   2. Verificacin con el algoritmo de Myers (en la formulacin de Hyyr): la columna
+//      de la matriz de distancias se lleva en dos palabras de 64 bits con sus diferencias
+//      verticales, as cada byte del candidato cuesta una decena de operaciones sobre
+//      palabras en lugar de una fila de la matriz. Se corta en cuanto la distancia ya no
+//      puede bajar de la cota.
+//
+// Los trigramas se agrupan en CUBETAS_TRIGRAMAS listas por su hash: una colisin solo
+// agrega candidatos. Un nombre que se va queda en su lista marcado como ausente (si
+// vuelve, revive sin tocar las listas) hasta que los ausentes superan a los presentes y
+// se compacta todo; as las bajas no recorren listas de 10^6 elementos.
+
+static const std::size_t SUGERENCIAS_APROXIMADAS = 5;
+static const std::size_t DISTANCIA_MAXIMA_SUGERENCIA = 2;
+static const std::size_t CUBETAS_TRIGRAMAS = 1 << 16;
+
+// Distancia de Levenshtein con la matriz completa, fila por fila; devuelve cota + 1 si
+// se pasa. Para patrones de ms de 64 bytes, que no caben en una palabra.
+inline std::size_t distanciaLevenshtein(const VistaNombre& a, const VistaNombre& b, std::size_t cota) {
+    std::vector<std::size_t> fila(b.longitud + 1);
+    for (std::size_t j = 0; j <= b.longitud; ++j) {
+        fila[j] = j;
+    }
+    for (std::size_t i = 1; i <= a.longitud; ++i) {
+        std::size_t diagonal = fila[0];
+        std::size_t minimo = fila[0] = i;
+        for (std::size_t j = 1; j <= b.longitud; ++j) {
+            std::size_t arriba = fila[j];
+            fila[j] = std::min(std::min(arriba, fila[j - 1]) + 1, diagonal + (a.datos[i - 1] != b.datos[j - 1]));
+            diagonal = arriba;
+            minimo = std::min(minimo, fila[j]);
+        }
+        if (minimo > cota) {
+            return cota + 1;
+        }
+    }
+    return std::min(fila[b.longitud], cota + 1);
+}
+
+// Patrn preparado para el algoritmo de Myers: para cada byte, los bits de las
+// posiciones del patrn donde aparece.
+class PatronMyers {
+public:
+    explicit PatronMyers(const VistaNombre& patron) : patron(patron), ultimo(0) {
+        std::memset(coincidencias, 0, sizeof(coincidencias));
+        if (patron.longitud <= 64) {
+            for (std::size_t i = 0; i < patron.longitud; ++i) {
+                coincidencias[static_cast<unsigned char>(patron.datos[i])] |= uint64_t(1) << i;
+            }
+            ultimo = patron.longitud > 0 ? uint64_t(1) << (patron.longitud - 1) : 0;
+        }
+    }
+
+    // Distancia de Levenshtein entre el patrn y el texto; cota + 1 si se pasa.
+    std::size_t distancia(const VistaNombre& texto, std::size_t cota) const {
+        std::size_t m = patron.longitud;
+        if (m == 0 || m > 64) {
+            return m == 0 ? std::min(texto.longitud, cota + 1) : distanciaLevenshtein(patron, texto, cota);
+        }
+        // Pv y Mv: bits de las filas donde la columna sube o baja en 1 respecto de la de
+        // arriba. La primera columna es 0, 1, ..., m: todo sube.
+        uint64_t positivos = ~uint64_t(0), negativos = 0;
+        std::size_t puntaje = m; // ltima fila de la columna actual.
+        for (std::size_t j = 0; j < texto.longitud; ++j) {
+            uint64_t igual = coincidencias[static_cast<unsigned char>(texto.datos[j])];
+            uint64_t xv = igual | negativos;
+            uint64_t xh = (((igual & positivos) + positivos) ^ positivos) | igual;
+            uint64_t ph = negativos | ~(xh | positivos);
+            uint64_t mh = positivos & xh;
+            if (ph & ultimo) {
+                ++puntaje;
+            } else if (mh & ultimo) {
+                --puntaje;
+            }
+            // La fila 0 es j: la diferencia horizontal que entra por abajo es +1.
+            ph = (ph << 1) | 1;
+            mh <<= 1;
+            positivos = mh | ~(xv | ph);
+            negativos = ph & xv;
+            // Cada byte restante baja la ltima fila a lo sumo en 1.
+            if (puntaje > cota + (texto.longitud - j - 1)) {
+                return cota + 1;
+            }
+        }
+        return std::min(puntaje, cota + 1);
+    }
+
+private:
+    VistaNombre patron;
+    uint64_t ultimo; // Bit de la ltima fila.
+    uint64_t coincidencias[256];
+};
+
+class IndiceAproximado {
+public:
+    IndiceAproximado() : listas(CUBETAS_TRIGRAMAS), ranuras(16, 0), presentes(0), ausentes(0) {}
+
+    // Una copia ms del nombre.
+    void agregar(const VistaNombre& nombre) {
+        uint64_t hash = hashNombre(nombre.datos, nombre.longitud);
+        std::size_t ranura = ranuraDe(nombre, hash);
+        if (ranuras[ranura] != 0) {
+            EntradaAproximada& entrada = entradas[ranuras[ranura] - 1];
+            if (entrada.copias++ == 0) {
+                // Revive: sus trigramas siguen en las listas.
+                ++presentes;
+                --ausentes;
+            }
+            return;
+        }
+        // Factor de carga mximo de 0.5.
+        if ((entradas.size() + 1) * 2 > ranuras.size()) {
+            crecer();
+            ranura = ranuraDe(nombre, hash);
+        }
+        ranuras[ranura] = nuevaEntrada(nombre, hash, 1) + 1;
+        ++presentes;
+    }
+
+    // Una copia menos del nombre; con la ltima deja de sugerirse.
+    void quitar(const VistaNombre& nombre) {
+        uint32_t valor = ranuras[ranuraDe(nombre, hashNombre(nombre.datos, nombre.longitud))];
+        if (valor == 0 || entradas[valor - 1].copias == 0 || --entradas[valor - 1].copias > 0) {
+            return;
+        }
+        --presentes;
+        ++ausentes;
+        if (ausentes > presentes && ausentes >= 1024) {
+            compactar();
+        }
+    }
+
+    // Llama a f(const VistaNombre& nombre, std::size_t distancia) con hasta limite nombres
+    // a distancia de edicin DISTANCIA_MAXIMA_SUGERENCIA o menos, de la menor a la mayor
+    // (y por nombre si empatan); devuelve cuntos fueron. Se admite a lo sumo una
+    // edicin cada 4 bytes: a un nombre corto, dos ediciones lo acercan a cualquiera.
+    template <class F>
+    std::size_t sugerir(const VistaNombre& nombre, std::size_t limite, F f) {
+        std::size_t cota = std::min(DISTANCIA_MAXIMA_SUGERENCIA, nombre.longitud / 4);
+        if (cota == 0 || limite == 0 || presentes == 0) {
+            return 0;
+        }
+        std::size_t minimo = elegirListas(nombre, cota);
+        conteos.resize(entradas.size(), 0);
+        tocadas.clear();
+        for (const ListaElegida& elegida : elegidas) {
+            for (uint32_t indice : listas[elegida.cubeta]) {
+                if (conteos[indice] == 0) {
+                    tocadas.push_back(indice);
+                }
+                conteos[indice] += elegida.veces;
+            }
+        }
+
+        // Quedan las que llegan al mnimo, sin leer todava su entrada, y en orden de
+        // entrada para recorrer entradas y textos hacia adelante.
+        std::size_t candidatas = 0;
+        for (uint32_t indice : tocadas) {
+            if (conteos[indice] >= minimo) {
+                tocadas[candidatas++] = indice;
+            }
+            conteos[indice] = 0;
+        }
+        tocadas.resize(candidatas);
+        std::sort(tocadas.begin(), tocadas.end());
+
+        PatronMyers patron(nombre);
+        mejores.clear();
+        for (uint32_t indice : tocadas) {
+            const EntradaAproximada& entrada = entradas[indice];
+            std::size_t diferencia = entrada.longitud > nombre.longitud ? entrada.longitud - nombre.longitud
+                                                                        : nombre.longitud - entrada.longitud;
+            if (entrada.copias == 0 || diferencia > cota) {
+                continue;
+            }
+            std::size_t distancia = patron.distancia(nombreDe(entrada), cota);
+            if (distancia > cota) {
+                continue;
+            }
+            SugerenciaAproximada sugerencia = {indice, static_cast<uint32_t>(distancia)};
+            std::vector<SugerenciaAproximada>::iterator lugar = std::upper_bound(
+                mejores.begin(), mejores.end(), sugerencia,
+                [this](const SugerenciaAproximada& a, const SugerenciaAproximada& b) { return antes(a, b); });
+            if (lugar - mejores.begin() >= static_cast<std::ptrdiff_t>(limite)) {
+                continue;
+            }
+            mejores.insert(lugar, sugerencia);
+            if (mejores.size() > limite) {
+                mejores.pop_back();
+            }
+            if (mejores.size() == limite) {
+                cota = mejores.back().distancia; // Solo puede entrar algo igual o ms cercano.
+            }
+        }
+        for (const SugerenciaAproximada& sugerencia : mejores) {
+            f(nombreDe(entradas[sugerencia.entrada]), static_cast<std::size_t>(sugerencia.distancia));
+        }
+        return mejores.size();
+    }
+
+    std::size_t tamano() const { return presentes; }
+
+    MemoriaEstructura memoria() const {
+        MemoriaEstructura memoria;
+        memoria.elementos = static_cast<int64_t>(presentes);
+        memoria += bloqueMonton(listas.capacity() * sizeof(std::vector<uint32_t>));
+        for (const std::vector<uint32_t>& lista : listas) {
+            memoria += bloqueMonton(lista.capacity() * sizeof(uint32_t));
+        }
+        memoria += bloqueMonton(entradas.capacity() * sizeof(EntradaAproximada));
+        memoria += bloqueMonton(textos.capacity());
+        memoria += bloqueMonton(ranuras.capacity() * sizeof(uint32_t));
+        memoria += bloqueMonton(conteos.capacity() * sizeof(uint32_t));
+        memoria += bloqueMonton(tocadas.capacity() * sizeof(uint32_t));
+        memoria += bloqueMonton(posiciones.capacity() * sizeof(uint32_t));
+        memoria += bloqueMonton(elegidas.capacity() * sizeof(ListaElegida));
+        memoria += bloqueMonton(mejores.capacity() * sizeof(SugerenciaAproximada));
+        return memoria;
+    }
+
+private:
+    // Los nombres van uno tras otro en textos.
+    struct EntradaAproximada {
+        uint64_t hash;
+        uint32_t inicio;
+        uint32_t longitud;
+        uint32_t copias; // 0: ausente, pero todava en las listas.
+    };
+
+    struct ListaElegida {
+        uint32_t cubeta;
+        uint32_t veces; // Posiciones de la consulta con trigramas en la cubeta.
+    };
+
+    struct SugerenciaAproximada {
+        uint32_t entrada;
+        uint32_t distancia;
+    };
+
+    VistaNombre nombreDe(const EntradaAproximada& entrada) const {
+        VistaNombre vista = {textos.data() + entrada.inicio, entrada.longitud};
+        return vista;
+    }
+
+    bool antes(const SugerenciaAproximada& a, const SugerenciaAproximada& b) const {
+        if (a.distancia != b.distancia) {
+            return a.distancia < b.distancia;
+        }
+        return nombreDe(entradas[a.entrada]) < nombreDe(entradas[b.entrada]);
+    }
+
+    // Cubeta del trigrama que empieza en la posicin i del nombre completado con dos
+    // bytes 0 a cada lado.
+    static uint32_t cubetaTrigrama(const VistaNombre& nombre, std::size_t i) {
+        uint32_t clave = 0;
+        for (std::size_t k = i; k < i + 3; ++k) {
+            uint32_t byte = k >= 2 && k - 2 < nombre.longitud ? static_cast<unsigned char>(nombre.datos[k - 2]) : 0;
+            clave = (clave << 8) | byte;
+        }
+        return (clave * 0x9E3779B1u) >> (32 - 16);
+    }
+
+    // Elige las listas a recorrer y devuelve cuntos trigramas de ellas debe tener un
+    // candidato. Van primero las 3 * cota + 1 ms cortas, que alcanzan con uno, y despus
+    // las que siguen mientras no sean ms largas que lo ya elegido: cada lista ms exige
+    // un trigrama ms y descarta candidatos sin ir a buscar su nombre. En elegidas queda
+    // cada cubeta una vez, con las posiciones de la consulta que cayeron en ella.
+    std::size_t elegirListas(const VistaNombre& nombre, std::size_t cota) {
+        posiciones.clear();
+        for (std::size_t i = 0; i < nombre.longitud + 2; ++i) {
+            posiciones.push_back(cubetaTrigrama(nombre, i));
+        }
+        std::sort(posiciones.begin(), posiciones.end(), [this](uint32_t a, uint32_t b) {
+            return listas[a].size() != listas[b].size() ? listas[a].size() < listas[b].size() : a < b;
+        });
+        std::size_t cantidad = 3 * cota + 1; // cota <= longitud / 4: hay longitud + 2.
+        std::size_t recorridos = 0;
+        for (std::size_t i = 0; i < cantidad; ++i) {
+            recorridos += listas[posiciones[i]].size();
+        }
+        for (; cantidad < posiciones.size() && listas[posiciones[cantidad]].size() <= recorridos; ++cantidad) {
+            recorridos += listas[posiciones[cantidad]].size();
+        }
+        // Cada posicin que no se recorre pudo aportar un trigrama sin que se vea.
+        elegidas.clear();
+        for (std::size_t i = 0; i < cantidad; ++i) {
+            if (elegidas.empty() || elegidas.back().cubeta != posiciones[i]) {
+                ListaElegida elegida = {posiciones[i], 0};
+                elegidas.push_back(elegida);
+            }
+            ++elegidas.back().veces;
+        }
+        return cantidad - 3 * cota;
+    }
+
+    uint32_t nuevaEntrada(const VistaNombre& nombre, uint64_t hash, uint32_t copias) {
+        uint32_t indice = static_cast<uint32_t>(entradas.size());
+        EntradaAproximada entrada = {hash, static_cast<uint32_t>(textos.size()), static_cast<uint32_t>(nombre.longitud),
+                                     copias};
+        entradas.push_back(entrada);
+        textos.append(nombre.datos, nombre.longitud);
+        for (std::size_t i = 0; i < nombre.longitud + 2; ++i) {
+            std::vector<uint32_t>& lista = listas[cubetaTrigrama(nombre, i)];
+            // Un trigrama repetido (o dos en la misma cubeta) se anota una vez.
+            if (lista.empty() || lista.back() != indice) {
+                lista.push_back(indice);
+            }
+        }
+        return indice;
+    }
+
+    // Rehace todo solo con los nombres presentes.
+    void compactar() {
+        std::vector<EntradaAproximada> anteriores;
+        std::string textosAnteriores;
+        anteriores.swap(entradas);
+        textosAnteriores.swap(textos);
+        for (std::vector<uint32_t>& lista : listas) {
+            lista.clear();
+        }
+        std::fill(ranuras.begin(), ranuras.end(), 0);
+        for (const EntradaAproximada& anterior : anteriores) {
+            if (anterior.copias > 0) {
+                VistaNombre nombre = {textosAnteriores.data() + anterior.inicio, anterior.longitud};
+                ranuras[ranuraDe(nombre, anterior.hash)] = nuevaEntrada(nombre, anterior.hash, anterior.copias) + 1;
+            }
+        }
+        ausentes = 0;
+        std::vector<uint32_t>().swap(conteos);
+    }
+
+    // Tabla de nombres con direccionamiento abierto (sondeo lineal): entrada + 1, o 0
+    // si la ranura est libre. Devuelve la ranura del nombre o la libre donde ira. Las
+    // entradas no se borran hasta compactar, as que no hace falta liberar ranuras.
+    std::size_t ranuraDe(const VistaNombre& nombre, uint64_t hash) const {
+        std::size_t mascara = ranuras.size() - 1;
+        for (std::size_t i = hash & mascara;; i = (i + 1) & mascara) {
+            uint32_t valor = ranuras[i];
+            if (valor == 0) {
+                return i;
+            }
+            const EntradaAproximada& entrada = entradas[valor - 1];
+            if (entrada.hash == hash && nombreDe(entrada) == nombre) {
+                return i;
+            }
+        }
+    }
+
+    void crecer() {
+        std::vector<uint32_t> anteriores(ranuras.size() * 2, 0);
+        anteriores.swap(ranuras);
+        std::size_t mascara = ranuras.size() - 1;
+        for (uint32_t valor : anteriores) {
+            if (valor != 0) {
+                std::size_t i = entradas[valor - 1].hash & mascara;
+                while (ranuras[i] != 0) {
+                    i = (i + 1) & mascara;
+                }
+                ranuras[i] = valor;
+            }
+        }
+    }
+
+    std::vector<std::vector<uint32_t> > listas; // Entradas con algn trigrama de cada cubeta, en orden.
+    std::vector<EntradaAproximada> entradas;
+    std::string textos;
+    std::vector<uint32_t> ranuras;
+    std::size_t presentes;
+    std::size_t ausentes;
+    // Espacio de trabajo de sugerir.
+    std::vector<uint32_t> conteos; // Trigramas de la consulta vistos en cada entrada; vuelven a 0.
+    std::vector<uint32_t> tocadas;  // Entradas con conteo distinto de 0.
+    std::vector<uint32_t> posiciones;
+    std::vector<ListaElegida> elegidas;
+    std::vector<SugerenciaAproximada> mejores;
+};
+
+#endif
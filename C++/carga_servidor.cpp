@@ -0,0 +1,295 @@
+// Generador de carga para el modo servidor
+// Abre muchas conexiones, mantiene varias peticiones en vuelo por conexin (pipelining)
+// y mide el rendimiento (peticiones/s) y la latencia de cada peticin.
+//
+// Uso: carga_servidor [-b] <ruta-socket | tcp:puerto> [conexiones] [profundidad] [segundos] [productos]
+//      Por defecto: 64 conexiones, 16 peticiones en vuelo, 5 segundos, 10000 productos.
+//      -b usa el protocolo binario en lugar del de texto.
+//
+// La mezcla es 90% consultas, 4% altas, 4% bajas y 2% operaciones de colas; es la
+// misma con los dos protocolos, as que sus resultados se pueden comparar.
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include "protocolo_binario.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+typedef std::chrono::steady_clock Reloj;
+
+struct ConexionCarga {
+    int fd;
+    std::string entrada;                // Respuestas recibidas sin procesar.
+    std::string salida;                 // Peticiones pendientes de enviar.
+    std::deque<Reloj::time_point> envios; // Instante de envo de cada peticin en vuelo.
+};
+
+static int conectar(const std::string& destino) {
+    int fd;
+    if (destino.compare(0, 4, "tcp:") == 0) {
+        sockaddr_in direccion;
+        std::memset(&direccion, 0, sizeof(direccion));
+        direccion.sin_family = AF_INET;
+        direccion.sin_port = htons(static_cast<uint16_t>(std::atoi(destino.c_str() + 4)));
+        direccion.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&direccion), sizeof(direccion)) != 0) {
+            if (fd >= 0) ::close(fd);
+            return -1;
+        }
+        int uno = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &uno, sizeof(uno));
+    } else {
+        sockaddr_un direccion;
+        std::memset(&direccion, 0, sizeof(direccion));
+        direccion.sun_family = AF_UNIX;
+        std::strncpy(direccion.sun_path, destino.c_str(), sizeof(direccion.sun_path) - 1);
+        fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&direccion), sizeof(direccion)) != 0) {
+            if (fd >= 0) ::close(fd);
+            return -1;
+        }
+    }
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+// Enva todo lo que el socket acepte sin bloquear.
+static bool enviar(ConexionCarga& c) {
+    while (!c.salida.empty()) {
+        ssize_t n = ::send(c.fd, c.salida.data(), c.salida.size(), MSG_NOSIGNAL);
+        if (n > 0) {
+            c.salida.erase(0, static_cast<std::size_t>(n));
+        } else {
+            return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+        }
+    }
+    return true;
+}
+
+// Cuenta las respuestas completas (terminadas por una lnea vaca, o tramas binarias)
+// y las quita de la entrada.
+static std::size_t respuestasCompletas(std::string& entrada, bool binario) {
+    if (binario) {
+        std::size_t consumidos = 0;
+        std::size_t completas = tramasCompletas(entrada.data(), entrada.size(), consumidos);
+        entrada.erase(0, consumidos);
+        return completas;
+    }
+    std::size_t completas = 0;
+    std::size_t consumidos = 0;
+    std::size_t inicioLinea = 0;
+    for (std::size_t i = 0; i < entrada.size(); ++i) {
+        if (entrada[i] == '\n') {
+            if (i == inicioLinea) {
+                ++completas;
+                consumidos = i + 1;
+            }
+            inicioLinea = i + 1;
+        }
+    }
+    entrada.erase(0, consumidos);
+    return completas;
+}
+
+static void agregarPeticion(std::string& salida, std::mt19937& azar, int productos, unsigned long long& altas, bool binario) {
+    unsigned tipo = azar() % 100;
+    if (binario) {
+        CodificadorPeticiones peticiones(salida);
+        if (tipo < 90) {
+            peticiones.consultarProducto("producto-" + std::to_string(azar() % productos));
+        } else if (tipo < 94) {
+            peticiones.registrarProducto("nuevo-" + std::to_string(altas++), 9.5, 3);
+        } else if (tipo < 98) {
+            peticiones.eliminarProducto("nuevo-" + std::to_string(altas > 0 ? azar() % altas : 0ULL));
+        } else if (tipo == 98) {
+            peticiones.registrarClienteEnEspera("cliente-" + std::to_string(azar() % 1000));
+        } else {
+            peticiones.operacion(10);
+        }
+        return;
+    }
+    char linea[96];
+    if (tipo < 90) {
+        std::snprintf(linea, sizeof(linea), "3 producto-%d\n", static_cast<int>(azar() % productos));
+    } else if (tipo < 94) {
+        std::snprintf(linea, sizeof(linea), "1 nuevo-%llu 9.5 3\n", altas++);
+    } else if (tipo < 98) {
+        std::snprintf(linea, sizeof(linea), "2 nuevo-%llu\n", altas > 0 ? azar() % altas : 0ULL);
+    } else if (tipo == 98) {
+        std::snprintf(linea, sizeof(linea), "9 cliente-%u\n", static_cast<unsigned>(azar() % 1000));
+    } else {
+        std::snprintf(linea, sizeof(linea), "10\n");
+    }
+    salida += linea;
+}
+
+int main(int argc, char** argv) {
+    bool binario = argc > 1 && std::string(argv[1]) == "-b";
+    if (binario) {
+        --argc;
+        ++argv;
+    }
+    if (argc < 2) {
+        std::cerr << "Uso: " << argv[0] << " [-b] <ruta-socket | tcp:puerto> [conexiones] [profundidad] [segundos] [productos]" << std::endl;
+        return 2;
+    }
+    std::string destino = argv[1];
+    int numConexiones = argc > 2 ? std::atoi(argv[2]) : 64;
+    int profundidad = argc > 3 ? std::atoi(argv[3]) : 16;
+    int segundos = argc > 4 ? std::atoi(argv[4]) : 5;
+    int productos = argc > 5 ? std::atoi(argv[5]) : 10000;
+    std::string preambulo = binario ? std::string(MAGICO_PROTOCOLO_BINARIO, 4) : std::string();
+    if (numConexiones < 1 || profundidad < 1 || segundos < 1 || productos < 1) {
+        std::cerr << "Los parmetros deben ser positivos." << std::endl;
+        return 2;
+    }
+
+    // Carga inicial del inventario por una sola conexin, con pipelining.
+    {
+        ConexionCarga c;
+        c.fd = conectar(destino);
+        if (c.fd < 0) {
+            std::cerr << "No se pudo conectar a " << destino << std::endl;
+            return 1;
+        }
+        c.salida = preambulo;
+        CodificadorPeticiones peticiones(c.salida);
+        for (int i = 0; i < productos; ++i) {
+            if (binario) {
+                peticiones.registrarProducto("producto-" + std::to_string(i), 1.5, 10);
+            } else {
+                c.salida += "1 producto-" + std::to_string(i) + " 1.5 10\n";
+            }
+        }
+        std::size_t recibidas = 0;
+        char bloque[65536];
+        while (recibidas < static_cast<std::size_t>(productos)) {
+            if (!enviar(c)) return 1;
+            ssize_t n = ::recv(c.fd, bloque, sizeof(bloque), 0);
+            if (n > 0) {
+                c.entrada.append(bloque, static_cast<std::size_t>(n));
+                recibidas += respuestasCompletas(c.entrada, binario);
+            } else if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                return 1;
+            }
+        }
+        ::close(c.fd);
+    }
+
+    int epoll = ::epoll_create1(0);
+    std::vector<ConexionCarga> conexiones(numConexiones);
+    std::mt19937 azar(12345);
+    unsigned long long altas = 0;
+    for (int i = 0; i < numConexiones; ++i) {
+        conexiones[i].fd = conectar(destino);
+        if (conexiones[i].fd < 0) {
+            std::cerr << "No se pudo abrir la conexin " << i << std::endl;
+            return 1;
+        }
+        epoll_event evento;
+        std::memset(&evento, 0, sizeof(evento));
+        evento.events = EPOLLIN;
+        evento.data.u32 = static_cast<uint32_t>(i);
+        ::epoll_ctl(epoll, EPOLL_CTL_ADD, conexiones[i].fd, &evento);
+    }
+
+    std::vector<double> latencias; // Microsegundos.
+    latencias.reserve(1 << 22);
+    Reloj::time_point inicio = Reloj::now();
+    Reloj::time_point limite = inicio + std::chrono::seconds(segundos);
+
+    // Llena cada conexin hasta la profundidad pedida; todas las peticiones de una
+    // conexin salen en una sola escritura.
+    for (auto& c : conexiones) {
+        Reloj::time_point ahora = Reloj::now();
+        c.salida = preambulo;
+        for (int k = 0; k < profundidad; ++k) {
+            agregarPeticion(c.salida, azar, productos, altas, binario);
+            c.envios.push_back(ahora);
+        }
+        enviar(c);
+    }
+
+    std::vector<epoll_event> eventos(256);
+    char bloque[65536];
+    bool enCurso = true;
+    while (enCurso) {
+        int n = ::epoll_wait(epoll, &eventos[0], static_cast<int>(eventos.size()), 100);
+        Reloj::time_point ahora = Reloj::now();
+        bool generar = ahora < limite;
+        for (int i = 0; i < n; ++i) {
+            ConexionCarga& c = conexiones[eventos[i].data.u32];
+            ssize_t leidos;
+            while ((leidos = ::recv(c.fd, bloque, sizeof(bloque), 0)) > 0) {
+                c.entrada.append(bloque, static_cast<std::size_t>(leidos));
+            }
+            std::size_t completas = respuestasCompletas(c.entrada, binario);
+            for (std::size_t k = 0; k < completas && !c.envios.empty(); ++k) {
+                latencias.push_back(std::chrono::duration<double, std::micro>(ahora - c.envios.front()).count());
+                c.envios.pop_front();
+                if (generar) {
+                    agregarPeticion(c.salida, azar, productos, altas, binario);
+                    c.envios.push_back(ahora);
+                }
+            }
+            enviar(c);
+        }
+        if (!generar) {
+            enCurso = false;
+            for (const auto& c : conexiones) {
+                if (!c.envios.empty()) enCurso = true;
+            }
+            if (ahora > limite + std::chrono::seconds(5)) {
+                break; // No esperar para siempre a un servidor que dej de responder.
+            }
+        }
+    }
+    double duracion = std::chrono::duration<double>(Reloj::now() - inicio).count();
+    for (auto& c : conexiones) {
+        ::close(c.fd);
+    }
+    ::close(epoll);
+
+    if (latencias.empty()) {
+        std::cerr << "No se recibieron respuestas." << std::endl;
+        return 1;
+    }
+    std::sort(latencias.begin(), latencias.end());
+    auto percentil = [&](double p) {
+        return latencias[std::min(latencias.size() - 1, static_cast<std::size_t>(p * latencias.size()))];
+    };
+    std::printf("protocolo=%s conexiones=%d profundidad=%d peticiones=%zu duracion=%.2fs\n", binario ? "binario" : "texto", numConexiones, profundidad,
+                latencias.size(), duracion);
+    std::printf("rendimiento=%.0f peticiones/s\n", latencias.size() / duracion);
+    std::printf("latencia_us p50=%.1f p90=%.1f p99=%.1f p999=%.1f max=%.1f\n", percentil(0.50), percentil(0.90),
+                percentil(0.99), percentil(0.999), latencias.back());
+    return 0;
+}
+
+#else
+
+int main() {
+    std::cerr << "El generador de carga solo est disponible en Linux." << std::endl;
+    return 1;
+}
+
+#endif
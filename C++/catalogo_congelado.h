@@ -0,0 +1,470 @@
+#ifndef CATALOGO_CONGELADO_H
+#define CATALOGO_CONGELADO_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <cstddef>
+#include <stdint.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "estructuras.h"
+#include "instrumentacion.h"
+
+// Catlogo congelado
+// Imagen inmutable y contigua del inventario para los periodos en que no cambia.
+// Todo vive en un nico bloque de memoria direccionado por desplazamientos:
+//
+//   Cabecera | Entrada[numProductos] | cubetas[numCubetas] | ranuras[numRanuras] | nombres
+//
+// - Las entradas estn ordenadas por nombre (estable), as listar es un recorrido lineal.
+// - Los nombres distintos se indexan con una funcin hash perfecta mnima estilo CHD
+//   (hash, desplazamiento y comprobacin): una consulta calcula dos hashes, lee un
+//   desplazamiento, una ranura y una entrada, y compara el nombre una sola vez.
+//   La tabla de ranuras lleva un 1% de holgura para que la construccin termine
+//   rpido; las entradas a las que apunta siguen siendo densas.
+// - Los agregados (unidades, valor total, precios extremos) se calculan al congelar.
+//
+// Como no contiene punteros, el bloque se puede guardar tal cual en un archivo y
+// otros procesos lo proyectan con mmap y consultan sin analizar nada: las pginas
+// se comparten a travs de la cach de pginas del sistema operativo.
+class CatalogoCongelado {
+public:
+    // Cabecera del bloque; todos los desplazamientos son relativos a su inicio.
+    struct Cabecera {
+        char magia[8];            // "CATALOG1"
+        uint32_t numProductos;    // Entradas (incluye nombres repetidos).
+        uint32_t numNombres;      // Nombres distintos.
+        uint32_t numRanuras;      // Rango de la funcin hash perfecta (>= numNombres).
+        uint32_t numCubetas;      // Cubetas de la funcin hash perfecta.
+        uint32_t semilla;         // Semilla con la que se logr construir la funcin.
+        uint32_t marcaOrden;      // MARCA_ORDEN en el orden de bytes de quien lo escribi.
+        uint64_t desplEntradas;
+        uint64_t desplCubetas;
+        uint64_t desplRanuras;
+        uint64_t desplNombres;
+        uint64_t tamanoTotal;     // Bytes del bloque completo.
+        int64_t unidadesTotales;  // Suma de cantidades.
+        double valorTotal;        // Suma de precio * cantidad.
+        double precioMinimo;
+        double precioMaximo;
+    };
+
+    // Un producto dentro del bloque.
+    struct Entrada {
+        uint64_t hash;            // hashNombre del nombre.
+        uint64_t desplNombre;     // Desde el inicio de la zona de nombres.
+        uint32_t longitudNombre;
+        int32_t cantidad;
+        double precio;
+    };
+
+    static const uint32_t MARCA_ORDEN = 0x01020304;
+
+    CatalogoCongelado() : base(nullptr), mapeo(nullptr), bytesMapeo(0) {}
+    ~CatalogoCongelado() { liberar(); }
+
+    CatalogoCongelado(const CatalogoCongelado&) = delete;
+    CatalogoCongelado& operator=(const CatalogoCongelado&) = delete;
+
+    // Construye la imagen a partir de productos ya ordenados por nombre (estable).
+    // Devuelve false si no se logr una funcin hash perfecta (nombres con hash idntico).
+    bool construir(const std::vector<VistaProducto>& productos);
+
+    // Escribe la imagen en un archivo. Devuelve false si no hay imagen o falla la escritura.
+    bool guardar(const std::string& ruta) const;
+
+    // Proyecta en memoria (solo lectura) una imagen guardada con guardar.
+    // Devuelve false si el archivo no existe o no es una imagen vlida para esta mquina.
+    bool abrir(const std::string& ruta);
+
+    // Descarta la imagen (propia o proyectada).
+    void liberar() {
+        base = nullptr;
+        std::vector<uint64_t>().swap(memoria);
+#ifndef _WIN32
+        if (mapeo) {
+            munmap(mapeo, bytesMapeo);
+        }
+#endif
+        mapeo = nullptr;
+        bytesMapeo = 0;
+    }
+
+    // Intercambia las imgenes de dos catlogos sin copiar bytes.
+    void intercambiar(CatalogoCongelado& otro) {
+        std::swap(base, otro.base);
+        memoria.swap(otro.memoria); // El bfer no se mueve, base sigue siendo vlido.
+        std::swap(mapeo, otro.mapeo);
+        std::swap(bytesMapeo, otro.bytesMapeo);
+    }
+
+    bool vacio() const { return base == nullptr; }
+    bool proyectado() const { return mapeo != nullptr; }
+
+    // Busca el primer producto con ese nombre.
+    bool buscar(const VistaNombre& nombre, VistaProducto& vista) const {
+        const Cabecera* c = cabecera();
+        if (!c || c->numNombres == 0) {
+            return false;
+        }
+        uint64_t h = hashNombre(nombre.datos, nombre.longitud);
+        uint32_t d = cubetas()[reducir(static_cast<uint32_t>(h >> 32), c->numCubetas)];
+        uint32_t i = ranuras()[ranura(h, d, c->semilla, c->numRanuras)];
+        const Entrada& e = entradas()[i];
+        INSTRUMENTAR(InstrSondeosHash);
+        INSTRUMENTAR(InstrComparaciones);
+        // Un nombre ajeno cae en alguna ranura vlida; la comprobacin lo descarta.
+        if (e.hash != h || e.longitudNombre != nombre.longitud ||
+            std::memcmp(nombres() + e.desplNombre, nombre.datos, nombre.longitud) != 0) {
+            return false;
+        }
+        vista = vistaEntrada(e);
+        return true;
+    }
+
+    bool buscar(const std::string& nombre, VistaProducto& vista) const {
+        return buscar(vistaDe(nombre), vista);
+    }
+
+    // Recorre los productos ordenados por nombre.
+    template <class F>
+    void recorrerOrdenado(F f) const {
+        std::size_t n = tamano();
+        const Entrada* e = entradas();
+        for (std::size_t i = 0; i < n; ++i) {
+            f(vistaEntrada(e[i]));
+        }
+    }
+
+    // Agregados precalculados.
+    std::size_t tamano() const { return base ? cabecera()->numProductos : 0; }
+    std::size_t nombresDistintos() const { return base ? cabecera()->numNombres : 0; }
+    int64_t unidadesTotales() const { return base ? cabecera()->unidadesTotales : 0; }
+    double valorTotal() const { return base ? cabecera()->valorTotal : 0.0; }
+    double precioMinimo() const { return base ? cabecera()->precioMinimo : 0.0; }
+    double precioMaximo() const { return base ? cabecera()->precioMaximo : 0.0; }
+    std::size_t bytes() const { return base ? static_cast<std::size_t>(cabecera()->tamanoTotal) : 0; }
+
+private:
+    static std::size_t alinear(std::size_t n) { return (n + 7) & ~static_cast<std::size_t>(7); }
+
+    // Reduce x al rango [0, n) sin divisin (multiplicacin y desplazamiento).
+    static uint32_t reducir(uint32_t x, uint32_t n) {
+        return static_cast<uint32_t>((static_cast<uint64_t>(x) * n) >> 32);
+    }
+
+    // Ranura de un nombre segn el desplazamiento de su cubeta.
+    static uint32_t ranura(uint64_t h, uint32_t desplazamiento, uint32_t semilla, uint32_t n) {
+        uint64_t x = h ^ (static_cast<uint64_t>(semilla) << 32);
+        x += (desplazamiento + 1) * 0x9E3779B97F4A7C15ULL;
+        x ^= x >> 33;
+        x *= 0xFF51AFD7ED558CCDULL;
+        x ^= x >> 33;
+        x *= 0xC4CEB9FE1A85EC53ULL;
+        x ^= x >> 33;
+        return reducir(static_cast<uint32_t>(x), n);
+    }
+
+    const Cabecera* cabecera() const { return reinterpret_cast<const Cabecera*>(base); }
+    const Entrada* entradas() const { return reinterpret_cast<const Entrada*>(base + cabecera()->desplEntradas); }
+    const uint32_t* cubetas() const { return reinterpret_cast<const uint32_t*>(base + cabecera()->desplCubetas); }
+    const uint32_t* ranuras() const { return reinterpret_cast<const uint32_t*>(base + cabecera()->desplRanuras); }
+    const char* nombres() const { return reinterpret_cast<const char*>(base + cabecera()->desplNombres); }
+
+    VistaProducto vistaEntrada(const Entrada& e) const {
+        VistaProducto vista;
+        vista.nombre.datos = nombres() + e.desplNombre;
+        vista.nombre.longitud = e.longitudNombre;
+        vista.precio = e.precio;
+        vista.cantidad = e.cantidad;
+        return vista;
+    }
+
+    // Busca desplazamientos para todas las cubetas con la semilla dada (CHD).
+    static bool asignarDesplazamientos(const std::vector<uint64_t>& hashes, uint32_t semilla, uint32_t numCubetas,
+                                       uint32_t numRanuras, std::vector<uint32_t>& desplazamientos,
+                                       std::vector<uint32_t>& ranuraDeClave);
+
+    // Comprueba que un bloque externo de bytes contiene una imagen coherente: las
+    // secciones, y que ninguna entrada ni ranura apunte fuera del bloque.
+    static bool validar(const unsigned char* datos, std::size_t bytes);
+
+    const unsigned char* base;     // Inicio del bloque (propio o proyectado).
+    std::vector<uint64_t> memoria; // Bloque propio, alineado a 8 bytes.
+    void* mapeo;                   // Proyeccin de un archivo, si la hay.
+    std::size_t bytesMapeo;
+};
+
+inline bool CatalogoCongelado::guardar(const std::string& ruta) const {
+    if (!base) {
+        return false;
+    }
+    // Se escribe aparte y se renombra encima: truncar en el sitio una imagen proyectada
+    // (por este proceso o por otro, como consulta_catalogo) la deja con SIGBUS. El
+    // renombrado conserva el archivo viejo para quien todava lo tenga proyectado.
+    std::string temporal = ruta + ".tmp";
+    {
+        std::ofstream archivo(temporal.c_str(), std::ios::binary | std::ios::trunc);
+        archivo.write(reinterpret_cast<const char*>(base), static_cast<std::streamsize>(bytes()));
+        archivo.flush();
+        if (!archivo) {
+            archivo.close();
+            std::remove(temporal.c_str());
+            return false;
+        }
+    }
+#ifdef _WIN32
+    std::remove(ruta.c_str()); // En Windows rename no reemplaza un archivo existente.
+#endif
+    if (std::rename(temporal.c_str(), ruta.c_str()) != 0) {
+        std::remove(temporal.c_str());
+        return false;
+    }
+    return true;
+}
+
+inline bool CatalogoCongelado::validar(const unsigned char* datos, std::size_t bytes) {
+    if (bytes < sizeof(Cabecera)) {
+        return false;
+    }
+    Cabecera c;
+    std::memcpy(&c, datos, sizeof(c));
+    if (std::memcmp(c.magia, "CATALOG1", 8) != 0 || c.marcaOrden != MARCA_ORDEN || c.tamanoTotal > bytes) {
+        return false;
+    }
+    // Los desplazamientos van primero acotados, as las sumas no desbordan.
+    bool secciones = c.numRanuras >= c.numNombres && c.numNombres <= c.numProductos && c.numCubetas > 0 &&
+                     c.desplEntradas >= sizeof(Cabecera) && c.desplEntradas % 8 == 0 && c.desplCubetas % 4 == 0 &&
+                     c.desplRanuras % 4 == 0 && c.desplNombres <= c.tamanoTotal && c.desplRanuras <= c.desplNombres &&
+                     c.desplCubetas <= c.desplRanuras && c.desplEntradas <= c.desplCubetas &&
+                     c.desplEntradas + sizeof(Entrada) * static_cast<uint64_t>(c.numProductos) <= c.desplCubetas &&
+                     c.desplCubetas + sizeof(uint32_t) * static_cast<uint64_t>(c.numCubetas) <= c.desplRanuras &&
+                     c.desplRanuras + sizeof(uint32_t) * static_cast<uint64_t>(c.numRanuras) <= c.desplNombres;
+    if (!secciones) {
+        return false;
+    }
+    // buscar y recorrerOrdenado no comprueban nada: cada nombre tiene que caber en la
+    // zona de nombres y cada ranura apuntar a una entrada. Un recorrido al abrir.
+    const Entrada* entradas = reinterpret_cast<const Entrada*>(datos + c.desplEntradas);
+    const uint64_t zonaNombres = c.tamanoTotal - c.desplNombres;
+    for (uint32_t i = 0; i < c.numProductos; ++i) {
+        if (entradas[i].desplNombre > zonaNombres || entradas[i].longitudNombre > zonaNombres - entradas[i].desplNombre) {
+            return false;
+        }
+    }
+    if (c.numNombres > 0) {
+        const uint32_t* ranuras = reinterpret_cast<const uint32_t*>(datos + c.desplRanuras);
+        for (uint32_t k = 0; k < c.numRanuras; ++k) {
+            if (ranuras[k] >= c.numProductos) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+inline bool CatalogoCongelado::abrir(const std::string& ruta) {
+    liberar();
+#ifndef _WIN32
+    int fd = ::open(ruta.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    std::size_t bytes = static_cast<std::size_t>(info.st_size);
+    void* datos = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // La proyeccin sigue vlida sin el descriptor.
+    if (datos == MAP_FAILED) {
+        return false;
+    }
+    if (!validar(static_cast<const unsigned char*>(datos), bytes)) {
+        munmap(datos, bytes);
+        return false;
+    }
+    mapeo = datos;
+    bytesMapeo = bytes;
+    base = static_cast<const unsigned char*>(datos);
+    return true;
+#else
+    // Sin mmap: se lee el archivo completo en el bloque propio.
+    std::ifstream archivo(ruta.c_str(), std::ios::binary | std::ios::ate);
+    if (!archivo) {
+        return false;
+    }
+    std::size_t bytes = static_cast<std::size_t>(archivo.tellg());
+    memoria.assign((bytes + 7) / 8, 0);
+    archivo.seekg(0);
+    if (bytes == 0 || !archivo.read(reinterpret_cast<char*>(&memoria[0]), static_cast<std::streamsize>(bytes)) ||
+        !validar(reinterpret_cast<const unsigned char*>(&memoria[0]), bytes)) {
+        std::vector<uint64_t>().swap(memoria);
+        return false;
+    }
+    base = reinterpret_cast<const unsigned char*>(&memoria[0]);
+    return true;
+#endif
+}
+
+inline bool CatalogoCongelado::asignarDesplazamientos(const std::vector<uint64_t>& hashes, uint32_t semilla,
+                                                      uint32_t numCubetas, uint32_t numRanuras,
+                                                      std::vector<uint32_t>& desplazamientos,
+                                                      std::vector<uint32_t>& ranuraDeClave) {
+    const uint32_t n = static_cast<uint32_t>(hashes.size());
+    const uint32_t intentosMaximos = 1u << 20;
+
+    // Reparte las claves en cubetas (ordenamiento por conteo).
+    std::vector<uint32_t> inicio(numCubetas + 1, 0);
+    for (uint32_t k = 0; k < n; ++k) {
+        ++inicio[reducir(static_cast<uint32_t>(hashes[k] >> 32), numCubetas) + 1];
+    }
+    for (uint32_t b = 0; b < numCubetas; ++b) {
+        inicio[b + 1] += inicio[b];
+    }
+    std::vector<uint32_t> claves(n);
+    std::vector<uint32_t> siguiente(inicio.begin(), inicio.end() - 1);
+    for (uint32_t k = 0; k < n; ++k) {
+        claves[siguiente[reducir(static_cast<uint32_t>(hashes[k] >> 32), numCubetas)]++] = k;
+    }
+
+    // Las cubetas ms grandes se resuelven primero, cuando hay ms ranuras libres.
+    std::vector<uint32_t> orden(numCubetas);
+    for (uint32_t b = 0; b < numCubetas; ++b) {
+        orden[b] = b;
+    }
+    std::stable_sort(orden.begin(), orden.end(), [&](uint32_t a, uint32_t b) {
+        return inicio[a + 1] - inicio[a] > inicio[b + 1] - inicio[b];
+    });
+
+    std::vector<unsigned char> ocupada(numRanuras, 0);
+    std::vector<uint32_t> candidatas;
+    desplazamientos.assign(numCubetas, 0);
+    ranuraDeClave.assign(n, 0);
+
+    for (uint32_t b : orden) {
+        uint32_t desde = inicio[b];
+        uint32_t hasta = inicio[b + 1];
+        if (desde == hasta) {
+            break; // Solo quedan cubetas vacas.
+        }
+        uint32_t d = 0;
+        for (; d < intentosMaximos; ++d) {
+            candidatas.clear();
+            bool libre = true;
+            for (uint32_t j = desde; j < hasta && libre; ++j) {
+                uint32_t r = ranura(hashes[claves[j]], d, semilla, numRanuras);
+                libre = !ocupada[r] && std::find(candidatas.begin(), candidatas.end(), r) == candidatas.end();
+                candidatas.push_back(r);
+            }
+            if (libre) {
+                break;
+            }
+        }
+        if (d == intentosMaximos) {
+            return false;
+        }
+        desplazamientos[b] = d;
+        for (uint32_t j = desde; j < hasta; ++j) {
+            uint32_t r = candidatas[j - desde];
+            ocupada[r] = 1;
+            ranuraDeClave[claves[j]] = r;
+        }
+    }
+    return true;
+}
+
+inline bool CatalogoCongelado::construir(const std::vector<VistaProducto>& productos) {
+    liberar();
+
+    // Nombres distintos: como la entrada est ordenada, los repetidos son contiguos
+    // y el primero de cada grupo es el ms antiguo.
+    std::vector<uint32_t> primeros;
+    std::vector<uint64_t> hashes;
+    std::size_t bytesNombres = 0;
+    for (std::size_t i = 0; i < productos.size(); ++i) {
+        bytesNombres += productos[i].nombre.longitud;
+        if (i == 0 || !(productos[i].nombre == productos[i - 1].nombre)) {
+            primeros.push_back(static_cast<uint32_t>(i));
+            hashes.push_back(hashNombre(productos[i].nombre.datos, productos[i].nombre.longitud));
+        }
+    }
+
+    const uint32_t numNombres = static_cast<uint32_t>(primeros.size());
+    const uint32_t numRanuras = numNombres + numNombres / 100 + 1;
+    const uint32_t numCubetas = std::max<uint32_t>(1, numNombres / 4);
+    std::vector<uint32_t> desplazamientos;
+    std::vector<uint32_t> ranuraDeClave;
+    uint32_t semilla = 0;
+    while (!asignarDesplazamientos(hashes, semilla, numCubetas, numRanuras, desplazamientos, ranuraDeClave)) {
+        if (++semilla == 8) {
+            return false;
+        }
+    }
+
+    // Distribucin del bloque.
+    Cabecera c;
+    std::memset(&c, 0, sizeof(c));
+    std::memcpy(c.magia, "CATALOG1", 8);
+    c.marcaOrden = MARCA_ORDEN;
+    c.numProductos = static_cast<uint32_t>(productos.size());
+    c.numNombres = numNombres;
+    c.numRanuras = numRanuras;
+    c.numCubetas = numCubetas;
+    c.semilla = semilla;
+    c.desplEntradas = alinear(sizeof(Cabecera));
+    c.desplCubetas = alinear(c.desplEntradas + sizeof(Entrada) * productos.size());
+    c.desplRanuras = alinear(c.desplCubetas + sizeof(uint32_t) * numCubetas);
+    c.desplNombres = alinear(c.desplRanuras + sizeof(uint32_t) * numRanuras);
+    c.tamanoTotal = alinear(c.desplNombres + bytesNombres);
+
+    memoria.assign(c.tamanoTotal / 8, 0);
+    unsigned char* destino = reinterpret_cast<unsigned char*>(&memoria[0]);
+
+    Entrada* e = reinterpret_cast<Entrada*>(destino + c.desplEntradas);
+    char* arena = reinterpret_cast<char*>(destino + c.desplNombres);
+    uint64_t desplNombre = 0;
+    uint64_t hashActual = 0;
+    for (std::size_t i = 0, grupo = 0; i < productos.size(); ++i) {
+        const VistaProducto& p = productos[i];
+        if (grupo < primeros.size() && primeros[grupo] == i) {
+            hashActual = hashes[grupo++];
+        }
+        e[i].hash = hashActual;
+        e[i].desplNombre = desplNombre;
+        e[i].longitudNombre = static_cast<uint32_t>(p.nombre.longitud);
+        e[i].cantidad = p.cantidad;
+        e[i].precio = p.precio;
+        std::memcpy(arena + desplNombre, p.nombre.datos, p.nombre.longitud);
+        desplNombre += p.nombre.longitud;
+
+        c.unidadesTotales += p.cantidad;
+        c.valorTotal += p.precio * p.cantidad;
+        if (i == 0 || p.precio < c.precioMinimo) c.precioMinimo = p.precio;
+        if (i == 0 || p.precio > c.precioMaximo) c.precioMaximo = p.precio;
+    }
+
+    std::copy(desplazamientos.begin(), desplazamientos.end(), reinterpret_cast<uint32_t*>(destino + c.desplCubetas));
+    // Las ranuras libres quedan apuntando a la entrada 0; la comprobacin del nombre las rechaza.
+    uint32_t* r = reinterpret_cast<uint32_t*>(destino + c.desplRanuras);
+    for (uint32_t k = 0; k < numNombres; ++k) {
+        r[ranuraDeClave[k]] = primeros[k];
+    }
+    std::memcpy(destino, &c, sizeof(c));
+
+    base = destino;
+    return true;
+}
+
+#endif
@@ -0,0 +1,286 @@
+#ifndef COMPRESION_BLOQUES_H
+#define COMPRESION_BLOQUES_H
+
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+#include "protocolo_binario.h"
+
+// Compresin de bloques
+// Cdec rpido para bloques de decenas de KiB con el formato de bloque de LZ4: cada
+// secuencia es
+//
+//   token (u8: literales << 4 | coincidencia - 4) | ms literales | literales |
+//   desplazamiento (u16 LE) | ms coincidencia
+//
+// donde "ms" son bytes 255 seguidos de un resto cuando el campo del token vale 15.
+// La ltima secuencia solo tiene literales; las coincidencias terminan al menos 5
+// bytes antes del final y empiezan al menos 12 antes. Un bloque comprimido aqu se
+// descomprime con cualquier implementacin de LZ4 (LZ4_decompress_safe), y al revs.
+//
+// El compresor es voraz con una tabla hash de 4096 posiciones: comprime menos que LZ4
+// de referencia pero tiene su misma forma de trabajo (una bsqueda por posicin, con
+// saltos cada vez ms largos en los datos que no se repiten). El descompresor valida
+// cada longitud y desplazamiento, as que un bloque daado no escribe fuera del destino.
+//
+// resumenXXH64 es el hash XXH64 (mismo resultado que xxhsum -H64); protege los bloques
+// contra daos, no contra quien quiera falsificarlos.
+
+static const std::size_t LZ4_COINCIDENCIA_MINIMA = 4;
+static const std::size_t LZ4_ULTIMOS_LITERALES = 5;
+static const std::size_t LZ4_LIMITE_COINCIDENCIA = 12;
+static const std::size_t LZ4_DESPLAZAMIENTO_MAXIMO = 65535;
+static const unsigned LZ4_BITS_TABLA = 12;
+
+// Bytes que puede ocupar, en el peor caso, un bloque de n bytes comprimido.
+inline std::size_t cotaComprimido(std::size_t n) { return n + n / 255 + 16; }
+
+// Escribe una longitud que no cupo en el token.
+inline char* escribirLongitudLZ4(char* op, std::size_t resto) {
+    while (resto >= 255) {
+        *op++ = static_cast<char>(255);
+        resto -= 255;
+    }
+    *op++ = static_cast<char>(resto);
+    return op;
+}
+
+// Comprime [origen, origen + n) en destino, que debe tener cotaComprimido(n) bytes.
+// Devuelve los bytes escritos.
+inline std::size_t comprimirBloque(const char* origen, std::size_t n, char* destino) {
+    uint32_t tabla[1u << LZ4_BITS_TABLA]; // Posicin + 1 de la ltima vez que se vio cada hash; 0 es vaca.
+    std::memset(tabla, 0, sizeof(tabla));
+    char* op = destino;
+    std::size_t ancla = 0; // Primer literal todava sin escribir.
+
+    if (n > LZ4_LIMITE_COINCIDENCIA) {
+        const std::size_t limite = n - LZ4_LIMITE_COINCIDENCIA; // ltima posicin donde puede empezar una coincidencia.
+        const std::size_t finCoincidencia = n - LZ4_ULTIMOS_LITERALES;
+        std::size_t ip = 0;
+        while (ip <= limite) {
+            uint32_t palabra = leerU32(origen + ip);
+            uint32_t h = (palabra * 2654435761u) >> (32 - LZ4_BITS_TABLA);
+            std::size_t candidato = tabla[h];
+            tabla[h] = static_cast<uint32_t>(ip + 1);
+            if (candidato == 0 || ip + 1 - candidato > LZ4_DESPLAZAMIENTO_MAXIMO ||
+                leerU32(origen + candidato - 1) != palabra) {
+                ip += 1 + ((ip - ancla) >> 6); // Cuanto ms tiempo sin coincidencias, ms largo el salto.
+                continue;
+            }
+            std::size_t referencia = candidato - 1;
+
+            // Extiende la coincidencia hacia atrs sobre los literales pendientes y hacia adelante.
+            while (ip > ancla && referencia > 0 && origen[ip - 1] == origen[referencia - 1]) {
+                --ip;
+                --referencia;
+            }
+            std::size_t longitud = LZ4_COINCIDENCIA_MINIMA;
+            while (ip + longitud + 8 <= finCoincidencia &&
+                   leerU64(origen + referencia + longitud) == leerU64(origen + ip + longitud)) {
+                longitud += 8;
+            }
+            while (ip + longitud < finCoincidencia && origen[referencia + longitud] == origen[ip + longitud]) {
+                ++longitud;
+            }
+
+            std::size_t literales = ip - ancla;
+            char* token = op++;
+            *token = static_cast<char>((literales < 15 ? literales : 15) << 4);
+            if (literales >= 15) {
+                op = escribirLongitudLZ4(op, literales - 15);
+            }
+            std::memcpy(op, origen + ancla, literales);
+            op += literales;
+            escribirU16(op, static_cast<uint16_t>(ip - referencia));
+            op += 2;
+            std::size_t extra = longitud - LZ4_COINCIDENCIA_MINIMA;
+            *token = static_cast<char>(*token | (extra < 15 ? extra : 15));
+            if (extra >= 15) {
+                op = escribirLongitudLZ4(op, extra - 15);
+            }
+
+            ip += longitud;
+            ancla = ip;
+            if (ip - 2 <= limite) {
+                uint32_t anterior = leerU32(origen + ip - 2);
+                tabla[(anterior * 2654435761u) >> (32 - LZ4_BITS_TABLA)] = static_cast<uint32_t>(ip - 2 + 1);
+            }
+        }
+    }
+
+    // ltima secuencia: el resto como literales.
+    std::size_t literales = n - ancla;
+    *op++ = static_cast<char>((literales < 15 ? literales : 15) << 4);
+    if (literales >= 15) {
+        op = escribirLongitudLZ4(op, literales - 15);
+    }
+    std::memcpy(op, origen + ancla, literales);
+    op += literales;
+    return static_cast<std::size_t>(op - destino);
+}
+
+// Lee una longitud que no cupo en el token; false si el bloque se termina antes.
+inline bool leerLongitudLZ4(const unsigned char*& ip, const unsigned char* fin, std::size_t& longitud) {
+    unsigned char byte;
+    do {
+        if (ip >= fin) {
+            return false;
+        }
+        byte = *ip++;
+        longitud += byte;
+    } while (byte == 255);
+    return true;
+}
+
+// Descomprime un bloque en destino, que tiene capacidad bytes. Devuelve false si el
+// bloque est mal formado o no cabe; si no, escritos recibe los bytes descomprimidos.
+inline bool descomprimirBloque(const char* origen, std::size_t n, char* destino, std::size_t capacidad,
+                               std::size_t& escritos) {
+    const unsigned char* ip = reinterpret_cast<const unsigned char*>(origen);
+    const unsigned char* fin = ip + n;
+    char* op = destino;
+    char* limite = destino + capacidad;
+
+    for (;;) {
+        if (ip >= fin) {
+            return false;
+        }
+        unsigned token = *ip++;
+        std::size_t literales = token >> 4;
+        if (literales < 15 && fin - ip >= 16 + 2 && limite - op >= 16) {
+            // Pocos literales lejos de los bordes (el caso comn): se copian 16 de una vez,
+            // sin llamar a memcpy. Detrs quedan bytes, as que no es la ltima secuencia.
+            std::memcpy(op, ip, 16);
+            op += literales;
+            ip += literales;
+        } else {
+            if (literales == 15 && !leerLongitudLZ4(ip, fin, literales)) {
+                return false;
+            }
+            if (literales > static_cast<std::size_t>(fin - ip) || literales > static_cast<std::size_t>(limite - op)) {
+                return false;
+            }
+            std::memcpy(op, ip, literales);
+            op += literales;
+            ip += literales;
+            if (ip == fin) {
+                break; // La ltima secuencia no tiene coincidencia.
+            }
+            if (fin - ip < 2) {
+                return false;
+            }
+        }
+
+        std::size_t desplazamiento = static_cast<std::size_t>(ip[0] | (ip[1] << 8));
+        ip += 2;
+        std::size_t longitud = token & 15;
+        if (longitud == 15 && !leerLongitudLZ4(ip, fin, longitud)) {
+            return false;
+        }
+        longitud += LZ4_COINCIDENCIA_MINIMA;
+        if (desplazamiento == 0 || desplazamiento > static_cast<std::size_t>(op - destino) ||
+            longitud > static_cast<std::size_t>(limite - op)) {
+            return false;
+        }
+
+        const char* referencia = op - desplazamiento;
+        char* finCopia = op + longitud;
+        if (desplazamiento >= 8 && longitud <= 16 && limite - op >= 16) {
+            std::memcpy(op, referencia, 8); // El caso comn: dos tramos fijos.
+            std::memcpy(op + 8, referencia + 8, 8);
+        } else if (desplazamiento >= longitud && longitud > 32) {
+            std::memcpy(op, referencia, longitud); // Larga y sin solaparse.
+        } else if (desplazamiento >= 8 && limite - finCopia >= 8) {
+            // De a 8 bytes, aunque se solape con lo que escribe: cada tramo ya est
+            // escrito. El ltimo tramo puede pasarse del final de la coincidencia; lo que
+            // sobra lo pisa la secuencia siguiente.
+            do {
+                std::memcpy(op, referencia, 8);
+                op += 8;
+                referencia += 8;
+            } while (op < finCopia);
+        } else {
+            while (op < finCopia) {
+                *op++ = *referencia++; // Patrn corto que se repite, o el final del destino.
+            }
+        }
+        op = finCopia;
+    }
+    escritos = static_cast<std::size_t>(op - destino);
+    return true;
+}
+
+// XXH64
+
+static const uint64_t XXH_PRIMO1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t XXH_PRIMO2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t XXH_PRIMO3 = 0x165667B19E3779F9ULL;
+static const uint64_t XXH_PRIMO4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t XXH_PRIMO5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t rotarIzquierda(uint64_t valor, unsigned bits) { return (valor << bits) | (valor >> (64 - bits)); }
+
+inline uint64_t rondaXXH64(uint64_t acumulado, uint64_t entrada) {
+    acumulado += entrada * XXH_PRIMO2;
+    return rotarIzquierda(acumulado, 31) * XXH_PRIMO1;
+}
+
+inline uint64_t mezclarXXH64(uint64_t h, uint64_t acumulado) {
+    h ^= rondaXXH64(0, acumulado);
+    return h * XXH_PRIMO1 + XXH_PRIMO4;
+}
+
+inline uint64_t resumenXXH64(const char* datos, std::size_t n, uint64_t semilla) {
+    const char* p = datos;
+    const char* fin = datos + n;
+    uint64_t h;
+
+    if (n >= 32) {
+        // Cuatro acumuladores independientes: el procesador los avanza en paralelo.
+        uint64_t v1 = semilla + XXH_PRIMO1 + XXH_PRIMO2;
+        uint64_t v2 = semilla + XXH_PRIMO2;
+        uint64_t v3 = semilla;
+        uint64_t v4 = semilla - XXH_PRIMO1;
+        do {
+            v1 = rondaXXH64(v1, leerU64(p));
+            v2 = rondaXXH64(v2, leerU64(p + 8));
+            v3 = rondaXXH64(v3, leerU64(p + 16));
+            v4 = rondaXXH64(v4, leerU64(p + 24));
+            p += 32;
+        } while (fin - p >= 32);
+        h = rotarIzquierda(v1, 1) + rotarIzquierda(v2, 7) + rotarIzquierda(v3, 12) + rotarIzquierda(v4, 18);
+        h = mezclarXXH64(h, v1);
+        h = mezclarXXH64(h, v2);
+        h = mezclarXXH64(h, v3);
+        h = mezclarXXH64(h, v4);
+    } else {
+        h = semilla + XXH_PRIMO5;
+    }
+    h += static_cast<uint64_t>(n);
+
+    while (fin - p >= 8) {
+        h ^= rondaXXH64(0, leerU64(p));
+        h = rotarIzquierda(h, 27) * XXH_PRIMO1 + XXH_PRIMO4;
+        p += 8;
+    }
+    if (fin - p >= 4) {
+        h ^= static_cast<uint64_t>(leerU32(p)) * XXH_PRIMO1;
+        h = rotarIzquierda(h, 23) * XXH_PRIMO2 + XXH_PRIMO3;
+        p += 4;
+    }
+    while (p < fin) {
+        h ^= static_cast<uint64_t>(static_cast<unsigned char>(*p)) * XXH_PRIMO5;
+        h = rotarIzquierda(h, 11) * XXH_PRIMO1;
+        ++p;
+    }
+
+    h ^= h >> 33;
+    h *= XXH_PRIMO2;
+    h ^= h >> 29;
+    h *= XXH_PRIMO3;
+    h ^= h >> 32;
+    return h;
+}
+
+#endif
@@ -0,0 +1,49 @@
+// Consulta de un catlogo guardado
+// Proyecta con mmap una imagen escrita por SistemaGestion::guardarCatalogo y responde
+// consultas en el lugar, sin reconstruir el inventario. Pensado para los procesos
+// de reportes que comparten el mismo archivo.
+//
+// Uso: consulta_catalogo <archivo> [nombre...]
+//      Sin nombres, muestra el resumen y lista el catlogo completo.
+
+#include <iostream>
+#include <chrono>
+#include <string>
+
+#include "catalogo_congelado.h"
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Uso: " << argv[0] << " <archivo> [nombre...]" << std::endl;
+        return 2;
+    }
+
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+    CatalogoCongelado catalogo;
+    if (!catalogo.abrir(argv[1])) {
+        std::cerr << "No se pudo abrir el catlogo " << argv[1] << std::endl;
+        return 1;
+    }
+    double microsegundos = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - inicio).count();
+
+    std::cout << "Catlogo: " << catalogo.tamano() << " productos (" << catalogo.nombresDistintos()
+              << " nombres), " << catalogo.unidadesTotales() << " unidades, valor total: " << catalogo.valorTotal()
+              << ", " << catalogo.bytes() << " bytes, abierto en " << microsegundos << " us" << std::endl;
+
+    if (argc == 2) {
+        catalogo.recorrerOrdenado([](const VistaProducto& producto) {
+            std::cout << "Producto: " << producto.nombre << ", Precio: " << producto.precio << ", Cantidad: " << producto.cantidad << std::endl;
+        });
+        return 0;
+    }
+
+    for (int i = 2; i < argc; ++i) {
+        VistaProducto producto;
+        if (catalogo.buscar(std::string(argv[i]), producto)) {
+            std::cout << "Producto: " << producto.nombre << ", Precio: " << producto.precio << ", Cantidad: " << producto.cantidad << std::endl;
+        } else {
+            std::cout << "Producto no encontrado." << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+#ifndef CONTADORES_HILO_H
+#define CONTADORES_HILO_H
+
+// Contadores por hilo
+// Cada hilo suma en su propio bloque de contadores; nadie ms escribe en l, as que
+// sumar es una lectura y una escritura relajadas, sin instrucciones atmicas de
+// lectura-modificacin ni lneas de cach compartidas. Los totales se calculan al
+// pedirlos, recorriendo los bloques de todos los hilos (tambin los que terminaron).
+//
+// Etiqueta distingue familias de contadores independientes con el mismo N.
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+template <class Etiqueta, int N>
+class ContadoresPorHilo {
+public:
+    static void sumar(int contador, uint64_t cantidad = 1) {
+        std::atomic<uint64_t>& valor = bloque().valores[contador];
+        valor.store(valor.load(std::memory_order_relaxed) + cantidad, std::memory_order_relaxed);
+    }
+
+    // Suma de todos los hilos; mientras otros hilos cuentan es una foto aproximada.
+    static uint64_t total(int contador) {
+        Registro& registro = registroGlobal();
+        std::lock_guard<std::mutex> guardia(registro.cerrojo);
+        uint64_t suma = 0;
+        for (const auto& b : registro.bloques) {
+            suma += b->valores[contador].load(std::memory_order_relaxed);
+        }
+        return suma;
+    }
+
+    static void totales(uint64_t (&sumas)[N]) {
+        Registro& registro = registroGlobal();
+        std::lock_guard<std::mutex> guardia(registro.cerrojo);
+        for (int i = 0; i < N; ++i) {
+            sumas[i] = 0;
+        }
+        for (const auto& b : registro.bloques) {
+            for (int i = 0; i < N; ++i) {
+                sumas[i] += b->valores[i].load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Pone a cero los bloques; solo es exacto si ningn hilo est contando.
+    static void reiniciar() {
+        Registro& registro = registroGlobal();
+        std::lock_guard<std::mutex> guardia(registro.cerrojo);
+        for (const auto& b : registro.bloques) {
+            for (int i = 0; i < N; ++i) {
+                b->valores[i].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    static const int LINEA_CACHE = 64;
+
+    // El relleno a ambos lados separa los contadores de cualquier otro dato en el
+    // montn, aunque new no respete la alineacin a lnea de cach.
+    struct Bloque {
+        Bloque() {
+            for (int i = 0; i < N; ++i) {
+                valores[i].store(0, std::memory_order_relaxed);
+            }
+        }
+        char rellenoAntes[LINEA_CACHE];
+        std::atomic<uint64_t> valores[N];
+        char rellenoDespues[LINEA_CACHE];
+    };
+
+    struct Registro {
+        std::mutex cerrojo;
+        std::vector<std::unique_ptr<Bloque> > bloques;
+    };
+
+    static Registro& registroGlobal() {
+        static Registro registro;
+        return registro;
+    }
+
+    // El primer uso de cada hilo registra su bloque bajo el cerrojo; despus no hay cerrojos.
+    static Bloque& bloque() {
+        static thread_local Bloque* propio = nullptr;
+        if (!propio) {
+            Registro& registro = registroGlobal();
+            std::lock_guard<std::mutex> guardia(registro.cerrojo);
+            registro.bloques.emplace_back(new Bloque());
+            propio = registro.bloques.back().get();
+        }
+        return *propio;
+    }
+};
+
+#endif
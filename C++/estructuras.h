@@ -0,0 +1,111 @@
+#ifndef ESTRUCTURAS_H
+#define ESTRUCTURAS_H
+
+#include <string>
+#include <ostream>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+
+// Estructura para un producto
+// Representa los atributos bsicos de un producto en el inventario.
+struct Producto {
+    std::string nombre; // Nombre del producto.
+    double precio;      // Precio del producto.
+    int cantidad;       // Cantidad disponible en inventario.
+};
+
+// Estructura para una solicitud de compra
+// Almacena informacin sobre una solicitud registrada por algn cliente.
+struct Solicitud {
+    int id;             // Identificador nico de la solicitud.
+    std::string descripcion; // Descripcin de la solicitud.
+};
+
+// Estructura para un cliente
+// Representa a un cliente que est en espera.
+struct Cliente {
+    int id;             // Identificador nico del cliente.
+    std::string nombre; // Nombre del cliente.
+};
+
+// Historial de cambios en el inventario
+// Permite llevar un registro de los cambios realizados, til para deshacer acciones.
+struct Cambio {
+    std::string tipo;   // Tipo de cambio: "agregar" o "eliminar".
+    Producto producto;  // Producto afectado por el cambio.
+    uint32_t consultas; // En "eliminar", las consultas que llevaba el nombre (autocompletado).
+};
+
+// Resultado de revertir el ltimo cambio del historial.
+enum ResultadoDeshacer {
+    NadaQueDeshacer,     // El historial estaba vaco.
+    AgregadoEliminado,   // Se quit un producto que se haba agregado.
+    AgregadoAusente,     // El producto agregado ya no estaba en el inventario.
+    EliminadoRestaurado  // Se volvi a insertar un producto eliminado.
+};
+
+// Vista de un nombre que no es duea de sus bytes (equivalente a std::string_view).
+struct VistaNombre {
+    const char* datos;
+    std::size_t longitud;
+};
+
+inline VistaNombre vistaDe(const std::string& texto) {
+    VistaNombre vista = {texto.data(), texto.size()};
+    return vista;
+}
+
+inline bool operator==(const VistaNombre& a, const VistaNombre& b) {
+    return a.longitud == b.longitud && std::memcmp(a.datos, b.datos, a.longitud) == 0;
+}
+
+// Mismo orden que std::string: byte a byte sin signo y, si uno es prefijo del otro, el ms corto.
+inline bool operator<(const VistaNombre& a, const VistaNombre& b) {
+    int orden = std::memcmp(a.datos, b.datos, std::min(a.longitud, b.longitud));
+    return orden != 0 ? orden < 0 : a.longitud < b.longitud;
+}
+
+inline std::ostream& operator<<(std::ostream& os, const VistaNombre& vista) {
+    return os.write(vista.datos, vista.longitud);
+}
+
+// Vista de solo lectura de un producto.
+// Los almacenes que no guardan un Producto contiguo (por ejemplo SoA o el catlogo
+// congelado) la usan para entregar los datos sin copiar el nombre.
+struct VistaProducto {
+    VistaNombre nombre; // Nombre del producto (apunta al almacn).
+    double precio;             // Precio del producto.
+    int cantidad;              // Cantidad disponible en inventario.
+};
+
+// Resumen de un inventario: productos, unidades y valor total (precio x cantidad).
+struct ValoracionInventario {
+    std::size_t productos;
+    long long unidades;
+    double valor;
+};
+
+// Funcin hash FNV-1a de 64 bits sobre el nombre de un producto.
+// Termina con el mezclador de MurmurHash3 para que todos los bits dependan de todo
+// el nombre; FNV sola reparte mal los bits altos en nombres cortos y parecidos.
+inline uint64_t hashNombre(const char* datos, std::size_t longitud) {
+    uint64_t h = 1469598103934665603ULL;
+    for (std::size_t i = 0; i < longitud; ++i) {
+        h ^= static_cast<unsigned char>(datos[i]);
+        h *= 1099511628211ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+inline uint64_t hashNombre(const std::string& nombre) {
+    return hashNombre(nombre.data(), nombre.size());
+}
+
+#endif
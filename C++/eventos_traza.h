@@ -0,0 +1,189 @@
+#ifndef EVENTOS_TRAZA_H
+#define EVENTOS_TRAZA_H
+
+// Eventos de traza en formato Chrome Trace Event (chrome://tracing, Perfetto)
+// EVENTO_TRAZA("fase") marca el resto del bloque como un evento con nombre: al salir
+// del bloque se guarda el inicio y la duracin en el bfer del hilo actual. Cada hilo
+// escribe solo en su bfer, sin cerrojos; el volcado lee la parte ya publicada.
+//
+// Solo existe si se compila con -DEVENTOS_TRAZA (make DEFINES=-DEVENTOS_TRAZA). Sin
+// esa opcin la macro no genera cdigo y el volcado informa que no hay eventos.
+//
+// Los nombres deben ser literales (o cadenas que vivan hasta el volcado): se guarda
+// el puntero, no una copia. Un bfer lleno descarta los eventos nuevos y los cuenta.
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#ifdef EVENTOS_TRAZA
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct EventoCompleto {
+    const char* nombre;
+    uint64_t inicio;   // Nanosegundos desde el origen del registro.
+    uint64_t duracion; // Nanosegundos.
+};
+
+// Bfer de un hilo: el hilo dueo escribe y publica la cantidad; el volcado solo lee.
+class BufferEventosHilo {
+public:
+    static const std::size_t CAPACIDAD = 1 << 20; // 24 MiB reservados; el sistema solo aporta las pginas usadas.
+
+    explicit BufferEventosHilo(int hilo) : hilo(hilo), cantidad(0), descartados(0), eventos(new EventoCompleto[CAPACIDAD]) {}
+
+    void agregar(const char* nombre, uint64_t inicio, uint64_t duracion) {
+        std::size_t n = cantidad.load(std::memory_order_relaxed);
+        if (n == CAPACIDAD) {
+            descartados.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        EventoCompleto& evento = eventos[n];
+        evento.nombre = nombre;
+        evento.inicio = inicio;
+        evento.duracion = duracion;
+        cantidad.store(n + 1, std::memory_order_release);
+    }
+
+    int hilo;
+    std::atomic<std::size_t> cantidad;
+    std::atomic<uint64_t> descartados;
+    std::unique_ptr<EventoCompleto[]> eventos;
+};
+
+// Registro global de bferes. Los bferes viven hasta el final del programa, as que
+// los eventos de un hilo que ya termin tambin se vuelcan.
+class RegistroEventos {
+public:
+    typedef std::chrono::steady_clock Reloj;
+
+    static RegistroEventos& global() {
+        static RegistroEventos registro;
+        return registro;
+    }
+
+    uint64_t ahora() const {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Reloj::now() - origen).count());
+    }
+
+    // Bfer del hilo que llama; el primer uso de cada hilo toma el cerrojo una vez.
+    BufferEventosHilo& bufferDelHilo() {
+        static thread_local BufferEventosHilo* propio = nullptr;
+        if (!propio) {
+            std::lock_guard<std::mutex> guardia(cerrojo);
+            buferes.emplace_back(new BufferEventosHilo(static_cast<int>(buferes.size()) + 1));
+            propio = buferes.back().get();
+        }
+        return *propio;
+    }
+
+    // Escribe los eventos publicados en JSON; devuelve cuntos se escribieron.
+    uint64_t volcar(std::ostream& salida, uint64_t& descartados) {
+        std::lock_guard<std::mutex> guardia(cerrojo);
+        uint64_t escritos = 0;
+        descartados = 0;
+        char linea[256];
+        salida << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        bool primero = true;
+        for (const auto& buffer : buferes) {
+            std::snprintf(linea, sizeof(linea), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"hilo %d\"}}",
+                          primero ? "" : ",\n", buffer->hilo, buffer->hilo);
+            salida << linea;
+            primero = false;
+            std::size_t n = buffer->cantidad.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < n; ++i) {
+                const EventoCompleto& evento = buffer->eventos[i];
+                std::snprintf(linea, sizeof(linea),
+                              ",\n{\"name\":\"%s\",\"cat\":\"sistema\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                              evento.nombre, evento.inicio / 1e3, evento.duracion / 1e3, buffer->hilo);
+                salida << linea;
+            }
+            escritos += n;
+            descartados += buffer->descartados.load(std::memory_order_relaxed);
+        }
+        salida << "\n]}\n";
+        return escritos;
+    }
+
+private:
+    RegistroEventos() : origen(Reloj::now()) {}
+
+    Reloj::time_point origen;
+    std::mutex cerrojo; // Protege la lista de bferes, no los eventos.
+    std::vector<std::unique_ptr<BufferEventosHilo> > buferes;
+};
+
+// Evento con alcance: empieza al construirse y se guarda al destruirse.
+class AmbitoEvento {
+public:
+    explicit AmbitoEvento(const char* nombre) : nombre(nombre), inicio(RegistroEventos::global().ahora()) {}
+    ~AmbitoEvento() {
+        RegistroEventos& registro = RegistroEventos::global();
+        uint64_t fin = registro.ahora();
+        registro.bufferDelHilo().agregar(nombre, inicio, fin - inicio);
+    }
+
+    AmbitoEvento(const AmbitoEvento&) = delete;
+    AmbitoEvento& operator=(const AmbitoEvento&) = delete;
+
+private:
+    const char* nombre;
+    uint64_t inicio;
+};
+
+#define EVENTO_TRAZA_UNIR2(a, b) a##b
+#define EVENTO_TRAZA_UNIR(a, b) EVENTO_TRAZA_UNIR2(a, b)
+#define EVENTO_TRAZA(nombre) AmbitoEvento EVENTO_TRAZA_UNIR(eventoTraza, __LINE__)(nombre)
+
+#else
+
+#define EVENTO_TRAZA(nombre) ((void)0)
+
+#endif
+
+// Guarda los eventos registrados hasta ahora en un archivo JSON e informa por errores.
+// Sin -DEVENTOS_TRAZA solo avisa que esta versin no los registra.
+inline bool guardarEventosTraza(const std::string& ruta, std::ostream& errores) {
+#ifdef EVENTOS_TRAZA
+    std::ofstream archivo(ruta.c_str());
+    if (!archivo) {
+        errores << "No se pudo crear " << ruta << std::endl;
+        return false;
+    }
+    uint64_t descartados = 0;
+    uint64_t escritos = RegistroEventos::global().volcar(archivo, descartados);
+    errores << escritos << " eventos de traza guardados en " << ruta;
+    if (descartados > 0) {
+        errores << " (" << descartados << " descartados por bferes llenos)";
+    }
+    errores << std::endl;
+    return static_cast<bool>(archivo);
+#else
+    errores << "Esta versin se compil sin eventos de traza; recompile con make DEFINES=-DEVENTOS_TRAZA para guardar "
+            << ruta << std::endl;
+    return false;
+#endif
+}
+
+// Guarda los eventos al salir del alcance (al terminar main por cualquier camino).
+class VolcadoEventosTraza {
+public:
+    explicit VolcadoEventosTraza(const std::string& ruta) : ruta(ruta) {}
+    ~VolcadoEventosTraza() {
+        if (!ruta.empty()) {
+            guardarEventosTraza(ruta, std::cerr);
+        }
+    }
+
+private:
+    std::string ruta;
+};
+
+#endif
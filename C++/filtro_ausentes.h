@@ -0,0 +1,174 @@
+#ifndef FILTRO_AUSENTES_H
+#define FILTRO_AUSENTES_H
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <stdint.h>
+
+#include "estructuras.h"
+#include "memoria_estructuras.h"
+
+// Filtro de nombres ausentes
+// Filtro de Bloom por bloques, con contadores, delante del inventario: si dice que un
+// nombre no est, no est, y la consulta termina sin tocar el almacn (que la lista y
+// SoA recorren entero). Cada nombre cae en un bloque de 64 bytes, una lnea de cach,
+// con 128 contadores de 4 bits, y marca 4 de ellos con 7 bits del hash cada uno: decir
+// "no est" lee una sola lnea.
+//
+// Con contadores en lugar de bits se pueden quitar nombres: quitar resta lo que agregar
+// sum. Un contador que llega a 15 se queda ah, porque ya no se sabe cuntos nombres lo
+// marcan; el filtro pierde algo de precisin pero nunca descarta un nombre que est.
+//
+// Cabe NOMBRES_POR_BLOQUE_FILTRO nombres por bloque; lleno, agregar se niega y el dueo
+// lo redimensiona para el doble de nombres y vuelve a agregarlos todos. Entre 5 y 10
+// nombres por bloque, la probabilidad de un falso positivo va de ~0.05% a ~0.6%.
+
+static const std::size_t NOMBRES_POR_BLOQUE_FILTRO = 10;
+
+// Resumen del filtro para los reportes.
+struct EstadoFiltroAusentes {
+    EstadoFiltroAusentes() : nombres(0), bytes(0), consultas(0), descartadas(0), falsosPositivos(0), tasaEstimada(0) {}
+
+    std::size_t nombres;
+    int64_t bytes;
+    uint64_t consultas;       // Nombres consultados al filtro.
+    uint64_t descartadas;     // Consultas que el filtro contest solo: el nombre no estaba.
+    uint64_t falsosPositivos; // El filtro dej pasar un nombre que tampoco estaba en el almacn.
+    double tasaEstimada;      // Probabilidad de falso positivo segn el llenado de los bloques.
+
+    // Fraccin de los nombres ausentes consultados que el filtro no descart.
+    double tasaObservada() const {
+        uint64_t ausentes = descartadas + falsosPositivos;
+        return ausentes ? static_cast<double>(falsosPositivos) / ausentes : 0.0;
+    }
+};
+
+class FiltroAusentes {
+public:
+    explicit FiltroAusentes(std::size_t capacidad = 0) : consultas(0), descartadas(0), falsosPositivos(0) {
+        dimensionar(capacidad);
+    }
+
+    // Vaca el filtro y le da lugar para capacidad nombres. Las cuentas de consultas siguen.
+    void dimensionar(std::size_t capacidad) {
+        bloques = std::max<std::size_t>(1, (capacidad + NOMBRES_POR_BLOQUE_FILTRO - 1) / NOMBRES_POR_BLOQUE_FILTRO);
+        palabras.assign(bloques * PALABRAS_BLOQUE + PALABRAS_BLOQUE - 1, 0);
+        palabras.shrink_to_fit();
+        // El vector solo garantiza la alineacin de uint64_t: se salta hasta la primera lnea.
+        uintptr_t direccion = reinterpret_cast<uintptr_t>(palabras.data()) / sizeof(uint64_t);
+        inicio = (PALABRAS_BLOQUE - direccion % PALABRAS_BLOQUE) % PALABRAS_BLOQUE;
+        nombres = 0;
+    }
+
+    // Devuelve false, sin agregarlo, si el filtro est lleno.
+    bool agregar(const VistaNombre& nombre) {
+        if (nombres >= bloques * NOMBRES_POR_BLOQUE_FILTRO) {
+            return false;
+        }
+        ++nombres;
+        uint64_t hash = hashNombre(nombre.datos, nombre.longitud);
+        uint64_t* bloque = bloqueDe(hash);
+        uint32_t bits = static_cast<uint32_t>(hash);
+        for (int i = 0; i < CONTADORES_NOMBRE; ++i, bits >>= 7) {
+            unsigned contador = bits & 127;
+            unsigned desplazamiento = (contador & 15) * 4;
+            if (((bloque[contador >> 4] >> desplazamiento) & 15) != 15) {
+                bloque[contador >> 4] += uint64_t(1) << desplazamiento;
+            }
+        }
+        return true;
+    }
+
+    // Quita un nombre que se agreg antes.
+    void quitar(const VistaNombre& nombre) {
+        if (nombres == 0) {
+            return;
+        }
+        --nombres;
+        uint64_t hash = hashNombre(nombre.datos, nombre.longitud);
+        uint64_t* bloque = bloqueDe(hash);
+        uint32_t bits = static_cast<uint32_t>(hash);
+        for (int i = 0; i < CONTADORES_NOMBRE; ++i, bits >>= 7) {
+            unsigned contador = bits & 127;
+            unsigned desplazamiento = (contador & 15) * 4;
+            uint64_t valor = (bloque[contador >> 4] >> desplazamiento) & 15;
+            if (valor != 15 && valor != 0) {
+                bloque[contador >> 4] -= uint64_t(1) << desplazamiento;
+            }
+        }
+    }
+
+    // false si el nombre seguro no est; true si puede estar (hay que buscarlo).
+    bool puedeEstar(const VistaNombre& nombre) {
+        ++consultas;
+        uint64_t hash = hashNombre(nombre.datos, nombre.longitud);
+        const uint64_t* bloque = bloqueDe(hash);
+        uint32_t bits = static_cast<uint32_t>(hash);
+        bool marcado = true;
+        for (int i = 0; i < CONTADORES_NOMBRE; ++i, bits >>= 7) {
+            unsigned contador = bits & 127;
+            marcado &= ((bloque[contador >> 4] >> ((contador & 15) * 4)) & 15) != 0;
+        }
+        descartadas += !marcado;
+        return marcado;
+    }
+
+    // El dueo avisa que un nombre que pas el filtro no estaba en el almacn.
+    void anotarFalsoPositivo() { ++falsosPositivos; }
+
+    // Recorre los bloques: para los reportes, no para cada operacin.
+    EstadoFiltroAusentes estado() const {
+        EstadoFiltroAusentes estado;
+        estado.nombres = nombres;
+        estado.bytes = memoria().total();
+        estado.consultas = consultas;
+        estado.descartadas = descartadas;
+        estado.falsosPositivos = falsosPositivos;
+        // Un nombre ausente pasa si sus 4 contadores estn marcados: (marcados / 128)^4
+        // en su bloque, promediado entre bloques.
+        double suma = 0;
+        for (std::size_t b = 0; b < bloques; ++b) {
+            const uint64_t* bloque = palabras.data() + inicio + b * PALABRAS_BLOQUE;
+            int marcados = 0;
+            for (std::size_t p = 0; p < PALABRAS_BLOQUE; ++p) {
+                for (unsigned desplazamiento = 0; desplazamiento < 64; desplazamiento += 4) {
+                    marcados += ((bloque[p] >> desplazamiento) & 15) != 0;
+                }
+            }
+            double llenado = marcados / 128.0;
+            suma += llenado * llenado * llenado * llenado;
+        }
+        estado.tasaEstimada = suma / bloques;
+        return estado;
+    }
+
+    MemoriaEstructura memoria() const {
+        MemoriaEstructura memoria;
+        memoria.elementos = static_cast<int64_t>(nombres);
+        memoria += bloqueMonton(palabras.capacity() * sizeof(uint64_t));
+        return memoria;
+    }
+
+private:
+    static const std::size_t PALABRAS_BLOQUE = 8; // 64 bytes: 128 contadores de 4 bits.
+    static const int CONTADORES_NOMBRE = 4;       // 7 bits del hash cada uno.
+
+    // Los 32 bits altos del hash eligen el bloque; los bajos, los contadores.
+    uint64_t* bloqueDe(uint64_t hash) {
+        return palabras.data() + inicio + ((hash >> 32) * bloques >> 32) * PALABRAS_BLOQUE;
+    }
+    const uint64_t* bloqueDe(uint64_t hash) const {
+        return palabras.data() + inicio + ((hash >> 32) * bloques >> 32) * PALABRAS_BLOQUE;
+    }
+
+    std::vector<uint64_t> palabras;
+    std::size_t inicio;  // Palabra donde empieza el primer bloque, alineado a 64 bytes.
+    std::size_t bloques;
+    std::size_t nombres;
+    uint64_t consultas;
+    uint64_t descartadas;
+    uint64_t falsosPositivos;
+};
+
+#endif
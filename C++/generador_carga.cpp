@@ -0,0 +1,321 @@
+// Generador de cargas sintticas
+// Produce una traza (traza.h) con una mezcla de operaciones parecida a la de una tienda
+// real, en lugar de operaciones uniformes al azar:
+//   - consultarProducto con popularidad Zipf: pocos productos reciben casi todas las consultas;
+//   - clientes que llegan en rfagas segn un proceso de Poisson y se atienden a otro ritmo;
+//   - solicitudes que se registran y procesan con sus propios ritmos de Poisson;
+//   - altas y bajas de productos (rotacin del catlogo) y deshacer con frecuencia configurable.
+// La traza empieza con el alta de todo el catlogo en el instante 0.
+//
+// Uso: generador_carga [opciones] <salida>
+//   --operaciones N   operaciones despus de la carga inicial     (1000000)
+//   --productos P     tamao del catlogo                          (10000)
+//   --zipf s          exponente de la distribucin Zipf            (0.99)
+//   --tasa R          operaciones de inventario por segundo        (50000)
+//   --altas A         % de las operaciones de inventario que son altas (2)
+//   --bajas B         % que son bajas                              (2)
+//   --deshacer D      % que son deshacer                           (0.5)
+//   --listados L      % que son listar productos                   (0.01)
+//   --llegadas Y      rfagas de clientes por segundo              (200)
+//   --rafaga M        clientes por rfaga, en promedio             (5)
+//   --atencion Z      clientes atendidos por segundo               (1000)
+//   --solicitudes S   solicitudes registradas y procesadas por segundo (500)
+//   --semilla X                                                    (1)
+//   --texto           escribe un guion de texto para proyecto_final --guion
+//
+// Ejemplo: generador_carga --productos 100000 carga.traza && bench_operaciones --traza carga.traza
+
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+#include "traza.h"
+
+struct Parametros {
+    long operaciones = 1000000;
+    long productos = 10000;
+    double zipf = 0.99;
+    double tasa = 50000;
+    double altas = 2, bajas = 2, deshacer = 0.5, listados = 0.01;
+    double llegadas = 200, rafaga = 5, atencion = 1000, solicitudes = 500;
+    unsigned semilla = 1;
+    bool texto = false;
+    std::string salida;
+};
+
+// Muestrea rangos 0..n-1 con probabilidad proporcional a 1 / (rango + 1)^s.
+class DistribucionZipf {
+public:
+    DistribucionZipf(long n, double s) : acumulada(n) {
+        double suma = 0;
+        for (long i = 0; i < n; ++i) {
+            suma += 1.0 / std::pow(static_cast<double>(i + 1), s);
+            acumulada[i] = suma;
+        }
+        for (double& valor : acumulada) {
+            valor /= suma;
+        }
+    }
+
+    template <class Azar>
+    long operator()(Azar& azar) {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(azar);
+        long rango = static_cast<long>(std::lower_bound(acumulada.begin(), acumulada.end(), u) - acumulada.begin());
+        return std::min(rango, static_cast<long>(acumulada.size()) - 1);
+    }
+
+private:
+    std::vector<double> acumulada;
+};
+
+// Productos presentes y ausentes, para que las bajas borren productos que existen y las
+// altas repongan los que faltan. Refleja el historial del sistema para seguir a deshacer.
+class Catalogo {
+public:
+    explicit Catalogo(long productos) : posicion(productos) {
+        for (long i = 0; i < productos; ++i) {
+            posicion[i] = i;
+            presentes.push_back(i);
+        }
+    }
+
+    template <class Azar>
+    long quitarAlAzar(Azar& azar) {
+        if (presentes.empty()) return -1;
+        long producto = presentes[azar() % presentes.size()];
+        mover(producto, presentes, ausentes);
+        historial.push_back(-1 - producto);
+        return producto;
+    }
+
+    template <class Azar>
+    long reponerAlAzar(Azar& azar) {
+        if (ausentes.empty()) return -1;
+        long producto = ausentes[azar() % ausentes.size()];
+        mover(producto, ausentes, presentes);
+        historial.push_back(producto);
+        return producto;
+    }
+
+    // Registra el alta inicial de un producto.
+    void alta(long producto) { historial.push_back(producto); }
+
+    // Deshace el ltimo cambio: un alta vuelve a ausentes, una baja a presentes.
+    void deshacer() {
+        if (historial.empty()) return;
+        long cambio = historial.back();
+        historial.pop_back();
+        if (cambio >= 0) {
+            mover(cambio, presentes, ausentes);
+        } else {
+            mover(-1 - cambio, ausentes, presentes);
+        }
+    }
+
+private:
+    void mover(long producto, std::vector<long>& origen, std::vector<long>& destino) {
+        long indice = posicion[producto];
+        origen[indice] = origen.back();
+        posicion[origen[indice]] = indice;
+        origen.pop_back();
+        posicion[producto] = static_cast<long>(destino.size());
+        destino.push_back(producto);
+    }
+
+    std::vector<long> posicion; // ndice del producto dentro de presentes o ausentes.
+    std::vector<long> presentes;
+    std::vector<long> ausentes;
+    std::vector<long> historial; // producto (alta) o -1 - producto (baja).
+};
+
+class Generador {
+public:
+    explicit Generador(const Parametros& p)
+        : p(p), azar(p.semilla), zipf(p.productos, p.zipf), catalogo(p.productos), orden(p.productos), siguienteSolicitud(1),
+          siguienteCliente(1), emitidas(0) {
+        for (long i = 0; i < p.productos; ++i) {
+            orden[i] = i;
+        }
+        // El rango Zipf se asigna a productos al azar: los populares no son los primeros.
+        std::shuffle(orden.begin(), orden.end(), azar);
+    }
+
+    template <class Emitir>
+    void generar(Emitir emitir) {
+        ComandoTexto comando;
+        comando.incompleto = false;
+        for (long i = 0; i < p.productos; ++i) {
+            registrar(comando, i);
+            catalogo.alta(i);
+            emitir(0, comando);
+        }
+
+        // Cada proceso tiene su prximo instante; se emite siempre el ms cercano.
+        double inventario = proximo(p.tasa), llegada = proximo(p.llegadas), atencion = proximo(p.atencion);
+        double alta = proximo(p.solicitudes), proceso = proximo(p.solicitudes);
+        double ahora = 0;
+        while (emitidas < p.operaciones) {
+            ahora = std::min(std::min(inventario, llegada), std::min(atencion, std::min(alta, proceso)));
+            uint64_t instante = static_cast<uint64_t>(ahora * 1e6);
+            if (ahora == inventario) {
+                operacionInventario(comando);
+                inventario += proximo(p.tasa);
+            } else if (ahora == llegada) {
+                // Rfaga: 1 + geomtrica, con media p.rafaga.
+                std::geometric_distribution<long> extra(1.0 / std::max(1.0, p.rafaga));
+                long clientes = 1 + extra(azar);
+                for (long c = 0; c < clientes && emitidas < p.operaciones; ++c) {
+                    comando.opcion = 9;
+                    comando.texto = "cliente-" + std::to_string(siguienteCliente++);
+                    emitir(instante, comando);
+                    ++emitidas;
+                }
+                llegada += proximo(p.llegadas);
+                continue;
+            } else if (ahora == atencion) {
+                comando.opcion = 10;
+                atencion += proximo(p.atencion);
+            } else if (ahora == alta) {
+                comando.opcion = 5;
+                comando.texto = "reponer pedido " + std::to_string(siguienteSolicitud++);
+                alta += proximo(p.solicitudes);
+            } else {
+                comando.opcion = 6;
+                proceso += proximo(p.solicitudes);
+            }
+            emitir(instante, comando);
+            ++emitidas;
+        }
+    }
+
+private:
+    // Espera exponencial hasta el prximo evento de un proceso de Poisson de esa tasa.
+    double proximo(double tasa) {
+        if (tasa <= 0) return 1e300;
+        return std::exponential_distribution<double>(tasa)(azar);
+    }
+
+    void registrar(ComandoTexto& comando, long producto) {
+        comando.opcion = 1;
+        comando.producto.nombre = nombre(producto);
+        comando.producto.precio = (1 + azar() % 50000) / 100.0;
+        comando.producto.cantidad = static_cast<int>(azar() % 500);
+    }
+
+    std::string nombre(long producto) const { return "producto-" + std::to_string(producto); }
+
+    void operacionInventario(ComandoTexto& comando) {
+        double u = std::uniform_real_distribution<double>(0.0, 100.0)(azar);
+        long producto = -1;
+        if (u < p.altas && (producto = catalogo.reponerAlAzar(azar)) >= 0) {
+            registrar(comando, producto);
+        } else if (u >= p.altas && u < p.altas + p.bajas && (producto = catalogo.quitarAlAzar(azar)) >= 0) {
+            comando.opcion = 2;
+            comando.producto.nombre = nombre(producto);
+        } else if (u >= p.altas + p.bajas && u < p.altas + p.bajas + p.deshacer) {
+            comando.opcion = 12;
+            catalogo.deshacer();
+        } else if (u >= p.altas + p.bajas + p.deshacer && u < p.altas + p.bajas + p.deshacer + p.listados) {
+            comando.opcion = 4;
+        } else {
+            comando.opcion = 3;
+            comando.producto.nombre = nombre(orden[zipf(azar)]);
+        }
+    }
+
+    const Parametros& p;
+    std::mt19937_64 azar;
+    DistribucionZipf zipf;
+    Catalogo catalogo;
+    std::vector<long> orden; // Producto de cada rango de popularidad.
+    long siguienteSolicitud;
+    long siguienteCliente;
+    long emitidas;
+};
+
+static bool leerParametros(int argc, char** argv, Parametros& p) {
+    for (int i = 1; i < argc; ++i) {
+        std::string opcion = argv[i];
+        bool conValor = i + 1 < argc;
+        if (opcion == "--texto") {
+            p.texto = true;
+        } else if (opcion == "--operaciones" && conValor) {
+            p.operaciones = std::atol(argv[++i]);
+        } else if (opcion == "--productos" && conValor) {
+            p.productos = std::atol(argv[++i]);
+        } else if (opcion == "--zipf" && conValor) {
+            p.zipf = std::atof(argv[++i]);
+        } else if (opcion == "--tasa" && conValor) {
+            p.tasa = std::atof(argv[++i]);
+        } else if (opcion == "--altas" && conValor) {
+            p.altas = std::atof(argv[++i]);
+        } else if (opcion == "--bajas" && conValor) {
+            p.bajas = std::atof(argv[++i]);
+        } else if (opcion == "--deshacer" && conValor) {
+            p.deshacer = std::atof(argv[++i]);
+        } else if (opcion == "--listados" && conValor) {
+            p.listados = std::atof(argv[++i]);
+        } else if (opcion == "--llegadas" && conValor) {
+            p.llegadas = std::atof(argv[++i]);
+        } else if (opcion == "--rafaga" && conValor) {
+            p.rafaga = std::atof(argv[++i]);
+        } else if (opcion == "--atencion" && conValor) {
+            p.atencion = std::atof(argv[++i]);
+        } else if (opcion == "--solicitudes" && conValor) {
+            p.solicitudes = std::atof(argv[++i]);
+        } else if (opcion == "--semilla" && conValor) {
+            p.semilla = static_cast<unsigned>(std::atol(argv[++i]));
+        } else if (opcion.size() > 2 && opcion.compare(0, 2, "--") == 0) {
+            return false;
+        } else {
+            p.salida = opcion;
+        }
+    }
+    return !p.salida.empty() && p.operaciones >= 0 && p.productos > 0 && p.zipf >= 0 && p.tasa > 0;
+}
+
+int main(int argc, char** argv) {
+    Parametros p;
+    if (!leerParametros(argc, argv, p)) {
+        std::cerr << "Uso: " << argv[0] << " [--operaciones N] [--productos P] [--zipf s] [--tasa R] [--altas A] [--bajas B]\n"
+                  << "       [--deshacer D] [--listados L] [--llegadas Y] [--rafaga M] [--atencion Z] [--solicitudes S]\n"
+                  << "       [--semilla X] [--texto] <salida>" << std::endl;
+        return 2;
+    }
+
+    Generador generador(p);
+    unsigned long long comandos = 0;
+    uint64_t ultimo = 0;
+    if (p.texto) {
+        std::ofstream archivo(p.salida.c_str(), std::ios::binary);
+        if (!archivo) {
+            std::cerr << "No se pudo crear " << p.salida << std::endl;
+            return 1;
+        }
+        generador.generar([&](uint64_t instante, const ComandoTexto& comando) {
+            escribirComandoTexto(archivo, comando);
+            ultimo = instante;
+            ++comandos;
+        });
+    } else {
+        EscritorTraza escritor;
+        if (!escritor.abrir(p.salida)) {
+            std::cerr << "No se pudo crear " << p.salida << std::endl;
+            return 1;
+        }
+        generador.generar([&](uint64_t instante, const ComandoTexto& comando) {
+            escritor.escribir(instante, comando);
+            ultimo = instante;
+            ++comandos;
+        });
+    }
+    std::printf("%llu comandos (%ld de carga inicial), %.3f s simulados, en %s\n", comandos, p.productos, ultimo / 1e6,
+                p.salida.c_str());
+    return 0;
+}
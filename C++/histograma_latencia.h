@@ -0,0 +1,207 @@
+#ifndef HISTOGRAMA_LATENCIA_H
+#define HISTOGRAMA_LATENCIA_H
+
+// Histogramas de latencia por operacin de SistemaGestion
+// Cada histograma es log-lineal, como HdrHistogram: los valores menores que 32 ns
+// tienen una cubeta cada uno y, a partir de ah, cada potencia de dos se parte en 16
+// cubetas iguales. El error relativo de un percentil es como mucho 1/32 (se informa
+// el punto medio de la cubeta) y el mximo se guarda exacto.
+//
+// Registrar cuesta dos lecturas del reloj y cuatro sumas atmicas relajadas, sin
+// cerrojos ni memoria dinmica: se puede dejar activo en produccin. Varios hilos
+// pueden registrar a la vez en el mismo histograma; leer mientras se registra da una
+// foto aproximada, nunca un valor roto.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+
+#include "operaciones_sistema.h"
+#include "eventos_traza.h"
+#include "instrumentacion.h"
+
+// Posicin del bit ms alto encendido (valor > 0).
+inline int bitMasAlto(uint64_t valor) {
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(valor);
+#else
+    int bit = 0;
+    while (valor >>= 1) ++bit;
+    return bit;
+#endif
+}
+
+class HistogramaLatencia {
+public:
+    static const int BITS_SUBCUBETA = 4;                        // 16 cubetas por potencia de dos.
+    static const int LINEALES = 2 << BITS_SUBCUBETA;            // Valores con cubeta propia: 0..31.
+    static const int BIT_MAXIMO = 40;                           // Hasta 2^41 ns (unos 36 minutos).
+    static const int CUBETAS = LINEALES + (BIT_MAXIMO - BITS_SUBCUBETA) * (1 << BITS_SUBCUBETA);
+
+    HistogramaLatencia() { reiniciar(); }
+
+    static int cubeta(uint64_t nanos) {
+        if (nanos < static_cast<uint64_t>(LINEALES)) {
+            return static_cast<int>(nanos);
+        }
+        int bit = bitMasAlto(nanos);
+        if (bit > BIT_MAXIMO) {
+            return CUBETAS - 1; // Fuera de rango: se cuenta en la ltima.
+        }
+        int desplazamiento = bit - BITS_SUBCUBETA;
+        return LINEALES + (desplazamiento - 1) * (1 << BITS_SUBCUBETA) +
+               static_cast<int>((nanos >> desplazamiento) & ((1 << BITS_SUBCUBETA) - 1));
+    }
+
+    // Lmites [desde, hasta) de los valores que caen en una cubeta.
+    static uint64_t inicioCubeta(int indice) {
+        if (indice < LINEALES) {
+            return static_cast<uint64_t>(indice);
+        }
+        int desplazamiento = (indice - LINEALES) / (1 << BITS_SUBCUBETA) + 1;
+        uint64_t sub = static_cast<uint64_t>((indice - LINEALES) % (1 << BITS_SUBCUBETA));
+        return ((1ull << BITS_SUBCUBETA) + sub) << desplazamiento;
+    }
+    static uint64_t anchoCubeta(int indice) {
+        return indice < LINEALES ? 1 : 1ull << ((indice - LINEALES) / (1 << BITS_SUBCUBETA) + 1);
+    }
+
+    void registrar(uint64_t nanos) {
+        cuentas[cubeta(nanos)].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(1, std::memory_order_relaxed);
+        suma.fetch_add(nanos, std::memory_order_relaxed);
+        uint64_t previo = maximo.load(std::memory_order_relaxed);
+        while (nanos > previo && !maximo.compare_exchange_weak(previo, nanos, std::memory_order_relaxed)) {
+        }
+    }
+
+    uint64_t cantidad() const { return total.load(std::memory_order_relaxed); }
+    uint64_t valorMaximo() const { return maximo.load(std::memory_order_relaxed); }
+    uint64_t sumaTotal() const { return suma.load(std::memory_order_relaxed); }
+
+    // Valor (ns) por debajo del cual queda la fraccin q de las muestras; 0 sin muestras.
+    uint64_t percentil(double q) const {
+        uint64_t muestras = cantidad();
+        if (muestras == 0) {
+            return 0;
+        }
+        uint64_t objetivo = static_cast<uint64_t>(q * muestras + 0.5);
+        if (objetivo == 0) objetivo = 1;
+        uint64_t acumulado = 0;
+        for (int i = 0; i < CUBETAS; ++i) {
+            acumulado += cuentas[i].load(std::memory_order_relaxed);
+            if (acumulado >= objetivo) {
+                uint64_t medio = inicioCubeta(i) + anchoCubeta(i) / 2;
+                uint64_t tope = valorMaximo();
+                return medio < tope ? medio : tope;
+            }
+        }
+        return valorMaximo();
+    }
+
+    void reiniciar() {
+        for (int i = 0; i < CUBETAS; ++i) {
+            cuentas[i].store(0, std::memory_order_relaxed);
+        }
+        total.store(0, std::memory_order_relaxed);
+        suma.store(0, std::memory_order_relaxed);
+        maximo.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> cuentas[CUBETAS];
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> suma;
+    std::atomic<uint64_t> maximo;
+};
+
+// Un histograma por operacin. Se puede apagar en tiempo de ejecucin: apagado,
+// medir cuesta una lectura de un booleano.
+class LatenciasSistema {
+public:
+    LatenciasSistema() : activo(true) {}
+
+    bool activas() const { return activo.load(std::memory_order_relaxed); }
+    void activar(bool valor) { activo.store(valor, std::memory_order_relaxed); }
+
+    void registrar(OperacionSistema operacion, uint64_t nanos) { histogramas[operacion].registrar(nanos); }
+    const HistogramaLatencia& operacion(OperacionSistema operacion) const { return histogramas[operacion]; }
+
+    void reiniciar() {
+        for (int i = 0; i < CANTIDAD_OPERACIONES_SISTEMA; ++i) {
+            histogramas[i].reiniciar();
+        }
+    }
+
+    // Tabla con cuenta, p50, p90, p99, p99.9 y mximo (en microsegundos) de cada
+    // operacin con muestras.
+    void imprimir(std::ostream& salida) const {
+        char linea[160];
+        std::snprintf(linea, sizeof(linea), "%-28s %10s %10s %10s %10s %10s %10s\n", "Operacin (s)", "cuenta", "p50",
+                      "p90", "p99", "p99.9", "mximo");
+        salida << linea;
+        bool alguna = false;
+        for (int i = 0; i < CANTIDAD_OPERACIONES_SISTEMA; ++i) {
+            const HistogramaLatencia& h = histogramas[i];
+            if (h.cantidad() == 0) continue;
+            alguna = true;
+            std::snprintf(linea, sizeof(linea), "%-28s %10llu %10.2f %10.2f %10.2f %10.2f %10.2f\n", nombreOperacionSistema(i),
+                          static_cast<unsigned long long>(h.cantidad()), h.percentil(0.50) / 1e3, h.percentil(0.90) / 1e3,
+                          h.percentil(0.99) / 1e3, h.percentil(0.999) / 1e3, h.valorMaximo() / 1e3);
+            salida << linea;
+        }
+        if (!alguna) {
+            salida << "Sin operaciones medidas." << std::endl;
+        }
+    }
+
+private:
+    std::atomic<bool> activo;
+    HistogramaLatencia histogramas[CANTIDAD_OPERACIONES_SISTEMA];
+};
+
+// Mide el tiempo de vida del objeto y lo registra al destruirse. Con -DEVENTOS_TRAZA
+// adems deja un evento de traza con el nombre de la operacin, y con
+// -DINSTRUMENTACION le atribuye los eventos instrumentados (instrumentacion.h).
+class MedicionLatencia {
+public:
+    typedef std::chrono::steady_clock Reloj;
+
+    MedicionLatencia(LatenciasSistema& latencias, OperacionSistema operacion)
+        : latencias(latencias), operacion(operacion), activa(latencias.activas())
+#ifdef EVENTOS_TRAZA
+        , evento(nombreOperacionSistema(operacion))
+#endif
+#ifdef INSTRUMENTACION
+        , instrumentado(operacion)
+#endif
+    {
+        ContadoresOperaciones::sumar(operacion);
+        if (activa) inicio = Reloj::now();
+    }
+    ~MedicionLatencia() {
+        if (activa) {
+            latencias.registrar(operacion, static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Reloj::now() - inicio).count()));
+        }
+    }
+
+    MedicionLatencia(const MedicionLatencia&) = delete;
+    MedicionLatencia& operator=(const MedicionLatencia&) = delete;
+
+private:
+    LatenciasSistema& latencias;
+    OperacionSistema operacion;
+    bool activa;
+    Reloj::time_point inicio;
+#ifdef EVENTOS_TRAZA
+    AmbitoEvento evento;
+#endif
+#ifdef INSTRUMENTACION
+    AmbitoInstrumentado instrumentado;
+#endif
+};
+
+#endif
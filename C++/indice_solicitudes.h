@@ -0,0 +1,280 @@
+#ifndef INDICE_SOLICITUDES_H
+#define INDICE_SOLICITUDES_H
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <stdint.h>
+
+#include "estructuras.h"
+#include "memoria_estructuras.h"
+#include "traza.h"
+
+// ndice invertido de las solicitudes pendientes
+// Para cada palabra de las descripciones, la lista (posteos) de las solicitudes
+// pendientes que la mencionan. Cada solicitud recibe un nmero de llegada y la cola es
+// FIFO, as que:
+//   - una solicitud nueva tiene el nmero ms alto: sus posteos van al final de cada
+//     lista, como diferencia con el anterior en un varint (1 o 2 bytes casi siempre);
+//   - la que sale es la ms vieja: es el primer posteo de cada una de sus listas, y
+//     quitarla es avanzar el comienzo de la lista un varint. Los bytes ya ledos se
+//     descartan cuando son ms de la mitad;
+//   - la posicin de una pendiente en la cola es su nmero menos el de la primera.
+//
+// Una consulta de varias palabras recorre solo la lista ms corta; las dems palabras
+// se comprueban en la descripcin de esos candidatos, que de todas formas hay que leer
+// para mostrarlos.
+//
+// Palabras: corridas de letras y dgitos, con las letras ASCII en minsculas. Los bytes
+// desde 0x80 cuentan como letras y se dejan como estn, as "garanta" es una palabra
+// tanto en Latin-1 como en UTF-8 (pero "GARANTA" es otra).
+
+// Llama a f(const std::string& palabra) con cada palabra del texto, en orden y con
+// repeticiones; palabra es el espacio de trabajo.
+template <class F>
+void recorrerPalabras(const VistaNombre& texto, std::string& palabra, F f) {
+    palabra.clear();
+    for (std::size_t i = 0; i <= texto.longitud; ++i) {
+        unsigned char byte = i < texto.longitud ? static_cast<unsigned char>(texto.datos[i]) : ' ';
+        if (byte >= 'A' && byte <= 'Z') {
+            palabra.push_back(static_cast<char>(byte - 'A' + 'a'));
+        } else if ((byte >= 'a' && byte <= 'z') || (byte >= '0' && byte <= '9') || byte >= 0x80) {
+            palabra.push_back(static_cast<char>(byte));
+        } else if (!palabra.empty()) {
+            f(static_cast<const std::string&>(palabra));
+            palabra.clear();
+        }
+    }
+}
+
+// Palabras distintas de una consulta; coincide con las descripciones que las tienen todas.
+class ConsultaSolicitudes {
+public:
+    explicit ConsultaSolicitudes(const VistaNombre& consulta) {
+        recorrerPalabras(consulta, palabra, [this](const std::string& p) { palabras.push_back(p); });
+        std::sort(palabras.begin(), palabras.end());
+        palabras.erase(std::unique(palabras.begin(), palabras.end()), palabras.end());
+    }
+
+    const std::vector<std::string>& lista() const { return palabras; }
+    bool vacia() const { return palabras.empty(); }
+
+    bool coincide(const VistaNombre& descripcion) {
+        vistas.assign(palabras.size(), false);
+        std::size_t faltan = palabras.size();
+        recorrerPalabras(descripcion, palabra, [this, &faltan](const std::string& p) {
+            std::vector<std::string>::const_iterator it = std::lower_bound(palabras.begin(), palabras.end(), p);
+            if (it != palabras.end() && *it == p && !vistas[it - palabras.begin()]) {
+                vistas[it - palabras.begin()] = true;
+                --faltan;
+            }
+        });
+        return faltan == 0;
+    }
+
+private:
+    std::vector<std::string> palabras; // Ordenadas.
+    std::vector<bool> vistas;
+    std::string palabra;
+};
+
+class IndiceSolicitudes {
+public:
+    IndiceSolicitudes() : ranuras(16, 0), ocupadas(0), siguiente(0), primera(0), posteos(0) {}
+
+    // Indexa la solicitud que acaba de entrar al final de la cola.
+    void agregar(const VistaNombre& descripcion) {
+        uint64_t numero = siguiente++;
+        recorrerPalabras(descripcion, palabra, [this, numero](const std::string& p) {
+            TerminoSolicitudes& termino = terminos[terminoDe(p)];
+            if (termino.cantidad > 0 && termino.ultimo == numero) {
+                return; // Palabra repetida en la misma descripcin.
+            }
+            agregarVarint(termino.posteos, numero - termino.ultimo);
+            termino.ultimo = numero;
+            ++termino.cantidad;
+            ++posteos;
+        });
+    }
+
+    // Olvida la primera solicitud de la cola, que acaba de salir con esta descripcin.
+    void quitarPrimera(const VistaNombre& descripcion) {
+        if (primera == siguiente) {
+            return;
+        }
+        uint64_t numero = primera++;
+        recorrerPalabras(descripcion, palabra, [this, numero](const std::string& p) {
+            std::size_t ranura = ranuraDe(vistaDe(p), hashNombre(p));
+            if (ranuras[ranura] == 0) {
+                return;
+            }
+            uint32_t indice = ranuras[ranura] - 1;
+            TerminoSolicitudes& termino = terminos[indice];
+            const char* q = termino.posteos.data() + termino.cabeza;
+            uint64_t diferencia;
+            leerVarint(q, termino.posteos.data() + termino.posteos.size(), diferencia);
+            if (termino.anterior + diferencia != numero) {
+                return; // Ya se quit por una repeticin de la palabra.
+            }
+            termino.anterior = numero;
+            termino.cabeza = q - termino.posteos.data();
+            --posteos;
+            if (--termino.cantidad == 0) {
+                liberarRanura(ranura);
+                --ocupadas;
+                terminos[indice] = TerminoSolicitudes();
+                libres.push_back(indice);
+            } else if (termino.cabeza * 2 > termino.posteos.size()) {
+                termino.posteos.erase(0, termino.cabeza);
+                termino.cabeza = 0;
+            }
+        });
+    }
+
+    // Deja en candidatas, en orden de cola (0 es la primera pendiente), las posiciones
+    // de las solicitudes que mencionan la palabra de la consulta con menos posteos; si
+    // la consulta tiene una sola palabra, son exactamente las que coinciden. Devuelve
+    // false si alguna palabra no aparece en ninguna pendiente.
+    bool candidatas(const ConsultaSolicitudes& consulta, std::vector<uint64_t>& posiciones) const {
+        posiciones.clear();
+        const TerminoSolicitudes* menor = nullptr;
+        for (const std::string& p : consulta.lista()) {
+            uint32_t valor = ranuras[ranuraDe(vistaDe(p), hashNombre(p))];
+            if (valor == 0) {
+                return false;
+            }
+            if (!menor || terminos[valor - 1].cantidad < menor->cantidad) {
+                menor = &terminos[valor - 1];
+            }
+        }
+        if (!menor) {
+            return false;
+        }
+        posiciones.reserve(menor->cantidad);
+        const char* q = menor->posteos.data() + menor->cabeza;
+        const char* fin = menor->posteos.data() + menor->posteos.size();
+        uint64_t numero = menor->anterior;
+        uint64_t diferencia;
+        while (q < fin && leerVarint(q, fin, diferencia)) {
+            numero += diferencia;
+            posiciones.push_back(numero - primera);
+        }
+        return true;
+    }
+
+    std::size_t pendientes() const { return static_cast<std::size_t>(siguiente - primera); }
+    std::size_t cantidadTerminos() const { return ocupadas; }
+    std::size_t cantidadPosteos() const { return posteos; }
+
+    // Recorre los trminos: para los reportes, no para cada operacin.
+    MemoriaEstructura memoria() const {
+        MemoriaEstructura memoria;
+        memoria.elementos = static_cast<int64_t>(ocupadas);
+        memoria += bloqueMonton(terminos.capacity() * sizeof(TerminoSolicitudes));
+        memoria += bloqueMonton(ranuras.capacity() * sizeof(uint32_t));
+        memoria += bloqueMonton(libres.capacity() * sizeof(uint32_t));
+        for (const TerminoSolicitudes& termino : terminos) {
+            contarCadena(memoria, termino.palabra);
+            contarCadena(memoria, termino.posteos);
+        }
+        return memoria;
+    }
+
+private:
+    struct TerminoSolicitudes {
+        TerminoSolicitudes() : hash(0), cabeza(0), anterior(0), ultimo(0), cantidad(0) {}
+        std::string palabra;
+        uint64_t hash;
+        std::string posteos;  // Diferencias entre nmeros de llegada, en varint.
+        std::size_t cabeza;   // Byte del primer posteo vigente.
+        uint64_t anterior;    // Nmero desde el que se cuenta la diferencia del primer posteo vigente.
+        uint64_t ultimo;      // Nmero del ltimo posteo.
+        uint32_t cantidad;    // Posteos vigentes.
+    };
+
+    // Trmino de la palabra; lo crea con la lista vaca si no estaba.
+    uint32_t terminoDe(const std::string& p) {
+        uint64_t hash = hashNombre(p);
+        std::size_t ranura = ranuraDe(vistaDe(p), hash);
+        if (ranuras[ranura] != 0) {
+            return ranuras[ranura] - 1;
+        }
+        // Factor de carga mximo de 0.5.
+        if ((ocupadas + 1) * 2 > ranuras.size()) {
+            crecer();
+            ranura = ranuraDe(vistaDe(p), hash);
+        }
+        uint32_t indice;
+        if (libres.empty()) {
+            indice = static_cast<uint32_t>(terminos.size());
+            terminos.push_back(TerminoSolicitudes());
+        } else {
+            indice = libres.back();
+            libres.pop_back();
+        }
+        TerminoSolicitudes& termino = terminos[indice];
+        termino.palabra = p;
+        termino.hash = hash;
+        // Una lista vaca empieza a contar desde la primera pendiente.
+        termino.anterior = termino.ultimo = primera;
+        ranuras[ranura] = indice + 1;
+        ++ocupadas;
+        return indice;
+    }
+
+    // Tabla de palabras con direccionamiento abierto (sondeo lineal): trmino + 1, o 0
+    // si la ranura est libre. Devuelve la ranura de la palabra o la libre donde ira.
+    std::size_t ranuraDe(const VistaNombre& p, uint64_t hash) const {
+        std::size_t mascara = ranuras.size() - 1;
+        for (std::size_t i = hash & mascara;; i = (i + 1) & mascara) {
+            uint32_t valor = ranuras[i];
+            if (valor == 0) {
+                return i;
+            }
+            const TerminoSolicitudes& termino = terminos[valor - 1];
+            if (termino.hash == hash && vistaDe(termino.palabra) == p) {
+                return i;
+            }
+        }
+    }
+
+    // Borra la ranura desplazando hacia atrs las siguientes, as no quedan lpidas.
+    void liberarRanura(std::size_t libre) {
+        std::size_t mascara = ranuras.size() - 1;
+        for (std::size_t i = (libre + 1) & mascara; ranuras[i] != 0; i = (i + 1) & mascara) {
+            std::size_t ideal = terminos[ranuras[i] - 1].hash & mascara;
+            if (((i - ideal) & mascara) >= ((i - libre) & mascara)) {
+                ranuras[libre] = ranuras[i];
+                libre = i;
+            }
+        }
+        ranuras[libre] = 0;
+    }
+
+    void crecer() {
+        std::vector<uint32_t> anteriores(ranuras.size() * 2, 0);
+        anteriores.swap(ranuras);
+        std::size_t mascara = ranuras.size() - 1;
+        for (uint32_t valor : anteriores) {
+            if (valor != 0) {
+                std::size_t i = terminos[valor - 1].hash & mascara;
+                while (ranuras[i] != 0) {
+                    i = (i + 1) & mascara;
+                }
+                ranuras[i] = valor;
+            }
+        }
+    }
+
+    std::vector<TerminoSolicitudes> terminos;
+    std::vector<uint32_t> ranuras;
+    std::vector<uint32_t> libres; // Trminos sin palabra, para reutilizar.
+    std::size_t ocupadas;         // Palabras distintas.
+    uint64_t siguiente;           // Nmero de la prxima solicitud.
+    uint64_t primera;             // Nmero de la primera pendiente.
+    std::size_t posteos;
+    std::string palabra;          // Espacio de trabajo.
+};
+
+#endif
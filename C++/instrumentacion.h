@@ -0,0 +1,191 @@
+#ifndef INSTRUMENTACION_H
+#define INSTRUMENTACION_H
+
+// Instrumentacin de los caminos calientes
+// Cuenta, por operacin de SistemaGestion, los eventos que explican su costo:
+// comparaciones de nombres, nodos visitados, sondeos de tabla hash, reservas de
+// memoria y ciclos (rdtsc; en otras arquitecturas, nanosegundos). Sirve para
+// comprobar, por ejemplo, que consultarProducto pas de n comparaciones a un sondeo.
+//
+// Solo existe si se compila con -DINSTRUMENTACION (make DEFINES=-DINSTRUMENTACION);
+// sin esa opcin las macros no generan cdigo. Los contadores son por hilo
+// (contadores_hilo.h) y se suman al imprimir. Los eventos fuera de una operacin
+// medida (por ejemplo, del men) se cuentan aparte.
+//
+// Las reservas solo se cuentan en los programas que usan DEFINIR_CONTEO_RESERVAS(),
+// porque reemplazar operator new solo puede hacerse una vez por programa.
+//
+// Uso en el cdigo medido:
+//   INSTRUMENTAR(InstrComparaciones);
+//   INSTRUMENTAR_N(InstrNodosVisitados, n);
+
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string>
+
+#include "operaciones_sistema.h"
+
+enum EventoInstrumentado {
+    InstrLlamadas,
+    InstrComparaciones,
+    InstrNodosVisitados,
+    InstrSondeosHash,
+    InstrReservas,
+    InstrCiclos,
+    CANTIDAD_EVENTOS_INSTRUMENTADOS
+};
+
+#ifdef INSTRUMENTACION
+
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Una fila por operacin y una ms para lo que ocurre fuera de ellas.
+static const int FILAS_INSTRUMENTACION = CANTIDAD_OPERACIONES_SISTEMA + 1;
+
+struct EtiquetaInstrumentacion;
+typedef ContadoresPorHilo<EtiquetaInstrumentacion, FILAS_INSTRUMENTACION * CANTIDAD_EVENTOS_INSTRUMENTADOS>
+    ContadoresInstrumentacion;
+
+inline uint64_t ciclosInstrumentacion() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Operacin en curso en este hilo; FILAS_INSTRUMENTACION - 1 fuera de las operaciones.
+inline int& operacionInstrumentada() {
+    static thread_local int operacion = FILAS_INSTRUMENTACION - 1;
+    return operacion;
+}
+
+// Evita contar mientras se cuenta: registrar el bloque de un hilo nuevo reserva memoria.
+inline bool& contandoInstrumentacion() {
+    static thread_local bool contando = false;
+    return contando;
+}
+
+inline void registrarEventoInstrumentado(EventoInstrumentado evento, uint64_t cantidad) {
+    bool& contando = contandoInstrumentacion();
+    if (contando) {
+        return;
+    }
+    contando = true;
+    ContadoresInstrumentacion::sumar(operacionInstrumentada() * CANTIDAD_EVENTOS_INSTRUMENTADOS + evento, cantidad);
+    contando = false;
+}
+
+// Atribuye los eventos del alcance a una operacin y cuenta sus ciclos. Anidadas
+// (guardarCatalogo congela antes de guardar), la exterior incluye los ciclos de la interior.
+class AmbitoInstrumentado {
+public:
+    explicit AmbitoInstrumentado(int operacion) : anterior(operacionInstrumentada()) {
+        operacionInstrumentada() = operacion;
+        registrarEventoInstrumentado(InstrLlamadas, 1);
+        inicio = ciclosInstrumentacion();
+    }
+    ~AmbitoInstrumentado() {
+        uint64_t ciclos = ciclosInstrumentacion() - inicio;
+        registrarEventoInstrumentado(InstrCiclos, ciclos);
+        operacionInstrumentada() = anterior;
+    }
+
+    AmbitoInstrumentado(const AmbitoInstrumentado&) = delete;
+    AmbitoInstrumentado& operator=(const AmbitoInstrumentado&) = delete;
+
+private:
+    int anterior;
+    uint64_t inicio;
+};
+
+#define INSTRUMENTAR_N(evento, cantidad) registrarEventoInstrumentado(evento, static_cast<uint64_t>(cantidad))
+
+// Este operator delete libera con free lo que el operator new de abajo reserv con
+// malloc; GCC no lo ve al analizar cada llamada y advierte de una pareja distinta.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+// Reemplaza operator new y delete para contar reservas; a lo sumo una vez por programa.
+#define DEFINIR_CONTEO_RESERVAS()                                                                        \
+    void* operator new(std::size_t bytes) {                                                              \
+        INSTRUMENTAR(InstrReservas);                                                                     \
+        void* memoria = std::malloc(bytes ? bytes : 1);                                                  \
+        if (!memoria) throw std::bad_alloc();                                                            \
+        return memoria;                                                                                  \
+    }                                                                                                    \
+    void* operator new[](std::size_t bytes) { return operator new(bytes); }                              \
+    void* operator new(std::size_t bytes, const std::nothrow_t&) noexcept {                              \
+        INSTRUMENTAR(InstrReservas);                                                                     \
+        return std::malloc(bytes ? bytes : 1);                                                           \
+    }                                                                                                    \
+    void* operator new[](std::size_t bytes, const std::nothrow_t& nt) noexcept {                          \
+        return operator new(bytes, nt);                                                                  \
+    }                                                                                                    \
+    void operator delete(void* memoria) noexcept { std::free(memoria); }                                \
+    void operator delete[](void* memoria) noexcept { std::free(memoria); }                              \
+    void operator delete(void* memoria, std::size_t) noexcept { std::free(memoria); }                   \
+    void operator delete[](void* memoria, std::size_t) noexcept { std::free(memoria); }
+
+#else
+
+#define INSTRUMENTAR_N(evento, cantidad) ((void)0)
+#define DEFINIR_CONTEO_RESERVAS()
+
+#endif
+
+#define INSTRUMENTAR(evento) INSTRUMENTAR_N(evento, 1)
+
+// Tabla por operacin: cuntas veces se ejecut desde el ltimo reinicio y el promedio
+// de cada evento por ejecucin. Sin -DINSTRUMENTACION no escribe nada.
+inline void imprimirInstrumentacion(std::ostream& salida) {
+#ifdef INSTRUMENTACION
+    static const int TOTAL = FILAS_INSTRUMENTACION * CANTIDAD_EVENTOS_INSTRUMENTADOS;
+    uint64_t sumas[TOTAL];
+    ContadoresInstrumentacion::totales(sumas);
+
+    char linea[200];
+    std::snprintf(linea, sizeof(linea), "%-28s %10s %12s %12s %12s %12s %14s\n", "Promedio por llamada", "llamadas",
+                  "comparac.", "nodos", "sondeos", "reservas",
+#if defined(__x86_64__) || defined(__i386__)
+                  "ciclos");
+#else
+                  "ns");
+#endif
+    salida << linea;
+    for (int fila = 0; fila < FILAS_INSTRUMENTACION; ++fila) {
+        const uint64_t* e = sumas + fila * CANTIDAD_EVENTOS_INSTRUMENTADOS;
+        bool fuera = fila == CANTIDAD_OPERACIONES_SISTEMA;
+        uint64_t n = fuera ? 1 : e[InstrLlamadas];
+        if (n == 0 || (fuera && e[InstrComparaciones] + e[InstrNodosVisitados] + e[InstrSondeosHash] + e[InstrReservas] == 0)) {
+            continue;
+        }
+        double d = static_cast<double>(n);
+        // Fuera de las operaciones se muestran totales, no promedios.
+        std::snprintf(linea, sizeof(linea), "%-28s %10s %12.1f %12.1f %12.1f %12.1f %14.0f\n",
+                      fuera ? "(fuera de operaciones)" : nombreOperacionSistema(fila),
+                      fuera ? "-" : std::to_string(static_cast<unsigned long long>(n)).c_str(), e[InstrComparaciones] / d,
+                      e[InstrNodosVisitados] / d, e[InstrSondeosHash] / d, e[InstrReservas] / d, e[InstrCiclos] / d);
+        salida << linea;
+    }
+#else
+    (void)salida;
+#endif
+}
+
+inline void reiniciarInstrumentacion() {
+#ifdef INSTRUMENTACION
+    ContadoresInstrumentacion::reiniciar();
+#endif
+}
+
+#endif
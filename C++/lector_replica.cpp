@@ -0,0 +1,68 @@
+// Lector de la rplica en memoria compartida
+// Consulta el inventario que publica SistemaGestion::publicarReplica sin sockets ni
+// bloqueos: proyecta la regin y lee directamente de ella.
+//
+// Uso: lector_replica <region> [nombre...]     resumen y consultas (sin nombres lista todo)
+//      lector_replica -v <segundos> <region>   muestra el resumen peridicamente
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+#include "replica_compartida.h"
+
+static void mostrarResumen(const LectorReplica& lector) {
+    LectorReplica::Resumen resumen = lector.resumen();
+    std::cout << "Rplica: " << resumen.productos << " productos, " << resumen.unidades << " unidades, valor total: "
+              << resumen.valor << ", " << resumen.mutaciones << " cambios publicados"
+              << (resumen.desbordada ? " (desbordada: no se actualiza hasta que el inventario baje a la mitad)" : "") << std::endl;
+}
+
+int main(int argc, char** argv) {
+    int primero = 1;
+    int intervalo = 0;
+    if (argc > 3 && std::string(argv[1]) == "-v") {
+        intervalo = std::atoi(argv[2]);
+        primero = 3;
+    }
+    if (argc <= primero) {
+        std::cerr << "Uso: " << argv[0] << " [-v segundos] <region> [nombre...]" << std::endl;
+        return 2;
+    }
+
+    LectorReplica lector;
+    if (!lector.abrir(argv[primero])) {
+        std::cerr << "No se pudo abrir la rplica " << argv[primero] << std::endl;
+        return 1;
+    }
+
+    if (intervalo > 0) {
+        for (;;) {
+            mostrarResumen(lector);
+            std::this_thread::sleep_for(std::chrono::seconds(intervalo));
+        }
+    }
+
+    mostrarResumen(lector);
+    if (argc == primero + 1) {
+        std::vector<Producto> productos;
+        lector.listar(productos);
+        for (const auto& producto : productos) {
+            std::cout << "Producto: " << producto.nombre << ", Precio: " << producto.precio << ", Cantidad: " << producto.cantidad << std::endl;
+        }
+        return 0;
+    }
+
+    for (int i = primero + 1; i < argc; ++i) {
+        Producto producto;
+        if (lector.buscar(argv[i], producto)) {
+            std::cout << "Producto: " << producto.nombre << ", Precio: " << producto.precio << ", Cantidad: " << producto.cantidad << std::endl;
+        } else {
+            std::cout << "Producto no encontrado." << std::endl;
+        }
+    }
+    return 0;
+}
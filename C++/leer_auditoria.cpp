@@ -0,0 +1,130 @@
+// Lectura del registro de auditora
+// Decodifica un registro escrito con --auditoria (auditoria.h) bloque a bloque:
+// comprueba la cadena de resmenes, descomprime y recorre los registros. En memoria
+// solo est el bloque en curso, as que lee registros de cualquier tamao.
+//
+// Uso: leer_auditoria <archivo> [--mostrar]
+//   Sin --mostrar informa cuntos registros hay de cada operacin, cunto ocupan y a
+//   qu velocidad se decodificaron. Con --mostrar escribe adems una lnea por
+//   registro: instante (UTC), almacn, operacin y sus datos.
+//
+// Devuelve 1 si el registro est daado, despus de informar hasta dnde es vlido, o
+// si no termina en una marca de cierre: entonces no se puede asegurar que est completo.
+
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+#include "auditoria.h"
+
+// Escribe un registro como una lnea de texto.
+static void mostrarEvento(const EventoAuditoria& evento) {
+    std::time_t segundos = static_cast<std::time_t>(evento.instante / 1000000);
+    char fecha[32];
+    std::strftime(fecha, sizeof(fecha), "%Y-%m-%d %H:%M:%S", std::gmtime(&segundos));
+    std::printf("%s.%06u %.*s %s", fecha, static_cast<unsigned>(evento.instante % 1000000),
+                static_cast<int>(evento.almacen.longitud), evento.almacen.datos, nombreOperacionAuditoria(evento.operacion));
+    switch (evento.operacion) {
+        case AuditoriaSolicitudRegistrada:
+            std::printf(" %d %.*s\n", evento.id, static_cast<int>(evento.texto.longitud), evento.texto.datos);
+            break;
+        case AuditoriaSolicitudProcesada:
+        case AuditoriaClienteAtendido:
+            std::printf(" %d\n", evento.id);
+            break;
+        case AuditoriaClienteRegistrado:
+            std::printf(" %d %.*s\n", evento.id, static_cast<int>(evento.nombre.longitud), evento.nombre.datos);
+            break;
+        case AuditoriaCatalogoCargado:
+            std::printf(" %.*s %llu\n", static_cast<int>(evento.texto.longitud), evento.texto.datos,
+                        static_cast<unsigned long long>(evento.productos));
+            break;
+        default: {
+            // El precio con los dgitos justos para leerlo de vuelta igual.
+            char precio[32];
+            std::snprintf(precio, sizeof(precio), "%.15g", evento.precio);
+            if (std::strtod(precio, nullptr) != evento.precio) {
+                std::snprintf(precio, sizeof(precio), "%.17g", evento.precio);
+            }
+            std::printf(" %.*s %s %d\n", static_cast<int>(evento.nombre.longitud), evento.nombre.datos, precio,
+                        evento.cantidad);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string ruta;
+    bool mostrar = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string argumento = argv[i];
+        if (argumento == "--mostrar") {
+            mostrar = true;
+        } else if (argumento.compare(0, 2, "--") != 0 && ruta.empty()) {
+            ruta = argumento;
+        } else {
+            ruta.clear();
+            break;
+        }
+    }
+    if (ruta.empty()) {
+        std::cerr << "Uso: " << argv[0] << " <archivo> [--mostrar]" << std::endl;
+        return 2;
+    }
+
+    LectorAuditoria lector;
+    if (!lector.abrir(ruta)) {
+        std::cerr << "No se pudo abrir el registro de auditora " << ruta << std::endl;
+        return 1;
+    }
+
+    unsigned long long porOperacion[FIN_OPERACIONES_AUDITORIA] = {};
+    unsigned long long registros = 0;
+    uint64_t primero = 0, ultimo = 0;
+    EventoAuditoria evento;
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+    while (lector.siguiente(evento)) {
+        if (registros == 0) {
+            primero = evento.instante;
+        }
+        ultimo = evento.instante;
+        ++porOperacion[evento.operacion];
+        ++registros;
+        if (mostrar) {
+            mostrarEvento(evento);
+        }
+    }
+    double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+
+    std::FILE* informe = mostrar ? stderr : stdout; // Con --mostrar, la salida estndar es solo de registros.
+    std::fprintf(informe, "%llu registros en %llu bloques", registros, lector.cantidadBloques());
+    if (registros > 0) {
+        std::fprintf(informe, ", %.3f s de actividad", (ultimo - primero) / 1e6);
+    }
+    std::fprintf(informe, "\n%llu bytes en disco, %llu sin comprimir (%.2fx)\n", lector.bytesEnDisco(),
+                 lector.bytesSinComprimir(),
+                 lector.bytesEnDisco() > 0 ? static_cast<double>(lector.bytesSinComprimir()) / lector.bytesEnDisco() : 0.0);
+    for (int operacion = 1; operacion < FIN_OPERACIONES_AUDITORIA; ++operacion) {
+        if (porOperacion[operacion] > 0) {
+            std::fprintf(informe, "  %-22s %12llu\n", nombreOperacionAuditoria(operacion), porOperacion[operacion]);
+        }
+    }
+    if (segundos > 0) {
+        std::fprintf(informe, "Decodificado en %.3f s: %.0f registros/s, %.2f GB/s sin comprimir, %.2f GB/s en disco\n",
+                     segundos, registros / segundos, lector.bytesSinComprimir() / segundos / 1e9,
+                     lector.bytesEnDisco() / segundos / 1e9);
+    }
+    if (lector.danado()) {
+        std::fprintf(stderr, "Registro daado en el bloque que empieza en el byte %llu: %s. Los registros anteriores son vlidos.\n",
+                     static_cast<unsigned long long>(lector.posicionBloque()), lector.error());
+        return 1;
+    }
+    if (!lector.cerrado()) {
+        std::fprintf(stderr, "El registro no termina en una marca de cierre: sigue abierto, el proceso termin sin "
+                             "cerrarlo o le faltan bloques del final.\n");
+        return 1;
+    }
+    return 0;
+}
@@ -1,210 +1,120 @@
 #include <iostream>
 #include <string>
-#include <list>
-#include <algorithm>
 
-// Estructura para un producto
-// Representa los atributos bsicos de un producto en el inventario.
-struct Producto {
-    std::string nombre; // Nombre del producto.
-    double precio;      // Precio del producto.
-    int cantidad;       // Cantidad disponible en inventario.
-};
+#include "sistema_gestion.h"
+#include "servidor.h"
+#include "tuberia_comandos.h"
+#include "registro_almacenes.h"
+#include "traza.h"
+#include "eventos_traza.h"
+#include "metricas.h"
+#include "auditoria.h"
 
-// Estructura para una solicitud de compra
-// Almacena informacin sobre una solicitud registrada por algn cliente.
-struct Solicitud {
-    int id;             // Identificador nico de la solicitud.
-    std::string descripcion; // Descripcin de la solicitud.
-};
+DEFINIR_CONTEO_RESERVAS() // Con -DINSTRUMENTACION cuenta las reservas de memoria por operacin.
 
-// Estructura para un cliente
-// Representa a un cliente que est en espera.
-struct Cliente {
-    int id;             // Identificador nico del cliente.
-    std::string nombre; // Nombre del cliente.
-};
+// El servidor atiende muchas consultas por segundo: usa la tabla hash y colas en anillo.
+typedef SistemaGestionT<AlmacenHashPlano, ColaAnillo, HistorialVector> SistemaServidor;
 
-// Historial de cambios en el inventario
-// Permite llevar un registro de los cambios realizados, til para deshacer acciones.
-struct Cambio {
-    std::string tipo;   // Tipo de cambio: "agregar" o "eliminar".
-    Producto producto;  // Producto afectado por el cambio.
-};
-
-// Clase para la gestin del sistema
-// Contiene listas para manejar inventario, solicitudes, clientes en espera, y el historial de cambios.
-class SistemaGestion {
-private:
-    // Listas que almacenan la informacin principal del sistema.
-    std::list<Producto> inventario;        // Almacena los productos registrados.
-    std::list<Solicitud> solicitudes;     // Almacena las solicitudes pendientes.
-    std::list<Cliente> clientesEnEspera;  // Lista de clientes en espera.
-    std::list<Cambio> historialCambios;   // Registro de los cambios realizados en el inventario.
-
-public:
-    // Mtodos para la gestin de inventario
-    void registrarProducto(const Producto& producto);
-    void eliminarProducto(const std::string& nombreProducto);
-    void consultarProducto(const std::string& nombreProducto);
-    void listarProductos();
-
-    // Mtodos para la gestin de solicitudes
-    void registrarSolicitud(const Solicitud& solicitud);
-    void procesarSolicitud();
-    void consultarSolicitudEnProceso();
-    void listarSolicitudesPendientes();
-
-    // Mtodos para la gestin de clientes en espera
-    void registrarClienteEnEspera(const Cliente& cliente);
-    void atenderCliente();
-    void consultarListaDeEspera();
-
-    // Mtodos para la gestin del historial de cambios
-    void deshacerUltimaAccion();
-};
-
-// Implementacin de los mtodos del SistemaGestion
-
-// Mtodo para agregar un producto al inventario.
-void SistemaGestion::registrarProducto(const Producto& producto) {
-    inventario.push_back(producto); // Agrega el producto al final de la lista.
-    historialCambios.push_back({"agregar", producto}); // Registra el cambio en el historial.
-    std::cout << "Producto agregado: " << producto.nombre << std::endl;
-}
-
-// Mtodo para eliminar un producto del inventario.
-void SistemaGestion::eliminarProducto(const std::string& nombreProducto) {
-    // Busca el producto por su nombre usando std::find_if.
-    auto it = std::find_if(inventario.begin(), inventario.end(), [&](const Producto& p) {
-        return p.nombre == nombreProducto;
-    });
-
-    if (it != inventario.end()) {
-        // Si el producto existe, registra el cambio y lo elimina.
-        historialCambios.push_back({"eliminar", *it});
-        inventario.erase(it);
-        std::cout << "Producto eliminado: " << nombreProducto << std::endl;
-    } else {
-        std::cout << "Producto no encontrado." << std::endl;
-    }
-}
-
-// Mtodo para consultar informacin de un producto especfico.
-void SistemaGestion::consultarProducto(const std::string& nombreProducto) {
-    // Busca el producto por su nombre.
-    auto it = std::find_if(inventario.begin(), inventario.end(), [&](const Producto& p) {
-        return p.nombre == nombreProducto;
-    });
-
-    if (it != inventario.end()) {
-        // Si se encuentra, muestra su informacin.
-        std::cout << "Producto: " << it->nombre << ", Precio: " << it->precio << ", Cantidad: " << it->cantidad << std::endl;
-    } else {
-        std::cout << "Producto no encontrado." << std::endl;
+// Funcin principal con men interactivo.
+// Con --servidor <ruta-socket> [--tcp <puerto>] atiende peticiones por sockets en lugar del men.
+// Con --guion [archivo] [--secuencial] ejecuta un guion de peticiones de texto.
+// Con --grabar <archivo> muestra el men y graba cada comando en una traza (traza.h).
+// Antes de cualquiera de las anteriores se admiten:
+//   --eventos <archivo.json>  guarda al salir los eventos de traza en formato Chrome
+//                             (requiere compilar con -DEVENTOS_TRAZA).
+//   --metricas <direccin>    publica mtricas de Prometheus (metricas.h) en
+//                             "unix:/ruta" o en un puerto TCP de 127.0.0.1.
+//   --auditoria <archivo>     agrega cada modificacin de los almacenes a un registro
+//                             de auditora (auditoria.h); leer_auditoria lo lee.
+int main(int argc, char** argv) {
+    std::string rutaEventos, direccionMetricas, rutaAuditoria;
+    while (argc > 2) {
+        std::string prefijo = argv[1];
+        std::string* valor = prefijo == "--eventos" ? &rutaEventos
+                             : prefijo == "--metricas" ? &direccionMetricas
+                             : prefijo == "--auditoria" ? &rutaAuditoria
+                             : nullptr;
+        if (!valor) {
+            break;
+        }
+        *valor = argv[2];
+        argv[2] = argv[0];
+        argc -= 2;
+        argv += 2;
     }
-}
-
-// Mtodo para listar todos los productos en el inventario.
-void SistemaGestion::listarProductos() {
-    // Ordena los productos por nombre antes de mostrarlos.
-    inventario.sort([](const Producto& a, const Producto& b) {
-        return a.nombre < b.nombre;
-    });
-
-    for (const auto& producto : inventario) {
-        // Muestra cada producto en el inventario.
-        std::cout << "Producto: " << producto.nombre << ", Precio: " << producto.precio << ", Cantidad: " << producto.cantidad << std::endl;
+    if (!direccionMetricas.empty() && !metricasDisponibles()) {
+        std::cerr << "Las mtricas no estn disponibles en esta plataforma; se ignora --metricas." << std::endl;
+        direccionMetricas.clear();
     }
-}
-
-// Mtodo para registrar una nueva solicitud.
-void SistemaGestion::registrarSolicitud(const Solicitud& solicitud) {
-    solicitudes.push_back(solicitud); // Agrega la solicitud al final de la lista.
-    std::cout << "Solicitud registrada: " << solicitud.descripcion << std::endl;
-}
+    VolcadoEventosTraza volcadoEventos(rutaEventos); // Sin ruta no guarda nada.
 
-// Mtodo para procesar la primera solicitud en la lista.
-void SistemaGestion::procesarSolicitud() {
-    if (!solicitudes.empty()) {
-        auto solicitud = solicitudes.front(); // Obtiene la primera solicitud.
-        solicitudes.pop_front(); // La elimina de la lista.
-        std::cout << "Procesando solicitud: " << solicitud.descripcion << std::endl;
-    } else {
-        std::cout << "No hay solicitudes pendientes." << std::endl;
+    RegistroAuditoria registroAuditoria; // Vive ms que los sistemas que lo usan.
+    if (!rutaAuditoria.empty() && !registroAuditoria.abrir(rutaAuditoria)) {
+        std::cerr << "No se pudo abrir el registro de auditora " << rutaAuditoria << std::endl;
+        return 1;
     }
-}
+    RegistroAuditoria* auditoria = registroAuditoria.abierto() ? &registroAuditoria : nullptr;
 
-// Mtodo para consultar la solicitud en proceso (la primera de la lista).
-void SistemaGestion::consultarSolicitudEnProceso() {
-    if (!solicitudes.empty()) {
-        auto solicitud = solicitudes.front();
-        std::cout << "Solicitud en proceso: " << solicitud.descripcion << std::endl;
-    } else {
-        std::cout << "No hay solicitudes en proceso." << std::endl;
-    }
-}
+    // Lanza el hilo de mtricas si se pidi; cada modo le dice qu almacenes publicar.
+    auto publicarMetricas = [&direccionMetricas](ServidorMetricas& metricas, ServidorMetricas::Recolector recolector) {
+        if (direccionMetricas.empty() || metricas.iniciar(direccionMetricas, recolector)) {
+            return true;
+        }
+        std::cerr << "No se pudo publicar mtricas en " << direccionMetricas << std::endl;
+        return false;
+    };
 
-// Mtodo para listar todas las solicitudes pendientes.
-void SistemaGestion::listarSolicitudesPendientes() {
-    for (const auto& solicitud : solicitudes) {
-        std::cout << "Solicitud pendiente: " << solicitud.descripcion << std::endl;
+    if (argc > 1 && std::string(argv[1]) == "--servidor") {
+        if (!servidorDisponible()) {
+            std::cerr << "El modo servidor no est disponible en esta plataforma (usa epoll de Linux)." << std::endl;
+            return 1;
+        }
+        SistemaServidor sistemaServidor;
+        sistemaServidor.fijarAuditoria(auditoria, "servidor");
+        sistemaServidor.activarIndices();
+        ServidorMetricas metricas;
+        if (!publicarMetricas(metricas, [&sistemaServidor](std::vector<MuestraAlmacen>& muestras) {
+                muestras.push_back(tomarMuestra("servidor", sistemaServidor));
+            })) {
+            return 1;
+        }
+        return ejecutarModoServidor(sistemaServidor, argc, argv);
     }
-}
-
-// Mtodo para registrar un cliente en espera.
-void SistemaGestion::registrarClienteEnEspera(const Cliente& cliente) {
-    clientesEnEspera.push_back(cliente); // Agrega el cliente al final de la lista.
-    std::cout << "Cliente registrado: " << cliente.nombre << std::endl;
-}
-
-// Mtodo para atender al primer cliente en espera.
-void SistemaGestion::atenderCliente() {
-    if (!clientesEnEspera.empty()) {
-        auto cliente = clientesEnEspera.front(); // Obtiene el primer cliente.
-        clientesEnEspera.pop_front(); // Lo elimina de la lista.
-        std::cout << "Atendiendo cliente: " << cliente.nombre << std::endl;
-    } else {
-        std::cout << "No hay clientes en espera." << std::endl;
+    if (argc > 1 && std::string(argv[1]) == "--guion") {
+        SistemaServidor sistemaGuion;
+        sistemaGuion.fijarAuditoria(auditoria, "guion");
+        sistemaGuion.activarIndices();
+        ServidorMetricas metricas;
+        if (!publicarMetricas(metricas, [&sistemaGuion](std::vector<MuestraAlmacen>& muestras) {
+                muestras.push_back(tomarMuestra("guion", sistemaGuion));
+            })) {
+            return 1;
+        }
+        return ejecutarModoGuion(sistemaGuion, argc, argv);
     }
-}
 
-// Mtodo para consultar todos los clientes en espera.
-void SistemaGestion::consultarListaDeEspera() {
-    for (const auto& cliente : clientesEnEspera) {
-        std::cout << "Cliente en espera: " << cliente.nombre << std::endl;
+    GrabadorSesion grabador; // Solo graba si se pidi --grabar.
+    if (argc > 2 && std::string(argv[1]) == "--grabar" && !grabador.abrir(argv[2])) {
+        std::cerr << "No se pudo crear la traza " << argv[2] << std::endl;
+        return 1;
     }
-}
 
-// Mtodo para deshacer la ltima accin registrada en el historial.
-void SistemaGestion::deshacerUltimaAccion() {
-    if (!historialCambios.empty()) {
-        auto cambio = historialCambios.back();
-        historialCambios.pop_back(); // Elimina el ltimo cambio del historial.
+    RegistroAlmacenes<SistemaGestion> almacenes; // Un sistema de gestin por almacn.
+    std::string almacenActivo = "principal";
+    SistemaGestion* sistema = almacenes.crearAlmacen(almacenActivo); // Almacn sobre el que trabaja el men.
+    sistema->fijarAuditoria(auditoria, almacenActivo);
+    sistema->activarIndices();
+    int opcion;
+    int siguienteId = 1; // Identificador de la prxima solicitud o cliente, como en el protocolo de texto.
 
-        if (cambio.tipo == "agregar") {
-            // Si fue un agregado, elimina el producto del inventario.
-            auto it = std::find_if(inventario.begin(), inventario.end(), [&](const Producto& p) {
-                return p.nombre == cambio.producto.nombre;
+    ServidorMetricas metricas; // Se detiene antes de destruir los almacenes.
+    if (!publicarMetricas(metricas, [&almacenes](std::vector<MuestraAlmacen>& muestras) {
+            almacenes.recorrerAlmacenes([&muestras](const std::string& nombre, SistemaGestion& sistema) {
+                muestras.push_back(tomarMuestra(nombre, sistema));
             });
-            if (it != inventario.end()) {
-                inventario.erase(it);
-                std::cout << "Deshacer: Producto agregado eliminado: " << cambio.producto.nombre << std::endl;
-            }
-        } else if (cambio.tipo == "eliminar") {
-            // Si fue una eliminacin, restaura el producto en el inventario.
-            inventario.push_back(cambio.producto);
-            std::cout << "Deshacer: Producto eliminado restaurado: " << cambio.producto.nombre << std::endl;
-        }
-    } else {
-        std::cout << "No hay cambios para deshacer." << std::endl;
+        })) {
+        return 1;
     }
-}
-
-// Funcin principal con men interactivo.
-int main() {
-    SistemaGestion sistema; // Instancia del sistema de gestin.
-    int opcion;
 
     do {
         // Mostrar el men al usuario.
@@ -222,6 +132,20 @@ int main() {
         std::cout << "11. Consultar Lista de Espera\n";
         std::cout << "12. Deshacer ltima Accin\n";
         std::cout << "13. Salir\n";
+        std::cout << "14. Congelar Catlogo\n";
+        std::cout << "15. Descongelar Catlogo\n";
+        std::cout << "16. Guardar Catlogo en Archivo\n";
+        std::cout << "17. Cargar Catlogo desde Archivo\n";
+        std::cout << "18. Publicar Inventario en Memoria Compartida\n";
+        std::cout << "19. Cambiar de Almacn\n";
+        std::cout << "20. Buscar Producto en Todos los Almacenes\n";
+        std::cout << "21. Valoracin Global\n";
+        std::cout << "22. Latencias por Operacin\n";
+        std::cout << "23. Reiniciar Latencias\n";
+        std::cout << "24. Memoria por Estructura\n";
+        std::cout << "25. Alerta de Memoria\n";
+        std::cout << "26. Autocompletar Producto\n";
+        std::cout << "27. Buscar Solicitudes Pendientes\n";
         std::cout << "Seleccione una opcin: ";
         
         std::cin >> opcion; // Lee la opcin seleccionada por el usuario.
@@ -236,65 +160,193 @@ int main() {
                 std::cin >> producto.precio;
                 std::cout << "Ingrese cantidad del producto: ";
                 std::cin >> producto.cantidad;
-                sistema.registrarProducto(producto);
+                grabador.grabar(producto);
+                sistema->registrarProducto(producto);
                 break;
             }
             case 2: {
                 std::string nombre;
                 std::cout << "Ingrese nombre del producto a eliminar: ";
                 std::cin >> nombre;
-                sistema.eliminarProducto(nombre);
+                grabador.grabar(2, nombre);
+                sistema->eliminarProducto(nombre);
                 break;
             }
             case 3: {
                 std::string nombre;
                 std::cout << "Ingrese nombre del producto a consultar: ";
                 std::cin >> nombre;
-                sistema.consultarProducto(nombre);
+                grabador.grabar(3, nombre);
+                sistema->consultarProducto(nombre);
                 break;
             }
             case 4:
-                sistema.listarProductos();
+                grabador.grabar(4);
+                sistema->listarProductos();
                 break;
             case 5: {
                 Solicitud solicitud;
+                solicitud.id = siguienteId++;
                 std::cout << "Ingrese descripcin de la solicitud: ";
                 std::cin.ignore(); // Limpia el buffer de entrada.
                 std::getline(std::cin, solicitud.descripcion);
-                sistema.registrarSolicitud(solicitud);
+                grabador.grabar(5, solicitud.descripcion);
+                sistema->registrarSolicitud(solicitud);
                 break;
             }
             case 6:
-                sistema.procesarSolicitud();
+                grabador.grabar(6);
+                sistema->procesarSolicitud();
                 break;
             case 7:
-                sistema.consultarSolicitudEnProceso();
+                grabador.grabar(7);
+                sistema->consultarSolicitudEnProceso();
                 break;
             case 8:
-                sistema.listarSolicitudesPendientes();
+                grabador.grabar(8);
+                sistema->listarSolicitudesPendientes();
                 break;
             case 9: {
                 Cliente cliente;
+                cliente.id = siguienteId++;
                 std::cout << "Ingrese nombre del cliente en espera: ";
                 std::cin >> cliente.nombre;
-                sistema.registrarClienteEnEspera(cliente);
+                grabador.grabar(9, cliente.nombre);
+                sistema->registrarClienteEnEspera(cliente);
                 break;
             }
             case 10:
-                sistema.atenderCliente();
+                grabador.grabar(10);
+                sistema->atenderCliente();
                 break;
             case 11:
-                sistema.consultarListaDeEspera();
+                grabador.grabar(11);
+                sistema->consultarListaDeEspera();
                 break;
             case 12:
-                sistema.deshacerUltimaAccion();
+                grabador.grabar(12);
+                sistema->deshacerUltimaAccion();
                 break;
             case 13:
                 std::cout << "Saliendo del sistema...\n";
                 break;
+            case 14:
+                grabador.grabar(14);
+                sistema->congelarCatalogo();
+                break;
+            case 15:
+                grabador.grabar(15);
+                sistema->descongelarCatalogo();
+                break;
+            case 16: {
+                std::string ruta;
+                std::cout << "Ingrese ruta del archivo del catlogo: ";
+                std::cin >> ruta;
+                grabador.grabar(16, ruta);
+                sistema->guardarCatalogo(ruta);
+                break;
+            }
+            case 17: {
+                std::string ruta;
+                std::cout << "Ingrese ruta del archivo del catlogo: ";
+                std::cin >> ruta;
+                grabador.grabar(17, ruta);
+                sistema->cargarCatalogo(ruta);
+                break;
+            }
+            case 18: {
+                std::string region;
+                std::cout << "Ingrese nombre de la regin (por ejemplo /inventario): ";
+                std::cin >> region;
+                grabador.grabar(18, region);
+                sistema->publicarReplica(region);
+                break;
+            }
+            case 19: {
+                std::cout << "Ingrese nombre del almacn: ";
+                std::cin >> almacenActivo;
+                grabador.grabar(19, almacenActivo);
+                SistemaGestion* existente = almacenes.almacen(almacenActivo);
+                if (existente) {
+                    sistema = existente;
+                    std::cout << "Almacn activo: " << almacenActivo << std::endl;
+                } else {
+                    sistema = almacenes.crearAlmacen(almacenActivo);
+                    sistema->fijarAuditoria(auditoria, almacenActivo);
+                    sistema->activarIndices();
+                    std::cout << "Almacn creado y activo: " << almacenActivo << std::endl;
+                }
+                break;
+            }
+            case 20: {
+                std::string nombre;
+                std::cout << "Ingrese nombre del producto a buscar: ";
+                std::cin >> nombre;
+                grabador.grabar(20, nombre);
+                std::vector<RegistroAlmacenes<SistemaGestion>::Existencia> existencias = almacenes.dondeHay(nombre);
+                long long total = 0;
+                for (const auto& existencia : existencias) {
+                    std::cout << "Almacn: " << *existencia.almacen << ", Precio: " << existencia.producto.precio
+                              << ", Cantidad: " << existencia.producto.cantidad << std::endl;
+                    total += existencia.producto.cantidad;
+                }
+                if (existencias.empty()) {
+                    std::cout << "No hay existencias de " << nombre << " en ningn almacn." << std::endl;
+                } else {
+                    std::cout << "Existencias totales de " << nombre << ": " << total << std::endl;
+                }
+                break;
+            }
+            case 21: {
+                grabador.grabar(21);
+                ValoracionInventario valoracion = almacenes.valoracionGlobal();
+                std::cout << "Valoracin global: " << almacenes.cantidad() << " almacenes, " << valoracion.productos
+                          << " productos, " << valoracion.unidades << " unidades, valor total: " << valoracion.valor << std::endl;
+                break;
+            }
+            case 22:
+                grabador.grabar(22);
+                sistema->imprimirLatencias();
+                imprimirInstrumentacion(std::cout); // Solo con -DINSTRUMENTACION.
+                break;
+            case 23:
+                grabador.grabar(23);
+                sistema->reiniciarLatencias();
+                reiniciarInstrumentacion();
+                break;
+            case 24:
+                grabador.grabar(24);
+                sistema->imprimirMemoria();
+                break;
+            case 25: {
+                long long umbral = 0;
+                std::cout << "Ingrese el umbral en bytes (0 para desactivar): ";
+                std::cin >> umbral;
+                grabador.grabar(25, std::to_string(umbral));
+                sistema->fijarAlertaMemoria(umbral);
+                break;
+            }
+            case 26: {
+                std::string prefijo;
+                std::cout << "Ingrese el comienzo del nombre: ";
+                std::cin >> prefijo;
+                grabador.grabar(26, prefijo);
+                sistema->autocompletarProducto(prefijo);
+                break;
+            }
+            case 27: {
+                std::string palabras;
+                std::cout << "Ingrese las palabras a buscar: ";
+                std::cin.ignore(); // Limpia el buffer de entrada.
+                std::getline(std::cin, palabras);
+                grabador.grabar(27, palabras);
+                sistema->buscarSolicitudesPendientes(palabras);
+                break;
+            }
             default:
                 std::cout << "Opcin no vlida.\n";
         }
+        registroAuditoria.volcar(); // En el men cada operacin queda en disco enseguida.
     } while (opcion != 13); // El men sigue apareciendo hasta que el usuario elija salir.
 
     return 0;
@@ -0,0 +1,246 @@
+#ifndef MEMORIA_ESTRUCTURAS_H
+#define MEMORIA_ESTRUCTURAS_H
+
+// Contabilidad de memoria por estructura
+// Cada poltica de almacenamiento (politicas.h) lleva la cuenta de los bytes que
+// ocupa, actualizada en cada insercin y extraccin, as que consultarla cuesta unas
+// pocas lecturas atmicas. Los bytes se reparten en:
+//   carga          lo que aportan los datos: caracteres de los nombres y descripciones,
+//                  precio, cantidad e identificadores;
+//   sobrecarga     el resto de lo pedido al asignador: punteros de los nodos, cabeceras
+//                  de std::string, capacidad sin usar de cadenas y arreglos, hashes;
+//   fragmentacin  lo que el asignador agrega a cada bloque: su cabecera y el redondeo
+//                  al tamao de bloque.
+//
+// El tamao de los nodos de std::list y los bloques del asignador siguen a libstdc++ y
+// glibc (bloques de 16 bytes, mnimo 32, 8 de cabecera); con otras bibliotecas las
+// cifras son una aproximacin. Las ranuras que quedan libres se vacan con
+// vaciarRanura, as no retienen memoria que no se cuenta.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <utility>
+
+#include "estructuras.h"
+
+struct MemoriaEstructura {
+    MemoriaEstructura() : elementos(0), carga(0), sobrecarga(0), fragmentacion(0) {}
+    int64_t elementos;
+    int64_t carga;
+    int64_t sobrecarga;
+    int64_t fragmentacion;
+
+    int64_t total() const { return carga + sobrecarga + fragmentacion; }
+
+    MemoriaEstructura& operator+=(const MemoriaEstructura& otra) {
+        elementos += otra.elementos;
+        carga += otra.carga;
+        sobrecarga += otra.sobrecarga;
+        fragmentacion += otra.fragmentacion;
+        return *this;
+    }
+};
+
+// Bytes que ocupa en el asignador un bloque pedido de n bytes.
+inline std::size_t bloqueAsignador(std::size_t pedido) {
+    const std::size_t cabecera = sizeof(std::size_t);
+    const std::size_t alineacion = 2 * sizeof(std::size_t);
+    const std::size_t minimo = 4 * sizeof(std::size_t);
+    const std::size_t umbralMmap = 128 * 1024; // Los bloques grandes van a mmap, por pginas.
+    if (pedido + cabecera >= umbralMmap) {
+        return (pedido + 2 * cabecera + 4095) & ~static_cast<std::size_t>(4095);
+    }
+    std::size_t bloque = (pedido + cabecera + alineacion - 1) & ~(alineacion - 1);
+    return bloque < minimo ? minimo : bloque;
+}
+
+// Un bloque del montn sin datos: todo es sobrecarga ms la fragmentacin.
+inline MemoriaEstructura bloqueMonton(std::size_t pedido) {
+    MemoriaEstructura memoria;
+    if (pedido > 0) {
+        memoria.sobrecarga = static_cast<int64_t>(pedido);
+        memoria.fragmentacion = static_cast<int64_t>(bloqueAsignador(pedido) - pedido);
+    }
+    return memoria;
+}
+
+// Bytes del objeto que ya cont su contenedor (el nodo o el arreglo) y que son datos:
+// pasan de sobrecarga a carga.
+inline void contarCargaEnLinea(MemoriaEstructura& memoria, std::size_t bytes) {
+    memoria.carga += static_cast<int64_t>(bytes);
+    memoria.sobrecarga -= static_cast<int64_t>(bytes);
+}
+
+// Una cadena guarda sus caracteres dentro del objeto (cadenas cortas) o en un bloque aparte.
+inline void contarCadena(MemoriaEstructura& memoria, const std::string& cadena) {
+    const char* datos = cadena.data();
+    const char* objeto = reinterpret_cast<const char*>(&cadena);
+    if (datos >= objeto && datos < objeto + sizeof(cadena)) {
+        contarCargaEnLinea(memoria, cadena.size());
+    } else {
+        memoria += bloqueMonton(cadena.capacity() + 1);
+        contarCargaEnLinea(memoria, cadena.size());
+    }
+}
+
+inline void contarElemento(MemoriaEstructura& memoria, const Producto& producto) {
+    contarCadena(memoria, producto.nombre);
+    contarCargaEnLinea(memoria, sizeof(producto.precio) + sizeof(producto.cantidad));
+}
+
+inline void contarElemento(MemoriaEstructura& memoria, const Solicitud& solicitud) {
+    contarCadena(memoria, solicitud.descripcion);
+    contarCargaEnLinea(memoria, sizeof(solicitud.id));
+}
+
+inline void contarElemento(MemoriaEstructura& memoria, const Cliente& cliente) {
+    contarCadena(memoria, cliente.nombre);
+    contarCargaEnLinea(memoria, sizeof(cliente.id));
+}
+
+inline void contarElemento(MemoriaEstructura& memoria, const Cambio& cambio) {
+    contarCadena(memoria, cambio.tipo);
+    contarElemento(memoria, cambio.producto);
+}
+
+// Cualquier otro tipo: el objeto entero es carga.
+template <class T>
+void contarElemento(MemoriaEstructura& memoria, const T&) {
+    contarCargaEnLinea(memoria, sizeof(T));
+}
+
+// Un elemento vivo dentro de un arreglo (el arreglo se cuenta aparte).
+template <class T>
+MemoriaEstructura memoriaEnArreglo(const T& valor) {
+    MemoriaEstructura memoria;
+    memoria.elementos = 1;
+    contarElemento(memoria, valor);
+    return memoria;
+}
+
+// Un elemento en su propio nodo de bytesNodo bytes.
+template <class T>
+MemoriaEstructura memoriaEnNodo(const T& valor, std::size_t bytesNodo) {
+    MemoriaEstructura memoria = bloqueMonton(bytesNodo);
+    memoria.elementos = 1;
+    contarElemento(memoria, valor);
+    return memoria;
+}
+
+// Nodo de std::list<T> en libstdc++: dos punteros y el valor.
+template <class T>
+std::size_t bytesNodoLista() {
+    std::size_t enlaces = 2 * sizeof(void*);
+    std::size_t alineacion = alignof(T) > alignof(void*) ? alignof(T) : alignof(void*);
+    return (enlaces + alineacion - 1) / alineacion * alineacion + sizeof(T);
+}
+
+// Deja una ranura de la que se movi el valor como recin construida. Asignarle T()
+// no basta: una cadena que recibi un movimiento puede conservar el bloque que tena
+// su destino, y la asignacin desde una cadena corta no lo suelta.
+template <class T>
+void vaciarRanura(T& ranura) {
+    T liberado(std::move(ranura)); // Se lleva los bloques y los libera al salir.
+    ranura = T();
+}
+
+// Acumulador que mantiene cada estructura. Es atmico para que otro hilo (las
+// mtricas) pueda leerlo sin cerrojos; las escrituras las hace quien modifica la
+// estructura. Se copia por valor al reemplazar la estructura (inventario = A()).
+class ContadorMemoria {
+public:
+    ContadorMemoria() : elementos(0), carga(0), sobrecarga(0), fragmentacion(0) {}
+    ContadorMemoria(const ContadorMemoria& otro) : elementos(0), carga(0), sobrecarga(0), fragmentacion(0) { *this = otro; }
+    ContadorMemoria& operator=(const ContadorMemoria& otro) {
+        MemoriaEstructura valor = otro.leer();
+        elementos.store(valor.elementos, std::memory_order_relaxed);
+        carga.store(valor.carga, std::memory_order_relaxed);
+        sobrecarga.store(valor.sobrecarga, std::memory_order_relaxed);
+        fragmentacion.store(valor.fragmentacion, std::memory_order_relaxed);
+        return *this;
+    }
+
+    void sumar(const MemoriaEstructura& delta) { aplicar(delta, 1); }
+    void restar(const MemoriaEstructura& delta) { aplicar(delta, -1); }
+
+    // Un arreglo cambi de capacidad: reemplaza su bloque.
+    void cambiarBloque(std::size_t bytesAntes, std::size_t bytesDespues) {
+        if (bytesAntes != bytesDespues) {
+            restar(bloqueMonton(bytesAntes));
+            sumar(bloqueMonton(bytesDespues));
+        }
+    }
+
+    MemoriaEstructura leer() const {
+        MemoriaEstructura valor;
+        valor.elementos = elementos.load(std::memory_order_relaxed);
+        valor.carga = carga.load(std::memory_order_relaxed);
+        valor.sobrecarga = sobrecarga.load(std::memory_order_relaxed);
+        valor.fragmentacion = fragmentacion.load(std::memory_order_relaxed);
+        return valor;
+    }
+
+private:
+    void aplicar(const MemoriaEstructura& delta, int64_t signo) {
+        elementos.fetch_add(signo * delta.elementos, std::memory_order_relaxed);
+        carga.fetch_add(signo * delta.carga, std::memory_order_relaxed);
+        sobrecarga.fetch_add(signo * delta.sobrecarga, std::memory_order_relaxed);
+        fragmentacion.fetch_add(signo * delta.fragmentacion, std::memory_order_relaxed);
+    }
+
+    std::atomic<int64_t> elementos;
+    std::atomic<int64_t> carga;
+    std::atomic<int64_t> sobrecarga;
+    std::atomic<int64_t> fragmentacion;
+};
+
+// Las cuatro estructuras de SistemaGestion, en el orden del reporte.
+enum EstructuraSistema {
+    EstructuraInventario,
+    EstructuraSolicitudes,
+    EstructuraClientes,
+    EstructuraHistorial,
+    CANTIDAD_ESTRUCTURAS
+};
+
+inline const char* nombreEstructura(int estructura) {
+    static const char* const nombres[CANTIDAD_ESTRUCTURAS] = {"inventario", "solicitudes", "clientesEnEspera",
+                                                              "historialCambios"};
+    return estructura >= 0 && estructura < CANTIDAD_ESTRUCTURAS ? nombres[estructura] : "?";
+}
+
+struct MemoriaSistema {
+    MemoriaEstructura estructuras[CANTIDAD_ESTRUCTURAS];
+
+    MemoriaEstructura total() const {
+        MemoriaEstructura suma;
+        for (const MemoriaEstructura& memoria : estructuras) {
+            suma += memoria;
+        }
+        return suma;
+    }
+};
+
+// Tabla con el desglose de cada estructura y el total, en bytes.
+inline void imprimirMemoriaSistema(std::ostream& salida, const MemoriaSistema& memoria) {
+    char linea[160];
+    std::snprintf(linea, sizeof(linea), "%-18s %10s %12s %12s %12s %12s %9s\n", "Estructura", "elementos", "carga",
+                  "sobrecarga", "fragment.", "total", "B/elem.");
+    salida << linea;
+    for (int i = 0; i <= CANTIDAD_ESTRUCTURAS; ++i) {
+        bool total = i == CANTIDAD_ESTRUCTURAS;
+        MemoriaEstructura m = total ? memoria.total() : memoria.estructuras[i];
+        double porElemento = m.elementos > 0 ? static_cast<double>(m.total()) / m.elementos : 0.0;
+        std::snprintf(linea, sizeof(linea), "%-18s %10lld %12lld %12lld %12lld %12lld %9.1f\n",
+                      total ? "total" : nombreEstructura(i), static_cast<long long>(m.elementos),
+                      static_cast<long long>(m.carga), static_cast<long long>(m.sobrecarga),
+                      static_cast<long long>(m.fragmentacion), static_cast<long long>(m.total()), porElemento);
+        salida << linea;
+    }
+}
+
+#endif
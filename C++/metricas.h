@@ -0,0 +1,411 @@
+#ifndef METRICAS_H
+#define METRICAS_H
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+#ifdef __linux__
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
+
+#include "histograma_latencia.h"
+#include "sistema_gestion.h"
+#include "nombres_normalizados.h"
+
+// Mtricas en formato de texto de Prometheus
+// Un hilo en segundo plano atiende GET por HTTP en un socket de dominio Unix o en TCP
+// de loopback y responde con el estado del proceso: operaciones ejecutadas (y por
+// segundo desde el raspado anterior), tamao del inventario, las colas y el historial
+// de cada almacn, latencias por operacin, memoria de cada estructura y del proceso.
+//
+// Nada de esto toma cerrojos en el camino de las operaciones: los contadores de
+// operaciones son por hilo (contadores_hilo.h) y se suman al raspar; los tamaos y los
+// histogramas son atmicos relajados que el sistema ya mantiene. El raspado ve una foto
+// aproximada, nunca valores rotos.
+//
+// Direccin: "unix:/ruta/del/socket" o un nmero de puerto TCP en 127.0.0.1.
+//   curl --unix-socket /tmp/sg-metricas.sock http://localhost/metrics
+//   curl http://127.0.0.1:9464/metrics
+
+// Lo que se publica de un almacn, copiado en el momento del raspado.
+struct MuestraAlmacen {
+    struct Latencia {
+        uint64_t cuenta;
+        uint64_t sumaNanos;
+        uint64_t cuantiles[4]; // p50, p90, p99, p99.9 en nanosegundos.
+    };
+
+    std::string almacen;
+    uint64_t productos;
+    uint64_t solicitudes;
+    uint64_t clientes;
+    uint64_t historial;
+    Latencia latencias[CANTIDAD_OPERACIONES_SISTEMA];
+    MemoriaSistema memoria;
+};
+
+static const double CUANTILES_METRICAS[4] = {0.5, 0.9, 0.99, 0.999};
+
+template <class Sistema>
+MuestraAlmacen tomarMuestra(const std::string& almacen, Sistema& sistema) {
+    MuestraAlmacen muestra;
+    muestra.almacen = almacen;
+    const TamanosSistema& tamanos = sistema.tamanos();
+    muestra.productos = tamanos.productos.load(std::memory_order_relaxed);
+    muestra.solicitudes = tamanos.solicitudes.load(std::memory_order_relaxed);
+    muestra.clientes = tamanos.clientes.load(std::memory_order_relaxed);
+    muestra.historial = tamanos.historial.load(std::memory_order_relaxed);
+    muestra.memoria = sistema.memoria();
+    for (int i = 0; i < CANTIDAD_OPERACIONES_SISTEMA; ++i) {
+        const HistogramaLatencia& h = sistema.latencias().operacion(static_cast<OperacionSistema>(i));
+        MuestraAlmacen::Latencia& l = muestra.latencias[i];
+        l.cuenta = h.cantidad();
+        l.sumaNanos = h.sumaTotal();
+        for (int q = 0; q < 4; ++q) {
+            l.cuantiles[q] = h.percentil(CUANTILES_METRICAS[q]);
+        }
+    }
+    return muestra;
+}
+
+// Valor de etiqueta con las secuencias de escape del formato (\\, \" y \n). El formato
+// exige UTF-8 y los nombres llegan en UTF-8 (la terminal, el servidor) o en Latin-1 (los
+// archivos del proyecto): las secuencias UTF-8 vlidas pasan tal cual y cada byte alto
+// suelto se toma como Latin-1 y ocupa dos.
+inline std::string escaparEtiqueta(const std::string& valor) {
+    std::string escapado;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(valor.data());
+    const unsigned char* fin = p + valor.size();
+    while (p < fin) {
+        unsigned char byte = *p;
+        if (byte == '\\' || byte == '"') {
+            escapado += '\\';
+            escapado += static_cast<char>(byte);
+        } else if (byte == '\n') {
+            escapado += "\\n";
+        } else if (byte >= 0x80) {
+            std::size_t longitud = longitudUtf8(p, fin);
+            if (longitud > 0) {
+                escapado.append(reinterpret_cast<const char*>(p), longitud);
+                p += longitud;
+                continue;
+            }
+            escapado += static_cast<char>(0xC0 | (byte >> 6));
+            escapado += static_cast<char>(0x80 | (byte & 0x3F));
+        } else {
+            escapado += static_cast<char>(byte);
+        }
+        ++p;
+    }
+    return escapado;
+}
+
+// Memoria virtual y residente del proceso en bytes; false si no se puede leer.
+inline bool memoriaProceso(uint64_t& virtualBytes, uint64_t& residenteBytes) {
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    uint64_t paginas = 0, residentes = 0;
+    if (!(statm >> paginas >> residentes)) {
+        return false;
+    }
+    uint64_t pagina = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+    virtualBytes = paginas * pagina;
+    residenteBytes = residentes * pagina;
+    return true;
+#else
+    virtualBytes = residenteBytes = 0;
+    return false;
+#endif
+}
+
+// Arma el texto de un raspado. Agrupa cada familia de mtricas con su HELP y TYPE,
+// como exige el formato, aunque haya varios almacenes. Los textos de ayuda van sin
+// acentos: el formato es UTF-8 y los fuentes estn en Latin-1.
+inline std::string formatearMetricas(const std::vector<MuestraAlmacen>& muestras, const uint64_t (&operaciones)[CANTIDAD_OPERACIONES_SISTEMA],
+                                     double operacionesPorSegundo) {
+    std::ostringstream texto;
+    char numero[64];
+
+    texto << "# HELP sistema_operaciones_total Operaciones de SistemaGestion ejecutadas en el proceso.\n"
+          << "# TYPE sistema_operaciones_total counter\n";
+    for (int i = 0; i < CANTIDAD_OPERACIONES_SISTEMA; ++i) {
+        texto << "sistema_operaciones_total{operacion=\"" << nombreOperacionSistema(i) << "\"} " << operaciones[i] << "\n";
+    }
+    std::snprintf(numero, sizeof(numero), "%.3f", operacionesPorSegundo);
+    texto << "# HELP sistema_operaciones_por_segundo Operaciones por segundo desde el raspado anterior.\n"
+          << "# TYPE sistema_operaciones_por_segundo gauge\n"
+          << "sistema_operaciones_por_segundo " << numero << "\n";
+
+    struct Familia {
+        const char* nombre;
+        const char* ayuda;
+        uint64_t MuestraAlmacen::*campo;
+    };
+    static const Familia familias[] = {
+        {"sistema_productos", "Productos en el inventario (o en el catalogo congelado).", &MuestraAlmacen::productos},
+        {"sistema_solicitudes_pendientes", "Solicitudes en la cola.", &MuestraAlmacen::solicitudes},
+        {"sistema_clientes_en_espera", "Clientes en la lista de espera.", &MuestraAlmacen::clientes},
+        {"sistema_historial_cambios", "Cambios guardados en el historial para deshacer.", &MuestraAlmacen::historial},
+    };
+    for (const Familia& familia : familias) {
+        texto << "# HELP " << familia.nombre << " " << familia.ayuda << "\n"
+              << "# TYPE " << familia.nombre << " gauge\n";
+        for (const MuestraAlmacen& muestra : muestras) {
+            texto << familia.nombre << "{almacen=\"" << escaparEtiqueta(muestra.almacen) << "\"} " << muestra.*familia.campo << "\n";
+        }
+    }
+
+    texto << "# HELP sistema_latencia_segundos Latencia de cada operacion por almacen.\n"
+          << "# TYPE sistema_latencia_segundos summary\n";
+    for (const MuestraAlmacen& muestra : muestras) {
+        std::string almacen = escaparEtiqueta(muestra.almacen);
+        for (int i = 0; i < CANTIDAD_OPERACIONES_SISTEMA; ++i) {
+            const MuestraAlmacen::Latencia& l = muestra.latencias[i];
+            if (l.cuenta == 0) continue;
+            std::string etiquetas = "almacen=\"" + almacen + "\",operacion=\"" + nombreOperacionSistema(i) + "\"";
+            for (int q = 0; q < 4; ++q) {
+                std::snprintf(numero, sizeof(numero), "%g\"} %.9f\n", CUANTILES_METRICAS[q], l.cuantiles[q] / 1e9);
+                texto << "sistema_latencia_segundos{" << etiquetas << ",quantile=\"" << numero;
+            }
+            std::snprintf(numero, sizeof(numero), "%.9f", l.sumaNanos / 1e9);
+            texto << "sistema_latencia_segundos_sum{" << etiquetas << "} " << numero << "\n"
+                  << "sistema_latencia_segundos_count{" << etiquetas << "} " << l.cuenta << "\n";
+        }
+    }
+
+    texto << "# HELP sistema_memoria_bytes Memoria de cada estructura: carga, sobrecarga y fragmentacion del asignador.\n"
+          << "# TYPE sistema_memoria_bytes gauge\n";
+    for (const MuestraAlmacen& muestra : muestras) {
+        std::string almacen = escaparEtiqueta(muestra.almacen);
+        for (int i = 0; i < CANTIDAD_ESTRUCTURAS; ++i) {
+            const MemoriaEstructura& m = muestra.memoria.estructuras[i];
+            std::string etiquetas = "almacen=\"" + almacen + "\",estructura=\"" + nombreEstructura(i) + "\",tipo=\"";
+            texto << "sistema_memoria_bytes{" << etiquetas << "carga\"} " << m.carga << "\n"
+                  << "sistema_memoria_bytes{" << etiquetas << "sobrecarga\"} " << m.sobrecarga << "\n"
+                  << "sistema_memoria_bytes{" << etiquetas << "fragmentacion\"} " << m.fragmentacion << "\n";
+        }
+    }
+
+    uint64_t virtualBytes = 0, residenteBytes = 0;
+    if (memoriaProceso(virtualBytes, residenteBytes)) {
+        texto << "# HELP process_resident_memory_bytes Memoria residente del proceso.\n"
+              << "# TYPE process_resident_memory_bytes gauge\n"
+              << "process_resident_memory_bytes " << residenteBytes << "\n"
+              << "# HELP process_virtual_memory_bytes Memoria virtual del proceso.\n"
+              << "# TYPE process_virtual_memory_bytes gauge\n"
+              << "process_virtual_memory_bytes " << virtualBytes << "\n";
+    }
+    return texto.str();
+}
+
+// Las mtricas se sirven con sockets POSIX: solo en Linux. En el resto (el proyecto de
+// Dev-C++ en Windows incluido) el archivo compila igual e iniciar() no hace nada.
+inline bool metricasDisponibles() {
+#ifdef __linux__
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Servidor de mtricas en un hilo propio.
+class ServidorMetricas {
+public:
+    // Agrega a la lista una muestra por almacn; se llama desde el hilo de mtricas.
+    typedef std::function<void(std::vector<MuestraAlmacen>&)> Recolector;
+
+    ServidorMetricas() : escucha(-1), detenido(false), raspados(0), anteriorTotal(0) {}
+    ~ServidorMetricas() { detener(); }
+
+    ServidorMetricas(const ServidorMetricas&) = delete;
+    ServidorMetricas& operator=(const ServidorMetricas&) = delete;
+
+    // Empieza a escuchar en la direccin y lanza el hilo; false si no se pudo.
+    bool iniciar(const std::string& direccion, Recolector nuevoRecolector) {
+#ifdef __linux__
+        if (direccion.compare(0, 5, "unix:") == 0) {
+            escucha = escucharUnix(direccion.substr(5));
+        } else {
+            int puerto = std::atoi(direccion.c_str());
+            escucha = puerto > 0 && puerto < 65536 ? escucharTcp(puerto) : -1;
+        }
+        if (escucha < 0) {
+            return false;
+        }
+        recolector = nuevoRecolector;
+        anteriorInstante = std::chrono::steady_clock::now();
+        hilo = std::thread([this] { atender(); });
+        return true;
+#else
+        (void)direccion;
+        (void)nuevoRecolector;
+        return false;
+#endif
+    }
+
+    // Termina el hilo y cierra el socket; lo llama tambin el destructor.
+    void detener() {
+        detenido.store(true);
+        if (hilo.joinable()) {
+            hilo.join();
+        }
+#ifdef __linux__
+        if (escucha >= 0) {
+            ::close(escucha);
+            escucha = -1;
+        }
+        if (!rutaUnix.empty()) {
+            ::unlink(rutaUnix.c_str());
+            rutaUnix.clear();
+        }
+#endif
+    }
+
+    unsigned long long raspadosAtendidos() const { return raspados.load(); }
+
+    // Texto de un raspado; lo usa el hilo, y sirve para volcarlo sin socket.
+    std::string raspar() {
+        std::vector<MuestraAlmacen> muestras;
+        recolector(muestras);
+        uint64_t operaciones[CANTIDAD_OPERACIONES_SISTEMA];
+        ContadoresOperaciones::totales(operaciones);
+        uint64_t total = 0;
+        for (uint64_t cuenta : operaciones) {
+            total += cuenta;
+        }
+        std::chrono::steady_clock::time_point ahora = std::chrono::steady_clock::now();
+        double segundos = std::chrono::duration<double>(ahora - anteriorInstante).count();
+        double porSegundo = segundos > 0 && total >= anteriorTotal ? (total - anteriorTotal) / segundos : 0.0;
+        anteriorTotal = total;
+        anteriorInstante = ahora;
+        return formatearMetricas(muestras, operaciones, porSegundo);
+    }
+
+private:
+#ifdef __linux__
+    int escucharUnix(const std::string& ruta) {
+        sockaddr_un direccion;
+        std::memset(&direccion, 0, sizeof(direccion));
+        if (ruta.empty() || ruta.size() >= sizeof(direccion.sun_path)) {
+            return -1;
+        }
+        direccion.sun_family = AF_UNIX;
+        std::memcpy(direccion.sun_path, ruta.c_str(), ruta.size());
+        ::unlink(ruta.c_str());
+        int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0 || ::bind(fd, reinterpret_cast<sockaddr*>(&direccion), sizeof(direccion)) != 0 || ::listen(fd, 16) != 0) {
+            if (fd >= 0) ::close(fd);
+            return -1;
+        }
+        rutaUnix = ruta;
+        return fd;
+    }
+
+    int escucharTcp(int puerto) {
+        sockaddr_in direccion;
+        std::memset(&direccion, 0, sizeof(direccion));
+        direccion.sin_family = AF_INET;
+        direccion.sin_port = htons(static_cast<uint16_t>(puerto));
+        direccion.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int uno = 1;
+        if (fd < 0 || ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &uno, sizeof(uno)) != 0 ||
+            ::bind(fd, reinterpret_cast<sockaddr*>(&direccion), sizeof(direccion)) != 0 || ::listen(fd, 16) != 0) {
+            if (fd >= 0) ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    // Atiende una conexin a la vez; poll con plazo para notar detener().
+    void atender() {
+        while (!detenido.load()) {
+            pollfd espera;
+            espera.fd = escucha;
+            espera.events = POLLIN;
+            espera.revents = 0;
+            int listos = ::poll(&espera, 1, 100);
+            if (listos <= 0) {
+                continue; // Plazo vencido o EINTR.
+            }
+            int fd = ::accept4(escucha, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0) {
+                continue;
+            }
+            responder(fd);
+            ::close(fd);
+        }
+    }
+
+    // Lee la peticin hasta el fin de las cabeceras y responde; cualquier ruta
+    // devuelve las mtricas salvo que el mtodo no sea GET.
+    void responder(int fd) {
+        timeval plazo = {1, 0};
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &plazo, sizeof(plazo));
+        ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &plazo, sizeof(plazo));
+        std::string peticion;
+        char bloque[1024];
+        while (peticion.find("\r\n\r\n") == std::string::npos && peticion.find("\n\n") == std::string::npos &&
+               peticion.size() < 8192) {
+            ssize_t leidos = ::recv(fd, bloque, sizeof(bloque), 0);
+            if (leidos <= 0) {
+                if (leidos < 0 && errno == EINTR) continue;
+                break;
+            }
+            peticion.append(bloque, static_cast<std::size_t>(leidos));
+        }
+        std::string cuerpo;
+        std::string estado;
+        if (peticion.compare(0, 4, "GET ") == 0) {
+            cuerpo = raspar();
+            estado = "200 OK";
+            ++raspados;
+        } else {
+            cuerpo = "Solo se admite GET.\n";
+            estado = "405 Method Not Allowed";
+        }
+        std::ostringstream respuesta;
+        respuesta << "HTTP/1.1 " << estado << "\r\n"
+                  << "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                  << "Content-Length: " << cuerpo.size() << "\r\n"
+                  << "Connection: close\r\n\r\n"
+                  << cuerpo;
+        std::string texto = respuesta.str();
+        std::size_t enviados = 0;
+        while (enviados < texto.size()) {
+            ssize_t n = ::send(fd, texto.data() + enviados, texto.size() - enviados, MSG_NOSIGNAL);
+            if (n <= 0) {
+                if (n < 0 && errno == EINTR) continue;
+                break;
+            }
+            enviados += static_cast<std::size_t>(n);
+        }
+    }
+#endif
+
+    int escucha;
+    std::string rutaUnix;
+    std::thread hilo;
+    std::atomic<bool> detenido;
+    std::atomic<unsigned long long> raspados;
+    Recolector recolector;
+    uint64_t anteriorTotal;                                 // Operaciones en el raspado anterior.
+    std::chrono::steady_clock::time_point anteriorInstante;
+};
+
+#endif
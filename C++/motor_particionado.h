@@ -0,0 +1,589 @@
+#ifndef MOTOR_PARTICIONADO_H
+#define MOTOR_PARTICIONADO_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "sistema_gestion.h"
+#include "anillo_spsc.h"
+
+// Motor particionado
+// Modo sin compartir para aprovechar varios ncleos: en lugar de un SistemaGestion
+// grande protegido por cerrojos, el inventario se reparte por el hash del nombre entre
+// N particiones. Cada particin es un SistemaGestion sin bloqueos atendido por su propio
+// hilo, fijado a un ncleo, y nadie ms toca sus datos.
+//
+// Los clientes abren una Sesion (una por hilo). Cada sesin tiene, por particin, un
+// anillo SPSC de peticiones y otro de respuestas, as que ningn anillo tiene ms de un
+// productor ni ms de un consumidor.
+//
+//   - Registrar, eliminar y consultar van a la particin duea del nombre.
+//   - Listar y valorar se envan a todas las particiones a la vez, que trabajan en
+//     paralelo; la sesin combina los resultados (mezcla ordenada por nombre).
+//   - Las solicitudes viven en la particin 0 y los clientes en espera en la 1 (o en
+//     la 0 si hay una sola), para conservar el orden de llegada de cada cola.
+//   - Deshacer usa un registro global con la particin de cada cambio del inventario.
+//     Es lo nico compartido y solo se toca en las modificaciones; entre sesiones
+//     concurrentes, "el ltimo cambio" es el ltimo que ejecut una particin.
+//
+// Con una sola sesin los mensajes son idnticos a los de SistemaGestion.
+
+// Sistema de cada particin: un solo hilo, sin cerrojos.
+typedef SistemaGestionT<AlmacenHashPlano, ColaAnillo, HistorialVector> SistemaParticion;
+
+// Operaciones del motor; usan los nmeros del men.
+enum OperacionMotor {
+    MotorRegistrarProducto = 1,
+    MotorEliminarProducto = 2,
+    MotorConsultarProducto = 3,
+    MotorListarProductos = 4,
+    MotorRegistrarSolicitud = 5,
+    MotorProcesarSolicitud = 6,
+    MotorSolicitudEnProceso = 7,
+    MotorSolicitudesPendientes = 8,
+    MotorRegistrarCliente = 9,
+    MotorAtenderCliente = 10,
+    MotorListaDeEspera = 11,
+    MotorDeshacer = 12,
+    MotorValorar = 16
+};
+
+struct PeticionMotor {
+    PeticionMotor() : operacion(0), etiqueta(0), mensajes(true) {}
+    int operacion;
+    uint64_t etiqueta;     // La asigna la sesin; la respuesta la repite.
+    bool mensajes;         // Capturar los mensajes del sistema en la respuesta.
+    Producto producto;     // Registrar; eliminar y consultar usan solo el nombre.
+    Solicitud solicitud;
+    Cliente cliente;
+};
+
+struct RespuestaMotor {
+    RespuestaMotor() : operacion(0), etiqueta(0), particion(0), encontrado(false), productosContados(0), unidades(0), valor(0) {}
+    int operacion;
+    uint64_t etiqueta;
+    unsigned particion;
+    bool encontrado;                 // Eliminar y consultar: el producto exista.
+    Producto producto;               // Consultar: precio y cantidad.
+    std::string texto;               // Mensajes del sistema, si se pidieron.
+    std::vector<Producto> productos; // Listar: los de la particin, ordenados por nombre.
+    std::size_t productosContados;   // Valorar.
+    long long unidades;
+    double valor;
+};
+
+// Espera activa corta: primero gira y despus cede el procesador.
+inline void esperarOcioso(unsigned intentos) {
+    if (intentos >= 64) {
+        std::this_thread::yield();
+    }
+}
+
+template <class Sistema = SistemaParticion>
+class MotorParticionado {
+public:
+    static const std::size_t MAXIMO_SESIONES = 64;
+    static const std::size_t CAPACIDAD_ANILLO = 1024;
+
+    class Sesion;
+
+    // cantidad = 0 usa una particin por ncleo.
+    explicit MotorParticionado(unsigned cantidad = 0, bool fijarNucleos = true)
+        : numSesiones(0), detener(false) {
+        unsigned nucleos = std::max(1u, std::thread::hardware_concurrency());
+        if (cantidad == 0) {
+            cantidad = nucleos;
+        }
+        for (unsigned i = 0; i < cantidad; ++i) {
+            particiones.emplace_back(new Particion());
+        }
+        for (unsigned i = 0; i < cantidad; ++i) {
+            particiones[i]->hilo = std::thread(&MotorParticionado::atender, this, i);
+            if (fijarNucleos) {
+                fijarNucleo(particiones[i]->hilo, i % nucleos);
+            }
+        }
+    }
+
+    ~MotorParticionado() {
+        detener.store(true, std::memory_order_release);
+        for (unsigned i = 0; i < particiones.size(); ++i) {
+            despertar(i);
+        }
+        for (auto& particion : particiones) {
+            particion->hilo.join();
+        }
+    }
+
+    MotorParticionado(const MotorParticionado&) = delete;
+    MotorParticionado& operator=(const MotorParticionado&) = delete;
+
+    // Abre una sesin para el hilo que la usar; nullptr si se alcanz el mximo.
+    // Las sesiones viven hasta que se destruye el motor.
+    Sesion* abrirSesion(std::ostream* salida = &std::cout) {
+        std::lock_guard<std::mutex> guardia(cerrojoSesiones);
+        std::size_t n = numSesiones.load(std::memory_order_relaxed);
+        if (n == MAXIMO_SESIONES) {
+            return nullptr;
+        }
+        sesiones[n].reset(new Sesion(*this, salida));
+        numSesiones.store(n + 1, std::memory_order_release);
+        return sesiones[n].get();
+    }
+
+    unsigned numeroParticiones() const { return static_cast<unsigned>(particiones.size()); }
+
+    // Particin duea de un nombre.
+    unsigned particionDe(const std::string& nombre) const {
+        return static_cast<unsigned>((hashNombre(nombre) >> 32) * particiones.size() >> 32);
+    }
+
+private:
+    // Vueltas sin trabajo antes de que una particin se duerma.
+    static const unsigned VUELTAS_ANTES_DE_DORMIR = 2048;
+
+    struct Particion {
+        Particion() : sistema(nullptr), flujo(&buffer), dormida(false) {}
+        Sistema sistema;
+        BufferSalida buffer;
+        std::ostream flujo;
+        std::thread hilo;
+        // Una particin sin trabajo se duerme; la sesin que le encola la despierta.
+        std::atomic<bool> dormida;
+        std::mutex cerrojoSueno;
+        std::condition_variable despertador;
+    };
+
+    static void fijarNucleo(std::thread& hilo, unsigned nucleo) {
+#ifdef __linux__
+        cpu_set_t conjunto;
+        CPU_ZERO(&conjunto);
+        CPU_SET(nucleo, &conjunto);
+        pthread_setaffinity_np(hilo.native_handle(), sizeof(conjunto), &conjunto);
+#else
+        (void)hilo;
+        (void)nucleo;
+#endif
+    }
+
+    unsigned particionSolicitudes() const { return 0; }
+    unsigned particionClientes() const { return particiones.size() > 1 ? 1 : 0; }
+
+    // Anota que la particin registr un cambio en su historial.
+    void anotarCambio(unsigned particion) {
+        std::lock_guard<std::mutex> guardia(cerrojoCambios);
+        cambios.push_back(particion);
+    }
+
+    // Particin del ltimo cambio, que se quita del registro.
+    unsigned tomarUltimoCambio() {
+        std::lock_guard<std::mutex> guardia(cerrojoCambios);
+        if (cambios.empty()) {
+            return 0; // Sin cambios: cualquier particin responde que no hay nada que deshacer.
+        }
+        unsigned particion = cambios.back();
+        cambios.pop_back();
+        return particion;
+    }
+
+    bool hayPeticiones(unsigned indice) const {
+        std::size_t n = numSesiones.load(std::memory_order_acquire);
+        for (std::size_t s = 0; s < n; ++s) {
+            if (!sesiones[s]->entradas[indice]->vacio()) return true;
+        }
+        return false;
+    }
+
+    // La particin anuncia que duerme y vuelve a mirar los anillos antes de esperar;
+    // despertar() encola primero y mira el anuncio despus, as ningn aviso se pierde.
+    void dormir(unsigned indice) {
+        Particion& particion = *particiones[indice];
+        std::unique_lock<std::mutex> guardia(particion.cerrojoSueno);
+        particion.dormida.store(true, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!hayPeticiones(indice) && !detener.load(std::memory_order_acquire)) {
+            particion.despertador.wait_for(guardia, std::chrono::milliseconds(10));
+        }
+        particion.dormida.store(false, std::memory_order_relaxed);
+    }
+
+    void despertar(unsigned indice) {
+        Particion& particion = *particiones[indice];
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (particion.dormida.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> guardia(particion.cerrojoSueno);
+            particion.despertador.notify_one();
+        }
+    }
+
+    // Bucle de cada particin: atiende por turnos los anillos de todas las sesiones.
+    void atender(unsigned indice) {
+        Particion& particion = *particiones[indice];
+        PeticionMotor peticion;
+        RespuestaMotor respuesta;
+        unsigned ociosas = 0;
+        while (!detener.load(std::memory_order_acquire)) {
+            bool trabajo = false;
+            std::size_t n = numSesiones.load(std::memory_order_acquire);
+            for (std::size_t s = 0; s < n; ++s) {
+                Sesion& sesion = *sesiones[s];
+                AnilloSPSC<PeticionMotor>& entrada = *sesion.entradas[indice];
+                AnilloSPSC<RespuestaMotor>& salida = *sesion.salidas[indice];
+                // Un lote por sesin para que ninguna acapare la particin.
+                for (int k = 0; k < 64 && entrada.intentarDesencolar(peticion); ++k) {
+                    ejecutar(particion, indice, peticion, respuesta);
+                    for (unsigned intentos = 0; !salida.intentarEncolar(respuesta); ++intentos) {
+                        esperarOcioso(intentos);
+                    }
+                    trabajo = true;
+                }
+            }
+            if (trabajo) {
+                ociosas = 0;
+            } else if (++ociosas < VUELTAS_ANTES_DE_DORMIR) {
+                esperarOcioso(ociosas);
+            } else {
+                dormir(indice);
+                ociosas = 0;
+            }
+        }
+    }
+
+    void ejecutar(Particion& particion, unsigned indice, PeticionMotor& peticion, RespuestaMotor& respuesta) {
+        Sistema& sistema = particion.sistema;
+        respuesta = RespuestaMotor();
+        respuesta.operacion = peticion.operacion;
+        respuesta.etiqueta = peticion.etiqueta;
+        respuesta.particion = indice;
+        particion.buffer.redirigir(peticion.mensajes ? &respuesta.texto : nullptr);
+        sistema.fijarSalida(peticion.mensajes ? &particion.flujo : nullptr);
+
+        switch (peticion.operacion) {
+            case MotorRegistrarProducto:
+                sistema.registrarProducto(peticion.producto);
+                anotarCambio(indice);
+                break;
+            case MotorEliminarProducto:
+                respuesta.encontrado = sistema.eliminarProducto(peticion.producto.nombre);
+                if (respuesta.encontrado) anotarCambio(indice);
+                break;
+            case MotorConsultarProducto: {
+                auto copiar = [&respuesta](const VistaProducto& producto) {
+                    respuesta.producto.precio = producto.precio;
+                    respuesta.producto.cantidad = producto.cantidad;
+                };
+                // Una sola bsqueda: con mensajes, consultarProducto los escribe y entrega el resultado.
+                VistaNombre nombre = vistaDe(peticion.producto.nombre);
+                respuesta.encontrado = peticion.mensajes ? sistema.consultarProducto(nombre, copiar)
+                                                         : sistema.buscarProducto(nombre, copiar);
+                break;
+            }
+            case MotorListarProductos:
+                sistema.recorrerProductos([&respuesta](const VistaProducto& producto) {
+                    Producto copia;
+                    copia.nombre.assign(producto.nombre.datos, producto.nombre.longitud);
+                    copia.precio = producto.precio;
+                    copia.cantidad = producto.cantidad;
+                    respuesta.productos.push_back(std::move(copia));
+                });
+                break;
+            case MotorRegistrarSolicitud:
+                sistema.registrarSolicitud(peticion.solicitud);
+                break;
+            case MotorProcesarSolicitud:
+                sistema.procesarSolicitud();
+                break;
+            case MotorSolicitudEnProceso:
+                sistema.consultarSolicitudEnProceso();
+                break;
+            case MotorSolicitudesPendientes:
+                sistema.listarSolicitudesPendientes();
+                break;
+            case MotorRegistrarCliente:
+                sistema.registrarClienteEnEspera(peticion.cliente);
+                break;
+            case MotorAtenderCliente:
+                sistema.atenderCliente();
+                break;
+            case MotorListaDeEspera:
+                sistema.consultarListaDeEspera();
+                break;
+            case MotorDeshacer:
+                sistema.deshacerUltimaAccion();
+                break;
+            case MotorValorar:
+                sistema.recorrerProductos([&respuesta](const VistaProducto& producto) {
+                    ++respuesta.productosContados;
+                    respuesta.unidades += producto.cantidad;
+                    respuesta.valor += producto.precio * producto.cantidad;
+                });
+                break;
+        }
+        sistema.fijarSalida(nullptr);
+        particion.buffer.redirigir(nullptr);
+    }
+
+    std::vector<std::unique_ptr<Particion> > particiones;
+    std::unique_ptr<Sesion> sesiones[MAXIMO_SESIONES];
+    std::atomic<std::size_t> numSesiones;
+    std::mutex cerrojoSesiones;
+    std::atomic<bool> detener;
+
+    std::vector<unsigned> cambios; // Particin de cada cambio del historial, en orden.
+    std::mutex cerrojoCambios;
+};
+
+// Sesin de un hilo cliente. Ofrece la misma interfaz que SistemaGestion (sncrona,
+// con los mismos mensajes) y una interfaz asncrona para mantener muchas peticiones
+// en vuelo: enviar() no espera la respuesta y recibir() entrega las que llegaron, en
+// cualquier orden entre particiones. No se deben mezclar las dos mientras haya
+// peticiones asncronas pendientes.
+template <class Sistema>
+class MotorParticionado<Sistema>::Sesion {
+public:
+    Sesion(MotorParticionado& motor, std::ostream* salida)
+        : motor(motor), salida(salida), siguienteEtiqueta(1), pendientes(0), turno(0) {
+        for (unsigned i = 0; i < motor.numeroParticiones(); ++i) {
+            entradas.emplace_back(new AnilloSPSC<PeticionMotor>(CAPACIDAD_ANILLO));
+            salidas.emplace_back(new AnilloSPSC<RespuestaMotor>(CAPACIDAD_ANILLO));
+        }
+    }
+
+    void fijarSalida(std::ostream* nuevaSalida) { salida = nuevaSalida; }
+
+    // Mtodos para la gestin de inventario
+    void registrarProducto(const Producto& producto) {
+        PeticionMotor peticion = nueva(MotorRegistrarProducto);
+        peticion.producto = producto;
+        ejecutarEn(motor.particionDe(producto.nombre), peticion);
+    }
+
+    bool eliminarProducto(const std::string& nombreProducto) {
+        PeticionMotor peticion = nueva(MotorEliminarProducto);
+        peticion.producto.nombre = nombreProducto;
+        return ejecutarEn(motor.particionDe(nombreProducto), peticion).encontrado;
+    }
+
+    void consultarProducto(const std::string& nombreProducto) {
+        PeticionMotor peticion = nueva(MotorConsultarProducto);
+        peticion.producto.nombre = nombreProducto;
+        ejecutarEn(motor.particionDe(nombreProducto), peticion);
+    }
+
+    // Pide a todas las particiones sus productos ordenados y los mezcla por nombre.
+    // Los repetidos de un nombre estn en la misma particin y conservan su orden.
+    void listarProductos() {
+        std::vector<RespuestaMotor> partes = difundir(MotorListarProductos);
+        typedef std::pair<std::size_t, std::size_t> Cabeza; // (parte, posicin)
+        auto mayor = [&partes](const Cabeza& a, const Cabeza& b) {
+            return partes[b.first].productos[b.second].nombre < partes[a.first].productos[a.second].nombre;
+        };
+        std::vector<Cabeza> monticulo;
+        for (std::size_t i = 0; i < partes.size(); ++i) {
+            if (!partes[i].productos.empty()) monticulo.push_back(Cabeza(i, 0));
+        }
+        std::make_heap(monticulo.begin(), monticulo.end(), mayor);
+        while (!monticulo.empty()) {
+            std::pop_heap(monticulo.begin(), monticulo.end(), mayor);
+            Cabeza& cabeza = monticulo.back();
+            const Producto& producto = partes[cabeza.first].productos[cabeza.second];
+            if (salida) *salida << "Producto: " << producto.nombre << ", Precio: " << producto.precio << ", Cantidad: " << producto.cantidad << std::endl;
+            if (++cabeza.second < partes[cabeza.first].productos.size()) {
+                std::push_heap(monticulo.begin(), monticulo.end(), mayor);
+            } else {
+                monticulo.pop_back();
+            }
+        }
+    }
+
+    // Valor total del inventario, calculado en paralelo por las particiones.
+    ValoracionInventario valorar() {
+        ValoracionInventario total = {0, 0, 0.0};
+        for (const auto& parte : difundir(MotorValorar)) {
+            total.productos += parte.productosContados;
+            total.unidades += parte.unidades;
+            total.valor += parte.valor;
+        }
+        return total;
+    }
+
+    // Mtodos para la gestin de solicitudes
+    void registrarSolicitud(const Solicitud& solicitud) {
+        PeticionMotor peticion = nueva(MotorRegistrarSolicitud);
+        peticion.solicitud = solicitud;
+        ejecutarEn(motor.particionSolicitudes(), peticion);
+    }
+
+    void procesarSolicitud() { ejecutarSimple(MotorProcesarSolicitud, motor.particionSolicitudes()); }
+    void consultarSolicitudEnProceso() { ejecutarSimple(MotorSolicitudEnProceso, motor.particionSolicitudes()); }
+    void listarSolicitudesPendientes() { ejecutarSimple(MotorSolicitudesPendientes, motor.particionSolicitudes()); }
+
+    // Mtodos para la gestin de clientes en espera
+    void registrarClienteEnEspera(const Cliente& cliente) {
+        PeticionMotor peticion = nueva(MotorRegistrarCliente);
+        peticion.cliente = cliente;
+        ejecutarEn(motor.particionClientes(), peticion);
+    }
+
+    void atenderCliente() { ejecutarSimple(MotorAtenderCliente, motor.particionClientes()); }
+    void consultarListaDeEspera() { ejecutarSimple(MotorListaDeEspera, motor.particionClientes()); }
+
+    // Mtodos para la gestin del historial de cambios
+    void deshacerUltimaAccion() { ejecutarSimple(MotorDeshacer, motor.tomarUltimoCambio()); }
+
+    // Interfaz asncrona: solo registrar, eliminar y consultar productos, y las
+    // operaciones de colas. Devuelve la etiqueta de la peticin.
+    uint64_t enviar(PeticionMotor& peticion) {
+        peticion.etiqueta = siguienteEtiqueta++;
+        unsigned particion;
+        switch (peticion.operacion) {
+            case MotorRegistrarProducto:
+            case MotorEliminarProducto:
+            case MotorConsultarProducto:
+                particion = motor.particionDe(peticion.producto.nombre);
+                break;
+            case MotorRegistrarCliente:
+            case MotorAtenderCliente:
+            case MotorListaDeEspera:
+                particion = motor.particionClientes();
+                break;
+            default:
+                particion = motor.particionSolicitudes();
+        }
+        uint64_t etiqueta = peticion.etiqueta;
+        encolar(particion, peticion);
+        return etiqueta;
+    }
+
+    // Entrega una respuesta si hay alguna; no espera.
+    bool recibir(RespuestaMotor& respuesta) {
+        if (!recibidas.empty()) {
+            respuesta = std::move(recibidas.front());
+            recibidas.pop_front();
+            return true;
+        }
+        return sondear(respuesta);
+    }
+
+    // Peticiones enviadas cuya respuesta an no se entreg.
+    std::size_t enVuelo() const { return pendientes; }
+
+private:
+    PeticionMotor nueva(int operacion) {
+        PeticionMotor peticion;
+        peticion.operacion = operacion;
+        peticion.etiqueta = siguienteEtiqueta++;
+        peticion.mensajes = salida != nullptr;
+        return peticion;
+    }
+
+    // Encola en la particin; si el anillo est lleno, guarda las respuestas que vayan
+    // llegando para que la particin no se bloquee esperando a esta sesin.
+    void encolar(unsigned particion, PeticionMotor& peticion) {
+        for (unsigned intentos = 0; !entradas[particion]->intentarEncolar(peticion); ++intentos) {
+            RespuestaMotor respuesta;
+            while (sondear(respuesta)) {
+                recibidas.push_back(std::move(respuesta));
+            }
+            esperarOcioso(intentos);
+        }
+        motor.despertar(particion);
+        ++pendientes;
+    }
+
+    // Revisa los anillos de respuesta por turnos, empezando por uno distinto cada vez.
+    bool sondear(RespuestaMotor& respuesta) {
+        std::size_t n = salidas.size();
+        for (std::size_t k = 0; k < n; ++k) {
+            std::size_t i = (turno + k) % n;
+            if (salidas[i]->intentarDesencolar(respuesta)) {
+                turno = static_cast<unsigned>(i + 1);
+                --pendientes;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Espera la respuesta con esa etiqueta; las dems quedan guardadas.
+    RespuestaMotor esperar(uint64_t etiqueta) {
+        for (auto it = recibidas.begin(); it != recibidas.end(); ++it) {
+            if (it->etiqueta == etiqueta) {
+                RespuestaMotor respuesta = std::move(*it);
+                recibidas.erase(it);
+                return respuesta;
+            }
+        }
+        RespuestaMotor respuesta;
+        for (unsigned intentos = 0;; ++intentos) {
+            if (sondear(respuesta)) {
+                if (respuesta.etiqueta == etiqueta) {
+                    return respuesta;
+                }
+                recibidas.push_back(std::move(respuesta));
+                intentos = 0;
+            } else {
+                esperarOcioso(intentos);
+            }
+        }
+    }
+
+    RespuestaMotor ejecutarEn(unsigned particion, PeticionMotor& peticion) {
+        uint64_t etiqueta = peticion.etiqueta;
+        encolar(particion, peticion);
+        RespuestaMotor respuesta = esperar(etiqueta);
+        if (salida && !respuesta.texto.empty()) {
+            *salida << respuesta.texto << std::flush;
+        }
+        return respuesta;
+    }
+
+    void ejecutarSimple(int operacion, unsigned particion) {
+        PeticionMotor peticion = nueva(operacion);
+        ejecutarEn(particion, peticion);
+    }
+
+    // Enva la misma operacin a todas las particiones y espera todas las respuestas.
+    std::vector<RespuestaMotor> difundir(int operacion) {
+        PeticionMotor peticion = nueva(operacion);
+        peticion.mensajes = false;
+        uint64_t etiqueta = peticion.etiqueta;
+        for (unsigned i = 0; i < entradas.size(); ++i) {
+            PeticionMotor copia = peticion;
+            encolar(i, copia);
+        }
+        std::vector<RespuestaMotor> partes;
+        for (unsigned i = 0; i < entradas.size(); ++i) {
+            partes.push_back(esperar(etiqueta));
+        }
+        return partes;
+    }
+
+    friend class MotorParticionado;
+
+    MotorParticionado& motor;
+    std::ostream* salida;
+    uint64_t siguienteEtiqueta;
+    std::size_t pendientes;
+    unsigned turno;
+    std::vector<std::unique_ptr<AnilloSPSC<PeticionMotor> > > entradas; // Por particin.
+    std::vector<std::unique_ptr<AnilloSPSC<RespuestaMotor> > > salidas;  // Por particin.
+    std::deque<RespuestaMotor> recibidas; // Llegaron mientras se esperaba otra respuesta.
+};
+
+#endif
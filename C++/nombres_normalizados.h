@@ -0,0 +1,279 @@
+#ifndef NOMBRES_NORMALIZADOS_H
+#define NOMBRES_NORMALIZADOS_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+
+#include "estructuras.h"
+#include "memoria_estructuras.h"
+
+// Nombres normalizados
+// El inventario compara los nombres byte a byte, as que "Cafe", "caf" y "CAFE" son
+// productos distintos. La clave normalizada de un nombre no distingue maysculas ni
+// acentos: "cafe" para los tres. IndiceNormalizado guarda la clave de cada nombre del
+// inventario, calculada una vez al agregarlo, y lleva de una clave a los nombres tal
+// como se registraron; una consulta se normaliza una sola vez y se compara con claves
+// ya normalizadas.
+//
+// Los nombres pueden venir en Latin-1 (la consola y los archivos del proyecto) o en
+// UTF-8 (el servidor, los guiones): un par UTF-8 vlido de U+0080..U+00FF se lee como
+// el carcter Latin-1 del mismo cdigo, as "caf" da la misma clave en las dos
+// codificaciones. Los acentos combinantes (U+0300..U+036F) se descartan y las dems
+// secuencias UTF-8 se copian sin cambios.
+
+// Plegado de los caracteres Latin-1 desde 0xA0; "" deja el byte como est.
+static const char PLEGADO_LATIN1[96][3] = {
+    "",   "",   "",   "",   "",   "",   "",   "",   "",   "",   "a",  "",   "",   "",   "",   "",   // A0..AF: 
+    "",   "",   "",   "",   "",   "",   "",   "",   "",   "",   "o",  "",   "",   "",   "",   "",   // B0..BF: 
+    "a",  "a",  "a",  "a",  "a",  "a",  "ae", "c",  "e",  "e",  "e",  "e",  "i",  "i",  "i",  "i",  // C0..CF
+    "d",  "n",  "o",  "o",  "o",  "o",  "o",  "",   "o",  "u",  "u",  "u",  "u",  "y",  "th", "ss", // D0..DF: 
+    "a",  "a",  "a",  "a",  "a",  "a",  "ae", "c",  "e",  "e",  "e",  "e",  "i",  "i",  "i",  "i",  // E0..EF
+    "d",  "n",  "o",  "o",  "o",  "o",  "o",  "",   "o",  "u",  "u",  "u",  "u",  "y",  "th", "y"}; // F0..FF: 
+
+// Longitud de la secuencia UTF-8 vlida que empieza en p, o 0 si no la hay.
+inline std::size_t longitudUtf8(const unsigned char* p, const unsigned char* fin) {
+    std::size_t longitud = 0;
+    if (*p >= 0xC2 && *p <= 0xDF) {
+        longitud = 2;
+    } else if (*p >= 0xE0 && *p <= 0xEF) {
+        longitud = 3;
+    } else if (*p >= 0xF0 && *p <= 0xF4) {
+        longitud = 4;
+    }
+    if (longitud == 0 || static_cast<std::size_t>(fin - p) < longitud) {
+        return 0;
+    }
+    for (std::size_t i = 1; i < longitud; ++i) {
+        if ((p[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+    }
+    // Sin formas largas, sustitutos (U+D800..U+DFFF) ni cdigos ms all de U+10FFFF.
+    if ((*p == 0xE0 && p[1] < 0xA0) || (*p == 0xED && p[1] > 0x9F) || (*p == 0xF0 && p[1] < 0x90) ||
+        (*p == 0xF4 && p[1] > 0x8F)) {
+        return 0;
+    }
+    return longitud;
+}
+
+// Deja en clave la forma normalizada del nombre: minsculas y sin acentos.
+inline void normalizarNombre(const VistaNombre& nombre, std::string& clave) {
+    clave.clear();
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(nombre.datos);
+    const unsigned char* fin = p + nombre.longitud;
+    while (p < fin) {
+        unsigned char byte = *p;
+        if (byte < 0x80) {
+            clave.push_back(static_cast<char>(byte >= 'A' && byte <= 'Z' ? byte + ('a' - 'A') : byte));
+            ++p;
+            continue;
+        }
+        std::size_t longitud = longitudUtf8(p, fin);
+        if (longitud == 2 && byte <= 0xC3) {
+            byte = static_cast<unsigned char>(((byte & 0x03) << 6) | (p[1] & 0x3F)); // U+0080..U+00FF.
+        } else if (longitud == 2 && (byte == 0xCC || (byte == 0xCD && p[1] < 0xB0))) {
+            p += 2; // Acento combinante.
+            continue;
+        } else if (longitud > 0) {
+            clave.append(reinterpret_cast<const char*>(p), longitud);
+            p += longitud;
+            continue;
+        }
+        p += longitud > 0 ? longitud : 1;
+        if (byte >= 0xA0 && PLEGADO_LATIN1[byte - 0xA0][0] != '\0') {
+            clave += PLEGADO_LATIN1[byte - 0xA0];
+        } else {
+            clave.push_back(static_cast<char>(byte));
+        }
+    }
+}
+
+class IndiceNormalizado {
+public:
+    IndiceNormalizado() : ranuras(16, 0), ocupadas(0) {}
+
+    // Agrega una aparicin del nombre (se admiten repetidos, como en el inventario).
+    void agregar(const VistaNombre& nombre) {
+        normalizarNombre(nombre, clave);
+        uint64_t hash = hashNombre(clave);
+        std::size_t ranura = ranuraDe(hash);
+        if (ranuras[ranura] == 0) {
+            // Factor de carga mximo de 0.5.
+            if ((ocupadas + 1) * 2 > ranuras.size()) {
+                crecer();
+                ranura = ranuraDe(hash);
+            }
+            uint32_t indice;
+            if (libres.empty()) {
+                indice = static_cast<uint32_t>(entradas.size());
+                entradas.push_back(EntradaNormalizada());
+            } else {
+                indice = libres.back();
+                libres.pop_back();
+            }
+            EntradaNormalizada& entrada = entradas[indice];
+            entrada.clave = clave;
+            entrada.hash = hash;
+            entrada.exacto.assign(nombre.datos, nombre.longitud);
+            entrada.repeticiones = 1;
+            ranuras[ranura] = indice + 1;
+            ++ocupadas;
+            return;
+        }
+        EntradaNormalizada& entrada = entradas[ranuras[ranura] - 1];
+        if (vistaDe(entrada.exacto) == nombre) {
+            ++entrada.repeticiones;
+            return;
+        }
+        for (VarianteNombre& variante : entrada.otras) {
+            if (vistaDe(variante.exacto) == nombre) {
+                ++variante.repeticiones;
+                return;
+            }
+        }
+        VarianteNombre variante;
+        variante.exacto.assign(nombre.datos, nombre.longitud);
+        variante.repeticiones = 1;
+        entrada.otras.push_back(variante);
+    }
+
+    // Quita una aparicin del nombre.
+    void quitar(const VistaNombre& nombre) {
+        normalizarNombre(nombre, clave);
+        std::size_t ranura = ranuraDe(hashNombre(clave));
+        if (ranuras[ranura] == 0) {
+            return;
+        }
+        uint32_t indice = ranuras[ranura] - 1;
+        EntradaNormalizada& entrada = entradas[indice];
+        if (!(vistaDe(entrada.exacto) == nombre)) {
+            for (std::size_t i = 0; i < entrada.otras.size(); ++i) {
+                if (vistaDe(entrada.otras[i].exacto) == nombre) {
+                    if (--entrada.otras[i].repeticiones == 0) {
+                        entrada.otras.erase(entrada.otras.begin() + i);
+                    }
+                    return;
+                }
+            }
+            return;
+        }
+        if (--entrada.repeticiones > 0) {
+            return;
+        }
+        if (!entrada.otras.empty()) {
+            // La variante registrada ms temprano pasa a ser la que se devuelve.
+            entrada.exacto.swap(entrada.otras.front().exacto);
+            entrada.repeticiones = entrada.otras.front().repeticiones;
+            entrada.otras.erase(entrada.otras.begin());
+            return;
+        }
+        liberarRanura(ranura);
+        --ocupadas;
+        entradas[indice] = EntradaNormalizada();
+        libres.push_back(indice);
+    }
+
+    // Si algn nombre del ndice tiene la misma clave que la consulta, deja en exacto el
+    // registrado primero de los que siguen y devuelve true.
+    bool resolver(const VistaNombre& consulta, std::string& exacto) {
+        normalizarNombre(consulta, clave);
+        uint32_t valor = ranuras[ranuraDe(hashNombre(clave))];
+        if (valor == 0) {
+            return false;
+        }
+        exacto = entradas[valor - 1].exacto;
+        return true;
+    }
+
+    std::size_t tamano() const { return ocupadas; } // Claves distintas.
+
+    // Recorre las entradas: para los reportes, no para cada operacin.
+    MemoriaEstructura memoria() const {
+        MemoriaEstructura memoria;
+        memoria.elementos = static_cast<int64_t>(ocupadas);
+        memoria += bloqueMonton(entradas.capacity() * sizeof(EntradaNormalizada));
+        memoria += bloqueMonton(ranuras.capacity() * sizeof(uint32_t));
+        memoria += bloqueMonton(libres.capacity() * sizeof(uint32_t));
+        for (const EntradaNormalizada& entrada : entradas) {
+            contarCadena(memoria, entrada.clave);
+            contarCadena(memoria, entrada.exacto);
+            if (!entrada.otras.empty()) {
+                memoria += bloqueMonton(entrada.otras.capacity() * sizeof(VarianteNombre));
+                for (const VarianteNombre& variante : entrada.otras) {
+                    contarCadena(memoria, variante.exacto);
+                }
+            }
+        }
+        return memoria;
+    }
+
+private:
+    struct VarianteNombre {
+        std::string exacto;
+        uint32_t repeticiones;
+    };
+
+    // Una clave con el primer nombre que la tiene; los dems, casi nunca, en otras.
+    struct EntradaNormalizada {
+        EntradaNormalizada() : hash(0), repeticiones(0) {}
+        std::string clave;
+        uint64_t hash;
+        std::string exacto;
+        uint32_t repeticiones;
+        std::vector<VarianteNombre> otras;
+    };
+
+    // Tabla de claves con direccionamiento abierto (sondeo lineal): entrada + 1, o 0 si
+    // la ranura est libre. Devuelve la ranura de la clave de trabajo o la libre donde ira.
+    std::size_t ranuraDe(uint64_t hash) const {
+        std::size_t mascara = ranuras.size() - 1;
+        for (std::size_t i = hash & mascara;; i = (i + 1) & mascara) {
+            uint32_t valor = ranuras[i];
+            if (valor == 0) {
+                return i;
+            }
+            const EntradaNormalizada& entrada = entradas[valor - 1];
+            if (entrada.hash == hash && entrada.clave == clave) {
+                return i;
+            }
+        }
+    }
+
+    // Borra la ranura desplazando hacia atrs las siguientes, as no quedan lpidas.
+    void liberarRanura(std::size_t libre) {
+        std::size_t mascara = ranuras.size() - 1;
+        for (std::size_t i = (libre + 1) & mascara; ranuras[i] != 0; i = (i + 1) & mascara) {
+            std::size_t ideal = entradas[ranuras[i] - 1].hash & mascara;
+            if (((i - ideal) & mascara) >= ((i - libre) & mascara)) {
+                ranuras[libre] = ranuras[i];
+                libre = i;
+            }
+        }
+        ranuras[libre] = 0;
+    }
+
+    void crecer() {
+        std::vector<uint32_t> anteriores(ranuras.size() * 2, 0);
+        anteriores.swap(ranuras);
+        std::size_t mascara = ranuras.size() - 1;
+        for (uint32_t valor : anteriores) {
+            if (valor != 0) {
+                std::size_t i = entradas[valor - 1].hash & mascara;
+                while (ranuras[i] != 0) {
+                    i = (i + 1) & mascara;
+                }
+                ranuras[i] = valor;
+            }
+        }
+    }
+
+    std::vector<EntradaNormalizada> entradas;
+    std::vector<uint32_t> ranuras;
+    std::vector<uint32_t> libres; // Entradas sin clave, para reutilizar.
+    std::size_t ocupadas;
+    std::string clave;            // Clave de la ltima consulta (espacio de trabajo).
+};
+
+#endif
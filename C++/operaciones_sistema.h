@@ -0,0 +1,46 @@
+#ifndef OPERACIONES_SISTEMA_H
+#define OPERACIONES_SISTEMA_H
+
+// Operaciones pblicas de SistemaGestion, para las mediciones que se llevan por
+// operacin (histograma_latencia.h, instrumentacion.h, metricas.h).
+
+#include "contadores_hilo.h"
+
+enum OperacionSistema {
+    SistemaRegistrarProducto,
+    SistemaEliminarProducto,
+    SistemaConsultarProducto,
+    SistemaListarProductos,
+    SistemaRegistrarSolicitud,
+    SistemaProcesarSolicitud,
+    SistemaConsultarSolicitudEnProceso,
+    SistemaListarSolicitudesPendientes,
+    SistemaRegistrarCliente,
+    SistemaAtenderCliente,
+    SistemaConsultarListaDeEspera,
+    SistemaDeshacer,
+    SistemaCongelarCatalogo,
+    SistemaDescongelarCatalogo,
+    SistemaGuardarCatalogo,
+    SistemaCargarCatalogo,
+    SistemaPublicarReplica,
+    SistemaAutocompletarProducto,
+    SistemaBuscarSolicitudes,
+    CANTIDAD_OPERACIONES_SISTEMA
+};
+
+inline const char* nombreOperacionSistema(int operacion) {
+    static const char* const nombres[CANTIDAD_OPERACIONES_SISTEMA] = {
+        "registrarProducto", "eliminarProducto", "consultarProducto", "listarProductos",
+        "registrarSolicitud", "procesarSolicitud", "consultarSolicitudEnProceso", "listarSolicitudesPendientes",
+        "registrarClienteEnEspera", "atenderCliente", "consultarListaDeEspera", "deshacerUltimaAccion",
+        "congelarCatalogo", "descongelarCatalogo", "guardarCatalogo", "cargarCatalogo", "publicarReplica",
+        "autocompletarProducto", "buscarSolicitudes"};
+    return operacion >= 0 && operacion < CANTIDAD_OPERACIONES_SISTEMA ? nombres[operacion] : "desconocida";
+}
+
+// Operaciones ejecutadas en todo el proceso (todos los sistemas), contadas por hilo.
+struct EtiquetaOperaciones;
+typedef ContadoresPorHilo<EtiquetaOperaciones, CANTIDAD_OPERACIONES_SISTEMA> ContadoresOperaciones;
+
+#endif
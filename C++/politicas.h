@@ -0,0 +1,778 @@
+#ifndef POLITICAS_H
+#define POLITICAS_H
+
+#include <string>
+#include <list>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <cstddef>
+
+#include "estructuras.h"
+#include "instrumentacion.h"
+#include "memoria_estructuras.h"
+
+// Polticas que eligen, en tiempo de compilacin, cmo guarda SistemaGestionT
+// su inventario, sus colas, su historial y cmo se sincroniza.
+// Cada poltica expone nombre() para identificarla en los reportes y benchmarks.
+// Las estructuras de datos llevan adems la cuenta de su memoria (memoria_estructuras.h):
+// memoria() la devuelve sin recorrer nada y puede llamarse desde otro hilo.
+
+// ---------------------------------------------------------------------------
+// Polticas de almacenamiento del inventario
+//
+// Interfaz comn:
+//   void insertar(const Producto& producto);
+//   bool buscar(const VistaNombre& nombre, VistaProducto& vista);
+//   bool extraer(const VistaNombre& nombre, Producto& producto);
+//   template <class F> void recorrerOrdenado(F f);   // f(const VistaProducto&)
+//   template <class F> void recorrer(F f) const;     // Igual, en el orden en que estn guardados.
+//   std::size_t tamano() const;
+//   MemoriaEstructura memoria() const;
+//
+// Los nombres llegan como VistaNombre para poder buscar directamente sobre un bfer
+// (por ejemplo, el de recepcin del protocolo binario) sin construir un std::string.
+// Se admiten nombres repetidos: buscar y extraer actan sobre el primero que se
+// insert, y recorrerOrdenado respeta el orden de insercin entre iguales, igual
+// que la lista original.
+// ---------------------------------------------------------------------------
+
+// Almacn original: lista enlazada con bsqueda lineal por nombre.
+class AlmacenLista {
+public:
+    static const char* nombre() { return "lista"; }
+
+    void insertar(const Producto& producto) {
+        productos.push_back(producto);
+        memoriaUsada.sumar(memoriaEnNodo(productos.back(), bytesNodoLista<Producto>()));
+    }
+
+    bool buscar(const VistaNombre& nombre, VistaProducto& vista) const {
+        auto it = localizar(nombre);
+        if (it == productos.end()) {
+            return false;
+        }
+        vista.nombre = vistaDe(it->nombre);
+        vista.precio = it->precio;
+        vista.cantidad = it->cantidad;
+        return true;
+    }
+
+    bool extraer(const VistaNombre& nombre, Producto& producto) {
+        auto it = localizar(nombre);
+        if (it == productos.end()) {
+            return false;
+        }
+        memoriaUsada.restar(memoriaEnNodo(*it, bytesNodoLista<Producto>()));
+        producto = std::move(*it);
+        productos.erase(it);
+        return true;
+    }
+
+    template <class F>
+    void recorrer(F f) const {
+        for (const auto& producto : productos) {
+            VistaProducto vista = {vistaDe(producto.nombre), producto.precio, producto.cantidad};
+            f(vista);
+        }
+    }
+
+    template <class F>
+    void recorrerOrdenado(F f) {
+        // Ordena los productos por nombre antes de recorrerlos (sort de lista es estable).
+        productos.sort([](const Producto& a, const Producto& b) {
+            return a.nombre < b.nombre;
+        });
+        for (const auto& producto : productos) {
+            VistaProducto vista = {vistaDe(producto.nombre), producto.precio, producto.cantidad};
+            f(vista);
+        }
+    }
+
+    std::size_t tamano() const { return productos.size(); }
+    MemoriaEstructura memoria() const { return memoriaUsada.leer(); }
+
+private:
+    std::list<Producto>::const_iterator localizar(const VistaNombre& nombre) const {
+        return std::find_if(productos.begin(), productos.end(), [&](const Producto& p) {
+            INSTRUMENTAR(InstrNodosVisitados);
+            INSTRUMENTAR(InstrComparaciones);
+            return vistaDe(p.nombre) == nombre;
+        });
+    }
+
+    std::list<Producto> productos;
+    ContadorMemoria memoriaUsada;
+};
+
+// Tabla hash plana con direccionamiento abierto (sondeo lineal).
+// Los repetidos ocupan ranuras distintas; la secuencia de insercin decide cul es el primero.
+// El borrado desplaza hacia atrs las ranuras siguientes, as no quedan lpidas.
+class AlmacenHashPlano {
+public:
+    AlmacenHashPlano() : ranuras(16), ocupadas(0), secuencia(0) {
+        memoriaUsada.cambiarBloque(0, ranuras.size() * sizeof(Ranura));
+    }
+
+    static const char* nombre() { return "hash plano"; }
+
+    void insertar(const Producto& producto) {
+        // Factor de carga mximo de 0.7.
+        if ((ocupadas + 1) * 10 > ranuras.size() * 7) {
+            crecer();
+        }
+        Ranura ranura;
+        ranura.hash = hashNombre(producto.nombre);
+        ranura.secuencia = secuencia++;
+        ranura.ocupada = true;
+        ranura.producto = producto;
+        // Mover la ranura conserva los bloques de sus cadenas: se cuenta antes de colocarla.
+        memoriaUsada.sumar(memoriaEnArreglo(ranura.producto));
+        colocar(std::move(ranura));
+        ++ocupadas;
+    }
+
+    bool buscar(const VistaNombre& nombre, VistaProducto& vista) const {
+        std::size_t posicion = 0;
+        if (!localizar(nombre, posicion)) {
+            return false;
+        }
+        const Producto& producto = ranuras[posicion].producto;
+        vista.nombre = vistaDe(producto.nombre);
+        vista.precio = producto.precio;
+        vista.cantidad = producto.cantidad;
+        return true;
+    }
+
+    bool extraer(const VistaNombre& nombre, Producto& producto) {
+        std::size_t posicion = 0;
+        if (!localizar(nombre, posicion)) {
+            return false;
+        }
+        memoriaUsada.restar(memoriaEnArreglo(ranuras[posicion].producto));
+        producto = std::move(ranuras[posicion].producto);
+        borrar(posicion);
+        return true;
+    }
+
+    template <class F>
+    void recorrer(F f) const {
+        for (const auto& ranura : ranuras) {
+            if (ranura.ocupada) {
+                VistaProducto vista = {vistaDe(ranura.producto.nombre), ranura.producto.precio, ranura.producto.cantidad};
+                f(vista);
+            }
+        }
+    }
+
+    template <class F>
+    void recorrerOrdenado(F f) const {
+        std::vector<const Ranura*> orden;
+        orden.reserve(ocupadas);
+        for (const auto& ranura : ranuras) {
+            if (ranura.ocupada) {
+                orden.push_back(&ranura);
+            }
+        }
+        std::sort(orden.begin(), orden.end(), [](const Ranura* a, const Ranura* b) {
+            int c = a->producto.nombre.compare(b->producto.nombre);
+            return c != 0 ? c < 0 : a->secuencia < b->secuencia;
+        });
+        for (const Ranura* ranura : orden) {
+            VistaProducto vista = {vistaDe(ranura->producto.nombre), ranura->producto.precio, ranura->producto.cantidad};
+            f(vista);
+        }
+    }
+
+    std::size_t tamano() const { return ocupadas; }
+    MemoriaEstructura memoria() const { return memoriaUsada.leer(); }
+
+private:
+    struct Ranura {
+        Ranura() : hash(0), secuencia(0), ocupada(false), producto() {}
+        uint64_t hash;      // Hash completo del nombre, evita comparar cadenas en la mayora de sondeos.
+        uint64_t secuencia; // Orden de insercin.
+        bool ocupada;
+        Producto producto;
+    };
+
+    std::size_t mascara() const { return ranuras.size() - 1; }
+
+    // Devuelve la ranura del producto ms antiguo con ese nombre.
+    bool localizar(const VistaNombre& nombre, std::size_t& posicion) const {
+        uint64_t h = hashNombre(nombre.datos, nombre.longitud);
+        bool hallado = false;
+        uint64_t menor = 0;
+        INSTRUMENTAR(InstrSondeosHash); // La ranura vaca que termina el sondeo.
+        for (std::size_t i = h & mascara(); ranuras[i].ocupada; i = (i + 1) & mascara()) {
+            const Ranura& r = ranuras[i];
+            INSTRUMENTAR(InstrSondeosHash);
+            if (r.hash == h && (!hallado || r.secuencia < menor) &&
+                (INSTRUMENTAR(InstrComparaciones), vistaDe(r.producto.nombre) == nombre)) {
+                hallado = true;
+                menor = r.secuencia;
+                posicion = i;
+            }
+        }
+        return hallado;
+    }
+
+    void colocar(Ranura&& ranura) {
+        std::size_t i = ranura.hash & mascara();
+        while (ranuras[i].ocupada) {
+            i = (i + 1) & mascara();
+        }
+        ranuras[i] = std::move(ranura);
+    }
+
+    void borrar(std::size_t i) {
+        std::size_t j = i;
+        for (;;) {
+            j = (j + 1) & mascara();
+            if (!ranuras[j].ocupada) {
+                break;
+            }
+            // La ranura j puede ocupar el hueco i si su posicin ideal no cae en (i, j].
+            std::size_t ideal = ranuras[j].hash & mascara();
+            bool enRango = (i <= j) ? (i < ideal && ideal <= j) : (i < ideal || ideal <= j);
+            if (!enRango) {
+                ranuras[i] = std::move(ranuras[j]);
+                i = j;
+            }
+        }
+        vaciarRanura(ranuras[i]);
+        --ocupadas;
+    }
+
+    void crecer() {
+        std::vector<Ranura> anteriores(ranuras.size() * 2);
+        anteriores.swap(ranuras);
+        memoriaUsada.cambiarBloque(anteriores.size() * sizeof(Ranura), ranuras.size() * sizeof(Ranura));
+        for (auto& ranura : anteriores) {
+            if (ranura.ocupada) {
+                colocar(std::move(ranura));
+            }
+        }
+    }
+
+    std::vector<Ranura> ranuras;
+    std::size_t ocupadas;
+    uint64_t secuencia;
+    ContadorMemoria memoriaUsada;
+};
+
+// Estructura de arreglos (SoA): cada atributo vive en su propio vector.
+// La bsqueda recorre solo el vector de hashes, que es contiguo y cabe mejor en cach.
+class AlmacenSoA {
+public:
+    AlmacenSoA() : capacidadAnotada(0) {}
+
+    static const char* nombre() { return "SoA"; }
+
+    void insertar(const Producto& producto) {
+        hashes.push_back(hashNombre(producto.nombre));
+        nombres.push_back(producto.nombre);
+        precios.push_back(producto.precio);
+        cantidades.push_back(producto.cantidad);
+        memoriaUsada.sumar(memoriaElemento(nombres.size() - 1));
+        anotarCapacidades();
+    }
+
+    bool buscar(const VistaNombre& nombre, VistaProducto& vista) const {
+        std::size_t i = localizar(nombre);
+        if (i == hashes.size()) {
+            return false;
+        }
+        vista.nombre = vistaDe(nombres[i]);
+        vista.precio = precios[i];
+        vista.cantidad = cantidades[i];
+        return true;
+    }
+
+    bool extraer(const VistaNombre& nombre, Producto& producto) {
+        std::size_t i = localizar(nombre);
+        if (i == hashes.size()) {
+            return false;
+        }
+        memoriaUsada.restar(memoriaElemento(i));
+        producto.nombre = std::move(nombres[i]);
+        producto.precio = precios[i];
+        producto.cantidad = cantidades[i];
+        // Se conserva el orden de insercin para que los repetidos se comporten como en la lista.
+        hashes.erase(hashes.begin() + i);
+        nombres.erase(nombres.begin() + i);
+        precios.erase(precios.begin() + i);
+        cantidades.erase(cantidades.begin() + i);
+        return true;
+    }
+
+    template <class F>
+    void recorrer(F f) const {
+        for (std::size_t i = 0; i < hashes.size(); ++i) {
+            VistaProducto vista = {vistaDe(nombres[i]), precios[i], cantidades[i]};
+            f(vista);
+        }
+    }
+
+    template <class F>
+    void recorrerOrdenado(F f) const {
+        std::vector<std::size_t> orden(hashes.size());
+        for (std::size_t i = 0; i < orden.size(); ++i) {
+            orden[i] = i;
+        }
+        std::stable_sort(orden.begin(), orden.end(), [&](std::size_t a, std::size_t b) {
+            return nombres[a] < nombres[b];
+        });
+        for (std::size_t i : orden) {
+            VistaProducto vista = {vistaDe(nombres[i]), precios[i], cantidades[i]};
+            f(vista);
+        }
+    }
+
+    std::size_t tamano() const { return hashes.size(); }
+    MemoriaEstructura memoria() const { return memoriaUsada.leer(); }
+
+private:
+    std::size_t localizar(const VistaNombre& nombre) const {
+        uint64_t h = hashNombre(nombre.datos, nombre.longitud);
+        for (std::size_t i = 0; i < hashes.size(); ++i) {
+            INSTRUMENTAR(InstrNodosVisitados);
+            if (hashes[i] == h && (INSTRUMENTAR(InstrComparaciones), vistaDe(nombres[i]) == nombre)) {
+                return i;
+            }
+        }
+        return hashes.size();
+    }
+
+    // El nombre, el precio y la cantidad son carga; el hash es sobrecarga.
+    MemoriaEstructura memoriaElemento(std::size_t i) const {
+        MemoriaEstructura memoria;
+        memoria.elementos = 1;
+        contarCadena(memoria, nombres[i]);
+        contarCargaEnLinea(memoria, sizeof(double) + sizeof(int));
+        return memoria;
+    }
+
+    // Los cuatro vectores crecen a la par, as que comparten capacidad; solo cambian de
+    // bloque al crecer, porque erase no reduce la capacidad.
+    void anotarCapacidades() {
+        std::size_t antes = capacidadAnotada;
+        std::size_t despues = hashes.capacity();
+        if (antes == despues) {
+            return;
+        }
+        memoriaUsada.cambiarBloque(antes * sizeof(uint64_t), despues * sizeof(uint64_t));
+        memoriaUsada.cambiarBloque(antes * sizeof(std::string), despues * sizeof(std::string));
+        memoriaUsada.cambiarBloque(antes * sizeof(double), despues * sizeof(double));
+        memoriaUsada.cambiarBloque(antes * sizeof(int), despues * sizeof(int));
+        capacidadAnotada = despues;
+    }
+
+    std::vector<uint64_t> hashes;
+    std::vector<std::string> nombres;
+    std::vector<double> precios;
+    std::vector<int> cantidades;
+    std::size_t capacidadAnotada;
+    ContadorMemoria memoriaUsada;
+};
+
+// ---------------------------------------------------------------------------
+// Polticas de cola (solicitudes y clientes en espera)
+//
+// Cada poltica define la plantilla anidada Cola<T> con la interfaz:
+//   void encolar(const T& valor);
+//   bool desencolar(T& valor);
+//   const T* frente() const;            // nullptr si est vaca
+//   bool vacia() const;
+//   std::size_t tamano() const;
+//   template <class F> void recorrer(F f) const;
+//   template <class F> void recorrerMientras(F f) const; // Para cuando f devuelve false.
+//   MemoriaEstructura memoria() const;
+// ---------------------------------------------------------------------------
+
+// Cola original sobre std::list.
+struct ColaLista {
+    static const char* nombre() { return "lista"; }
+
+    template <class T>
+    class Cola {
+    public:
+        void encolar(const T& valor) {
+            elementos.push_back(valor);
+            memoriaUsada.sumar(memoriaEnNodo(elementos.back(), bytesNodoLista<T>()));
+        }
+
+        bool desencolar(T& valor) {
+            if (elementos.empty()) {
+                return false;
+            }
+            memoriaUsada.restar(memoriaEnNodo(elementos.front(), bytesNodoLista<T>()));
+            valor = std::move(elementos.front());
+            elementos.pop_front();
+            return true;
+        }
+
+        const T* frente() const { return elementos.empty() ? nullptr : &elementos.front(); }
+        bool vacia() const { return elementos.empty(); }
+        std::size_t tamano() const { return elementos.size(); }
+        MemoriaEstructura memoria() const { return memoriaUsada.leer(); }
+
+        template <class F>
+        void recorrer(F f) const {
+            for (const auto& elemento : elementos) {
+                f(elemento);
+            }
+        }
+
+        template <class F>
+        void recorrerMientras(F f) const {
+            for (const auto& elemento : elementos) {
+                if (!f(elemento)) {
+                    return;
+                }
+            }
+        }
+
+    private:
+        std::list<T> elementos;
+        ContadorMemoria memoriaUsada;
+    };
+};
+
+// Bfer circular que crece por potencias de dos; sin un nodo por elemento.
+struct ColaAnillo {
+    static const char* nombre() { return "anillo"; }
+
+    template <class T>
+    class Cola {
+    public:
+        Cola() : buffer(8), cabeza(0), cuenta(0) {
+            memoriaUsada.cambiarBloque(0, buffer.size() * sizeof(T));
+        }
+
+        void encolar(const T& valor) {
+            if (cuenta == buffer.size()) {
+                crecer();
+            }
+            T& ranura = buffer[(cabeza + cuenta) & mascara()];
+            ranura = valor;
+            memoriaUsada.sumar(memoriaEnArreglo(ranura));
+            ++cuenta;
+        }
+
+        bool desencolar(T& valor) {
+            if (cuenta == 0) {
+                return false;
+            }
+            memoriaUsada.restar(memoriaEnArreglo(buffer[cabeza]));
+            valor = std::move(buffer[cabeza]);
+            vaciarRanura(buffer[cabeza]);
+            cabeza = (cabeza + 1) & mascara();
+            --cuenta;
+            return true;
+        }
+
+        const T* frente() const { return cuenta == 0 ? nullptr : &buffer[cabeza]; }
+        bool vacia() const { return cuenta == 0; }
+        std::size_t tamano() const { return cuenta; }
+        MemoriaEstructura memoria() const { return memoriaUsada.leer(); }
+
+        template <class F>
+        void recorrer(F f) const {
+            for (std::size_t i = 0; i < cuenta; ++i) {
+                f(buffer[(cabeza + i) & mascara()]);
+            }
+        }
+
+        template <class F>
+        void recorrerMientras(F f) const {
+            for (std::size_t i = 0; i < cuenta; ++i) {
+                if (!f(buffer[(cabeza + i) & mascara()])) {
+                    return;
+                }
+            }
+        }
+
+    private:
+        std::size_t mascara() const { return buffer.size() - 1; }
+
+        void crecer() {
+            std::vector<T> nuevo(buffer.size() * 2);
+            for (std::size_t i = 0; i < cuenta; ++i) {
+                nuevo[i] = std::move(buffer[(cabeza + i) & mascara()]);
+            }
+            buffer.swap(nuevo);
+            memoriaUsada.cambiarBloque(nuevo.size() * sizeof(T), buffer.size() * sizeof(T));
+            cabeza = 0;
+        }
+
+        std::vector<T> buffer;
+        std::size_t cabeza;
+        std::size_t cuenta;
+        ContadorMemoria memoriaUsada;
+    };
+};
+
+// Cola sin bloqueo de varios productores y un consumidor (algoritmo de Vyukov).
+// encolar puede llamarse desde cualquier hilo; desencolar, frente y recorrer
+// solo desde el hilo consumidor.
+struct ColaSinBloqueo {
+    static const char* nombre() { return "sin bloqueo"; }
+
+    template <class T>
+    class Cola {
+    public:
+        Cola() : ultimo(nullptr), cabeza(new Nodo()), cuenta(0) {
+            ultimo.store(cabeza);
+            memoriaUsada.sumar(bloqueMonton(sizeof(Nodo)));
+        }
+
+        ~Cola() {
+            while (cabeza) {
+                Nodo* siguiente = cabeza->siguiente.load(std::memory_order_relaxed);
+                delete cabeza;
+                cabeza = siguiente;
+            }
+        }
+
+        Cola(const Cola&) = delete;
+        Cola& operator=(const Cola&) = delete;
+
+        void encolar(const T& valor) {
+            Nodo* nodo = new Nodo();
+            nodo->valor = valor;
+            memoriaUsada.sumar(memoriaEnNodo(nodo->valor, sizeof(Nodo)));
+            Nodo* anterior = ultimo.exchange(nodo, std::memory_order_acq_rel);
+            anterior->siguiente.store(nodo, std::memory_order_release);
+            cuenta.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        bool desencolar(T& valor) {
+            Nodo* siguiente = cabeza->siguiente.load(std::memory_order_acquire);
+            if (!siguiente) {
+                return false;
+            }
+            // El nodo siguiente pasa a ser el nuevo centinela y se libera el anterior:
+            // hay un nodo menos, como si se borrara el del elemento.
+            memoriaUsada.restar(memoriaEnNodo(siguiente->valor, sizeof(Nodo)));
+            valor = std::move(siguiente->valor);
+            vaciarRanura(siguiente->valor);
+            delete cabeza;
+            cabeza = siguiente;
+            cuenta.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        const T* frente() const {
+            Nodo* siguiente = cabeza->siguiente.load(std::memory_order_acquire);
+            return siguiente ? &siguiente->valor : nullptr;
+        }
+
+        bool vacia() const { return frente() == nullptr; }
+        std::size_t tamano() const { return cuenta.load(std::memory_order_relaxed); }
+        MemoriaEstructura memoria() const { return memoriaUsada.leer(); }
+
+        template <class F>
+        void recorrer(F f) const {
+            for (Nodo* n = cabeza->siguiente.load(std::memory_order_acquire); n;
+                 n = n->siguiente.load(std::memory_order_acquire)) {
+                f(n->valor);
+            }
+        }
+
+        template <class F>
+        void recorrerMientras(F f) const {
+            for (Nodo* n = cabeza->siguiente.load(std::memory_order_acquire); n;
+                 n = n->siguiente.load(std::memory_order_acquire)) {
+                if (!f(n->valor)) {
+                    return;
+                }
+            }
+        }
+
+    private:
+        struct Nodo {
+            Nodo() : siguiente(nullptr), valor() {}
+            std::atomic<Nodo*> siguiente;
+            T valor;
+        };
+
+        std::atomic<Nodo*> ultimo; // Extremo de los productores.
+        Nodo* cabeza;              // Centinela, solo lo toca el consumidor.
+        std::atomic<std::size_t> cuenta;
+        ContadorMemoria memoriaUsada;
+    };
+};
+
+// ---------------------------------------------------------------------------
+// Polticas de historial de cambios
+//
+// Interfaz comn:
+//   void agregar(const Cambio& cambio);
+//   bool extraerUltimo(Cambio& cambio);
+//   bool vacio() const;
+//   std::size_t tamano() const;
+//   MemoriaEstructura memoria() const;
+// ---------------------------------------------------------------------------
+
+// Historial original sobre std::list, sin lmite.
+class HistorialLista {
+public:
+    static const char* nombre() { return "lista"; }
+
+    void agregar(const Cambio& cambio) {
+        cambios.push_back(cambio);
+        memoriaUsada.sumar(memoriaEnNodo(cambios.back(), bytesNodoLista<Cambio>()));
+    }
+
+    bool extraerUltimo(Cambio& cambio) {
+        if (cambios.empty()) {
+            return false;
+        }
+        memoriaUsada.restar(memoriaEnNodo(cambios.back(), bytesNodoLista<Cambio>()));
+        cambio = std::move(cambios.back());
+        cambios.pop_back();
+        return true;
+    }
+
+    bool vacio() const { return cambios.empty(); }
+    std::size_t tamano() const { return cambios.size(); }
+
+    MemoriaEstructura memoria() const { return memoriaUsada.leer(); }
+
+private:
+    std::list<Cambio> cambios;
+    ContadorMemoria memoriaUsada;
+};
+
+// Historial contiguo sin lmite.
+class HistorialVector {
+public:
+    HistorialVector() : capacidadAnotada(0) {}
+
+    static const char* nombre() { return "vector"; }
+
+    void agregar(const Cambio& cambio) {
+        cambios.push_back(cambio);
+        memoriaUsada.sumar(memoriaEnArreglo(cambios.back()));
+        if (cambios.capacity() != capacidadAnotada) {
+            memoriaUsada.cambiarBloque(capacidadAnotada * sizeof(Cambio), cambios.capacity() * sizeof(Cambio));
+            capacidadAnotada = cambios.capacity();
+        }
+    }
+
+    bool extraerUltimo(Cambio& cambio) {
+        if (cambios.empty()) {
+            return false;
+        }
+        memoriaUsada.restar(memoriaEnArreglo(cambios.back()));
+        cambio = std::move(cambios.back());
+        cambios.pop_back();
+        return true;
+    }
+
+    bool vacio() const { return cambios.empty(); }
+    std::size_t tamano() const { return cambios.size(); }
+
+    MemoriaEstructura memoria() const { return memoriaUsada.leer(); }
+
+private:
+    std::vector<Cambio> cambios;
+    std::size_t capacidadAnotada;
+    ContadorMemoria memoriaUsada;
+};
+
+// Historial acotado: conserva solo los ltimos Capacidad cambios y descarta los ms antiguos.
+template <std::size_t Capacidad = 1024>
+class HistorialAnillo {
+public:
+    HistorialAnillo() : cambios(Capacidad), inicio(0), cuenta(0) {
+        memoriaUsada.cambiarBloque(0, Capacidad * sizeof(Cambio));
+    }
+
+    static const char* nombre() { return "anillo"; }
+
+    void agregar(const Cambio& cambio) {
+        if (cuenta == Capacidad) {
+            // Reemplaza al ms antiguo; la asignacin puede reutilizar los bloques de sus cadenas.
+            memoriaUsada.restar(memoriaEnArreglo(cambios[inicio]));
+            cambios[inicio] = cambio;
+            memoriaUsada.sumar(memoriaEnArreglo(cambios[inicio]));
+            inicio = (inicio + 1) % Capacidad;
+        } else {
+            Cambio& ranura = cambios[(inicio + cuenta) % Capacidad];
+            ranura = cambio;
+            memoriaUsada.sumar(memoriaEnArreglo(ranura));
+            ++cuenta;
+        }
+    }
+
+    bool extraerUltimo(Cambio& cambio) {
+        if (cuenta == 0) {
+            return false;
+        }
+        Cambio& ultimo = cambios[(inicio + cuenta - 1) % Capacidad];
+        memoriaUsada.restar(memoriaEnArreglo(ultimo));
+        cambio = std::move(ultimo);
+        vaciarRanura(ultimo);
+        --cuenta;
+        return true;
+    }
+
+    bool vacio() const { return cuenta == 0; }
+    std::size_t tamano() const { return cuenta; }
+    MemoriaEstructura memoria() const { return memoriaUsada.leer(); }
+
+private:
+    std::vector<Cambio> cambios;
+    std::size_t inicio;
+    std::size_t cuenta;
+    ContadorMemoria memoriaUsada;
+};
+
+// ---------------------------------------------------------------------------
+// Polticas de bloqueo
+//
+// Cada poltica define el tipo Cerrojo (con lock y unlock) que protege cada
+// estructura del sistema.
+// ---------------------------------------------------------------------------
+
+// Para uso en un solo hilo: el cerrojo est vaco y el compilador lo elimina.
+struct SinBloqueo {
+    static const char* nombre() { return "sin bloqueo"; }
+
+    struct Cerrojo {
+        void lock() {}
+        void unlock() {}
+    };
+};
+
+// Espera activa sobre un atomic_flag; adecuado para secciones crticas muy cortas.
+struct BloqueoSpin {
+    static const char* nombre() { return "spin"; }
+
+    class Cerrojo {
+    public:
+        Cerrojo() { bandera.clear(); }
+
+        void lock() {
+            while (bandera.test_and_set(std::memory_order_acquire)) {
+            }
+        }
+
+        void unlock() { bandera.clear(std::memory_order_release); }
+
+    private:
+        std::atomic_flag bandera;
+    };
+};
+
+// Exclusin mutua del sistema operativo.
+struct BloqueoMutex {
+    static const char* nombre() { return "mutex"; }
+
+    typedef std::mutex Cerrojo;
+};
+
+#endif
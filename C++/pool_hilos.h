@@ -0,0 +1,118 @@
+#ifndef POOL_HILOS_H
+#define POOL_HILOS_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <cstddef>
+
+// Grupo fijo de hilos para repartir trabajo independiente (un "para cada" en paralelo).
+// El hilo que llama tambin trabaja, as que con hilos = N hay N + 1 ejecutando.
+// Los ndices se reparten de a uno con un contador atmico: sirve para tareas de
+// tamao desigual, como recorrer almacenes de distinto tamao.
+class PoolHilos {
+public:
+    // hilos = 0 usa uno por ncleo, descontando el hilo que llama.
+    explicit PoolHilos(unsigned hilos = 0)
+        : trabajo(nullptr), total(0), siguiente(0), activos(0), generacion(0), detener(false) {
+        if (hilos == 0) {
+            unsigned nucleos = std::thread::hardware_concurrency();
+            hilos = nucleos > 1 ? nucleos - 1 : 0;
+        }
+        for (unsigned i = 0; i < hilos; ++i) {
+            trabajadores.emplace_back(&PoolHilos::bucle, this);
+        }
+    }
+
+    ~PoolHilos() {
+        {
+            std::lock_guard<std::mutex> guardia(cerrojo);
+            detener = true;
+        }
+        hayTrabajo.notify_all();
+        for (auto& trabajador : trabajadores) {
+            trabajador.join();
+        }
+    }
+
+    PoolHilos(const PoolHilos&) = delete;
+    PoolHilos& operator=(const PoolHilos&) = delete;
+
+    // Hilos que ejecutan un paraCada, contando al que llama.
+    unsigned tamano() const { return static_cast<unsigned>(trabajadores.size()) + 1; }
+
+    // Ejecuta f(i) para cada i en [0, n) y vuelve cuando terminaron todos.
+    // Las llamadas desde varios hilos se atienden de a una.
+    template <class F>
+    void paraCada(std::size_t n, F f) {
+        if (trabajadores.empty() || n <= 1) {
+            for (std::size_t i = 0; i < n; ++i) {
+                f(i);
+            }
+            return;
+        }
+        std::lock_guard<std::mutex> turno(cerrojoLlamadas);
+        std::function<void(std::size_t)> tarea(f);
+        {
+            std::lock_guard<std::mutex> guardia(cerrojo);
+            trabajo = &tarea;
+            total = n;
+            siguiente.store(0, std::memory_order_relaxed);
+            activos = trabajadores.size();
+            ++generacion;
+        }
+        hayTrabajo.notify_all();
+        ejecutarTareas();
+
+        // Ningn trabajador puede seguir usando la tarea cuando esta funcin vuelve.
+        std::unique_lock<std::mutex> guardia(cerrojo);
+        terminado.wait(guardia, [this] { return activos == 0; });
+        trabajo = nullptr;
+    }
+
+private:
+    void ejecutarTareas() {
+        for (;;) {
+            std::size_t i = siguiente.fetch_add(1, std::memory_order_relaxed);
+            if (i >= total) {
+                return;
+            }
+            (*trabajo)(i);
+        }
+    }
+
+    void bucle() {
+        unsigned long vista = 0;
+        std::unique_lock<std::mutex> guardia(cerrojo);
+        for (;;) {
+            hayTrabajo.wait(guardia, [&] { return detener || generacion != vista; });
+            if (detener) {
+                return;
+            }
+            vista = generacion;
+            guardia.unlock();
+            ejecutarTareas();
+            guardia.lock();
+            if (--activos == 0) {
+                terminado.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> trabajadores;
+    std::mutex cerrojoLlamadas;
+    std::mutex cerrojo;
+    std::condition_variable hayTrabajo;
+    std::condition_variable terminado;
+    const std::function<void(std::size_t)>* trabajo;
+    std::size_t total;
+    std::atomic<std::size_t> siguiente;
+    std::size_t activos;       // Trabajadores que an no terminaron la generacin actual.
+    unsigned long generacion;  // Aumenta con cada paraCada.
+    bool detener;
+};
+
+#endif
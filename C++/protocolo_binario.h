@@ -0,0 +1,765 @@
+#ifndef PROTOCOLO_BINARIO_H
+#define PROTOCOLO_BINARIO_H
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+#ifdef __linux__
+#include <cerrno>
+#include <climits>
+#include <sys/types.h>
+#include <sys/uio.h>
+#endif
+
+#include "estructuras.h"
+#include "autocompletado.h"
+#include "histograma_latencia.h"
+
+// Protocolo binario
+// Alternativa compacta al protocolo de texto del modo servidor (ver servidor.h).
+// El cliente lo elige enviando los 4 bytes "SGB1" al abrir la conexin; despus cada
+// mensaje es una trama con prefijo de longitud. Los enteros van en little-endian y
+// los precios como double IEEE-754 de 8 bytes.
+//
+//   Peticin:  u32 longitud | u8 operacin | argumentos
+//   Respuesta: u32 longitud | u8 operacin | u8 estado | datos
+//
+// La longitud cuenta los bytes que la siguen. Las operaciones usan los nmeros del men:
+//
+//   Op  Argumentos                          Datos de la respuesta (estado Correcto)
+//   1   f64 precio, i32 cantidad, nombre    -
+//   2   nombre                              -            (NoEncontrado si no existe)
+//   3   nombre                              f64 precio, i32 cantidad
+//   4   -                                   u32 n, n x (f64 precio, i32 cantidad, nombre)
+//   5   descripcin                         i32 id asignado
+//   6   -                                   i32 id, descripcin  (Vacio si no hay)
+//   7   -                                   i32 id, descripcin  (Vacio si no hay)
+//   8   -                                   u32 n, n x (i32 id, descripcin)
+//   9   nombre                              i32 id asignado
+//   10  -                                   i32 id, nombre       (Vacio si no hay)
+//   11  -                                   u32 n, n x (i32 id, nombre)
+//   12  -                                   u8 resultado (ResultadoDeshacer), nombre
+//   14  -                                   u32 productos congelados (Error si falla)
+//   15  -                                   -            (Vacio si no estaba congelado)
+//   22  -                                   u32 n, n x (u8 operacin, u64 cuenta, u64 p50, u64 p90,
+//                                                       u64 p99, u64 p99.9, u64 mximo)
+//   23  -                                   -
+//   26  nombre (prefijo)                    u32 n, n x (u32 consultas, nombre)
+//   27  descripcin (palabras)              u32 n, n x (i32 id, descripcin)
+//
+// En 22 van solo las operaciones con muestras; operacin es un OperacionSistema
+// (operaciones_sistema.h) y las latencias estn en nanosegundos; decodificarLatencias
+// lee esa respuesta del lado del cliente. Las opciones 16 a 18
+// del men (archivos y memoria compartida) no existen aqu: un cliente remoto no debe
+// poder escribir archivos ni crear regiones con los permisos del servidor.
+// "nombre" es u16 longitud + bytes y "descripcin" es u32 longitud + bytes. Una trama
+// mal formada o una operacin desconocida responde con estado Error.
+//
+// Los nombres de las peticiones se decodifican como VistaNombre sobre el bfer de
+// recepcin, sin copiarlos. Las respuestas se arman en una SalidaVectorial: los datos
+// fijos se copian a un bfer propio y los textos largos se referencian en el almacn,
+// de modo que se envan con una sola llamada a writev.
+
+static const char MAGICO_PROTOCOLO_BINARIO[4] = {'S', 'G', 'B', '1'};
+
+// Estados de respuesta.
+enum EstadoBinario {
+    EstadoCorrecto = 0,
+    EstadoNoEncontrado = 1,
+    EstadoVacio = 2,
+    EstadoError = 3
+};
+
+// Tamao mximo de una trama de peticin; una mayor se considera un error del cliente.
+static const uint32_t LIMITE_TRAMA_BINARIA = 1u << 24;
+
+// ---------------------------------------------------------------------------
+// Codificacin de enteros little-endian
+// ---------------------------------------------------------------------------
+
+inline void escribirU16(char* destino, uint16_t valor) {
+    destino[0] = static_cast<char>(valor);
+    destino[1] = static_cast<char>(valor >> 8);
+}
+
+inline void escribirU32(char* destino, uint32_t valor) {
+    for (int i = 0; i < 4; ++i) {
+        destino[i] = static_cast<char>(valor >> (8 * i));
+    }
+}
+
+inline void escribirU64(char* destino, uint64_t valor) {
+    for (int i = 0; i < 8; ++i) {
+        destino[i] = static_cast<char>(valor >> (8 * i));
+    }
+}
+
+inline uint16_t leerU16(const char* origen) {
+    const unsigned char* b = reinterpret_cast<const unsigned char*>(origen);
+    return static_cast<uint16_t>(b[0] | (b[1] << 8));
+}
+
+inline uint32_t leerU32(const char* origen) {
+    const unsigned char* b = reinterpret_cast<const unsigned char*>(origen);
+    return static_cast<uint32_t>(b[0]) | (static_cast<uint32_t>(b[1]) << 8) |
+           (static_cast<uint32_t>(b[2]) << 16) | (static_cast<uint32_t>(b[3]) << 24);
+}
+
+inline uint64_t leerU64(const char* origen) {
+    return static_cast<uint64_t>(leerU32(origen)) | (static_cast<uint64_t>(leerU32(origen + 4)) << 32);
+}
+
+// ---------------------------------------------------------------------------
+// Lectura de una trama recibida
+// Cada lectura comprueba que queden bytes; si falta alguno, correcto() pasa a false
+// y las lecturas siguientes devuelven ceros.
+// ---------------------------------------------------------------------------
+
+class LectorTrama {
+public:
+    LectorTrama(const char* datos, std::size_t longitud) : p(datos), fin(datos + longitud), valido(true) {}
+
+    uint8_t u8() {
+        if (!disponible(1)) return 0;
+        return static_cast<uint8_t>(*p++);
+    }
+
+    uint16_t u16() {
+        if (!disponible(2)) return 0;
+        uint16_t valor = leerU16(p);
+        p += 2;
+        return valor;
+    }
+
+    uint32_t u32() {
+        if (!disponible(4)) return 0;
+        uint32_t valor = leerU32(p);
+        p += 4;
+        return valor;
+    }
+
+    int32_t i32() { return static_cast<int32_t>(u32()); }
+
+    uint64_t u64() {
+        if (!disponible(8)) return 0;
+        uint64_t valor = leerU64(p);
+        p += 8;
+        return valor;
+    }
+
+    double f64() {
+        if (!disponible(8)) return 0.0;
+        uint64_t bits = leerU64(p);
+        p += 8;
+        double valor;
+        std::memcpy(&valor, &bits, sizeof(valor));
+        return valor;
+    }
+
+    // Texto con prefijo u16 (nombres) o u32 (descripciones); apunta a la trama.
+    VistaNombre nombre() { return texto(u16()); }
+    VistaNombre descripcion() { return texto(u32()); }
+
+    // La trama se ley completa y sin bytes de ms.
+    bool correcto() const { return valido && p == fin; }
+
+private:
+    bool disponible(std::size_t n) {
+        if (!valido || static_cast<std::size_t>(fin - p) < n) {
+            valido = false;
+            return false;
+        }
+        return true;
+    }
+
+    VistaNombre texto(std::size_t longitud) {
+        VistaNombre vista = {p, 0};
+        if (disponible(longitud)) {
+            vista.longitud = longitud;
+            p += longitud;
+        }
+        return vista;
+    }
+
+    const char* p;
+    const char* fin;
+    bool valido;
+};
+
+// ---------------------------------------------------------------------------
+// Salida vectorial
+// Secuencia de fragmentos que se enva con writev. Un fragmento es un tramo del bfer
+// propio (datos fijos, cabeceras, textos cortos) o una referencia a memoria externa
+// (textos largos que viven en el almacn). Las referencias solo son vlidas hasta la
+// siguiente modificacin del sistema: materializar() las copia al bfer propio.
+// ---------------------------------------------------------------------------
+
+class SalidaVectorial {
+public:
+    // Textos de al menos este tamao se referencian en lugar de copiarse; para los
+    // cortos una copia es ms barata que un elemento ms en el vector de writev.
+    static const std::size_t UMBRAL_REFERENCIA = 256;
+
+    SalidaVectorial() : total(0), enviados(0), primero(0), consumido(0), externos(0), inicioTrama(0) {}
+
+    void u8(uint8_t valor) { agregar(reinterpret_cast<const char*>(&valor), 1); }
+
+    void u16(uint16_t valor) {
+        char b[2];
+        escribirU16(b, valor);
+        agregar(b, 2);
+    }
+
+    void u32(uint32_t valor) {
+        char b[4];
+        escribirU32(b, valor);
+        agregar(b, 4);
+    }
+
+    void i32(int32_t valor) { u32(static_cast<uint32_t>(valor)); }
+
+    void u64(uint64_t valor) {
+        char b[8];
+        escribirU64(b, valor);
+        agregar(b, 8);
+    }
+
+    void f64(double valor) {
+        uint64_t bits;
+        std::memcpy(&bits, &valor, sizeof(bits));
+        char b[8];
+        escribirU64(b, bits);
+        agregar(b, 8);
+    }
+
+    // Nombre con prefijo u16; los nombres ms largos se recortan a 65535 bytes.
+    void nombre(const char* datos, std::size_t longitud) {
+        if (longitud > 0xFFFF) longitud = 0xFFFF;
+        u16(static_cast<uint16_t>(longitud));
+        texto(datos, longitud);
+    }
+
+    // Descripcin con prefijo u32.
+    void descripcion(const char* datos, std::size_t longitud) {
+        u32(static_cast<uint32_t>(longitud));
+        texto(datos, longitud);
+    }
+
+    // Copia bytes al bfer propio.
+    void agregar(const char* datos, std::size_t longitud) {
+        if (fragmentos.empty() || fragmentos.back().externo || fragmentos.back().desplazamiento + fragmentos.back().longitud != bytes.size()) {
+            Fragmento fragmento = {nullptr, bytes.size(), 0};
+            fragmentos.push_back(fragmento);
+        }
+        bytes.append(datos, longitud);
+        fragmentos.back().longitud += longitud;
+        total += longitud;
+    }
+
+    // Agrega un texto: lo referencia si es largo y lo copia si es corto.
+    void texto(const char* datos, std::size_t longitud) {
+        if (longitud < UMBRAL_REFERENCIA) {
+            agregar(datos, longitud);
+            return;
+        }
+        Fragmento fragmento = {datos, 0, longitud};
+        fragmentos.push_back(fragmento);
+        total += longitud;
+        ++externos;
+    }
+
+    // Reserva n bytes en el bfer propio para completarlos despus (longitudes, cuentas).
+    std::size_t reservar(std::size_t n) {
+        std::size_t desplazamiento = bytes.size();
+        agregar("\0\0\0\0\0\0\0\0", n);
+        return desplazamiento;
+    }
+
+    void completarU32(std::size_t desplazamiento, uint32_t valor) { escribirU32(&bytes[desplazamiento], valor); }
+
+    // Abre una trama de respuesta; devuelve la marca que necesita cerrarTrama.
+    std::size_t abrirTrama(uint8_t operacion, uint8_t estado) {
+        std::size_t marca = reservar(4);
+        inicioTrama = total;
+        u8(operacion);
+        u8(estado);
+        return marca;
+    }
+
+    void cerrarTrama(std::size_t marca) { completarU32(marca, static_cast<uint32_t>(total - inicioTrama)); }
+
+    // Cambia el estado de la trama abierta (est justo despus de la operacin).
+    void fijarEstado(std::size_t marca, uint8_t estado) { bytes[marca + 5] = static_cast<char>(estado); }
+
+    // Copia las referencias externas pendientes al bfer propio.
+    void materializar() {
+        if (externos == 0) return;
+        for (std::size_t i = primero; i < fragmentos.size(); ++i) {
+            Fragmento& fragmento = fragmentos[i];
+            if (fragmento.externo) {
+                std::size_t desplazamiento = bytes.size();
+                bytes.append(fragmento.externo, fragmento.longitud);
+                fragmento.externo = nullptr;
+                fragmento.desplazamiento = desplazamiento;
+            }
+        }
+        externos = 0;
+    }
+
+    // Bytes an sin enviar.
+    std::size_t pendiente() const { return total - enviados; }
+
+    void limpiar() {
+        bytes.clear();
+        fragmentos.clear();
+        total = enviados = 0;
+        primero = consumido = 0;
+        externos = 0;
+    }
+
+    // Recorre los tramos pendientes en orden: f(const char* datos, size_t longitud).
+    template <class F>
+    void recorrer(F f) const {
+        for (std::size_t i = primero; i < fragmentos.size(); ++i) {
+            std::size_t saltar = i == primero ? consumido : 0;
+            f(inicio(fragmentos[i]) + saltar, fragmentos[i].longitud - saltar);
+        }
+    }
+
+#ifdef __linux__
+    // Enva con writev todo lo que el socket acepte. Devuelve false si la conexin fall.
+    bool enviar(int fd) {
+        const std::size_t maximo = IOV_MAX < 1024 ? IOV_MAX : 1024;
+        iovec vector[1024];
+        while (primero < fragmentos.size()) {
+            std::size_t n = 0;
+            for (std::size_t i = primero; i < fragmentos.size() && n < maximo; ++i, ++n) {
+                std::size_t saltar = i == primero ? consumido : 0;
+                vector[n].iov_base = const_cast<char*>(inicio(fragmentos[i]) + saltar);
+                vector[n].iov_len = fragmentos[i].longitud - saltar;
+            }
+            ssize_t escritos = ::writev(fd, vector, static_cast<int>(n));
+            if (escritos < 0) {
+                return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+            }
+            avanzar(static_cast<std::size_t>(escritos));
+            if (static_cast<std::size_t>(escritos) == 0) {
+                break;
+            }
+        }
+        if (pendiente() == 0) {
+            limpiar();
+        }
+        return true;
+    }
+#endif
+
+private:
+    struct Fragmento {
+        const char* externo;        // Memoria externa, o nullptr si el tramo est en bytes.
+        std::size_t desplazamiento; // Posicin en bytes (solo tramos propios).
+        std::size_t longitud;
+    };
+
+    const char* inicio(const Fragmento& fragmento) const {
+        return fragmento.externo ? fragmento.externo : bytes.data() + fragmento.desplazamiento;
+    }
+
+    // Descarta n bytes ya enviados del principio de la secuencia.
+    void avanzar(std::size_t n) {
+        enviados += n;
+        while (n > 0 && primero < fragmentos.size()) {
+            std::size_t resto = fragmentos[primero].longitud - consumido;
+            if (n < resto) {
+                consumido += n;
+                return;
+            }
+            n -= resto;
+            if (fragmentos[primero].externo) --externos;
+            ++primero;
+            consumido = 0;
+        }
+    }
+
+    std::string bytes;                 // Bfer propio.
+    std::vector<Fragmento> fragmentos; // Orden de envo.
+    std::size_t total;                 // Bytes lgicos agregados (propios y externos).
+    std::size_t enviados;              // Bytes ya enviados.
+    std::size_t primero;               // Primer fragmento sin enviar por completo.
+    std::size_t consumido;             // Bytes enviados de fragmentos[primero].
+    std::size_t externos;              // Referencias externas an sin enviar.
+    std::size_t inicioTrama;           // total al abrir la trama en curso.
+};
+
+// ---------------------------------------------------------------------------
+// Ejecucin de peticiones
+// ---------------------------------------------------------------------------
+
+// Operaciones que no modifican el sistema: sus respuestas pueden referenciar el almacn.
+inline bool operacionDeLectura(uint8_t operacion) {
+    return operacion == 3 || operacion == 4 || operacion == 7 || operacion == 8 || operacion == 11 || operacion == 22 ||
+           operacion == 26 || operacion == 27;
+}
+
+// Ejecuta una trama de peticin (operacin y argumentos, sin el prefijo de longitud)
+// y agrega la trama de respuesta a la salida.
+template <class Sistema>
+void ejecutarTramaBinaria(Sistema& sistema, const char* trama, std::size_t longitud, SalidaVectorial& salida, int& siguienteId) {
+    LectorTrama lector(trama, longitud);
+    uint8_t operacion = lector.u8();
+    if (!operacionDeLectura(operacion)) {
+        salida.materializar(); // Lo que ya se referenci podra moverse o liberarse.
+    }
+    std::size_t marca = salida.abrirTrama(operacion, EstadoCorrecto);
+    uint8_t estado = EstadoCorrecto;
+
+    switch (operacion) {
+        case 1: {
+            Producto producto;
+            producto.precio = lector.f64();
+            producto.cantidad = lector.i32();
+            VistaNombre nombre = lector.nombre();
+            if (!lector.correcto()) {
+                estado = EstadoError;
+                break;
+            }
+            producto.nombre.assign(nombre.datos, nombre.longitud);
+            sistema.registrarProducto(producto);
+            break;
+        }
+        case 2: {
+            VistaNombre nombre = lector.nombre();
+            if (!lector.correcto()) {
+                estado = EstadoError;
+            } else if (!sistema.quitarProducto(nombre)) {
+                estado = EstadoNoEncontrado;
+            }
+            break;
+        }
+        case 3: {
+            VistaNombre nombre = lector.nombre();
+            if (!lector.correcto()) {
+                estado = EstadoError;
+                break;
+            }
+            bool encontrado = sistema.buscarProducto(nombre, [&salida](const VistaProducto& producto) {
+                salida.f64(producto.precio);
+                salida.i32(producto.cantidad);
+            });
+            if (!encontrado) estado = EstadoNoEncontrado;
+            break;
+        }
+        case 4: {
+            std::size_t cuenta = salida.reservar(4);
+            uint32_t n = 0;
+            sistema.recorrerProductos([&salida, &n](const VistaProducto& producto) {
+                salida.f64(producto.precio);
+                salida.i32(producto.cantidad);
+                salida.nombre(producto.nombre.datos, producto.nombre.longitud);
+                ++n;
+            });
+            salida.completarU32(cuenta, n);
+            break;
+        }
+        case 5: {
+            VistaNombre descripcion = lector.descripcion();
+            if (!lector.correcto()) {
+                estado = EstadoError;
+                break;
+            }
+            Solicitud solicitud;
+            solicitud.id = siguienteId++;
+            solicitud.descripcion.assign(descripcion.datos, descripcion.longitud);
+            sistema.registrarSolicitud(solicitud);
+            salida.i32(solicitud.id);
+            break;
+        }
+        case 6: {
+            Solicitud solicitud;
+            if (sistema.tomarSolicitud(solicitud)) {
+                salida.i32(solicitud.id);
+                salida.u32(static_cast<uint32_t>(solicitud.descripcion.size()));
+                salida.agregar(solicitud.descripcion.data(), solicitud.descripcion.size()); // Es local: se copia.
+            } else {
+                estado = EstadoVacio;
+            }
+            break;
+        }
+        case 7: {
+            bool hay = sistema.verSolicitudEnProceso([&salida](const Solicitud& solicitud) {
+                salida.i32(solicitud.id);
+                salida.descripcion(solicitud.descripcion.data(), solicitud.descripcion.size());
+            });
+            if (!hay) estado = EstadoVacio;
+            break;
+        }
+        case 8: {
+            std::size_t cuenta = salida.reservar(4);
+            uint32_t n = 0;
+            sistema.recorrerSolicitudes([&salida, &n](const Solicitud& solicitud) {
+                salida.i32(solicitud.id);
+                salida.descripcion(solicitud.descripcion.data(), solicitud.descripcion.size());
+                ++n;
+            });
+            salida.completarU32(cuenta, n);
+            break;
+        }
+        case 9: {
+            VistaNombre nombre = lector.nombre();
+            if (!lector.correcto()) {
+                estado = EstadoError;
+                break;
+            }
+            Cliente cliente;
+            cliente.id = siguienteId++;
+            cliente.nombre.assign(nombre.datos, nombre.longitud);
+            sistema.registrarClienteEnEspera(cliente);
+            salida.i32(cliente.id);
+            break;
+        }
+        case 10: {
+            Cliente cliente;
+            if (sistema.tomarCliente(cliente)) {
+                salida.i32(cliente.id);
+                std::size_t n = cliente.nombre.size() > 0xFFFF ? 0xFFFF : cliente.nombre.size();
+                salida.u16(static_cast<uint16_t>(n));
+                salida.agregar(cliente.nombre.data(), n);
+            } else {
+                estado = EstadoVacio;
+            }
+            break;
+        }
+        case 11: {
+            std::size_t cuenta = salida.reservar(4);
+            uint32_t n = 0;
+            sistema.recorrerClientes([&salida, &n](const Cliente& cliente) {
+                salida.i32(cliente.id);
+                salida.nombre(cliente.nombre.data(), cliente.nombre.size());
+                ++n;
+            });
+            salida.completarU32(cuenta, n);
+            break;
+        }
+        case 12: {
+            Cambio cambio;
+            ResultadoDeshacer resultado = sistema.revertirUltimoCambio(cambio);
+            if (resultado == NadaQueDeshacer) {
+                estado = EstadoVacio;
+                break;
+            }
+            salida.u8(static_cast<uint8_t>(resultado));
+            std::size_t n = cambio.producto.nombre.size() > 0xFFFF ? 0xFFFF : cambio.producto.nombre.size();
+            salida.u16(static_cast<uint16_t>(n));
+            salida.agregar(cambio.producto.nombre.data(), n);
+            break;
+        }
+        case 14:
+            sistema.congelarCatalogo();
+            if (sistema.catalogoCongelado()) {
+                std::size_t cuenta = salida.reservar(4);
+                uint32_t n = 0;
+                sistema.recorrerProductos([&n](const VistaProducto&) { ++n; });
+                salida.completarU32(cuenta, n);
+            } else {
+                estado = EstadoError;
+            }
+            break;
+        case 15:
+            if (sistema.catalogoCongelado()) {
+                sistema.descongelarCatalogo();
+            } else {
+                estado = EstadoVacio;
+            }
+            break;
+        case 22: {
+            std::size_t cuenta = salida.reservar(4);
+            uint32_t n = 0;
+            for (int i = 0; i < CANTIDAD_OPERACIONES_SISTEMA; ++i) {
+                const HistogramaLatencia& h = sistema.latencias().operacion(static_cast<OperacionSistema>(i));
+                if (h.cantidad() == 0) continue;
+                salida.u8(static_cast<uint8_t>(i));
+                salida.u64(h.cantidad());
+                salida.u64(h.percentil(0.50));
+                salida.u64(h.percentil(0.90));
+                salida.u64(h.percentil(0.99));
+                salida.u64(h.percentil(0.999));
+                salida.u64(h.valorMaximo());
+                ++n;
+            }
+            salida.completarU32(cuenta, n);
+            break;
+        }
+        case 23:
+            sistema.reiniciarLatencias();
+            break;
+        case 26: {
+            VistaNombre prefijo = lector.nombre();
+            if (!lector.correcto()) {
+                estado = EstadoError;
+                break;
+            }
+            std::size_t cuenta = salida.reservar(4);
+            uint32_t n = 0;
+            // Los nombres se copian: consultar un producto reordena el autocompletado.
+            sistema.completarProducto(prefijo, SUGERENCIAS_AUTOCOMPLETADO, [&salida, &n](const VistaNombre& nombre, uint32_t consultas) {
+                std::size_t longitud = nombre.longitud > 0xFFFF ? 0xFFFF : nombre.longitud;
+                salida.u32(consultas);
+                salida.u16(static_cast<uint16_t>(longitud));
+                salida.agregar(nombre.datos, longitud);
+                ++n;
+            });
+            salida.completarU32(cuenta, n);
+            break;
+        }
+        case 27: {
+            VistaNombre palabras = lector.descripcion();
+            if (!lector.correcto()) {
+                estado = EstadoError;
+                break;
+            }
+            std::size_t cuenta = salida.reservar(4);
+            uint32_t n = 0;
+            sistema.buscarSolicitudes(palabras, [&salida, &n](const Solicitud& solicitud) {
+                salida.i32(solicitud.id);
+                salida.descripcion(solicitud.descripcion.data(), solicitud.descripcion.size());
+                ++n;
+            });
+            salida.completarU32(cuenta, n);
+            break;
+        }
+        default:
+            estado = EstadoError;
+    }
+    if (estado != EstadoCorrecto) {
+        salida.fijarEstado(marca, estado);
+    }
+    salida.cerrarTrama(marca);
+}
+
+// ---------------------------------------------------------------------------
+// Codificacin de peticiones (lado del cliente)
+// ---------------------------------------------------------------------------
+
+// Arma tramas de peticin en una cadena; se usa desde los clientes y los benchmarks.
+class CodificadorPeticiones {
+public:
+    explicit CodificadorPeticiones(std::string& destino) : destino(destino) {}
+
+    void registrarProducto(const std::string& nombre, double precio, int cantidad) {
+        std::size_t marca = abrir(1);
+        uint64_t bits;
+        std::memcpy(&bits, &precio, sizeof(bits));
+        char b[8];
+        escribirU64(b, bits);
+        destino.append(b, 8);
+        u32(static_cast<uint32_t>(cantidad));
+        nombre16(nombre);
+        cerrar(marca);
+    }
+
+    void eliminarProducto(const std::string& nombre) { conNombre(2, nombre); }
+    void consultarProducto(const std::string& nombre) { conNombre(3, nombre); }
+    void registrarClienteEnEspera(const std::string& nombre) { conNombre(9, nombre); }
+    void autocompletarProducto(const std::string& prefijo) { conNombre(26, prefijo); }
+
+    void registrarSolicitud(const std::string& descripcion) { conDescripcion(5, descripcion); }
+    void buscarSolicitudesPendientes(const std::string& palabras) { conDescripcion(27, palabras); }
+
+    // Operaciones sin argumentos: 4, 6, 7, 8, 10, 11, 12, 14, 15, 22 y 23.
+    void operacion(uint8_t numero) { cerrar(abrir(numero)); }
+
+private:
+    std::size_t abrir(uint8_t numero) {
+        std::size_t marca = destino.size();
+        destino.append(4, '\0');
+        destino.push_back(static_cast<char>(numero));
+        return marca;
+    }
+
+    void cerrar(std::size_t marca) {
+        escribirU32(&destino[marca], static_cast<uint32_t>(destino.size() - marca - 4));
+    }
+
+    void u32(uint32_t valor) {
+        char b[4];
+        escribirU32(b, valor);
+        destino.append(b, 4);
+    }
+
+    void nombre16(const std::string& nombre) {
+        char b[2];
+        escribirU16(b, static_cast<uint16_t>(nombre.size()));
+        destino.append(b, 2);
+        destino += nombre;
+    }
+
+    void conNombre(uint8_t numero, const std::string& nombre) {
+        std::size_t marca = abrir(numero);
+        nombre16(nombre);
+        cerrar(marca);
+    }
+
+    void conDescripcion(uint8_t numero, const std::string& texto) {
+        std::size_t marca = abrir(numero);
+        u32(static_cast<uint32_t>(texto.size()));
+        destino += texto;
+        cerrar(marca);
+    }
+
+    std::string& destino;
+};
+
+// Latencias de una operacin segn la respuesta a 22, en nanosegundos.
+struct LatenciaRemota {
+    uint8_t operacion; // OperacionSistema.
+    uint64_t cuenta;
+    uint64_t p50;
+    uint64_t p90;
+    uint64_t p99;
+    uint64_t p999;
+    uint64_t maximo;
+};
+
+// Decodifica los datos de una respuesta a 22 (lo que sigue al u8 de estado). Devuelve
+// false si estn mal formados.
+inline bool decodificarLatencias(const char* datos, std::size_t longitud, std::vector<LatenciaRemota>& latencias) {
+    LectorTrama lector(datos, longitud);
+    uint32_t n = lector.u32();
+    latencias.clear();
+    if (longitud != 4 + static_cast<std::size_t>(n) * (1 + 6 * 8)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+        LatenciaRemota l;
+        l.operacion = lector.u8();
+        l.cuenta = lector.u64();
+        l.p50 = lector.u64();
+        l.p90 = lector.u64();
+        l.p99 = lector.u64();
+        l.p999 = lector.u64();
+        l.maximo = lector.u64();
+        latencias.push_back(l);
+    }
+    return lector.correcto();
+}
+
+// Cuenta las tramas completas al principio de [datos, datos + longitud) y devuelve
+// en consumidos los bytes que ocupan.
+inline std::size_t tramasCompletas(const char* datos, std::size_t longitud, std::size_t& consumidos) {
+    std::size_t n = 0;
+    consumidos = 0;
+    while (longitud - consumidos >= 4) {
+        std::size_t tamano = 4 + static_cast<std::size_t>(leerU32(datos + consumidos));
+        if (longitud - consumidos < tamano) {
+            break;
+        }
+        consumidos += tamano;
+        ++n;
+    }
+    return n;
+}
+
+#endif
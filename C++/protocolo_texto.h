@@ -0,0 +1,234 @@
+#ifndef PROTOCOLO_TEXTO_H
+#define PROTOCOLO_TEXTO_H
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <cstddef>
+
+#include "estructuras.h"
+
+// Protocolo de texto
+// Cada peticin es una lnea con el nmero de la opcin del men y sus argumentos;
+// la respuesta son los mismos mensajes que imprime el men, terminados por una lnea
+// vaca. Lo usan el modo servidor y la tubera de comandos (tuberia_comandos.h).
+// El servidor rechaza 16, 17 y 18 (ver opcionSoloLocal): reciben rutas del cliente.
+//
+//   1 <nombre> <precio> <cantidad>     Registrar producto
+//   2 <nombre>                         Eliminar producto
+//   3 <nombre>                         Consultar producto
+//   4                                  Listar productos
+//   5 <descripcin hasta fin de lnea> Registrar solicitud
+//   6 | 7 | 8                          Procesar / en proceso / pendientes
+//   9 <nombre>                         Registrar cliente en espera
+//   10 | 11 | 12                       Atender / lista de espera / deshacer
+//   14 | 15                            Congelar / descongelar catlogo
+//   16 | 17 <ruta>                     Guardar / cargar catlogo en un archivo
+//   18 <regin>                        Publicar inventario en memoria compartida
+//   22 | 23                            Latencias por operacin / reiniciarlas
+//   24                                 Memoria por estructura
+//   25 <bytes>                         Alerta de memoria (0 la desactiva)
+//   26 <prefijo>                       Autocompletar producto
+//   27 <palabras hasta fin de lnea>   Buscar solicitudes pendientes
+//
+// Analizar y ejecutar estn separados para que puedan correr en hilos distintos:
+// analizarPeticionTexto no toca el sistema y ejecutarComandoTexto no mira el texto.
+
+// Peticin ya analizada.
+struct ComandoTexto {
+    int opcion;         // Nmero de la opcin; 0 si no es vlida.
+    bool incompleto;    // Faltan argumentos.
+    Producto producto;  // Opcin 1; en 2, 3 y 26 solo se usa el nombre.
+    std::string texto;  // Descripcin (5), cliente (9), ruta (16, 17), regin (18), umbral (25) o palabras (27).
+};
+
+// Extrae la siguiente palabra (separada por espacios) de [p, fin).
+inline VistaNombre siguientePalabra(const char*& p, const char* fin) {
+    while (p < fin && (*p == ' ' || *p == '\t')) {
+        ++p;
+    }
+    const char* inicio = p;
+    while (p < fin && *p != ' ' && *p != '\t') {
+        ++p;
+    }
+    VistaNombre palabra = {inicio, static_cast<std::size_t>(p - inicio)};
+    return palabra;
+}
+
+// Opciones que escriben archivos o crean memoria compartida con los permisos del
+// proceso: solo se aceptan desde la mquina local (men, guiones, trazas).
+inline bool opcionSoloLocal(int opcion) {
+    return opcion == 16 || opcion == 17 || opcion == 18;
+}
+
+// Analiza una peticin de texto (sin el salto de lnea).
+inline void analizarPeticionTexto(const char* linea, std::size_t longitud, ComandoTexto& comando) {
+    const char* p = linea;
+    const char* fin = linea + longitud;
+    if (fin > p && fin[-1] == '\r') {
+        --fin;
+    }
+    VistaNombre opcion = siguientePalabra(p, fin);
+    comando.opcion = opcion.longitud > 0 && opcion.longitud < 4 ? std::atoi(std::string(opcion.datos, opcion.longitud).c_str()) : 0;
+    if (comando.opcion < 0) {
+        comando.opcion = 0; // "-1" no es una opcin; los negativos quedan libres como marcas internas.
+    }
+    comando.incompleto = false;
+
+    switch (comando.opcion) {
+        case 1: {
+            VistaNombre nombre = siguientePalabra(p, fin);
+            VistaNombre precio = siguientePalabra(p, fin);
+            VistaNombre cantidad = siguientePalabra(p, fin);
+            if (nombre.longitud == 0 || precio.longitud == 0 || cantidad.longitud == 0) {
+                comando.incompleto = true;
+                break;
+            }
+            comando.producto.nombre.assign(nombre.datos, nombre.longitud);
+            comando.producto.precio = std::strtod(std::string(precio.datos, precio.longitud).c_str(), nullptr);
+            comando.producto.cantidad = std::atoi(std::string(cantidad.datos, cantidad.longitud).c_str());
+            break;
+        }
+        case 2:
+        case 3:
+        case 26: {
+            VistaNombre nombre = siguientePalabra(p, fin);
+            comando.producto.nombre.assign(nombre.datos, nombre.longitud);
+            break;
+        }
+        case 5:
+        case 27:
+            while (p < fin && *p == ' ') {
+                ++p;
+            }
+            comando.texto.assign(p, fin);
+            break;
+        case 9: {
+            VistaNombre nombre = siguientePalabra(p, fin);
+            comando.texto.assign(nombre.datos, nombre.longitud);
+            break;
+        }
+        case 16:
+        case 17:
+        case 18:
+        case 25: {
+            VistaNombre argumento = siguientePalabra(p, fin);
+            comando.texto.assign(argumento.datos, argumento.longitud);
+            comando.incompleto = argumento.longitud == 0;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// Ejecuta un comando analizado. Las respuestas se escriben en la salida que el sistema
+// tenga configurada; salida recibe solo los errores del propio protocolo y la lnea
+// vaca que cierra la respuesta. Puede mover los textos del comando.
+template <class Sistema>
+void ejecutarComandoTexto(Sistema& sistema, ComandoTexto& comando, std::ostream& salida, int& siguienteId) {
+    switch (comando.opcion) {
+        case 1:
+            if (comando.incompleto) {
+                salida << "Argumentos incompletos.\n";
+            } else {
+                sistema.registrarProducto(comando.producto);
+            }
+            break;
+        case 2:
+            sistema.eliminarProducto(comando.producto.nombre);
+            break;
+        case 3:
+            sistema.consultarProducto(comando.producto.nombre);
+            break;
+        case 4:
+            sistema.listarProductos();
+            break;
+        case 5: {
+            Solicitud solicitud;
+            solicitud.id = siguienteId++;
+            solicitud.descripcion.swap(comando.texto);
+            sistema.registrarSolicitud(solicitud);
+            break;
+        }
+        case 6:
+            sistema.procesarSolicitud();
+            break;
+        case 7:
+            sistema.consultarSolicitudEnProceso();
+            break;
+        case 8:
+            sistema.listarSolicitudesPendientes();
+            break;
+        case 9: {
+            Cliente cliente;
+            cliente.id = siguienteId++;
+            cliente.nombre.swap(comando.texto);
+            sistema.registrarClienteEnEspera(cliente);
+            break;
+        }
+        case 10:
+            sistema.atenderCliente();
+            break;
+        case 11:
+            sistema.consultarListaDeEspera();
+            break;
+        case 12:
+            sistema.deshacerUltimaAccion();
+            break;
+        case 14:
+            sistema.congelarCatalogo();
+            break;
+        case 15:
+            sistema.descongelarCatalogo();
+            break;
+        case 16:
+        case 17:
+        case 18:
+            if (comando.incompleto) {
+                salida << "Argumentos incompletos.\n";
+            } else if (comando.opcion == 16) {
+                sistema.guardarCatalogo(comando.texto);
+            } else if (comando.opcion == 17) {
+                sistema.cargarCatalogo(comando.texto);
+            } else {
+                sistema.publicarReplica(comando.texto);
+            }
+            break;
+        case 22:
+            sistema.imprimirLatencias();
+            break;
+        case 23:
+            sistema.reiniciarLatencias();
+            break;
+        case 24:
+            sistema.imprimirMemoria();
+            break;
+        case 25:
+            if (comando.incompleto) {
+                salida << "Argumentos incompletos.\n";
+            } else {
+                sistema.fijarAlertaMemoria(std::strtoll(comando.texto.c_str(), nullptr, 10));
+            }
+            break;
+        case 26:
+            sistema.autocompletarProducto(comando.producto.nombre);
+            break;
+        case 27:
+            sistema.buscarSolicitudesPendientes(comando.texto);
+            break;
+        default:
+            salida << "Opcin no vlida.\n";
+    }
+    salida << '\n'; // Fin de la respuesta.
+}
+
+// Analiza y ejecuta una peticin de texto (sin el salto de lnea).
+template <class Sistema>
+void ejecutarPeticionTexto(Sistema& sistema, const char* linea, std::size_t longitud, std::ostream& salida, int& siguienteId) {
+    ComandoTexto comando;
+    analizarPeticionTexto(linea, longitud, comando);
+    ejecutarComandoTexto(sistema, comando, salida, siguienteId);
+}
+
+#endif
@@ -0,0 +1,1272 @@
+// Pruebas de comportamiento
+// Comprueban las invariantes de las estructuras propias (las que no son contenedores
+// de la biblioteca estndar) y casos que ya fallaron alguna vez. Cada prueba es una
+// funcin que usa COMPROBAR; al final se informa cuntas comprobaciones fallaron y el
+// cdigo de salida es distinto de cero si alguna fall.
+//
+// Uso: pruebas_sistema   (make pruebas la compila en C++11 y en C++20 y ejecuta las dos;
+//                         las pruebas de corrutinas solo existen en la de C++20)
+//
+// Los archivos temporales se crean en el directorio actual y se borran al terminar.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <map>
+#include <deque>
+#include <sstream>
+#include <cstdio>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <csignal>
+#include <cstring>
+#include <cstdlib>
+
+#include <unistd.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "estructuras.h"
+#include "catalogo_congelado.h"
+#include "replica_compartida.h"
+#include "sistema_gestion.h"
+#include "tuberia_comandos.h"
+#include "motor_particionado.h"
+#include "registro_mensajes.h"
+#include "sistema_asincrono.h"
+#include "metricas.h"
+#include "compresion_bloques.h"
+#include "auditoria.h"
+#include "autocompletado.h"
+#include "registro_almacenes.h"
+#include "busqueda_aproximada.h"
+#include "indice_solicitudes.h"
+#include "filtro_ausentes.h"
+#include "nombres_normalizados.h"
+#include "protocolo_texto.h"
+#include "protocolo_binario.h"
+#include "servidor.h"
+
+static int comprobaciones = 0;
+static int fallos = 0;
+
+#define COMPROBAR(condicion)                                                                      \
+    do {                                                                                          \
+        ++comprobaciones;                                                                         \
+        if (!(condicion)) {                                                                       \
+            ++fallos;                                                                             \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": fall " << #condicion << std::endl;   \
+        }                                                                                         \
+    } while (0)
+
+static std::string texto(const VistaNombre& vista) { return std::string(vista.datos, vista.longitud); }
+
+// Productos con nombres y precios distintos, ordenados por nombre como pide construir.
+static void productosOrdenados(std::size_t n, std::vector<std::string>& nombres, std::vector<VistaProducto>& productos) {
+    nombres.clear();
+    for (std::size_t i = 0; i < n; ++i) {
+        nombres.push_back("producto" + std::to_string(i));
+    }
+    nombres.push_back("producto7"); // Un nombre repetido: buscar da el primero.
+    std::stable_sort(nombres.begin(), nombres.end());
+    productos.clear();
+    for (std::size_t i = 0; i < nombres.size(); ++i) {
+        VistaProducto p;
+        p.nombre = vistaDe(nombres[i]);
+        p.precio = 1.0 + static_cast<double>(i);
+        p.cantidad = static_cast<int>(i % 5);
+        productos.push_back(p);
+    }
+}
+
+// Catlogo congelado: la funcin hash perfecta encuentra cada nombre y rechaza los
+// ajenos, los agregados coinciden, y una imagen guardada se proyecta igual.
+static void probarCatalogoCongelado() {
+    std::vector<std::string> nombres;
+    std::vector<VistaProducto> productos;
+    productosOrdenados(3000, nombres, productos);
+
+    CatalogoCongelado catalogo;
+    COMPROBAR(catalogo.construir(productos));
+    COMPROBAR(catalogo.tamano() == productos.size());
+    COMPROBAR(catalogo.nombresDistintos() == productos.size() - 1);
+
+    int64_t unidades = 0;
+    double valor = 0;
+    for (const VistaProducto& p : productos) {
+        unidades += p.cantidad;
+        valor += p.precio * p.cantidad;
+    }
+    COMPROBAR(catalogo.unidadesTotales() == unidades);
+    COMPROBAR(catalogo.valorTotal() == valor);
+
+    bool todos = true;
+    for (std::size_t i = 0; i < productos.size(); ++i) {
+        VistaProducto encontrado;
+        std::size_t primero = i;
+        while (primero > 0 && nombres[primero - 1] == nombres[i]) --primero;
+        todos = todos && catalogo.buscar(nombres[i], encontrado) && encontrado.precio == productos[primero].precio;
+    }
+    COMPROBAR(todos);
+
+    bool ajenos = true;
+    for (int i = 0; i < 3000; ++i) {
+        VistaProducto encontrado;
+        ajenos = ajenos && !catalogo.buscar("otro" + std::to_string(i), encontrado);
+    }
+    COMPROBAR(ajenos);
+
+    std::size_t orden = 0;
+    bool ordenado = true;
+    catalogo.recorrerOrdenado([&](const VistaProducto& p) { ordenado = ordenado && texto(p.nombre) == nombres[orden++]; });
+    COMPROBAR(ordenado && orden == nombres.size());
+
+    const std::string ruta = "pruebas_catalogo.img";
+    COMPROBAR(catalogo.guardar(ruta));
+    CatalogoCongelado proyectado;
+    COMPROBAR(proyectado.abrir(ruta) && proyectado.proyectado());
+    VistaProducto encontrado;
+    COMPROBAR(proyectado.buscar(nombres[10], encontrado) && encontrado.precio == productos[10].precio);
+
+    // Guardar encima de la imagen proyectada no debe invalidar la proyeccin (antes la
+    // truncaba en el sitio y la lectura siguiente mora con SIGBUS).
+    std::vector<std::string> otrosNombres;
+    std::vector<VistaProducto> otros;
+    productosOrdenados(10, otrosNombres, otros);
+    CatalogoCongelado pequeno;
+    COMPROBAR(pequeno.construir(otros));
+    COMPROBAR(pequeno.guardar(ruta));
+    COMPROBAR(proyectado.buscar(nombres[2999], encontrado) && proyectado.tamano() == productos.size());
+    CatalogoCongelado nuevo;
+    COMPROBAR(nuevo.abrir(ruta) && nuevo.tamano() == otros.size());
+
+    // Una imagen truncada o con otra marca no se abre.
+    COMPROBAR(catalogo.guardar(ruta));
+    CatalogoCongelado danado;
+    COMPROBAR(truncate(ruta.c_str(), static_cast<off_t>(catalogo.bytes() / 2)) == 0 && !danado.abrir(ruta));
+    std::FILE* archivo = std::fopen(ruta.c_str(), "r+b");
+    COMPROBAR(archivo != nullptr);
+    if (archivo) {
+        std::fputc('X', archivo);
+        std::fclose(archivo);
+    }
+    COMPROBAR(!danado.abrir(ruta));
+    std::remove(ruta.c_str());
+    COMPROBAR(!danado.abrir(ruta));
+}
+
+// Rplica compartida: refleja altas y bajas, y una que se desbord vuelve a publicar
+// (y quita la marca) cuando el inventario baja a la mitad de su capacidad.
+static void probarReplicaCompartida() {
+    const std::string region = "/pruebas_replica_" + std::to_string(getpid());
+    SistemaGestion sistema(nullptr);
+    COMPROBAR(sistema.publicarReplica(region, 10)); // 16 ranuras: caben 11 productos.
+    LectorReplica lector;
+    COMPROBAR(lector.abrir(region));
+
+    for (int i = 0; i < 5; ++i) {
+        sistema.registrarProducto(Producto{"p" + std::to_string(i), 2.0, 3});
+    }
+    sistema.eliminarProducto("p0");
+    Producto copia;
+    COMPROBAR(lector.resumen().productos == 4 && lector.resumen().unidades == 12);
+    COMPROBAR(lector.buscar("p1", copia) && copia.precio == 2.0 && !lector.buscar("p0", copia));
+
+    for (int i = 5; i < 14; ++i) {
+        sistema.registrarProducto(Producto{"p" + std::to_string(i), 2.0, 3});
+    }
+    COMPROBAR(lector.resumen().desbordada);
+    for (int i = 1; i < 9; ++i) {
+        sistema.eliminarProducto("p" + std::to_string(i));
+    }
+    LectorReplica::Resumen resumen = lector.resumen();
+    COMPROBAR(!resumen.desbordada && resumen.productos == 5);
+    COMPROBAR(lector.buscar("p13", copia) && !lector.buscar("p8", copia));
+
+}
+
+// Tubera de comandos: da la misma salida que la ejecucin secuencial, tambin con
+// lneas que no son opciones vlidas ("-1" terminaba la tubera antes de tiempo).
+static void probarTuberiaComandos() {
+    const std::string guion = "1 leche 2 3\n-1\n3 leche\n5 revisar stock\n8\n99\n2 leche\n12\n4\n";
+    std::istringstream entradaSecuencial(guion), entradaTuberia(guion);
+    std::ostringstream salidaSecuencial, salidaTuberia;
+    SistemaGestion secuencial(nullptr), tuberia(nullptr);
+    InformeGuion informeSecuencial = ejecutarGuionSecuencial(secuencial, entradaSecuencial, salidaSecuencial);
+    InformeGuion informeTuberia = ejecutarGuionEnTuberia(tuberia, entradaTuberia, salidaTuberia);
+    COMPROBAR(informeSecuencial.comandos == 9 && informeTuberia.comandos == 9);
+    COMPROBAR(salidaTuberia.str() == salidaSecuencial.str());
+    COMPROBAR(salidaTuberia.str().find("Producto: leche") != std::string::npos);
+
+    ComandoTexto comando;
+    analizarPeticionTexto("-1", 2, comando);
+    COMPROBAR(comando.opcion == 0);
+}
+
+// Etiquetas de mtricas: los nombres en Latin-1 salen en UTF-8, los que ya estn en
+// UTF-8 salen iguales, y todos con escapes.
+static void probarEtiquetasMetricas() {
+    COMPROBAR(escaparEtiqueta("norte") == "norte");
+    COMPROBAR(escaparEtiqueta("Almac\xE9n \"sur\"\\\n") == "Almac\xC3\xA9n \\\"sur\\\"\\\\\\n");
+    COMPROBAR(escaparEtiqueta("\xFF") == "\xC3\xBF");
+    // UTF-8 vlido pasa tal cual, as "caf" da la misma etiqueta escrito de las dos formas.
+    COMPROBAR(escaparEtiqueta("caf\xC3\xA9") == escaparEtiqueta("caf\xE9"));
+    COMPROBAR(escaparEtiqueta("5 \xE2\x82\xAC \xF0\x9F\x8D\x9E") == "5 \xE2\x82\xAC \xF0\x9F\x8D\x9E");
+    // Secuencias truncadas, largas o de sustitutos: cada byte se toma como Latin-1.
+    COMPROBAR(escaparEtiqueta("\xC3") == "\xC3\x83");
+    COMPROBAR(escaparEtiqueta("\xC0\xAF") == "\xC3\x80\xC2\xAF");
+    COMPROBAR(escaparEtiqueta("\xED\xA0\x80") == "\xC3\xAD\xC2\xA0\xC2\x80");
+}
+
+// Cambia un byte de un archivo.
+static bool alterarByte(const std::string& ruta, long posicion) {
+    std::FILE* archivo = std::fopen(ruta.c_str(), "r+b");
+    if (!archivo) {
+        return false;
+    }
+    std::fseek(archivo, posicion, SEEK_SET);
+    int c = std::fgetc(archivo);
+    std::fseek(archivo, posicion, SEEK_SET);
+    std::fputc(c ^ 0x5A, archivo);
+    std::fclose(archivo);
+    return true;
+}
+
+// Compresin por bloques: ida y vuelta de datos repetitivos y aleatorios de varios
+// tamaos, entradas mal formadas rechazadas y valores conocidos de XXH64.
+static void probarCompresionBloques() {
+    uint64_t estado = 12345;
+    bool idaYVuelta = true;
+    const std::size_t tamanos[] = {0, 1, 12, 13, 100, 4096, 70000};
+    for (std::size_t n : tamanos) {
+        for (int aleatorio = 0; aleatorio < 2; ++aleatorio) {
+            std::string original(n, '\0');
+            for (std::size_t i = 0; i < n; ++i) {
+                estado = estado * 6364136223846793005ULL + 1442695040888963407ULL;
+                original[i] = aleatorio ? static_cast<char>(estado >> 56) : "alta leche 2.5 "[i % 15];
+            }
+            std::vector<char> comprimido(cotaComprimido(n));
+            std::size_t bytes = comprimirBloque(original.data(), n, comprimido.data());
+            std::string vuelta(n + 8, '\0');
+            std::size_t escritos = 0;
+            idaYVuelta = idaYVuelta && bytes <= comprimido.size() &&
+                         descomprimirBloque(comprimido.data(), bytes, &vuelta[0], n, escritos) && escritos == n &&
+                         vuelta.compare(0, n, original) == 0;
+            if (!aleatorio && n >= 4096) {
+                COMPROBAR(bytes < n / 4); // Lo repetitivo se achica.
+            }
+        }
+    }
+    COMPROBAR(idaYVuelta);
+
+    std::string original(1000, 'x');
+    std::vector<char> comprimido(cotaComprimido(original.size()));
+    std::size_t bytes = comprimirBloque(original.data(), original.size(), comprimido.data());
+    std::vector<char> destino(original.size());
+    std::size_t escritos = 0;
+    COMPROBAR(!descomprimirBloque(comprimido.data(), bytes, destino.data(), original.size() - 1, escritos));
+    COMPROBAR(!descomprimirBloque(comprimido.data(), bytes - 1, destino.data(), destino.size(), escritos));
+
+    COMPROBAR(resumenXXH64("", 0, 0) == 0xEF46DB3751D8E999ULL);
+    COMPROBAR(resumenXXH64("a", 1, 0) == 0xD24EC4F1A98C6E5BULL);
+    COMPROBAR(resumenXXH64("abc", 3, 0) == 0x44BC2CF5AD770999ULL);
+    const char* largo = "Nobody inspects the spammish repetition";
+    COMPROBAR(resumenXXH64(largo, std::strlen(largo), 0) == 0xFBCEA83C8A378BF1ULL);
+}
+
+// Registro de auditora: lo registrado se lee igual en varios bloques encadenados,
+// la marca de cierre distingue un registro completo de uno cortado, al reabrirlo la
+// cadena sigue, y un byte cambiado rompe la verificacin.
+static void probarAuditoria() {
+    const std::string ruta = "pruebas_auditoria.log";
+    std::remove(ruta.c_str());
+    const int altas = 20000; // Ms de un bloque de 64 KB.
+    {
+        RegistroAuditoria registro;
+        COMPROBAR(registro.abrir(ruta));
+        std::string almacen = "principal";
+        for (int i = 0; i < altas; ++i) {
+            std::string nombre = "producto" + std::to_string(i % 500);
+            registro.producto(AuditoriaProductoRegistrado, vistaDe(almacen), vistaDe(nombre), 1.5 + i, i % 7);
+        }
+        std::string cliente = "Ana";
+        registro.cliente(AuditoriaClienteRegistrado, vistaDe(almacen), 41, vistaDe(cliente));
+        registro.cerrar();
+        COMPROBAR(registro.cantidadBloques() > 1);
+        COMPROBAR(registro.bytesEnDisco() < registro.bytesSinComprimir());
+    }
+
+    int leidos = 0;
+    bool iguales = true;
+    {
+        LectorAuditoria lector;
+        COMPROBAR(lector.abrir(ruta));
+        EventoAuditoria evento;
+        while (lector.siguiente(evento)) {
+            if (leidos < altas) {
+                iguales = iguales && evento.operacion == AuditoriaProductoRegistrado &&
+                          texto(evento.nombre) == "producto" + std::to_string(leidos % 500) &&
+                          evento.precio == 1.5 + leidos && evento.cantidad == leidos % 7 && texto(evento.almacen) == "principal";
+            } else {
+                iguales = iguales && evento.operacion == AuditoriaClienteRegistrado && evento.id == 41 &&
+                          texto(evento.nombre) == "Ana";
+            }
+            ++leidos;
+        }
+        COMPROBAR(!lector.danado() && lector.cerrado());
+    }
+    COMPROBAR(iguales && leidos == altas + 1);
+
+    // Reabrir agrega despus de la marca de cierre y la cadena sigue verificando.
+    {
+        RegistroAuditoria registro;
+        COMPROBAR(registro.abrir(ruta));
+        std::string almacen = "norte", nombre = "leche";
+        registro.producto(AuditoriaProductoEliminado, vistaDe(almacen), vistaDe(nombre), 2.0, 3);
+        registro.cerrar();
+    }
+    {
+        LectorAuditoria lector;
+        COMPROBAR(lector.abrir(ruta));
+        EventoAuditoria evento;
+        int total = 0;
+        bool ultimoBien = false;
+        while (lector.siguiente(evento)) {
+            ++total;
+            ultimoBien = evento.operacion == AuditoriaProductoEliminado && texto(evento.nombre) == "leche";
+        }
+        COMPROBAR(!lector.danado() && lector.cerrado() && total == altas + 2 && ultimoBien);
+    }
+
+    // Sin la marca de cierre final se lee todo, pero no consta que est completo.
+    std::ifstream medida(ruta.c_str(), std::ios::binary | std::ios::ate);
+    long bytes = static_cast<long>(medida.tellg());
+    medida.close();
+    COMPROBAR(truncate(ruta.c_str(), bytes - CABECERA_BLOQUE_AUDITORIA) == 0);
+    {
+        LectorAuditoria lector;
+        COMPROBAR(lector.abrir(ruta));
+        EventoAuditoria evento;
+        int total = 0;
+        while (lector.siguiente(evento)) ++total;
+        COMPROBAR(!lector.danado() && !lector.cerrado() && total == altas + 2);
+    }
+
+    // Un byte cambiado en los datos del primer bloque rompe la cadena.
+    COMPROBAR(alterarByte(ruta, sizeof(MAGICO_AUDITORIA) + CABECERA_BLOQUE_AUDITORIA + 100));
+    {
+        LectorAuditoria lector;
+        COMPROBAR(lector.abrir(ruta));
+        EventoAuditoria evento;
+        int total = 0;
+        while (lector.siguiente(evento)) ++total;
+        COMPROBAR(lector.danado() && total == 0);
+    }
+    std::remove(ruta.c_str());
+}
+
+// Generador pseudoaleatorio fijo, para que una falla se pueda repetir.
+static uint32_t azar(uint64_t& estado) {
+    estado = estado * 6364136223846793005ULL + 1442695040888963407ULL;
+    return static_cast<uint32_t>(estado >> 33);
+}
+
+// Autocompletado: tras altas, bajas y consultas al azar sobre nombres con prefijos
+// comunes, cada prefijo da los mismos nombres que calcular la respuesta a mano (ms
+// consultados primero y, entre iguales, por nombre). Adems, deshacer una baja en
+// SistemaGestion conserva las consultas del nombre.
+static void probarAutocompletado() {
+    struct Modelo {
+        int copias;
+        uint32_t consultas;
+    };
+    std::vector<std::string> nombres;
+    const char* raices[] = {"a", "ab", "abc", "abd", "b", "ba", "leche", "lechuga", "lente"};
+    for (const char* raiz : raices) {
+        nombres.push_back(raiz);
+        for (int i = 0; i < 12; ++i) {
+            nombres.push_back(std::string(raiz) + static_cast<char>('a' + i % 6) + std::to_string(i));
+        }
+    }
+
+    IndiceAutocompletado indice;
+    std::map<std::string, Modelo> modelo;
+    uint64_t estado = 7;
+    bool coincide = true;
+    for (int paso = 0; paso < 6000 && coincide; ++paso) {
+        const std::string& nombre = nombres[azar(estado) % nombres.size()];
+        uint32_t accion = azar(estado) % 10;
+        if (accion < 4) {
+            indice.agregar(vistaDe(nombre));
+            ++modelo[nombre].copias;
+        } else if (accion < 6) {
+            indice.quitar(vistaDe(nombre));
+            std::map<std::string, Modelo>::iterator it = modelo.find(nombre);
+            if (it != modelo.end() && --it->second.copias == 0) {
+                modelo.erase(it);
+            }
+        } else {
+            indice.anotarConsulta(vistaDe(nombre));
+            std::map<std::string, Modelo>::iterator it = modelo.find(nombre);
+            if (it != modelo.end()) {
+                ++it->second.consultas;
+            }
+        }
+        if (paso % 50 != 0) {
+            continue;
+        }
+        coincide = indice.tamano() == modelo.size();
+        for (std::size_t n = 0; n < nombres.size() && coincide; n += 3) {
+            for (std::size_t largo = 0; largo <= nombres[n].size() && coincide; ++largo) {
+                std::string prefijo = nombres[n].substr(0, largo);
+                std::vector<std::pair<uint32_t, std::string> > esperado;
+                for (const auto& par : modelo) {
+                    if (par.first.compare(0, largo, prefijo) == 0) {
+                        esperado.push_back(std::make_pair(par.second.consultas, par.first));
+                    }
+                }
+                std::sort(esperado.begin(), esperado.end(), [](const std::pair<uint32_t, std::string>& a,
+                                                               const std::pair<uint32_t, std::string>& b) {
+                    return a.first != b.first ? a.first > b.first : a.second < b.second;
+                });
+                esperado.resize(std::min(esperado.size(), SUGERENCIAS_AUTOCOMPLETADO));
+                std::vector<std::pair<uint32_t, std::string> > obtenido;
+                indice.completar(vistaDe(prefijo), SUGERENCIAS_AUTOCOMPLETADO, [&](const VistaNombre& v, uint32_t c) {
+                    obtenido.push_back(std::make_pair(c, texto(v)));
+                });
+                coincide = obtenido == esperado;
+                if (!coincide) {
+                    std::cerr << "autocompletado: difiere en el paso " << paso << " con el prefijo '" << prefijo << "'\n";
+                }
+            }
+        }
+    }
+    COMPROBAR(coincide);
+
+    SistemaGestion sistema(nullptr);
+    sistema.activarAutocompletado();
+    sistema.registrarProducto(Producto{"leche", 1.0, 1});
+    sistema.registrarProducto(Producto{"lechuga", 1.0, 1});
+    sistema.consultarProducto("lechuga");
+    sistema.consultarProducto("lechuga");
+    sistema.eliminarProducto("lechuga");
+    sistema.deshacerUltimaAccion();
+    std::vector<std::string> orden;
+    std::string prefijo = "lec";
+    sistema.completarProducto(vistaDe(prefijo), 2, [&](const VistaNombre& v, uint32_t) { orden.push_back(texto(v)); });
+    COMPROBAR(orden.size() == 2 && orden[0] == "lechuga");
+}
+
+// Registro de almacenes: dondeHay y existenciasTotales cruzan los almacenes y, como
+// son reportes, no cambian la popularidad de los nombres en el autocompletado.
+static void probarRegistroAlmacenes() {
+    RegistroAlmacenes<SistemaGestion> almacenes(2);
+    SistemaGestion* norte = almacenes.crearAlmacen("norte", nullptr);
+    SistemaGestion* sur = almacenes.crearAlmacen("sur", nullptr);
+    SistemaGestion* este = almacenes.crearAlmacen("este", nullptr);
+    COMPROBAR(norte && sur && este && !almacenes.crearAlmacen("sur", nullptr));
+    norte->registrarProducto(Producto{"leche", 1.0, 3});
+    sur->registrarProducto(Producto{"leche", 1.5, 0});
+    este->registrarProducto(Producto{"leche", 1.2, 4});
+    for (SistemaGestion* sistema : {norte, sur, este}) {
+        sistema->activarAutocompletado();
+        sistema->registrarProducto(Producto{"lechuga", 2.0, 1});
+        sistema->consultarProducto("lechuga");
+    }
+
+    std::vector<RegistroAlmacenes<SistemaGestion>::Existencia> existencias;
+    for (int i = 0; i < 5; ++i) {
+        existencias = almacenes.dondeHay("leche");
+        COMPROBAR(almacenes.existenciasTotales("leche") == 7);
+    }
+    COMPROBAR(existencias.size() == 2 && *existencias[0].almacen == "este" && *existencias[1].almacen == "norte");
+    COMPROBAR(existencias.size() == 2 && existencias[0].producto.cantidad == 4);
+
+    std::string prefijo = "lec";
+    for (SistemaGestion* sistema : {norte, sur, este}) {
+        std::vector<std::string> orden;
+        sistema->completarProducto(vistaDe(prefijo), 2, [&](const VistaNombre& v, uint32_t) { orden.push_back(texto(v)); });
+        COMPROBAR(orden.size() == 2 && orden[0] == "lechuga");
+    }
+}
+
+// Motor particionado: la misma carga mezclada (altas con nombres repetidos, bajas,
+// consultas, deshacer, solicitudes y clientes) por una sesin del motor y por un
+// SistemaGestion da los mismos mensajes, y en ellos los mismos listados de inventario,
+// solicitudes pendientes y lista de espera; la valoracin en paralelo coincide.
+static void probarMotorParticionado() {
+    MotorParticionado<> motor(3, false);
+    std::ostringstream salidaMotor, salidaSistema;
+    MotorParticionado<>::Sesion* sesion = motor.abrirSesion(&salidaMotor);
+    SistemaGestion sistema(&salidaSistema);
+    COMPROBAR(sesion != nullptr);
+    if (!sesion) {
+        return;
+    }
+    uint64_t estado = 17;
+    bool coincide = true;
+    int siguienteId = 1;
+    for (int paso = 0; paso < 3000 && coincide; ++paso) {
+        std::string nombre = "p" + std::to_string(azar(estado) % 40);
+        switch (azar(estado) % 12) {
+            case 0:
+            case 1:
+            case 2: {
+                Producto producto = {nombre, 1.0 + azar(estado) % 100 / 4.0, static_cast<int>(azar(estado) % 10)};
+                sesion->registrarProducto(producto);
+                sistema.registrarProducto(producto);
+                break;
+            }
+            case 3:
+                coincide = sesion->eliminarProducto(nombre) == sistema.eliminarProducto(nombre);
+                break;
+            case 4:
+                sesion->consultarProducto(nombre);
+                sistema.consultarProducto(nombre);
+                break;
+            case 5:
+                sesion->deshacerUltimaAccion();
+                sistema.deshacerUltimaAccion();
+                break;
+            case 6: {
+                Solicitud solicitud = {siguienteId++, "pedido de " + nombre};
+                sesion->registrarSolicitud(solicitud);
+                sistema.registrarSolicitud(solicitud);
+                break;
+            }
+            case 7:
+                sesion->procesarSolicitud();
+                sistema.procesarSolicitud();
+                sesion->consultarSolicitudEnProceso();
+                sistema.consultarSolicitudEnProceso();
+                break;
+            case 8: {
+                Cliente cliente = {siguienteId++, "cliente " + nombre};
+                sesion->registrarClienteEnEspera(cliente);
+                sistema.registrarClienteEnEspera(cliente);
+                break;
+            }
+            case 9:
+                sesion->atenderCliente();
+                sistema.atenderCliente();
+                break;
+            default:
+                if (paso % 50 == 0) {
+                    sesion->listarProductos();
+                    sistema.listarProductos();
+                    sesion->listarSolicitudesPendientes();
+                    sistema.listarSolicitudesPendientes();
+                    sesion->consultarListaDeEspera();
+                    sistema.consultarListaDeEspera();
+                }
+        }
+        coincide = coincide && salidaMotor.str() == salidaSistema.str();
+        if (!coincide) {
+            std::cerr << "motor particionado: difiere en el paso " << paso << "\n";
+        }
+        salidaMotor.str("");
+        salidaSistema.str("");
+    }
+    COMPROBAR(coincide);
+
+    sesion->listarProductos();
+    sistema.listarProductos();
+    sesion->listarSolicitudesPendientes();
+    sistema.listarSolicitudesPendientes();
+    sesion->consultarListaDeEspera();
+    sistema.consultarListaDeEspera();
+    COMPROBAR(salidaMotor.str() == salidaSistema.str());
+
+    ValoracionInventario esperada = {0, 0, 0.0};
+    sistema.recorrerProductos([&esperada](const VistaProducto& producto) {
+        ++esperada.productos;
+        esperada.unidades += producto.cantidad;
+        esperada.valor += producto.precio * producto.cantidad;
+    });
+    ValoracionInventario valoracion = sesion->valorar();
+    COMPROBAR(esperada.productos > 0 && valoracion.productos == esperada.productos && valoracion.unidades == esperada.unidades);
+    COMPROBAR(valoracion.valor > esperada.valor - 1e-6 && valoracion.valor < esperada.valor + 1e-6);
+}
+
+// Mensajes asncronos: varios hilos encolan a la vez en el mismo destino mensajes de
+// largos variados (muchos ocupan varios registros); tras vaciar, cada hilo encuentra sus
+// mensajes completos y en su orden, iguales a los del camino sncrono. Un sistema con
+// mensajes asncronos escribe lo mismo que uno sncrono.
+static void probarRegistroMensajes() {
+    const int hilos = 4;
+    const int porHilo = 5000;
+    std::ostringstream destino;
+    std::vector<std::string> esperado(hilos);
+    RegistroMensajes::global().iniciar();
+    std::vector<std::thread> productores;
+    for (int h = 0; h < hilos; ++h) {
+        productores.emplace_back([h, &destino, &esperado]() {
+            std::ostringstream sincrono;
+            uint64_t estado = 100 + h;
+            for (int i = 0; i < porHilo; ++i) {
+                std::string texto = "[" + std::to_string(h) + "] " + std::to_string(i) + " ";
+                texto.append(azar(estado) % 120, static_cast<char>('a' + i % 26));
+                MensajeSistema codigo = i % 7 == 0 ? MensajeProducto : MensajeTexto;
+                if (codigo == MensajeTexto) {
+                    texto += '\n';
+                }
+                RegistroMensajes::global().encolar(&destino, codigo, texto.data(), texto.size(), i / 4.0, i);
+                escribirMensaje(sincrono, codigo, texto.data(), texto.size(), i / 4.0, i);
+            }
+            esperado[h] = sincrono.str();
+        });
+    }
+    for (std::thread& productor : productores) {
+        productor.join();
+    }
+    RegistroMensajes::global().vaciar();
+
+    std::vector<std::string> obtenido(hilos);
+    std::istringstream lineas(destino.str());
+    std::string linea;
+    bool reconocidas = true;
+    while (std::getline(lineas, linea)) {
+        std::size_t marca = linea.find('[');
+        int h = marca == std::string::npos ? -1 : linea[marca + 1] - '0';
+        if (h < 0 || h >= hilos) {
+            reconocidas = false;
+            continue;
+        }
+        obtenido[h] += linea + '\n';
+    }
+    COMPROBAR(reconocidas);
+    COMPROBAR(obtenido == esperado);
+
+    std::ostringstream salidaAsincrona, salidaSincrona;
+    {
+        SistemaGestion asincrono(&salidaAsincrona);
+        SistemaGestion sincrono(&salidaSincrona);
+        asincrono.fijarMensajesAsincronos(true);
+        for (SistemaGestion* sistema : {&asincrono, &sincrono}) {
+            sistema->registrarProducto(Producto{"leche", 1.25, 3});
+            sistema->registrarProducto(Producto{std::string(300, 'x'), 2.0, 1});
+            sistema->consultarProducto("leche");
+            sistema->consultarProducto("pan");
+            sistema->eliminarProducto("leche");
+            sistema->deshacerUltimaAccion();
+            sistema->listarProductos();
+        }
+    } // El destructor vaca los mensajes pendientes.
+    COMPROBAR(!salidaSincrona.str().empty() && salidaAsincrona.str() == salidaSincrona.str());
+    RegistroMensajes::global().detener();
+}
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+// Lo que vio una corrutina de la prueba asncrona.
+struct RecorridoAsincrono {
+    bool agregadoVisible = false;
+    bool eliminado = false;
+    bool eliminadoDosVeces = true;
+    bool ausenteDespues = false;
+    int id = 0;
+    std::thread::id hilo;
+    std::atomic<bool> terminado{false};
+};
+
+// Agrega, consulta y elimina un producto con co_await y despus espera un cliente (o
+// una solicitud); anota el hilo donde se reanud.
+static Tarea<> recorrerAsincrono(SistemaAsincrono<>& sistema, std::string nombre, bool cliente, RecorridoAsincrono& r) {
+    Producto nuevo = {nombre, 2.5, 4}; // Fuera del co_await: ver sistema_asincrono.h.
+    co_await sistema.registrarProductoAsync(nuevo);
+    std::optional<Producto> producto = co_await sistema.consultarProductoAsync(nombre);
+    r.agregadoVisible = producto && producto->nombre == nombre && producto->cantidad == 4 && producto->precio == 2.5;
+    r.eliminado = co_await sistema.eliminarProductoAsync(nombre);
+    r.eliminadoDosVeces = co_await sistema.eliminarProductoAsync(nombre);
+    r.ausenteDespues = !(co_await sistema.consultarProductoAsync(nombre));
+    if (cliente) {
+        r.id = (co_await sistema.atenderClienteAsync()).id;
+    } else {
+        r.id = (co_await sistema.procesarSolicitudAsync()).id;
+    }
+    r.hilo = std::this_thread::get_id();
+    r.terminado.store(true, std::memory_order_release);
+}
+
+static bool recorridoCorrecto(const RecorridoAsincrono& r) {
+    return r.agregadoVisible && r.eliminado && !r.eliminadoDosVeces && r.ausenteDespues;
+}
+
+// API asncrona (solo con C++20): las operaciones del inventario con co_await dan los
+// mismos resultados que las sncronas; los consumidores esperan sin ocupar hilos, los
+// atienden en orden de llegada y se reanudan en su ejecutor: el de un hilo, en quien
+// llama a ejecutarPendientes; el grupo de hilos, en uno de sus hilos.
+static void probarSistemaAsincrono() {
+    std::ostringstream salida;
+    SistemaAsincrono<> sistema(&salida);
+    std::thread::id principal = std::this_thread::get_id();
+
+    EjecutorUnHilo unHilo;
+    RecorridoAsincrono recorridos[3];
+    for (int i = 0; i < 3; ++i) {
+        lanzar(unHilo, recorrerAsincrono(sistema, "p" + std::to_string(i), true, recorridos[i]));
+    }
+    COMPROBAR(unHilo.ejecutarPendientes() == 3 && sistema.esperandoClientes() == 3);
+    std::thread productor([&sistema]() {
+        for (int id = 1; id <= 3; ++id) {
+            sistema.registrarClienteEnEspera(Cliente{id, "cliente" + std::to_string(id)});
+        }
+    });
+    productor.join();
+    COMPROBAR(!recorridos[0].terminado.load() && sistema.esperandoClientes() == 0); // Programadas, no corridas.
+    COMPROBAR(unHilo.ejecutarPendientes() == 3);
+    bool enOrden = true;
+    for (int i = 0; i < 3; ++i) {
+        enOrden = enOrden && recorridoCorrecto(recorridos[i]) && recorridos[i].terminado.load() &&
+                  recorridos[i].id == i + 1 && recorridos[i].hilo == principal;
+    }
+    COMPROBAR(enOrden);
+    COMPROBAR(salida.str().find("Atendiendo cliente: cliente1\n") != std::string::npos);
+
+    RecorridoAsincrono enGrupo;
+    {
+        EjecutorHilos grupo(2);
+        lanzar(grupo, recorrerAsincrono(sistema, "q", false, enGrupo));
+        for (int vueltas = 0; sistema.esperandoSolicitudes() == 0 && vueltas < 5000; ++vueltas) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        COMPROBAR(sistema.esperandoSolicitudes() == 1);
+        sistema.registrarSolicitud(Solicitud{7, "pedido"});
+        for (int vueltas = 0; !enGrupo.terminado.load(std::memory_order_acquire) && vueltas < 5000; ++vueltas) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    COMPROBAR(enGrupo.terminado.load() && recorridoCorrecto(enGrupo) && enGrupo.id == 7 && enGrupo.hilo != principal);
+}
+#endif
+
+// Nombre al azar sobre un alfabeto chico, para que haya nombres cercanos.
+static std::string nombreAzar(uint64_t& estado, std::size_t minimo, std::size_t maximo) {
+    std::string nombre(minimo + azar(estado) % (maximo - minimo + 1), 'a');
+    for (char& c : nombre) {
+        c = static_cast<char>('a' + azar(estado) % 4);
+    }
+    return nombre;
+}
+
+// Aplica hasta ediciones inserciones, borrados o reemplazos al azar.
+static std::string editarAzar(uint64_t& estado, std::string nombre, int ediciones) {
+    for (int i = 0; i < ediciones; ++i) {
+        std::size_t lugar = nombre.empty() ? 0 : azar(estado) % nombre.size();
+        char letra = static_cast<char>('a' + azar(estado) % 5);
+        switch (azar(estado) % 3) {
+            case 0: nombre.insert(nombre.begin() + lugar, letra); break;
+            case 1: if (!nombre.empty()) nombre.erase(lugar, 1); break;
+            default: if (!nombre.empty()) nombre[lugar] = letra; break;
+        }
+    }
+    return nombre;
+}
+
+// Bsqueda aproximada: el algoritmo de Myers da la misma distancia que la matriz
+// completa (con y sin cota, tambin con patrones de ms de 64 bytes), y las
+// sugerencias del ndice de trigramas son las mismas que comparar contra todos los
+// nombres presentes, tambin despus de bajas, regresos y compactaciones.
+static void probarBusquedaAproximada() {
+    uint64_t estado = 11;
+    bool distancias = true;
+    for (int i = 0; i < 3000 && distancias; ++i) {
+        std::string a = nombreAzar(estado, 0, i % 10 == 0 ? 90 : 20);
+        std::string b = i % 2 ? editarAzar(estado, a, azar(estado) % 5) : nombreAzar(estado, 0, 20);
+        std::size_t exacta = distanciaLevenshtein(vistaDe(a), vistaDe(b), 1000);
+        std::size_t cota = azar(estado) % 4;
+        distancias = PatronMyers(vistaDe(a)).distancia(vistaDe(b), 1000) == exacta &&
+                     PatronMyers(vistaDe(a)).distancia(vistaDe(b), cota) == std::min(exacta, cota + 1) &&
+                     distanciaLevenshtein(vistaDe(a), vistaDe(b), cota) == std::min(exacta, cota + 1);
+    }
+    COMPROBAR(distancias);
+
+    IndiceAproximado indice;
+    std::map<std::string, int> copias;
+    std::vector<std::string> nombres;
+    for (int i = 0; i < 4000; ++i) {
+        nombres.push_back(nombreAzar(estado, 4, 14));
+    }
+    bool coincide = true;
+    for (int ronda = 0; ronda < 6 && coincide; ++ronda) {
+        // Altas y bajas; con muchas bajas seguidas el ndice se compacta.
+        for (int i = 0; i < 3000; ++i) {
+            const std::string& nombre = nombres[azar(estado) % nombres.size()];
+            if (ronda % 3 == 2 || azar(estado) % 3 == 0) {
+                indice.quitar(vistaDe(nombre));
+                std::map<std::string, int>::iterator it = copias.find(nombre);
+                if (it != copias.end() && --it->second == 0) {
+                    copias.erase(it);
+                }
+            } else {
+                indice.agregar(vistaDe(nombre));
+                ++copias[nombre];
+            }
+        }
+        coincide = indice.tamano() == copias.size();
+        for (int consulta = 0; consulta < 200 && coincide; ++consulta) {
+            std::string pedido = editarAzar(estado, nombres[azar(estado) % nombres.size()], 1 + azar(estado) % 2);
+            std::size_t cota = std::min(DISTANCIA_MAXIMA_SUGERENCIA, pedido.size() / 4);
+            std::vector<std::pair<std::size_t, std::string> > esperado;
+            for (const auto& par : copias) {
+                std::size_t distancia = distanciaLevenshtein(vistaDe(pedido), vistaDe(par.first), cota);
+                if (cota > 0 && distancia <= cota) {
+                    esperado.push_back(std::make_pair(distancia, par.first));
+                }
+            }
+            std::sort(esperado.begin(), esperado.end());
+            esperado.resize(std::min(esperado.size(), SUGERENCIAS_APROXIMADAS));
+            std::vector<std::pair<std::size_t, std::string> > obtenido;
+            indice.sugerir(vistaDe(pedido), SUGERENCIAS_APROXIMADAS, [&](const VistaNombre& v, std::size_t distancia) {
+                obtenido.push_back(std::make_pair(distancia, texto(v)));
+            });
+            coincide = obtenido == esperado;
+            if (!coincide) {
+                std::cerr << "bsqueda aproximada: difiere en la ronda " << ronda << " con '" << pedido << "'\n";
+            }
+        }
+    }
+    COMPROBAR(coincide);
+}
+
+// ndice de solicitudes: con entradas y salidas al azar de la cola, las candidatas
+// filtradas con la consulta son exactamente las pendientes que tienen todas sus
+// palabras (sin distinguir maysculas ASCII), y con una palabra no hace falta filtrar.
+static void probarIndiceSolicitudes() {
+    const char* vocabulario[] = {"revisar", "Stock", "STOCK", "leche", "urgente", "garant\xED" "a", "caja", "caja-2", "17"};
+    const std::size_t palabras = sizeof(vocabulario) / sizeof(vocabulario[0]);
+    IndiceSolicitudes indice;
+    std::deque<std::string> cola;
+    uint64_t estado = 5;
+    bool coincide = true;
+    for (int paso = 0; paso < 5000 && coincide; ++paso) {
+        if (azar(estado) % 5 < 3 || cola.empty()) {
+            std::string descripcion;
+            for (uint32_t n = 1 + azar(estado) % 4; n > 0; --n) {
+                descripcion += vocabulario[azar(estado) % palabras];
+                descripcion += n > 1 ? (azar(estado) % 2 ? " " : ", ") : ".";
+            }
+            cola.push_back(descripcion);
+            indice.agregar(vistaDe(descripcion));
+        } else {
+            indice.quitarPrimera(vistaDe(cola.front()));
+            cola.pop_front();
+        }
+        coincide = indice.pendientes() == cola.size();
+
+        std::string pedido = vocabulario[azar(estado) % palabras];
+        if (azar(estado) % 2) {
+            pedido += std::string(" ") + vocabulario[azar(estado) % palabras];
+        }
+        ConsultaSolicitudes consulta(vistaDe(pedido));
+        std::vector<uint64_t> esperado, posiciones, obtenido;
+        for (std::size_t i = 0; i < cola.size(); ++i) {
+            ConsultaSolicitudes revisar(vistaDe(pedido));
+            if (revisar.coincide(vistaDe(cola[i]))) {
+                esperado.push_back(i);
+            }
+        }
+        if (indice.candidatas(consulta, posiciones)) {
+            for (uint64_t posicion : posiciones) {
+                if (posicion >= cola.size()) {
+                    coincide = false;
+                } else if (consulta.coincide(vistaDe(cola[posicion]))) {
+                    obtenido.push_back(posicion);
+                }
+            }
+            if (consulta.lista().size() == 1) {
+                coincide = coincide && posiciones == obtenido;
+            }
+        }
+        coincide = coincide && obtenido == esperado;
+        if (!coincide) {
+            std::cerr << "ndice de solicitudes: difiere en el paso " << paso << " con '" << pedido << "'\n";
+        }
+    }
+    COMPROBAR(coincide);
+
+    ConsultaSolicitudes mayusculas(vistaDe(std::string("STOCK leche")));
+    COMPROBAR(mayusculas.lista().size() == 2 && mayusculas.coincide(vistaDe(std::string("Leche sin stock"))));
+    COMPROBAR(!mayusculas.coincide(vistaDe(std::string("stock de lechera"))));
+}
+
+// Filtro de ausentes: nunca descarta un nombre presente, tampoco con repetidos que
+// saturan contadores, bajas ni redimensiones; con el llenado mximo los falsos positivos
+// quedan cerca de lo que anuncia el encabezado, y la estimacin del estado los acompaa.
+static void probarFiltroAusentes() {
+    FiltroAusentes filtro(4);
+    std::map<std::string, int> presentes;
+    uint64_t estado = 11;
+    bool completo = true;
+    for (int paso = 0; paso < 20000 && completo; ++paso) {
+        std::string nombre = "n" + std::to_string(azar(estado) % 600);
+        if (azar(estado) % 3 != 0) {
+            if (!filtro.agregar(vistaDe(nombre))) {
+                // Lleno: lo que hace el dueo, el doble de lugar y todos de nuevo.
+                std::size_t total = 1;
+                for (const auto& par : presentes) {
+                    total += par.second;
+                }
+                filtro.dimensionar(total * 2);
+                for (const auto& par : presentes) {
+                    for (int i = 0; i < par.second; ++i) {
+                        filtro.agregar(vistaDe(par.first));
+                    }
+                }
+                COMPROBAR(filtro.agregar(vistaDe(nombre)));
+            }
+            ++presentes[nombre];
+        } else if (presentes.count(nombre)) {
+            filtro.quitar(vistaDe(nombre));
+            if (--presentes[nombre] == 0) {
+                presentes.erase(nombre);
+            }
+        }
+        if (paso % 100 == 0) {
+            for (const auto& par : presentes) {
+                if (!filtro.puedeEstar(vistaDe(par.first))) {
+                    std::cerr << "filtro de ausentes: descarta '" << par.first << "' en el paso " << paso << "\n";
+                    completo = false;
+                    break;
+                }
+            }
+        }
+    }
+    COMPROBAR(completo);
+
+    // Un nombre repetido ms all de 15 satura sus contadores: sigue presente al quitarlo.
+    FiltroAusentes repetidos(100);
+    std::string repetido = "repetido";
+    for (int i = 0; i < 20; ++i) {
+        repetidos.agregar(vistaDe(repetido));
+    }
+    for (int i = 0; i < 19; ++i) {
+        repetidos.quitar(vistaDe(repetido));
+    }
+    COMPROBAR(repetidos.puedeEstar(vistaDe(repetido)));
+
+    // Lleno hasta NOMBRES_POR_BLOQUE_FILTRO por bloque, el peor caso.
+    const std::size_t capacidad = 20000;
+    FiltroAusentes lleno(capacidad);
+    bool admitidos = true;
+    for (std::size_t i = 0; i < capacidad; ++i) {
+        std::string nombre = "presente" + std::to_string(i);
+        admitidos = lleno.agregar(vistaDe(nombre)) && admitidos;
+    }
+    COMPROBAR(admitidos);
+    COMPROBAR(!lleno.agregar(vistaDe(std::string("sobrante"))));
+    for (std::size_t i = 0; i < 100000; ++i) {
+        std::string nombre = "ausente" + std::to_string(i);
+        if (lleno.puedeEstar(vistaDe(nombre))) {
+            lleno.anotarFalsoPositivo();
+        }
+    }
+    EstadoFiltroAusentes resumen = lleno.estado();
+    COMPROBAR(resumen.nombres == capacidad && resumen.consultas == 100000);
+    COMPROBAR(resumen.tasaObservada() < 0.015);
+    COMPROBAR(resumen.tasaEstimada > 0 && resumen.tasaEstimada < 0.015);
+    COMPROBAR(resumen.tasaObservada() < resumen.tasaEstimada * 2 + 0.001);
+
+    // En el sistema, el filtro crece con el inventario sin perder nombres.
+    SistemaGestion sistema(nullptr);
+    sistema.activarFiltroAusentes();
+    for (int i = 0; i < 500; ++i) {
+        sistema.registrarProducto(Producto{"p" + std::to_string(i), 1.0, 1});
+    }
+    sistema.eliminarProducto("p7");
+    int encontrados = 0;
+    for (int i = 0; i < 500; ++i) {
+        std::string nombre = "p" + std::to_string(i);
+        encontrados += sistema.buscarProducto(vistaDe(nombre), [](const VistaProducto&) {});
+    }
+    COMPROBAR(encontrados == 499);
+    COMPROBAR(sistema.estadoFiltroAusentes().nombres == 499);
+}
+
+static std::string clave(const std::string& nombre) {
+    std::string resultado;
+    normalizarNombre(vistaDe(nombre), resultado);
+    return resultado;
+}
+
+// Nombres normalizados: la clave no distingue maysculas ni acentos, en Latin-1 ni en
+// UTF-8; el ndice devuelve, de los nombres vigentes con la clave pedida, el registrado
+// primero (contra un modelo de listas por clave); y eliminar con otra grafa informa el
+// nombre registrado.
+static void probarNombresNormalizados() {
+    COMPROBAR(clave("Caf\xE9") == "cafe");             // Latin-1.
+    COMPROBAR(clave("CAF\xC3\x89") == "cafe");         // UTF-8.
+    COMPROBAR(clave("cafe\xCC\x81") == "cafe");        // Acento combinante.
+    COMPROBAR(clave("Stra\xDF" "e") == "strasse");
+    COMPROBAR(clave("\xC3") == "a");                   // UTF-8 truncado: se lee como Latin-1.
+    COMPROBAR(clave("5 \xE2\x82\xAC") == "5 \xE2\x82\xAC"); // Fuera de Latin-1: sin cambios.
+    COMPROBAR(clave("a\xD7" "b") == "a\xD7" "b");      // El signo de multiplicar no se pliega.
+
+    const char* variantes[] = {"cafe", "Caf\xE9", "CAF\xC3\x89", "cafe\xCC\x81", "te", "T\xE9", "TE",
+                               "pan", "Pan", "PAN", "a\xF1o", "A\xD1O", "ano", "n0", "n1", "n2", "n3",
+                               "n4", "n5", "n6", "n7", "n8", "n9", "n10", "n11", "n12", "n13", "n14"};
+    const std::size_t total = sizeof(variantes) / sizeof(variantes[0]);
+    IndiceNormalizado indice;
+    // Por clave, los nombres vigentes en orden de registro con sus repeticiones.
+    std::map<std::string, std::vector<std::pair<std::string, int> > > modelo;
+    uint64_t estado = 13;
+    bool coincide = true;
+    for (int paso = 0; paso < 20000 && coincide; ++paso) {
+        std::string nombre = variantes[azar(estado) % total];
+        std::vector<std::pair<std::string, int> >& lista = modelo[clave(nombre)];
+        std::size_t i = 0;
+        while (i < lista.size() && lista[i].first != nombre) {
+            ++i;
+        }
+        if (azar(estado) % 2) {
+            indice.agregar(vistaDe(nombre));
+            if (i == lista.size()) {
+                lista.push_back(std::make_pair(nombre, 0));
+            }
+            ++lista[i].second;
+        } else {
+            indice.quitar(vistaDe(nombre)); // Si no est, no cambia nada.
+            if (i < lista.size() && --lista[i].second == 0) {
+                lista.erase(lista.begin() + i);
+            }
+        }
+        std::size_t claves = 0;
+        for (const auto& par : modelo) {
+            claves += !par.second.empty();
+        }
+        coincide = indice.tamano() == claves;
+        std::string consulta = variantes[azar(estado) % total];
+        const std::vector<std::pair<std::string, int> >& esperado = modelo[clave(consulta)];
+        std::string exacto;
+        bool resuelto = indice.resolver(vistaDe(consulta), exacto);
+        coincide = coincide && resuelto == !esperado.empty() && (!resuelto || exacto == esperado.front().first);
+        if (!coincide) {
+            std::cerr << "nombres normalizados: difiere en el paso " << paso << " con '" << consulta << "'\n";
+        }
+    }
+    COMPROBAR(coincide);
+
+    std::ostringstream salida;
+    SistemaGestion sistema(&salida);
+    sistema.activarNombresNormalizados();
+    sistema.registrarProducto(Producto{"Leche", 1.0, 1});
+    sistema.registrarProducto(Producto{"Caf\xE9", 2.0, 1});
+    salida.str("");
+    COMPROBAR(sistema.eliminarProducto("LECHE"));
+    COMPROBAR(salida.str().find("Leche") != std::string::npos && salida.str().find("LECHE") == std::string::npos);
+    COMPROBAR(sistema.buscarProducto(vistaDe(std::string("caf\xC3\xA9")), [](const VistaProducto&) {}));
+    COMPROBAR(!sistema.buscarProducto(vistaDe(std::string("leche")), [](const VistaProducto&) {}));
+    sistema.deshacerUltimaAccion();
+    COMPROBAR(sistema.buscarProducto(vistaDe(std::string("leche")), [](const VistaProducto&) {}));
+}
+
+// Ejecuta una trama de peticin binaria y devuelve la respuesta completa.
+static std::string ejecutarTrama(SistemaGestion& sistema, const std::string& trama) {
+    SalidaVectorial salida;
+    int siguienteId = 1;
+    ejecutarTramaBinaria(sistema, trama.data(), trama.size(), salida, siguienteId);
+    std::string respuesta;
+    salida.recorrer([&respuesta](const char* datos, std::size_t n) { respuesta.append(datos, n); });
+    return respuesta;
+}
+
+// Protocolos de red: las opciones que escriben archivos o crean memoria compartida
+// (16, 17 y 18) quedan fuera; el texto las marca como locales y el binario contesta
+// con error sin tocar el disco. "-1" no es una opcin.
+static void probarProtocolosRed() {
+    ComandoTexto comando;
+    std::string linea = "16 pruebas_red.img";
+    analizarPeticionTexto(linea.data(), linea.size(), comando);
+    COMPROBAR(comando.opcion == 16 && opcionSoloLocal(comando.opcion));
+    COMPROBAR(opcionSoloLocal(17) && opcionSoloLocal(18) && !opcionSoloLocal(15) && !opcionSoloLocal(19));
+    linea = "-1";
+    analizarPeticionTexto(linea.data(), linea.size(), comando);
+    COMPROBAR(comando.opcion == 0);
+
+    SistemaGestion sistema(nullptr);
+    sistema.registrarProducto(Producto{"leche", 1.0, 1});
+    // La ruta va como un nombre bien formado (u16 longitud + bytes): con la operacin 9,
+    // que recibe un nombre, la misma trama es correcta, as que el error es por la opcin.
+    std::string ruta = "pruebas_red.img";
+    char longitud[2];
+    escribirU16(longitud, static_cast<uint16_t>(ruta.size()));
+    std::string argumentos = std::string(longitud, 2) + ruta;
+    std::string respuesta = ejecutarTrama(sistema, std::string(1, static_cast<char>(9)) + argumentos);
+    COMPROBAR(respuesta.size() == 10 && static_cast<uint8_t>(respuesta[5]) == EstadoCorrecto);
+    for (uint8_t operacion = 16; operacion <= 18; ++operacion) {
+        respuesta = ejecutarTrama(sistema, std::string(1, static_cast<char>(operacion)) + argumentos);
+        COMPROBAR(respuesta.size() == 6 && static_cast<uint8_t>(respuesta[5]) == EstadoError);
+    }
+    std::FILE* archivo = std::fopen(ruta.c_str(), "rb");
+    COMPROBAR(archivo == nullptr);
+    if (archivo) {
+        std::fclose(archivo);
+        std::remove(ruta.c_str());
+    }
+}
+
+// Tiempo de CPU de un proceso en tics de reloj (utime + stime de /proc/<pid>/stat).
+static long ticsProceso(pid_t pid) {
+    std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+    std::string linea;
+    std::getline(stat, linea);
+    std::size_t fin = linea.rfind(')'); // El nombre del programa puede tener espacios.
+    if (fin == std::string::npos) {
+        return -1;
+    }
+    std::istringstream campos(linea.substr(fin + 2));
+    std::string campo;
+    long utime = 0, stime = 0;
+    for (int i = 3; i <= 15 && campos >> campo; ++i) {
+        if (i == 14) utime = std::atol(campo.c_str());
+        if (i == 15) stime = std::atol(campo.c_str());
+    }
+    return utime + stime;
+}
+
+static int conectarUnix(const std::string& ruta) {
+    sockaddr_un direccion;
+    std::memset(&direccion, 0, sizeof(direccion));
+    direccion.sun_family = AF_UNIX;
+    std::memcpy(direccion.sun_path, ruta.c_str(), ruta.size());
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&direccion), sizeof(direccion)) != 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+// Servidor sin descriptores: con el lmite de archivos agotado y conexiones esperando
+// en la cola, el servidor no gira consumiendo CPU; al cerrarse las conexiones vuelve a
+// aceptar y atiende a un cliente nuevo (la opcin 16 tiene respuesta fija).
+static void probarServidorSinDescriptores() {
+    std::string ruta = "pruebas_servidor_" + std::to_string(::getpid()) + ".sock";
+    pid_t hijo = ::fork();
+    if (hijo == 0) {
+        std::freopen("/dev/null", "w", stderr); // El aviso de la pausa es esperado.
+        rlimit limite = {24, 24};
+        ::setrlimit(RLIMIT_NOFILE, &limite);
+        std::signal(SIGTERM, manejarSenalServidor);
+        std::signal(SIGPIPE, SIG_IGN);
+        SistemaGestion sistema(nullptr);
+        ServidorSistema<SistemaGestion> servidor(sistema);
+        if (!servidor.escucharUnix(ruta)) {
+            ::_exit(2);
+        }
+        servidor.ejecutar();
+        ::_exit(0);
+    }
+    COMPROBAR(hijo > 0);
+    if (hijo <= 0) {
+        return;
+    }
+
+    std::vector<int> clientes;
+    for (int intentos = 0; clientes.empty() && intentos < 2000; ++intentos) {
+        int fd = conectarUnix(ruta);
+        if (fd >= 0) {
+            clientes.push_back(fd);
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    while (!clientes.empty() && clientes.size() < 40) {
+        int fd = conectarUnix(ruta);
+        if (fd < 0) break;
+        clientes.push_back(fd);
+    }
+    COMPROBAR(clientes.size() == 40);
+
+    // Ms conexiones que descriptores: las que sobran esperan en la cola de la escucha.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    long antes = ticsProceso(hijo);
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    long consumidos = ticsProceso(hijo) - antes;
+    COMPROBAR(antes >= 0 && consumidos * 1000 < ::sysconf(_SC_CLK_TCK) * 100); // Menos de 100 ms de CPU en 500 ms.
+
+    for (int fd : clientes) {
+        ::close(fd);
+    }
+    std::string respuesta;
+    int cliente = conectarUnix(ruta);
+    std::string peticion = "16 pruebas_red.img\n";
+    if (cliente >= 0 && ::send(cliente, peticion.data(), peticion.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(peticion.size())) {
+        pollfd espera = {cliente, POLLIN, 0};
+        char bloque[256];
+        while (respuesta.find("\n\n") == std::string::npos && ::poll(&espera, 1, 3000) > 0) {
+            ssize_t n = ::recv(cliente, bloque, sizeof(bloque), 0);
+            if (n <= 0) break;
+            respuesta.append(bloque, static_cast<std::size_t>(n));
+        }
+    }
+    if (cliente >= 0) {
+        ::close(cliente);
+    }
+    COMPROBAR(respuesta.find("no disponible en el servidor") != std::string::npos);
+
+    ::kill(hijo, SIGTERM);
+    int estado = 0;
+    COMPROBAR(::waitpid(hijo, &estado, 0) == hijo && WIFEXITED(estado) && WEXITSTATUS(estado) == 0);
+    std::remove(ruta.c_str());
+}
+
+// Latencias por el protocolo binario: 22 da cuenta, p50, p90, p99, p99.9 y mximo de
+// cada operacin con muestras, iguales a los histogramas del sistema; 23 los vaca.
+static void probarLatenciasBinarias() {
+    SistemaGestion sistema(nullptr);
+    for (int i = 0; i < 300; ++i) {
+        sistema.registrarProducto(Producto{"p" + std::to_string(i), 1.0, 1});
+        sistema.consultarProducto("p" + std::to_string(i / 2));
+    }
+    sistema.eliminarProducto("p0");
+
+    std::string respuesta = ejecutarTrama(sistema, std::string(1, static_cast<char>(22)));
+    std::vector<LatenciaRemota> latencias;
+    COMPROBAR(respuesta.size() > 6 && static_cast<uint8_t>(respuesta[5]) == EstadoCorrecto);
+    COMPROBAR(decodificarLatencias(respuesta.data() + 6, respuesta.size() - 6, latencias));
+    COMPROBAR(latencias.size() == 3);
+    bool coinciden = !latencias.empty();
+    for (const LatenciaRemota& l : latencias) {
+        const HistogramaLatencia& h = sistema.latencias().operacion(static_cast<OperacionSistema>(l.operacion));
+        coinciden = coinciden && l.cuenta == h.cantidad() && l.p50 == h.percentil(0.50) && l.p90 == h.percentil(0.90) &&
+                    l.p99 == h.percentil(0.99) && l.p999 == h.percentil(0.999) && l.maximo == h.valorMaximo();
+        coinciden = coinciden && l.p50 <= l.p90 && l.p90 <= l.p99 && l.p99 <= l.p999 && l.p999 <= l.maximo;
+        coinciden = coinciden && (l.cuenta == (l.operacion == SistemaEliminarProducto ? 1u : 300u));
+    }
+    COMPROBAR(coinciden);
+    COMPROBAR(!decodificarLatencias(respuesta.data() + 6, respuesta.size() - 7, latencias));
+
+    ejecutarTrama(sistema, std::string(1, static_cast<char>(23)));
+    respuesta = ejecutarTrama(sistema, std::string(1, static_cast<char>(22)));
+    COMPROBAR(decodificarLatencias(respuesta.data() + 6, respuesta.size() - 6, latencias) && latencias.empty());
+}
+
+int main() {
+    probarCatalogoCongelado();
+    probarReplicaCompartida();
+    probarTuberiaComandos();
+    probarEtiquetasMetricas();
+    probarCompresionBloques();
+    probarAuditoria();
+    probarAutocompletado();
+    probarRegistroAlmacenes();
+    probarMotorParticionado();
+    probarRegistroMensajes();
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+    probarSistemaAsincrono();
+#endif
+    probarBusquedaAproximada();
+    probarIndiceSolicitudes();
+    probarFiltroAusentes();
+    probarNombresNormalizados();
+    probarProtocolosRed();
+    probarLatenciasBinarias();
+    probarServidorSinDescriptores();
+
+    std::cout << comprobaciones - fallos << " de " << comprobaciones << " comprobaciones correctas." << std::endl;
+    return fallos == 0 ? 0 : 1;
+}
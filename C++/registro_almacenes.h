@@ -0,0 +1,171 @@
+#ifndef REGISTRO_ALMACENES_H
+#define REGISTRO_ALMACENES_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "sistema_gestion.h"
+#include "pool_hilos.h"
+
+// Registro de almacenes
+// Varias tiendas en un mismo proceso: cada almacn tiene nombre y su propio sistema
+// (inventario, solicitudes, clientes en espera e historial). Las consultas que cruzan
+// todos los almacenes se reparten entre los hilos de un PoolHilos, un almacn por
+// tarea, y cada tarea escribe solo en su propia posicin del resultado.
+//
+// Los resultados son vistas (VistaProducto) que apuntan al almacenamiento de cada
+// almacn, no copias de Producto: valen hasta que se modifica o elimina ese almacn.
+// Un mismo almacn nunca lo recorren dos hilos a la vez, as que un Sistema sin
+// bloqueos basta mientras no se modifique durante la consulta.
+template <class Sistema = SistemaGestion>
+class RegistroAlmacenes {
+public:
+    // Un almacn donde hay existencias de un producto.
+    struct Existencia {
+        const std::string* almacen; // Nombre del almacn (propiedad del registro).
+        VistaProducto producto;
+    };
+
+    // hilos = 0 usa uno por ncleo.
+    explicit RegistroAlmacenes(unsigned hilos = 0) : pool(hilos) {}
+
+    // Crea un almacn; devuelve nullptr si ya existe uno con ese nombre.
+    Sistema* crearAlmacen(const std::string& nombre, std::ostream* salida = &std::cout) {
+        std::lock_guard<std::mutex> guardia(cerrojo);
+        std::shared_ptr<Almacen>& almacen = almacenes[nombre];
+        if (almacen) {
+            return nullptr;
+        }
+        almacen = std::make_shared<Almacen>(nombre, salida);
+        return &almacen->sistema;
+    }
+
+    // Devuelve el almacn con ese nombre, o nullptr si no existe.
+    Sistema* almacen(const std::string& nombre) {
+        std::lock_guard<std::mutex> guardia(cerrojo);
+        auto it = almacenes.find(nombre);
+        return it == almacenes.end() ? nullptr : &it->second->sistema;
+    }
+
+    bool eliminarAlmacen(const std::string& nombre) {
+        std::lock_guard<std::mutex> guardia(cerrojo);
+        return almacenes.erase(nombre) > 0;
+    }
+
+    // Nombres de los almacenes, ordenados.
+    std::vector<std::string> nombres() const {
+        std::lock_guard<std::mutex> guardia(cerrojo);
+        std::vector<std::string> resultado;
+        for (const auto& par : almacenes) {
+            resultado.push_back(par.first);
+        }
+        return resultado;
+    }
+
+    std::size_t cantidad() const {
+        std::lock_guard<std::mutex> guardia(cerrojo);
+        return almacenes.size();
+    }
+
+    // Llama a f(nombre, sistema) con cada almacn, en orden, sin retener el cerrojo del
+    // registro; f solo debe leer lo que el sistema permite leer desde otro hilo.
+    template <class F>
+    void recorrerAlmacenes(F f) {
+        std::vector<std::shared_ptr<Almacen> > todos = instantanea();
+        for (const auto& almacen : todos) {
+            f(almacen->nombre, almacen->sistema);
+        }
+    }
+
+    // Almacenes que tienen existencias del producto (cantidad > 0), ordenados por nombre.
+    // Como consultarProducto, cada almacn aporta el primero registrado con ese nombre,
+    // pero sin anotar la consulta: un reporte no cambia la popularidad del autocompletado.
+    std::vector<Existencia> dondeHay(const std::string& producto) {
+        std::vector<std::shared_ptr<Almacen> > todos = instantanea();
+        std::vector<Existencia> porAlmacen(todos.size());
+        std::vector<char> hay(todos.size(), 0);
+        VistaNombre nombre = vistaDe(producto);
+        pool.paraCada(todos.size(), [&](std::size_t i) {
+            todos[i]->sistema.verProducto(nombre, [&](const VistaProducto& vista) {
+                porAlmacen[i].almacen = &todos[i]->nombre;
+                porAlmacen[i].producto = vista;
+                hay[i] = vista.cantidad > 0;
+            });
+        });
+
+        std::vector<Existencia> resultado;
+        for (std::size_t i = 0; i < todos.size(); ++i) {
+            if (hay[i]) resultado.push_back(porAlmacen[i]);
+        }
+        return resultado;
+    }
+
+    // Existencias de un producto sumadas en todos los almacenes.
+    long long existenciasTotales(const std::string& producto) {
+        std::vector<std::shared_ptr<Almacen> > todos = instantanea();
+        std::vector<long long> parciales(todos.size(), 0);
+        VistaNombre nombre = vistaDe(producto);
+        pool.paraCada(todos.size(), [&](std::size_t i) {
+            todos[i]->sistema.verProducto(nombre, [&](const VistaProducto& vista) {
+                parciales[i] = vista.cantidad;
+            });
+        });
+
+        long long total = 0;
+        for (long long parcial : parciales) {
+            total += parcial;
+        }
+        return total;
+    }
+
+    // Productos, unidades y valor (precio x cantidad) de todos los almacenes.
+    ValoracionInventario valoracionGlobal() {
+        std::vector<std::shared_ptr<Almacen> > todos = instantanea();
+        std::vector<ValoracionInventario> parciales(todos.size(), ValoracionInventario{0, 0, 0.0});
+        pool.paraCada(todos.size(), [&](std::size_t i) {
+            ValoracionInventario& parcial = parciales[i];
+            todos[i]->sistema.recorrerProductos([&parcial](const VistaProducto& producto) {
+                ++parcial.productos;
+                parcial.unidades += producto.cantidad;
+                parcial.valor += producto.precio * producto.cantidad;
+            });
+        });
+
+        ValoracionInventario total = {0, 0, 0.0};
+        for (const auto& parcial : parciales) {
+            total.productos += parcial.productos;
+            total.unidades += parcial.unidades;
+            total.valor += parcial.valor;
+        }
+        return total;
+    }
+
+private:
+    struct Almacen {
+        Almacen(const std::string& nombre, std::ostream* salida) : nombre(nombre), sistema(salida) {}
+        std::string nombre;
+        Sistema sistema;
+    };
+
+    // Copia de los punteros a los almacenes: la consulta no retiene el cerrojo del
+    // registro, y un almacn eliminado mientras tanto sigue vivo hasta que termine.
+    std::vector<std::shared_ptr<Almacen> > instantanea() const {
+        std::lock_guard<std::mutex> guardia(cerrojo);
+        std::vector<std::shared_ptr<Almacen> > todos;
+        todos.reserve(almacenes.size());
+        for (const auto& par : almacenes) {
+            todos.push_back(par.second);
+        }
+        return todos;
+    }
+
+    mutable std::mutex cerrojo;
+    std::map<std::string, std::shared_ptr<Almacen> > almacenes; // Ordenados por nombre.
+    PoolHilos pool;
+};
+
+#endif
@@ -0,0 +1,348 @@
+#ifndef REGISTRO_MENSAJES_H
+#define REGISTRO_MENSAJES_H
+
+// Mensajes asncronos
+// Los mensajes de confirmacin de SistemaGestion ("Producto agregado: ...") se escriben
+// por omisin dentro de cada operacin, as que una terminal o un archivo lentos se
+// suman a su latencia. Con los mensajes asncronos la operacin solo copia un registro
+// binario compacto (cdigo de mensaje, flujo de destino, argumentos numricos y el
+// texto variable) en un anillo sin bloqueos de su hilo; un hilo en segundo plano les da
+// formato y los escribe por lotes, con un flush por flujo y lote.
+//
+// Cada hilo productor tiene su propio anillo SPSC (anillo_spsc.h): los mensajes de un
+// hilo salen en orden; los de hilos distintos pueden intercalarse. Si el anillo se
+// llena, el productor espera (no se pierden mensajes) y la espera se cuenta.
+//
+// El texto lo formatea escribirMensaje, el mismo que usa el camino sncrono, as que la
+// salida es idntica byte a byte. Los flujos de destino deben vivir hasta vaciar().
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "anillo_spsc.h"
+
+enum MensajeSistema {
+    MensajeTexto, // Texto ya formateado, con sus saltos de lnea.
+    MensajeProducto,
+    MensajeProductoAgregado,
+    MensajeProductoEliminado,
+    MensajeProductoNoEncontrado,
+    MensajeSolicitudRegistrada,
+    MensajeProcesandoSolicitud,
+    MensajeSinSolicitudesPendientes,
+    MensajeSolicitudEnProceso,
+    MensajeSinSolicitudEnProceso,
+    MensajeSolicitudPendiente,
+    MensajeClienteRegistrado,
+    MensajeAtendiendoCliente,
+    MensajeSinClientesEnEspera,
+    MensajeClienteEnEspera,
+    MensajeDeshacerAgregado,
+    MensajeDeshacerEliminado,
+    MensajeSinCambios,
+    CANTIDAD_MENSAJES_SISTEMA
+};
+
+// Escribe un mensaje con su salto de lnea. Salvo el texto libre y la ficha de un
+// producto (precio y cantidad), cada mensaje es un prefijo fijo seguido del texto.
+inline void escribirMensaje(std::ostream& salida, int codigo, const char* texto, std::size_t longitud, double real,
+                            int entero) {
+    static const char* const prefijos[CANTIDAD_MENSAJES_SISTEMA] = {
+        "",
+        "Producto: ",
+        "Producto agregado: ",
+        "Producto eliminado: ",
+        "Producto no encontrado.",
+        "Solicitud registrada: ",
+        "Procesando solicitud: ",
+        "No hay solicitudes pendientes.",
+        "Solicitud en proceso: ",
+        "No hay solicitudes en proceso.",
+        "Solicitud pendiente: ",
+        "Cliente registrado: ",
+        "Atendiendo cliente: ",
+        "No hay clientes en espera.",
+        "Cliente en espera: ",
+        "Deshacer: Producto agregado eliminado: ",
+        "Deshacer: Producto eliminado restaurado: ",
+        "No hay cambios para deshacer.",
+    };
+    if (codigo == MensajeTexto) {
+        salida.write(texto, static_cast<std::streamsize>(longitud));
+        return;
+    }
+    salida << prefijos[codigo];
+    salida.write(texto, static_cast<std::streamsize>(longitud));
+    if (codigo == MensajeProducto) {
+        salida << ", Precio: " << real << ", Cantidad: " << entero;
+    }
+    salida << '\n';
+}
+
+static const std::size_t TEXTO_REGISTRO_MENSAJE = 40;
+
+// Un registro ocupa 64 bytes (con punteros de 8). Un texto ms largo que
+// TEXTO_REGISTRO_MENSAJE sigue en los registros siguientes, marcados con continua.
+struct RegistroMensaje {
+    std::ostream* destino;
+    double real;
+    int32_t entero;
+    uint8_t codigo;
+    uint8_t continua;  // Le sigue otro registro con ms texto.
+    uint16_t longitud; // Caracteres de texto usados en este registro.
+    char texto[TEXTO_REGISTRO_MENSAJE];
+};
+
+class RegistroMensajes {
+public:
+    static RegistroMensajes& global() {
+        static RegistroMensajes registro;
+        return registro;
+    }
+
+    ~RegistroMensajes() { detener(); }
+
+    // Lanza el hilo escritor si no est corriendo.
+    void iniciar() {
+        std::lock_guard<std::mutex> guardia(cerrojo);
+        if (!escritor.joinable()) {
+            detenido.store(false, std::memory_order_relaxed);
+            escritor = std::thread(&RegistroMensajes::escribir, this);
+        }
+    }
+
+    // Escribe lo pendiente y termina el hilo escritor.
+    void detener() {
+        std::thread hilo;
+        {
+            std::lock_guard<std::mutex> guardia(cerrojo);
+            hilo.swap(escritor);
+        }
+        if (hilo.joinable()) {
+            detenido.store(true, std::memory_order_release);
+            despertar.notify_one();
+            hilo.join();
+        }
+    }
+
+    // Lado de las operaciones: copia el mensaje al anillo del hilo.
+    void encolar(std::ostream* destino, MensajeSistema codigo, const char* texto = nullptr, std::size_t longitud = 0,
+                 double real = 0, int entero = 0) {
+        Canal& canal = canalDelHilo();
+        RegistroMensaje registro;
+        registro.destino = destino;
+        registro.real = real;
+        registro.entero = entero;
+        registro.codigo = static_cast<uint8_t>(codigo);
+        std::size_t enviado = 0;
+        do {
+            std::size_t n = std::min(longitud - enviado, TEXTO_REGISTRO_MENSAJE);
+            if (n > 0) {
+                std::memcpy(registro.texto, texto + enviado, n);
+            }
+            registro.longitud = static_cast<uint16_t>(n);
+            enviado += n;
+            registro.continua = enviado < longitud;
+            while (!canal.anillo.intentarEncolar(registro)) {
+                canal.esperas.store(canal.esperas.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                std::this_thread::yield();
+            }
+        } while (enviado < longitud);
+        canal.encolados.store(canal.encolados.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Espera a que se escriba todo lo encolado hasta ahora (por cualquier hilo).
+    void vaciar() {
+        std::vector<std::pair<Canal*, uint64_t> > objetivos;
+        {
+            std::lock_guard<std::mutex> guardia(cerrojo);
+            if (!escritor.joinable()) {
+                return;
+            }
+            for (const auto& canal : canales) {
+                objetivos.push_back(std::make_pair(canal.get(), canal->encolados.load(std::memory_order_acquire)));
+            }
+        }
+        despertar.notify_one();
+        std::unique_lock<std::mutex> espera(cerrojoEspera);
+        vaciado.wait(espera, [&objetivos]() {
+            for (const auto& objetivo : objetivos) {
+                if (objetivo.first->escritos.load(std::memory_order_acquire) < objetivo.second) {
+                    return false;
+                }
+            }
+            return true;
+        });
+    }
+
+    // Veces que un productor encontr su anillo lleno y tuvo que esperar.
+    uint64_t esperas() {
+        std::lock_guard<std::mutex> guardia(cerrojo);
+        uint64_t total = 0;
+        for (const auto& canal : canales) {
+            total += canal->esperas.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+private:
+    static const std::size_t CAPACIDAD_CANAL = 4096; // Registros por hilo: 256 KiB.
+    static const std::size_t LOTE = 1024;           // Registros por canal y vuelta del escritor.
+
+    struct Canal {
+        Canal() : anillo(CAPACIDAD_CANAL), encolados(0), escritos(0), esperas(0), procesados(0), aMedias(false) {}
+
+        AnilloSPSC<RegistroMensaje> anillo;
+        std::atomic<uint64_t> encolados; // Mensajes completos; solo lo escribe el productor.
+        std::atomic<uint64_t> escritos;  // Mensajes ya escritos y vaciados; solo el escritor.
+        std::atomic<uint64_t> esperas;
+
+        // Estado del escritor: un mensaje largo puede llegar en varias vueltas.
+        uint64_t procesados;
+        bool aMedias;
+        RegistroMensaje primero;
+        std::string texto;
+    };
+
+    RegistroMensajes() : detenido(false) {}
+
+    // Canal del hilo que llama; el primer uso de cada hilo toma el cerrojo una vez.
+    Canal& canalDelHilo() {
+        static thread_local Canal* propio = nullptr;
+        if (!propio) {
+            std::lock_guard<std::mutex> guardia(cerrojo);
+            canales.emplace_back(new Canal());
+            propio = canales.back().get();
+        }
+        return *propio;
+    }
+
+    // Hilo escritor: vaca los anillos por lotes; sin trabajo, duerme hasta 1 ms.
+    void escribir() {
+        std::vector<Canal*> vista;
+        std::vector<std::ostream*> tocados;
+        for (;;) {
+            bool terminar = detenido.load(std::memory_order_acquire);
+            {
+                std::lock_guard<std::mutex> guardia(cerrojo);
+                vista.clear();
+                for (const auto& canal : canales) {
+                    vista.push_back(canal.get());
+                }
+            }
+            bool hubo = false;
+            for (Canal* canal : vista) {
+                hubo |= escribirLote(*canal, tocados);
+            }
+            if (hubo) {
+                for (std::ostream* flujo : tocados) {
+                    flujo->flush();
+                }
+                tocados.clear();
+                for (Canal* canal : vista) {
+                    canal->escritos.store(canal->procesados, std::memory_order_release);
+                }
+                std::lock_guard<std::mutex> espera(cerrojoEspera);
+                vaciado.notify_all();
+            } else if (terminar) {
+                return;
+            } else {
+                std::unique_lock<std::mutex> espera(cerrojoEspera);
+                despertar.wait_for(espera, std::chrono::milliseconds(1));
+            }
+        }
+    }
+
+    bool escribirLote(Canal& canal, std::vector<std::ostream*>& tocados) {
+        RegistroMensaje registro;
+        std::size_t leidos = 0;
+        while (leidos < LOTE && canal.anillo.intentarDesencolar(registro)) {
+            ++leidos;
+            if (!canal.aMedias && !registro.continua) {
+                // Caso comn: el mensaje entero en un registro, sin copiar el texto.
+                escribirMensaje(*registro.destino, registro.codigo, registro.texto, registro.longitud, registro.real,
+                                registro.entero);
+            } else {
+                if (!canal.aMedias) {
+                    canal.primero = registro;
+                    canal.texto.assign(registro.texto, registro.longitud);
+                    canal.aMedias = true;
+                } else {
+                    canal.texto.append(registro.texto, registro.longitud);
+                }
+                if (registro.continua) {
+                    continue;
+                }
+                const RegistroMensaje& primero = canal.primero;
+                escribirMensaje(*primero.destino, primero.codigo, canal.texto.data(), canal.texto.size(), primero.real,
+                                primero.entero);
+                canal.aMedias = false;
+            }
+            ++canal.procesados;
+            if (std::find(tocados.begin(), tocados.end(), registro.destino) == tocados.end()) {
+                tocados.push_back(registro.destino);
+            }
+        }
+        return leidos > 0;
+    }
+
+    std::mutex cerrojo; // Protege la lista de canales y el hilo, no los mensajes.
+    std::vector<std::unique_ptr<Canal> > canales;
+    std::thread escritor;
+    std::atomic<bool> detenido;
+
+    std::mutex cerrojoEspera;
+    std::condition_variable despertar; // Avisa al escritor que alguien espera en vaciar().
+    std::condition_variable vaciado;   // Avisa a vaciar() que se escribi un lote.
+};
+
+// Mensaje de texto libre, armado con <<, para los mensajes poco frecuentes. Sncrono,
+// escribe directo en el destino; asncrono, lo acumula y lo encola al destruirse (al
+// final de la sentencia si es un temporal).
+class MensajeLibre {
+public:
+    MensajeLibre(std::ostream* destino, bool asincrono) : destino(destino), asincrono(asincrono && destino) {}
+    ~MensajeLibre() {
+        if (asincrono) {
+            std::string acumulado = texto.str();
+            if (!acumulado.empty()) {
+                RegistroMensajes::global().encolar(destino, MensajeTexto, acumulado.data(), acumulado.size());
+            }
+        }
+    }
+
+    MensajeLibre(const MensajeLibre&) = delete;
+    MensajeLibre& operator=(const MensajeLibre&) = delete;
+
+    // Flujo donde escribir; solo vlido si hay destino.
+    std::ostream& flujo() { return asincrono ? texto : *destino; }
+
+    template <class T>
+    MensajeLibre& operator<<(const T& valor) {
+        if (destino) flujo() << valor;
+        return *this;
+    }
+
+    MensajeLibre& operator<<(std::ostream& (*manipulador)(std::ostream&)) {
+        if (destino) flujo() << manipulador;
+        return *this;
+    }
+
+private:
+    std::ostream* destino;
+    bool asincrono;
+    std::ostringstream texto;
+};
+
+#endif
@@ -0,0 +1,508 @@
+#ifndef REPLICA_COMPARTIDA_H
+#define REPLICA_COMPARTIDA_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <new>
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+#include <stdint.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "estructuras.h"
+
+// Rplica del inventario en memoria compartida (POSIX shm)
+// El proceso interactivo publica cada cambio del inventario en una regin que los
+// procesos de reportes proyectan en solo lectura. La regin es una tabla hash plana
+// (sondeo lineal, igual que AlmacenHashPlano) ms una zona de nombres, protegida por
+// un seqlock: el escritor vuelve impar la secuencia mientras modifica y par al
+// terminar; el lector lee sin bloquear y repite si la secuencia cambi durante la lectura.
+// As un lector nunca frena al escritor y siempre ve un estado completo.
+//
+//   CabeceraReplica | RanuraReplica[numRanuras] | nombres[capacidadNombres]
+//
+// Solo disponible en sistemas POSIX; en Windows crear y abrir devuelven false.
+
+struct CabeceraReplica {
+    char magia[8];                  // "REPLICA1"
+    uint32_t marcaOrden;            // 0x01020304 en el orden de bytes del escritor.
+    uint32_t desbordada;            // 1 si el escritor dej de publicar por falta de espacio
+                                    // (hasta que vuelve a publicar todo el inventario).
+    std::atomic<uint64_t> secuencia; // Seqlock: impar mientras hay una escritura en curso.
+    uint64_t numRanuras;            // Potencia de dos.
+    uint64_t capacidadNombres;      // Bytes de la zona de nombres.
+    uint64_t desplRanuras;
+    uint64_t desplNombres;
+    uint64_t tamanoTotal;
+    uint64_t numProductos;
+    uint64_t usadoNombres;          // Bytes ocupados (incluye nombres ya borrados hasta compactar).
+    uint64_t siguienteInsercion;    // Secuencia de insercin para resolver repetidos.
+    uint64_t mutaciones;            // Cambios publicados.
+    int64_t unidadesTotales;
+    double valorTotal;
+};
+
+struct RanuraReplica {
+    uint64_t hash;
+    uint64_t insercion;     // Orden de insercin (el menor es el primero con ese nombre).
+    uint64_t desplNombre;
+    uint32_t longitudNombre;
+    uint32_t ocupada;
+    int32_t cantidad;
+    int32_t relleno;
+    double precio;
+};
+
+// Lado escritor: lo usa SistemaGestion, que ya serializa las escrituras con su cerrojo.
+class PublicadorReplica {
+public:
+    PublicadorReplica() : region(nullptr), bytesRegion(0) {}
+    ~PublicadorReplica() { cerrar(); }
+
+    PublicadorReplica(const PublicadorReplica&) = delete;
+    PublicadorReplica& operator=(const PublicadorReplica&) = delete;
+
+    // Crea (o reemplaza) la regin con espacio para capacidadProductos productos.
+    bool crear(const std::string& nombreRegion, std::size_t capacidadProductos);
+
+    // Deja de publicar y elimina el nombre de la regin (los lectores conservan su proyeccin).
+    void cerrar();
+
+    bool activa() const { return region != nullptr && !cabecera()->desbordada; }
+    // La regin existe pero dej de publicar porque se llen: se perdi al menos un
+    // cambio, as que la marca solo se quita al reemplazar todo el contenido.
+    bool desbordada() const { return region != nullptr && cabecera()->desbordada; }
+    // Productos que caben sin pasar el factor de carga de la tabla (0.7).
+    std::size_t capacidad() const { return region ? static_cast<std::size_t>(cabecera()->numRanuras * 7 / 10) : 0; }
+    const std::string& nombre() const { return nombreRegion; }
+
+    // Operaciones publicadas; cada una es una seccin de escritura del seqlock.
+    // Devuelven false si la regin se llen (queda marcada como desbordada).
+    bool insertar(const Producto& producto) {
+        comenzarEscritura();
+        bool ok = insertarSinSeccion(vistaDe(producto.nombre), producto.precio, producto.cantidad);
+        terminarEscritura();
+        return ok;
+    }
+
+    bool eliminar(const VistaNombre& nombreProducto) {
+        comenzarEscritura();
+        eliminarSinSeccion(nombreProducto);
+        terminarEscritura();
+        return true;
+    }
+
+    // Reemplaza todo el contenido con los productos que entrega recorrer(f).
+    template <class Recorrer>
+    bool reemplazar(Recorrer recorrer) {
+        comenzarEscritura();
+        vaciarSinSeccion();
+        bool ok = true;
+        recorrer([&](const VistaProducto& producto) {
+            if (ok) {
+                ok = insertarSinSeccion(producto.nombre, producto.precio, producto.cantidad);
+            }
+        });
+        terminarEscritura();
+        return ok;
+    }
+
+private:
+    CabeceraReplica* cabecera() const { return reinterpret_cast<CabeceraReplica*>(region); }
+    RanuraReplica* ranuras() const { return reinterpret_cast<RanuraReplica*>(region + cabecera()->desplRanuras); }
+    char* nombres() const { return reinterpret_cast<char*>(region + cabecera()->desplNombres); }
+    uint64_t mascara() const { return cabecera()->numRanuras - 1; }
+
+    void comenzarEscritura() {
+        CabeceraReplica* c = cabecera();
+        c->secuencia.store(c->secuencia.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void terminarEscritura() {
+        CabeceraReplica* c = cabecera();
+        ++c->mutaciones;
+        c->secuencia.store(c->secuencia.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool insertarSinSeccion(const VistaNombre& nombreProducto, double precio, int cantidad);
+    void eliminarSinSeccion(const VistaNombre& nombreProducto);
+    void vaciarSinSeccion();
+    bool compactarNombres(uint64_t necesarios);
+
+    unsigned char* region;
+    std::size_t bytesRegion;
+    std::string nombreRegion;
+};
+
+// Lado lector: lo usan los procesos de reportes.
+class LectorReplica {
+public:
+    struct Resumen {
+        uint64_t productos;
+        int64_t unidades;
+        double valor;
+        uint64_t mutaciones;
+        bool desbordada;
+    };
+
+    LectorReplica() : region(nullptr), bytesRegion(0) {}
+    ~LectorReplica() { cerrar(); }
+
+    LectorReplica(const LectorReplica&) = delete;
+    LectorReplica& operator=(const LectorReplica&) = delete;
+
+    bool abrir(const std::string& nombreRegion);
+    void cerrar();
+
+    // Copia el primer producto con ese nombre, visto en un estado consistente.
+    bool buscar(const std::string& nombreProducto, Producto& producto) const;
+
+    Resumen resumen() const;
+
+    // Copia todos los productos ordenados por nombre (estable por insercin).
+    void listar(std::vector<Producto>& productos) const;
+
+private:
+    const CabeceraReplica* cabecera() const { return reinterpret_cast<const CabeceraReplica*>(region); }
+
+    uint64_t comenzarLectura() const {
+        for (;;) {
+            uint64_t s = cabecera()->secuencia.load(std::memory_order_acquire);
+            if ((s & 1) == 0) {
+                return s;
+            }
+        }
+    }
+
+    bool lecturaValida(uint64_t inicio) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return cabecera()->secuencia.load(std::memory_order_relaxed) == inicio;
+    }
+
+    // Un lector puede ver datos a medio escribir antes de descartar la lectura:
+    // toda posicin leda de la regin se comprueba antes de usarla.
+    bool nombreDentro(const RanuraReplica& r) const {
+        const CabeceraReplica* c = cabecera();
+        return r.desplNombre <= c->capacidadNombres && r.longitudNombre <= c->capacidadNombres - r.desplNombre;
+    }
+
+    const unsigned char* region;
+    std::size_t bytesRegion;
+};
+
+#ifndef _WIN32
+
+inline bool PublicadorReplica::crear(const std::string& nombreRegion, std::size_t capacidadProductos) {
+    cerrar();
+    uint64_t numRanuras = 16;
+    while (numRanuras * 7 < static_cast<uint64_t>(capacidadProductos) * 10) {
+        numRanuras <<= 1;
+    }
+    uint64_t capacidadNombres = std::max<uint64_t>(4096, static_cast<uint64_t>(capacidadProductos) * 32);
+    uint64_t desplRanuras = (sizeof(CabeceraReplica) + 63) & ~static_cast<uint64_t>(63);
+    uint64_t desplNombres = desplRanuras + numRanuras * sizeof(RanuraReplica);
+    uint64_t tamanoTotal = desplNombres + capacidadNombres;
+
+    shm_unlink(nombreRegion.c_str());
+    int fd = shm_open(nombreRegion.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(tamanoTotal)) != 0) {
+        ::close(fd);
+        shm_unlink(nombreRegion.c_str());
+        return false;
+    }
+    void* datos = mmap(nullptr, tamanoTotal, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (datos == MAP_FAILED) {
+        shm_unlink(nombreRegion.c_str());
+        return false;
+    }
+
+    // ftruncate deja la regin en ceros: solo falta la cabecera.
+    region = static_cast<unsigned char*>(datos);
+    bytesRegion = tamanoTotal;
+    this->nombreRegion = nombreRegion;
+    CabeceraReplica* c = cabecera();
+    new (&c->secuencia) std::atomic<uint64_t>(1); // Impar hasta que la cabecera est completa.
+    c->numRanuras = numRanuras;
+    c->capacidadNombres = capacidadNombres;
+    c->desplRanuras = desplRanuras;
+    c->desplNombres = desplNombres;
+    c->tamanoTotal = tamanoTotal;
+    c->marcaOrden = 0x01020304;
+    std::memcpy(c->magia, "REPLICA1", 8);
+    c->secuencia.store(2, std::memory_order_release);
+    return true;
+}
+
+inline void PublicadorReplica::cerrar() {
+    if (region) {
+        munmap(region, bytesRegion);
+        shm_unlink(nombreRegion.c_str());
+    }
+    region = nullptr;
+    bytesRegion = 0;
+    nombreRegion.clear();
+}
+
+inline bool PublicadorReplica::insertarSinSeccion(const VistaNombre& nombreProducto, double precio, int cantidad) {
+    CabeceraReplica* c = cabecera();
+    if (c->desbordada) {
+        return false;
+    }
+    if ((c->numProductos + 1) * 10 > c->numRanuras * 7 ||
+        (c->usadoNombres + nombreProducto.longitud > c->capacidadNombres && !compactarNombres(nombreProducto.longitud))) {
+        c->desbordada = 1;
+        return false;
+    }
+
+    std::memcpy(nombres() + c->usadoNombres, nombreProducto.datos, nombreProducto.longitud);
+    RanuraReplica nueva;
+    std::memset(&nueva, 0, sizeof(nueva));
+    nueva.hash = hashNombre(nombreProducto.datos, nombreProducto.longitud);
+    nueva.insercion = c->siguienteInsercion++;
+    nueva.desplNombre = c->usadoNombres;
+    nueva.longitudNombre = static_cast<uint32_t>(nombreProducto.longitud);
+    nueva.ocupada = 1;
+    nueva.cantidad = cantidad;
+    nueva.precio = precio;
+    c->usadoNombres += nombreProducto.longitud;
+
+    RanuraReplica* r = ranuras();
+    uint64_t i = nueva.hash & mascara();
+    while (r[i].ocupada) {
+        i = (i + 1) & mascara();
+    }
+    r[i] = nueva;
+    ++c->numProductos;
+    c->unidadesTotales += cantidad;
+    c->valorTotal += precio * cantidad;
+    return true;
+}
+
+inline void PublicadorReplica::eliminarSinSeccion(const VistaNombre& nombreProducto) {
+    CabeceraReplica* c = cabecera();
+    RanuraReplica* r = ranuras();
+    uint64_t h = hashNombre(nombreProducto.datos, nombreProducto.longitud);
+    uint64_t posicion = 0;
+    bool hallado = false;
+    for (uint64_t i = h & mascara(); r[i].ocupada; i = (i + 1) & mascara()) {
+        if (r[i].hash == h && (!hallado || r[i].insercion < r[posicion].insercion) &&
+            r[i].longitudNombre == nombreProducto.longitud &&
+            std::memcmp(nombres() + r[i].desplNombre, nombreProducto.datos, nombreProducto.longitud) == 0) {
+            hallado = true;
+            posicion = i;
+        }
+    }
+    if (!hallado) {
+        return;
+    }
+    --c->numProductos;
+    c->unidadesTotales -= r[posicion].cantidad;
+    c->valorTotal -= r[posicion].precio * r[posicion].cantidad;
+
+    // Borrado con desplazamiento hacia atrs, igual que AlmacenHashPlano.
+    uint64_t i = posicion;
+    uint64_t j = i;
+    for (;;) {
+        j = (j + 1) & mascara();
+        if (!r[j].ocupada) {
+            break;
+        }
+        uint64_t ideal = r[j].hash & mascara();
+        bool enRango = (i <= j) ? (i < ideal && ideal <= j) : (i < ideal || ideal <= j);
+        if (!enRango) {
+            r[i] = r[j];
+            i = j;
+        }
+    }
+    std::memset(&r[i], 0, sizeof(RanuraReplica));
+}
+
+inline void PublicadorReplica::vaciarSinSeccion() {
+    CabeceraReplica* c = cabecera();
+    std::memset(ranuras(), 0, c->numRanuras * sizeof(RanuraReplica));
+    c->numProductos = 0;
+    c->usadoNombres = 0;
+    c->unidadesTotales = 0;
+    c->valorTotal = 0.0;
+    c->desbordada = 0;
+}
+
+// Reescribe los nombres vivos al principio de la zona; los borrados dejan huecos.
+inline bool PublicadorReplica::compactarNombres(uint64_t necesarios) {
+    CabeceraReplica* c = cabecera();
+    RanuraReplica* r = ranuras();
+    std::vector<char> vivos;
+    vivos.reserve(c->usadoNombres);
+    for (uint64_t i = 0; i < c->numRanuras; ++i) {
+        if (r[i].ocupada) {
+            uint64_t desde = vivos.size();
+            vivos.insert(vivos.end(), nombres() + r[i].desplNombre, nombres() + r[i].desplNombre + r[i].longitudNombre);
+            r[i].desplNombre = desde;
+        }
+    }
+    if (!vivos.empty()) {
+        std::memcpy(nombres(), &vivos[0], vivos.size());
+    }
+    c->usadoNombres = vivos.size();
+    return c->usadoNombres + necesarios <= c->capacidadNombres;
+}
+
+inline bool LectorReplica::abrir(const std::string& nombreRegion) {
+    cerrar();
+    int fd = shm_open(nombreRegion.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(CabeceraReplica)) {
+        ::close(fd);
+        return false;
+    }
+    std::size_t bytes = static_cast<std::size_t>(info.st_size);
+    void* datos = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (datos == MAP_FAILED) {
+        return false;
+    }
+    const CabeceraReplica* c = static_cast<const CabeceraReplica*>(datos);
+    if (std::memcmp(c->magia, "REPLICA1", 8) != 0 || c->marcaOrden != 0x01020304 || c->tamanoTotal > bytes ||
+        c->desplNombres + c->capacidadNombres > c->tamanoTotal ||
+        c->desplRanuras + c->numRanuras * sizeof(RanuraReplica) > c->desplNombres ||
+        c->numRanuras == 0 || (c->numRanuras & (c->numRanuras - 1)) != 0) {
+        munmap(datos, bytes);
+        return false;
+    }
+    region = static_cast<const unsigned char*>(datos);
+    bytesRegion = bytes;
+    return true;
+}
+
+inline void LectorReplica::cerrar() {
+    if (region) {
+        munmap(const_cast<unsigned char*>(region), bytesRegion);
+    }
+    region = nullptr;
+    bytesRegion = 0;
+}
+
+inline bool LectorReplica::buscar(const std::string& nombreProducto, Producto& producto) const {
+    const CabeceraReplica* c = cabecera();
+    const RanuraReplica* r = reinterpret_cast<const RanuraReplica*>(region + c->desplRanuras);
+    const char* arena = reinterpret_cast<const char*>(region + c->desplNombres);
+    const uint64_t mascara = c->numRanuras - 1;
+    const uint64_t h = hashNombre(nombreProducto);
+
+    for (;;) {
+        uint64_t inicio = comenzarLectura();
+        bool hallado = false;
+        RanuraReplica copia;
+        std::memset(&copia, 0, sizeof(copia));
+        uint64_t i = h & mascara;
+        for (uint64_t pasos = 0; pasos < c->numRanuras && r[i].ocupada; ++pasos, i = (i + 1) & mascara) {
+            RanuraReplica actual = r[i];
+            if (actual.hash == h && (!hallado || actual.insercion < copia.insercion) &&
+                actual.longitudNombre == nombreProducto.size() && nombreDentro(actual) &&
+                std::memcmp(arena + actual.desplNombre, nombreProducto.data(), nombreProducto.size()) == 0) {
+                hallado = true;
+                copia = actual;
+            }
+        }
+        if (lecturaValida(inicio)) {
+            if (hallado) {
+                producto.nombre = nombreProducto;
+                producto.precio = copia.precio;
+                producto.cantidad = copia.cantidad;
+            }
+            return hallado;
+        }
+    }
+}
+
+inline LectorReplica::Resumen LectorReplica::resumen() const {
+    const CabeceraReplica* c = cabecera();
+    for (;;) {
+        uint64_t inicio = comenzarLectura();
+        Resumen resumen;
+        resumen.productos = c->numProductos;
+        resumen.unidades = c->unidadesTotales;
+        resumen.valor = c->valorTotal;
+        resumen.mutaciones = c->mutaciones;
+        resumen.desbordada = c->desbordada != 0;
+        if (lecturaValida(inicio)) {
+            return resumen;
+        }
+    }
+}
+
+inline void LectorReplica::listar(std::vector<Producto>& productos) const {
+    const CabeceraReplica* c = cabecera();
+    const RanuraReplica* r = reinterpret_cast<const RanuraReplica*>(region + c->desplRanuras);
+    const char* arena = reinterpret_cast<const char*>(region + c->desplNombres);
+    std::vector<uint64_t> inserciones;
+
+    for (;;) {
+        uint64_t inicio = comenzarLectura();
+        productos.clear();
+        inserciones.clear();
+        for (uint64_t i = 0; i < c->numRanuras; ++i) {
+            RanuraReplica actual = r[i];
+            if (actual.ocupada && nombreDentro(actual)) {
+                Producto producto;
+                producto.nombre.assign(arena + actual.desplNombre, actual.longitudNombre);
+                producto.precio = actual.precio;
+                producto.cantidad = actual.cantidad;
+                productos.push_back(producto);
+                inserciones.push_back(actual.insercion);
+            }
+        }
+        if (lecturaValida(inicio)) {
+            break;
+        }
+    }
+
+    std::vector<std::size_t> orden(productos.size());
+    for (std::size_t i = 0; i < orden.size(); ++i) {
+        orden[i] = i;
+    }
+    std::sort(orden.begin(), orden.end(), [&](std::size_t a, std::size_t b) {
+        int comparacion = productos[a].nombre.compare(productos[b].nombre);
+        return comparacion != 0 ? comparacion < 0 : inserciones[a] < inserciones[b];
+    });
+    std::vector<Producto> ordenados;
+    ordenados.reserve(orden.size());
+    for (std::size_t i : orden) {
+        ordenados.push_back(std::move(productos[i]));
+    }
+    productos.swap(ordenados);
+}
+
+#else
+
+inline bool PublicadorReplica::crear(const std::string&, std::size_t) { return false; }
+inline void PublicadorReplica::cerrar() {}
+inline bool PublicadorReplica::insertarSinSeccion(const VistaNombre&, double, int) { return false; }
+inline void PublicadorReplica::eliminarSinSeccion(const VistaNombre&) {}
+inline void PublicadorReplica::vaciarSinSeccion() {}
+inline bool PublicadorReplica::compactarNombres(uint64_t) { return false; }
+inline bool LectorReplica::abrir(const std::string&) { return false; }
+inline void LectorReplica::cerrar() {}
+inline bool LectorReplica::buscar(const std::string&, Producto&) const { return false; }
+inline LectorReplica::Resumen LectorReplica::resumen() const { Resumen r = {0, 0, 0.0, 0, false}; return r; }
+inline void LectorReplica::listar(std::vector<Producto>& productos) const { productos.clear(); }
+
+#endif
+
+#endif
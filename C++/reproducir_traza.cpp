@@ -0,0 +1,318 @@
+// Reproduccin de sesiones grabadas
+// Vuelve a ejecutar una traza (proyecto_final --grabar, generador_carga) contra
+// SistemaGestion, con los mismos almacenes que el men, y mide la latencia de cada
+// comando. Sirve para reproducir "se puso lento" con la sesin real del operador.
+//
+// Uso: reproducir_traza <traza> [--ritmo] [--velocidad x] [--mostrar]
+//                       [--guardar latencias.txt] [--comparar latencias.txt] [--tolerancia %]
+//                       [--eventos eventos.json] [--asincrono] [--auditoria archivo]
+//   --ritmo        respeta los instantes grabados (por defecto, lo ms rpido posible)
+//   --velocidad x  con --ritmo, multiplica el ritmo grabado por x
+//   --mostrar      escribe los mensajes del sistema en la salida estndar
+//   --guardar      guarda el resumen de latencias como base para comparar despus
+//   --comparar     compara con una base guardada; devuelve 1 si alguna operacin
+//                  empeor ms que la tolerancia (10% por defecto) en media o p99
+//   --eventos      guarda los eventos de traza en formato Chrome (compilado con -DEVENTOS_TRAZA)
+//   --asincrono    con --mostrar, los mensajes los escribe un hilo aparte (registro_mensajes.h):
+//                  la latencia medida deja de incluir la escritura en la terminal
+//   --auditoria    agrega las modificaciones de la sesin a un registro de auditora (auditoria.h)
+//
+// Guardar catlogo (16) y publicar rplica (18) no se repiten: escribiran archivos o
+// memoria compartida de la sesin original. Se informan como omitidos.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <streambuf>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include "sistema_gestion.h"
+#include "registro_almacenes.h"
+#include "traza.h"
+#include "eventos_traza.h"
+#include "auditoria.h"
+
+DEFINIR_CONTEO_RESERVAS() // Con -DINSTRUMENTACION cuenta las reservas de memoria por operacin.
+
+// Flujo que descarta lo que recibe.
+class SumideroSalida : public std::streambuf {
+protected:
+    int_type overflow(int_type c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+struct Latencias {
+    unsigned long long cuenta;
+    double media, p50, p99, maximo; // Nanosegundos.
+};
+
+static Latencias resumir(std::vector<double>& muestras) {
+    std::sort(muestras.begin(), muestras.end());
+    double suma = 0;
+    for (double muestra : muestras) {
+        suma += muestra;
+    }
+    std::size_t n = muestras.size();
+    Latencias latencias = {n, suma / n, muestras[n / 2], muestras[std::min(n - 1, n * 99 / 100)], muestras.back()};
+    return latencias;
+}
+
+// Ejecuta la sesin como lo hara el men, sobre el almacn activo.
+class Reproductor {
+public:
+    Reproductor(std::ostream& salida, bool asincrono, RegistroAuditoria* auditoria)
+        : salida(salida), descarte(nullptr), asincrono(asincrono), auditoria(auditoria), almacenActivo("principal"),
+          siguienteId(1), omitidos(0) {
+        sistema = crearAlmacen();
+    }
+
+    void ejecutar(ComandoTexto& comando) {
+        switch (comando.opcion) {
+            case 16:
+            case 18:
+                ++omitidos;
+                break;
+            case 19: {
+                almacenActivo = comando.texto;
+                SistemaGestion* existente = almacenes.almacen(almacenActivo);
+                if (existente) {
+                    sistema = existente;
+                    MensajeLibre(&salida, asincrono) << "Almacn activo: " << almacenActivo << std::endl;
+                } else {
+                    sistema = crearAlmacen();
+                    MensajeLibre(&salida, asincrono) << "Almacn creado y activo: " << almacenActivo << std::endl;
+                }
+                break;
+            }
+            case 20: {
+                long long total = 0;
+                std::vector<RegistroAlmacenes<SistemaGestion>::Existencia> existencias = almacenes.dondeHay(comando.texto);
+                MensajeLibre respuesta(&salida, asincrono);
+                for (const auto& existencia : existencias) {
+                    respuesta << "Almacn: " << *existencia.almacen << ", Precio: " << existencia.producto.precio
+                           << ", Cantidad: " << existencia.producto.cantidad << std::endl;
+                    total += existencia.producto.cantidad;
+                }
+                if (existencias.empty()) {
+                    respuesta << "No hay existencias de " << comando.texto << " en ningn almacn." << std::endl;
+                } else {
+                    respuesta << "Existencias totales de " << comando.texto << ": " << total << std::endl;
+                }
+                break;
+            }
+            case 21: {
+                ValoracionInventario valoracion = almacenes.valoracionGlobal();
+                MensajeLibre(&salida, asincrono) << "Valoracin global: " << almacenes.cantidad() << " almacenes, "
+                                                 << valoracion.productos << " productos, " << valoracion.unidades
+                                                 << " unidades, valor total: " << valoracion.valor << std::endl;
+                break;
+            }
+            default:
+                // Las opciones del protocolo de texto; la lnea vaca que cierra cada
+                // respuesta del protocolo va al descarte.
+                ejecutarComandoTexto(*sistema, comando, descarte, siguienteId);
+        }
+    }
+
+    unsigned long long comandosOmitidos() const { return omitidos; }
+
+private:
+    SistemaGestion* crearAlmacen() {
+        SistemaGestion* nuevo = almacenes.crearAlmacen(almacenActivo, &salida);
+        nuevo->fijarMensajesAsincronos(asincrono);
+        nuevo->fijarAuditoria(auditoria, almacenActivo);
+        nuevo->activarIndices(); // Como en el men.
+        return nuevo;
+    }
+
+    std::ostream& salida;
+    std::ostream descarte;
+    bool asincrono;
+    RegistroAuditoria* auditoria;
+    RegistroAlmacenes<SistemaGestion> almacenes;
+    std::string almacenActivo;
+    SistemaGestion* sistema;
+    int siguienteId;
+    unsigned long long omitidos;
+};
+
+static bool guardarLatencias(const std::string& ruta, const std::map<std::string, Latencias>& resumen) {
+    std::ofstream archivo(ruta.c_str());
+    archivo << "# operacion cuenta media_ns p50_ns p99_ns max_ns\n";
+    char linea[256];
+    for (const auto& par : resumen) {
+        const Latencias& l = par.second;
+        std::snprintf(linea, sizeof(linea), "%s %llu %.1f %.1f %.1f %.1f\n", par.first.c_str(), l.cuenta, l.media, l.p50, l.p99,
+                      l.maximo);
+        archivo << linea;
+    }
+    return static_cast<bool>(archivo);
+}
+
+static bool cargarLatencias(const std::string& ruta, std::map<std::string, Latencias>& resumen) {
+    std::ifstream archivo(ruta.c_str());
+    if (!archivo) {
+        return false;
+    }
+    std::string linea;
+    while (std::getline(archivo, linea)) {
+        if (linea.empty() || linea[0] == '#') continue;
+        std::istringstream campos(linea);
+        std::string operacion;
+        Latencias l;
+        if (campos >> operacion >> l.cuenta >> l.media >> l.p50 >> l.p99 >> l.maximo) {
+            resumen[operacion] = l;
+        }
+    }
+    return true;
+}
+
+// Imprime la comparacin y devuelve cuntas operaciones empeoraron ms que la tolerancia.
+static int comparar(const std::map<std::string, Latencias>& base, const std::map<std::string, Latencias>& actual,
+                    double tolerancia) {
+    int regresiones = 0;
+    std::printf("\n%-30s %12s %12s %8s %12s %12s %8s\n", "operacion", "media base", "media", "razon", "p99 base", "p99",
+                "razon");
+    for (const auto& par : actual) {
+        auto previa = base.find(par.first);
+        if (previa == base.end()) {
+            std::printf("%-30s %12s %12.0f\n", par.first.c_str(), "-", par.second.media);
+            continue;
+        }
+        const Latencias& b = previa->second;
+        const Latencias& a = par.second;
+        double razonMedia = b.media > 0 ? a.media / b.media : 1.0;
+        double razonP99 = b.p99 > 0 ? a.p99 / b.p99 : 1.0;
+        bool peor = razonMedia > 1.0 + tolerancia / 100.0 || razonP99 > 1.0 + tolerancia / 100.0;
+        regresiones += peor;
+        std::printf("%-30s %12.0f %12.0f %7.2fx %12.0f %12.0f %7.2fx%s\n", par.first.c_str(), b.media, a.media, razonMedia, b.p99,
+                    a.p99, razonP99, peor ? "  REGRESION" : "");
+    }
+    return regresiones;
+}
+
+int main(int argc, char** argv) {
+    std::string rutaTraza, rutaGuardar, rutaComparar, rutaEventos, rutaAuditoria;
+    bool ritmo = false, mostrar = false, asincrono = false;
+    double velocidad = 1.0, tolerancia = 10.0;
+    for (int i = 1; i < argc; ++i) {
+        std::string argumento = argv[i];
+        bool conValor = i + 1 < argc;
+        if (argumento == "--ritmo") {
+            ritmo = true;
+        } else if (argumento == "--mostrar") {
+            mostrar = true;
+        } else if (argumento == "--asincrono") {
+            asincrono = true;
+        } else if (argumento == "--velocidad" && conValor) {
+            velocidad = std::atof(argv[++i]);
+        } else if (argumento == "--guardar" && conValor) {
+            rutaGuardar = argv[++i];
+        } else if (argumento == "--comparar" && conValor) {
+            rutaComparar = argv[++i];
+        } else if (argumento == "--eventos" && conValor) {
+            rutaEventos = argv[++i];
+        } else if (argumento == "--auditoria" && conValor) {
+            rutaAuditoria = argv[++i];
+        } else if (argumento == "--tolerancia" && conValor) {
+            tolerancia = std::atof(argv[++i]);
+        } else if (argumento.compare(0, 2, "--") != 0 && rutaTraza.empty()) {
+            rutaTraza = argumento;
+        } else {
+            rutaTraza.clear();
+            break;
+        }
+    }
+    if (rutaTraza.empty() || velocidad <= 0) {
+        std::cerr << "Uso: " << argv[0] << " <traza> [--ritmo] [--velocidad x] [--mostrar]\n"
+                  << "       [--guardar latencias.txt] [--comparar latencias.txt] [--tolerancia %]\n"
+                  << "       [--eventos eventos.json] [--asincrono] [--auditoria archivo]" << std::endl;
+        return 2;
+    }
+
+    LectorTraza lector;
+    if (!lector.cargar(rutaTraza)) {
+        std::cerr << "No se pudo leer la traza " << rutaTraza << std::endl;
+        return 1;
+    }
+    std::map<std::string, Latencias> base;
+    if (!rutaComparar.empty() && !cargarLatencias(rutaComparar, base)) {
+        std::cerr << "No se pudo leer la base " << rutaComparar << std::endl;
+        return 1;
+    }
+
+    RegistroAuditoria auditoria;
+    if (!rutaAuditoria.empty() && !auditoria.abrir(rutaAuditoria)) {
+        std::cerr << "No se pudo abrir el registro de auditora " << rutaAuditoria << std::endl;
+        return 1;
+    }
+
+    SumideroSalida sumidero;
+    std::ostream silencio(&sumidero);
+    Reproductor reproductor(mostrar ? std::cout : silencio, mostrar && asincrono, auditoria.abierto() ? &auditoria : nullptr);
+    std::map<std::string, std::vector<double> > muestras;
+    EventoTraza evento;
+    unsigned long long comandos = 0;
+    typedef std::chrono::steady_clock Reloj;
+    Reloj::time_point inicio = Reloj::now();
+    while (lector.siguiente(evento)) {
+        if (ritmo) {
+            std::this_thread::sleep_until(inicio + std::chrono::microseconds(static_cast<long long>(evento.instante / velocidad)));
+        }
+        Reloj::time_point antes = Reloj::now();
+        reproductor.ejecutar(evento.comando);
+        Reloj::time_point despues = Reloj::now();
+        muestras[nombreOperacionTraza(evento.comando.opcion)].push_back(
+            std::chrono::duration<double, std::nano>(despues - antes).count());
+        ++comandos;
+    }
+    double segundos = std::chrono::duration<double>(Reloj::now() - inicio).count();
+    RegistroMensajes::global().vaciar(); // El resumen va despus de los mensajes.
+    if (lector.danada()) {
+        std::cerr << "La traza " << rutaTraza << " est daada; se reprodujo hasta el ltimo comando vlido." << std::endl;
+    }
+
+    std::map<std::string, Latencias> resumen;
+    for (auto& par : muestras) {
+        resumen[par.first] = resumir(par.second);
+    }
+    std::printf("%llu comandos en %.3f s (%s), %llu omitidos\n", comandos, segundos, ritmo ? "al ritmo grabado" : "sin pausas",
+                reproductor.comandosOmitidos());
+    std::printf("%-30s %10s %12s %12s %12s %12s\n", "operacion", "cuenta", "media ns", "p50 ns", "p99 ns", "max ns");
+    for (const auto& par : resumen) {
+        const Latencias& l = par.second;
+        std::printf("%-30s %10llu %12.0f %12.0f %12.0f %12.0f\n", par.first.c_str(), l.cuenta, l.media, l.p50, l.p99, l.maximo);
+    }
+
+    if (auditoria.abierto()) {
+        auditoria.volcar();
+        std::printf("Auditora: %llu registros en %llu bloques, %llu bytes (%llu sin comprimir)\n",
+                    auditoria.cantidadRegistros(), auditoria.cantidadBloques(), auditoria.bytesEnDisco(),
+                    auditoria.bytesSinComprimir());
+    }
+    uint64_t esperas = RegistroMensajes::global().esperas();
+    if (esperas > 0) {
+        std::printf("%llu esperas por el anillo de mensajes lleno\n", static_cast<unsigned long long>(esperas));
+    }
+    imprimirInstrumentacion(std::cout); // Solo con -DINSTRUMENTACION.
+    if (!rutaEventos.empty()) {
+        guardarEventosTraza(rutaEventos, std::cerr);
+    }
+    if (!rutaGuardar.empty() && !guardarLatencias(rutaGuardar, resumen)) {
+        std::cerr << "No se pudo escribir " << rutaGuardar << std::endl;
+        return 1;
+    }
+    if (!rutaComparar.empty()) {
+        int regresiones = comparar(base, resumen, tolerancia);
+        std::printf("%d operaciones empeoraron ms de %.0f%%\n", regresiones, tolerancia);
+        return regresiones > 0 ? 1 : 0;
+    }
+    return 0;
+}
@@ -0,0 +1,467 @@
+#ifndef SERVIDOR_H
+#define SERVIDOR_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#endif
+
+#include "estructuras.h"
+#include "sistema_gestion.h"
+#include "protocolo_texto.h"
+#include "protocolo_binario.h"
+
+// Modo servidor
+// Atiende a muchos clientes a la vez sobre un socket de dominio Unix (y, si se pide,
+// TCP en 127.0.0.1) con un bucle de eventos epoll en un solo hilo: SistemaGestion
+// no necesita bloqueos porque solo este hilo lo usa.
+//
+// Las peticiones siguen el protocolo de texto de protocolo_texto.h, salvo las opciones
+// que reciben rutas (16, 17 y 18): cualquier cliente, tambin por TCP, podra hacer
+// que el servidor sobrescriba archivos suyos. Esas quedan para el men y los guiones.
+//
+// Se admite pipelining: el cliente puede enviar varias peticiones sin esperar; todas
+// las completas que llegan juntas se ejecutan y sus respuestas salen en una sola escritura.
+//
+// Si la conexin empieza con "SGB1" se usa el protocolo binario (protocolo_binario.h)
+// en lugar del de texto; las respuestas binarias se envan con writev.
+
+#ifdef __linux__
+
+// El modo servidor usa epoll: solo existe en Linux. En el resto (el proyecto de
+// Dev-C++ en Windows incluido) este archivo compila igual, sin el servidor.
+inline bool servidorDisponible() { return true; }
+
+// Bandera que ponen SIGINT y SIGTERM para terminar el bucle ordenadamente.
+inline volatile std::sig_atomic_t& servidorDetenido() {
+    static volatile std::sig_atomic_t detenido = 0;
+    return detenido;
+}
+
+inline void manejarSenalServidor(int) {
+    servidorDetenido() = 1;
+}
+
+template <class Sistema>
+class ServidorSistema {
+public:
+    explicit ServidorSistema(Sistema& sistema)
+        : sistema(sistema), flujo(&buffer), epoll(-1), siguienteId(1), atendidas(0), escuchasPausadas(false), sinDescriptores(false) {}
+
+    ~ServidorSistema() {
+        for (std::size_t fd = 0; fd < conexiones.size(); ++fd) {
+            if (conexiones[fd]) {
+                ::close(static_cast<int>(fd));
+            }
+        }
+        for (int fd : escuchas) {
+            ::close(fd);
+        }
+        if (!rutaUnix.empty()) {
+            ::unlink(rutaUnix.c_str());
+        }
+        if (epoll >= 0) {
+            ::close(epoll);
+        }
+    }
+
+    ServidorSistema(const ServidorSistema&) = delete;
+    ServidorSistema& operator=(const ServidorSistema&) = delete;
+
+    // Escucha en un socket de dominio Unix (reemplaza un archivo de socket anterior).
+    bool escucharUnix(const std::string& ruta) {
+        sockaddr_un direccion;
+        std::memset(&direccion, 0, sizeof(direccion));
+        if (ruta.size() >= sizeof(direccion.sun_path)) {
+            return false;
+        }
+        direccion.sun_family = AF_UNIX;
+        std::memcpy(direccion.sun_path, ruta.c_str(), ruta.size());
+        ::unlink(ruta.c_str());
+        int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0 || ::bind(fd, reinterpret_cast<sockaddr*>(&direccion), sizeof(direccion)) != 0 || ::listen(fd, 4096) != 0) {
+            if (fd >= 0) ::close(fd);
+            return false;
+        }
+        rutaUnix = ruta;
+        return registrarEscucha(fd);
+    }
+
+    // Escucha en TCP solo en la interfaz de loopback.
+    bool escucharTcp(int puerto) {
+        sockaddr_in direccion;
+        std::memset(&direccion, 0, sizeof(direccion));
+        direccion.sin_family = AF_INET;
+        direccion.sin_port = htons(static_cast<uint16_t>(puerto));
+        direccion.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int uno = 1;
+        if (fd < 0 || ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &uno, sizeof(uno)) != 0 ||
+            ::bind(fd, reinterpret_cast<sockaddr*>(&direccion), sizeof(direccion)) != 0 || ::listen(fd, 4096) != 0) {
+            if (fd >= 0) ::close(fd);
+            return false;
+        }
+        return registrarEscucha(fd);
+    }
+
+    // Atiende eventos hasta recibir SIGINT o SIGTERM.
+    void ejecutar() {
+        const int maximoEventos = 256;
+        epoll_event eventos[maximoEventos];
+        while (!servidorDetenido()) {
+            int n = ::epoll_wait(epoll, eventos, maximoEventos, escuchasPausadas ? PAUSA_ESCUCHAS_MS : -1);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            if (n == 0 && escuchasPausadas) {
+                pausarEscuchas(false); // Ninguna conexin se cerr: se vuelve a probar.
+            }
+            for (int i = 0; i < n; ++i) {
+                int fd = eventos[i].data.fd;
+                if (esEscucha(fd)) {
+                    aceptar(fd);
+                    continue;
+                }
+                Conexion* c = fd < static_cast<int>(conexiones.size()) ? conexiones[fd].get() : nullptr;
+                if (!c) continue;
+                bool abierta = true;
+                if (eventos[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR | EPOLLRDHUP)) {
+                    abierta = leer(*c);
+                }
+                if (abierta) {
+                    abierta = atender(*c);
+                }
+                if (abierta) {
+                    actualizarInteres(*c);
+                } else {
+                    cerrar(fd);
+                }
+            }
+        }
+    }
+
+    unsigned long long peticionesAtendidas() const { return atendidas; }
+
+private:
+    // Respuestas pendientes por encima de este tamao: se deja de leer hasta vaciarlas.
+    static const std::size_t LIMITE_SALIDA = 1 << 22;
+    // Sin descriptores para aceptar, cada cunto se vuelve a probar si nadie cierra.
+    static const int PAUSA_ESCUCHAS_MS = 100;
+
+    enum Protocolo { ProtocoloPorDecidir, ProtocoloTexto, ProtocoloBinario };
+
+    struct Conexion {
+        Conexion(int fd) : fd(fd), enviados(0), interes(0), cerrando(false), protocolo(ProtocoloPorDecidir) {}
+        int fd;
+        std::string entrada;        // Bytes recibidos an sin procesar.
+        std::string salida;         // Respuestas de texto pendientes de enviar.
+        SalidaVectorial vectorial;  // Respuestas binarias pendientes de enviar.
+        std::size_t enviados;       // Prefijo de salida ya enviado.
+        uint32_t interes;           // Eventos registrados en epoll.
+        bool cerrando;              // El cliente cerr su lado: enviar lo pendiente y cerrar.
+        Protocolo protocolo;        // Se decide con los primeros bytes recibidos.
+        std::size_t pendiente() const { return salida.size() - enviados + vectorial.pendiente(); }
+    };
+
+    bool registrarEscucha(int fd) {
+        if (epoll < 0) {
+            epoll = ::epoll_create1(EPOLL_CLOEXEC);
+        }
+        epoll_event evento;
+        std::memset(&evento, 0, sizeof(evento));
+        evento.events = EPOLLIN;
+        evento.data.fd = fd;
+        if (epoll < 0 || ::epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &evento) != 0) {
+            ::close(fd);
+            return false;
+        }
+        escuchas.push_back(fd);
+        return true;
+    }
+
+    bool esEscucha(int fd) const {
+        for (int e : escuchas) {
+            if (e == fd) return true;
+        }
+        return false;
+    }
+
+    void aceptar(int escucha) {
+        for (;;) {
+            int fd = ::accept4(escucha, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED || errno == EPROTO) {
+                    continue; // La conexin se cay antes de aceptarla: la siguiente.
+                }
+                if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                    // La conexin sigue en la cola y la escucha seguira lista para leer:
+                    // con epoll por nivel, el bucle girara sin descanso. Se deja de
+                    // escucharla hasta que se cierre una conexin o pase la pausa.
+                    if (!sinDescriptores) {
+                        std::cerr << "No se pueden aceptar conexiones (" << std::strerror(errno)
+                                  << "): se pausa la escucha." << std::endl;
+                        sinDescriptores = true;
+                    }
+                    pausarEscuchas(true);
+                }
+                return; // EAGAIN: no quedan conexiones por aceptar.
+            }
+            sinDescriptores = false;
+            int uno = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &uno, sizeof(uno)); // Falla sin efecto en sockets Unix.
+            if (static_cast<std::size_t>(fd) >= conexiones.size()) {
+                conexiones.resize(fd + 1);
+            }
+            conexiones[fd].reset(new Conexion(fd));
+            epoll_event evento;
+            std::memset(&evento, 0, sizeof(evento));
+            evento.events = EPOLLIN | EPOLLRDHUP;
+            evento.data.fd = fd;
+            conexiones[fd]->interes = evento.events;
+            ::epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &evento);
+        }
+    }
+
+    // Lee todo lo disponible. Devuelve false si la conexin fall.
+    bool leer(Conexion& c) {
+        char bloque[65536];
+        while (c.pendiente() < LIMITE_SALIDA) {
+            ssize_t n = ::recv(c.fd, bloque, sizeof(bloque), 0);
+            if (n > 0) {
+                c.entrada.append(bloque, static_cast<std::size_t>(n));
+                continue;
+            }
+            if (n == 0) {
+                c.cerrando = true;
+                return true;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        return true;
+    }
+
+    // Decide el protocolo con los primeros bytes: el prefijo "SGB1" elige el binario.
+    void decidirProtocolo(Conexion& c) {
+        std::size_t n = c.entrada.size() < 4 ? c.entrada.size() : 4;
+        if (n == 0) {
+            return;
+        }
+        if (c.entrada.compare(0, n, MAGICO_PROTOCOLO_BINARIO, n) != 0) {
+            c.protocolo = ProtocoloTexto;
+        } else if (n == 4) {
+            c.protocolo = ProtocoloBinario;
+            c.entrada.erase(0, 4);
+        }
+    }
+
+    // Ejecuta las peticiones completas recibidas segn el protocolo de la conexin.
+    void procesar(Conexion& c) {
+        if (c.protocolo == ProtocoloPorDecidir) {
+            decidirProtocolo(c);
+        }
+        if (c.protocolo == ProtocoloTexto) {
+            procesarTexto(c);
+        } else if (c.protocolo == ProtocoloBinario) {
+            procesarBinario(c);
+        }
+    }
+
+    // Tramas binarias; las respuestas se acumulan en c.vectorial. Una trama que excede
+    // el lmite cierra la conexin.
+    void procesarBinario(Conexion& c) {
+        sistema.fijarSalida(nullptr);
+        std::size_t consumidos = 0;
+        while (c.pendiente() < LIMITE_SALIDA && c.entrada.size() - consumidos >= 4) {
+            uint32_t longitud = leerU32(c.entrada.data() + consumidos);
+            if (longitud > LIMITE_TRAMA_BINARIA) {
+                c.cerrando = true;
+                consumidos = c.entrada.size();
+                break;
+            }
+            if (c.entrada.size() - consumidos - 4 < longitud) {
+                break;
+            }
+            ejecutarTramaBinaria(sistema, c.entrada.data() + consumidos + 4, longitud, c.vectorial, siguienteId);
+            consumidos += 4 + static_cast<std::size_t>(longitud);
+            ++atendidas;
+        }
+        c.entrada.erase(0, consumidos);
+    }
+
+    // Lneas de texto; las respuestas se acumulan en c.salida.
+    void procesarTexto(Conexion& c) {
+        buffer.redirigir(&c.salida);
+        sistema.fijarSalida(&flujo);
+        ComandoTexto comando;
+        std::size_t consumidos = 0;
+        while (c.pendiente() < LIMITE_SALIDA) {
+            std::size_t finLinea = c.entrada.find('\n', consumidos);
+            if (finLinea == std::string::npos) {
+                break;
+            }
+            analizarPeticionTexto(c.entrada.data() + consumidos, finLinea - consumidos, comando);
+            if (opcionSoloLocal(comando.opcion)) {
+                flujo << "Opcin no disponible en el servidor.\n\n";
+            } else {
+                ejecutarComandoTexto(sistema, comando, flujo, siguienteId);
+            }
+            consumidos = finLinea + 1;
+            ++atendidas;
+        }
+        c.entrada.erase(0, consumidos);
+        sistema.fijarSalida(nullptr);
+        buffer.redirigir(nullptr);
+    }
+
+    // Ejecuta lo recibido y enva las respuestas. Devuelve false si la conexin debe
+    // cerrarse. procesar se detiene en LIMITE_SALIDA aunque queden peticiones completas en
+    // la entrada: si la escritura vaca la salida se sigue con ellas aqu, porque puede
+    // no llegar otro evento de lectura que las despierte.
+    bool atender(Conexion& c) {
+        for (;;) {
+            std::size_t sinProcesar = c.entrada.size();
+            procesar(c);
+            if (!escribir(c)) {
+                return false;
+            }
+            if (c.pendiente() > 0 || c.entrada.size() == sinProcesar) {
+                break;
+            }
+        }
+        return !c.cerrando || c.pendiente() > 0;
+    }
+
+    // Enva lo pendiente. Devuelve false si la conexin fall.
+    bool escribir(Conexion& c) {
+        if (c.protocolo == ProtocoloBinario) {
+            if (!c.vectorial.enviar(c.fd)) {
+                return false;
+            }
+            // Lo que no se pudo enviar no debe apuntar al almacn: otra conexin puede modificarlo.
+            c.vectorial.materializar();
+            return true;
+        }
+        while (c.pendiente() > 0) {
+            ssize_t n = ::send(c.fd, c.salida.data() + c.enviados, c.pendiente(), MSG_NOSIGNAL);
+            if (n > 0) {
+                c.enviados += static_cast<std::size_t>(n);
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+                break;
+            }
+            return false;
+        }
+        if (c.pendiente() == 0) {
+            c.salida.clear();
+            c.enviados = 0;
+        }
+        return true;
+    }
+
+    // Pide EPOLLIN mientras haya espacio para respuestas y EPOLLOUT mientras queden por enviar.
+    void actualizarInteres(Conexion& c) {
+        uint32_t interes = c.cerrando ? 0u : static_cast<uint32_t>(EPOLLRDHUP);
+        if (c.pendiente() < LIMITE_SALIDA && !c.cerrando) interes |= EPOLLIN;
+        if (c.pendiente() > 0) interes |= EPOLLOUT;
+        if (interes != c.interes) {
+            epoll_event evento;
+            std::memset(&evento, 0, sizeof(evento));
+            evento.events = interes;
+            evento.data.fd = c.fd;
+            ::epoll_ctl(epoll, EPOLL_CTL_MOD, c.fd, &evento);
+            c.interes = interes;
+        }
+    }
+
+    void cerrar(int fd) {
+        ::epoll_ctl(epoll, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        conexiones[fd].reset();
+        if (escuchasPausadas) {
+            pausarEscuchas(false); // Hay un descriptor libre para la prxima.
+        }
+    }
+
+    // Quita (o devuelve) EPOLLIN a las escuchas, sin sacarlas de epoll.
+    void pausarEscuchas(bool pausar) {
+        for (int fd : escuchas) {
+            epoll_event evento;
+            std::memset(&evento, 0, sizeof(evento));
+            evento.events = pausar ? 0u : static_cast<uint32_t>(EPOLLIN);
+            evento.data.fd = fd;
+            ::epoll_ctl(epoll, EPOLL_CTL_MOD, fd, &evento);
+        }
+        escuchasPausadas = pausar;
+    }
+
+    Sistema& sistema;
+    BufferSalida buffer;
+    std::ostream flujo;
+    int epoll;
+    int siguienteId;
+    unsigned long long atendidas;
+    std::vector<int> escuchas;
+    bool escuchasPausadas; // Sin descriptores: las escuchas no piden EPOLLIN.
+    bool sinDescriptores;  // Ya se avis que faltan descriptores (hasta aceptar otra).
+    std::string rutaUnix;
+    std::vector<std::unique_ptr<Conexion> > conexiones; // Indexadas por descriptor.
+};
+
+// Arranca el modo servidor con los argumentos de la lnea de comandos:
+//   --servidor <ruta-socket-unix> [--tcp <puerto>]
+template <class Sistema>
+int ejecutarModoServidor(Sistema& sistema, int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Uso: " << argv[0] << " --servidor <ruta-socket> [--tcp <puerto>]" << std::endl;
+        return 2;
+    }
+    ServidorSistema<Sistema> servidor(sistema);
+    if (!servidor.escucharUnix(argv[2])) {
+        std::cerr << "No se pudo escuchar en " << argv[2] << std::endl;
+        return 1;
+    }
+    bool tcp = argc > 4 && std::string(argv[3]) == "--tcp";
+    if (tcp && !servidor.escucharTcp(std::atoi(argv[4]))) {
+        std::cerr << "No se pudo escuchar en 127.0.0.1:" << argv[4] << std::endl;
+        return 1;
+    }
+
+    std::signal(SIGINT, manejarSenalServidor);
+    std::signal(SIGTERM, manejarSenalServidor);
+    std::signal(SIGPIPE, SIG_IGN);
+    std::cout << "Servidor escuchando en " << argv[2] << (tcp ? " y 127.0.0.1:" : "") << (tcp ? argv[4] : "") << std::endl;
+    servidor.ejecutar();
+    std::cout << "Servidor detenido: " << servidor.peticionesAtendidas() << " peticiones atendidas." << std::endl;
+    return 0;
+}
+
+#else
+
+inline bool servidorDisponible() { return false; }
+
+template <class Sistema>
+int ejecutarModoServidor(Sistema&, int, char**) {
+    std::cerr << "El modo servidor solo est disponible en Linux." << std::endl;
+    return 1;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,464 @@
+#ifndef SISTEMA_ASINCRONO_H
+#define SISTEMA_ASINCRONO_H
+
+// API asncrona con corrutinas de C++20
+// Para usar SistemaGestion desde servicios asncronos: en lugar de imprimir "No hay
+// clientes en espera", co_await atenderClienteAsync() suspende la corrutina hasta que
+// llegue un cliente, y co_await procesarSolicitudAsync() hace lo mismo con las
+// solicitudes. Una corrutina suspendida es solo su marco en memoria: miles de
+// consumidores esperando no ocupan ningn hilo.
+//
+// Incluye el tipo de tarea (Tarea<T>), lanzar() para corrutinas sueltas y dos
+// ejecutores: EjecutorUnHilo (un bucle en el hilo que lo llama) y EjecutorHilos (un
+// grupo fijo de hilos). Una corrutina despertada se reanuda en el ejecutor desde el que
+// esperaba; si esperaba fuera de un ejecutor, en el hilo que la despierta.
+//
+// Solo se compila con C++20 (-std=c++20); el resto del proyecto sigue en C++11.
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include <string>
+
+#include "sistema_gestion.h"
+
+// Dnde se reanudan las corrutinas.
+class Ejecutor {
+public:
+    virtual ~Ejecutor() {}
+    virtual void programar(std::coroutine_handle<> corrutina) = 0;
+
+    // Ejecutor que est corriendo la corrutina actual en este hilo (nullptr fuera de uno).
+    static Ejecutor*& actual() {
+        thread_local Ejecutor* ejecutor = nullptr;
+        return ejecutor;
+    }
+
+protected:
+    void correr(std::coroutine_handle<> corrutina) {
+        Ejecutor* anterior = actual();
+        actual() = this;
+        corrutina.resume();
+        actual() = anterior;
+    }
+};
+
+inline void reanudarEn(Ejecutor* ejecutor, std::coroutine_handle<> corrutina) {
+    if (ejecutor) {
+        ejecutor->programar(corrutina);
+    } else {
+        corrutina.resume();
+    }
+}
+
+// Bucle de un solo hilo. programar() se puede llamar desde cualquier hilo.
+class EjecutorUnHilo : public Ejecutor {
+public:
+    EjecutorUnHilo() : detenido(false) {}
+
+    void programar(std::coroutine_handle<> corrutina) override {
+        {
+            std::lock_guard<std::mutex> guardia(cerrojo);
+            listas.push_back(corrutina);
+        }
+        hayTrabajo.notify_one();
+    }
+
+    // Corre lo que est listo (y lo que eso programe) y vuelve; devuelve cuntas reanud.
+    std::size_t ejecutarPendientes() {
+        std::size_t reanudadas = 0;
+        std::coroutine_handle<> corrutina;
+        while (sacar(corrutina, false)) {
+            correr(corrutina);
+            ++reanudadas;
+        }
+        return reanudadas;
+    }
+
+    // Corre hasta que se llame a detener().
+    void ejecutar() {
+        std::coroutine_handle<> corrutina;
+        while (sacar(corrutina, true)) {
+            correr(corrutina);
+        }
+    }
+
+    void detener() {
+        {
+            std::lock_guard<std::mutex> guardia(cerrojo);
+            detenido = true;
+        }
+        hayTrabajo.notify_all();
+    }
+
+private:
+    bool sacar(std::coroutine_handle<>& corrutina, bool esperar) {
+        std::unique_lock<std::mutex> guardia(cerrojo);
+        if (esperar) {
+            hayTrabajo.wait(guardia, [this] { return detenido || !listas.empty(); });
+        }
+        if (listas.empty()) {
+            return false;
+        }
+        corrutina = listas.front();
+        listas.pop_front();
+        return true;
+    }
+
+    std::mutex cerrojo;
+    std::condition_variable hayTrabajo;
+    std::deque<std::coroutine_handle<> > listas;
+    bool detenido;
+};
+
+// Grupo fijo de hilos que toman corrutinas de una cola comn.
+// Al destruirse termina lo que ya estaba programado.
+class EjecutorHilos : public Ejecutor {
+public:
+    // hilos = 0 usa uno por ncleo.
+    explicit EjecutorHilos(unsigned hilos = 0) : detenido(false) {
+        if (hilos == 0) {
+            hilos = std::thread::hardware_concurrency();
+            if (hilos == 0) hilos = 1;
+        }
+        for (unsigned i = 0; i < hilos; ++i) {
+            trabajadores.emplace_back(&EjecutorHilos::bucle, this);
+        }
+    }
+
+    ~EjecutorHilos() override {
+        {
+            std::lock_guard<std::mutex> guardia(cerrojo);
+            detenido = true;
+        }
+        hayTrabajo.notify_all();
+        for (auto& trabajador : trabajadores) {
+            trabajador.join();
+        }
+    }
+
+    EjecutorHilos(const EjecutorHilos&) = delete;
+    EjecutorHilos& operator=(const EjecutorHilos&) = delete;
+
+    void programar(std::coroutine_handle<> corrutina) override {
+        {
+            std::lock_guard<std::mutex> guardia(cerrojo);
+            listas.push_back(corrutina);
+        }
+        hayTrabajo.notify_one();
+    }
+
+    unsigned tamano() const { return static_cast<unsigned>(trabajadores.size()); }
+
+private:
+    void bucle() {
+        for (;;) {
+            std::coroutine_handle<> corrutina;
+            {
+                std::unique_lock<std::mutex> guardia(cerrojo);
+                hayTrabajo.wait(guardia, [this] { return detenido || !listas.empty(); });
+                if (listas.empty()) {
+                    return;
+                }
+                corrutina = listas.front();
+                listas.pop_front();
+            }
+            correr(corrutina);
+        }
+    }
+
+    std::vector<std::thread> trabajadores;
+    std::mutex cerrojo;
+    std::condition_variable hayTrabajo;
+    std::deque<std::coroutine_handle<> > listas;
+    bool detenido;
+};
+
+// Parte comn de las promesas de Tarea: al terminar se contina con quien la esperaba.
+struct PromesaTareaBase {
+    std::coroutine_handle<> continuacion;
+    std::exception_ptr excepcion;
+
+    struct AlTerminar {
+        bool await_ready() const noexcept { return false; }
+        template <class Promesa>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promesa> corrutina) noexcept {
+            std::coroutine_handle<> siguiente = corrutina.promise().continuacion;
+            return siguiente ? siguiente : std::noop_coroutine();
+        }
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    AlTerminar final_suspend() const noexcept { return {}; }
+    void unhandled_exception() { excepcion = std::current_exception(); }
+};
+
+// Corrutina perezosa: empieza cuando se la espera con co_await.
+template <class T = void>
+class Tarea {
+public:
+    struct promise_type : PromesaTareaBase {
+        std::optional<T> valor;
+        Tarea get_return_object() { return Tarea(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        template <class U>
+        void return_value(U&& v) { valor.emplace(std::forward<U>(v)); }
+    };
+
+    Tarea(Tarea&& otra) noexcept : corrutina(std::exchange(otra.corrutina, nullptr)) {}
+    Tarea& operator=(Tarea&& otra) noexcept {
+        if (this != &otra) {
+            if (corrutina) corrutina.destroy();
+            corrutina = std::exchange(otra.corrutina, nullptr);
+        }
+        return *this;
+    }
+    ~Tarea() {
+        if (corrutina) corrutina.destroy();
+    }
+
+    bool await_ready() const noexcept { return !corrutina || corrutina.done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> quien) noexcept {
+        corrutina.promise().continuacion = quien;
+        return corrutina;
+    }
+    T await_resume() {
+        if (corrutina.promise().excepcion) std::rethrow_exception(corrutina.promise().excepcion);
+        return std::move(*corrutina.promise().valor);
+    }
+
+private:
+    explicit Tarea(std::coroutine_handle<promise_type> corrutina) : corrutina(corrutina) {}
+    std::coroutine_handle<promise_type> corrutina;
+};
+
+template <>
+class Tarea<void> {
+public:
+    struct promise_type : PromesaTareaBase {
+        Tarea get_return_object() { return Tarea(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        void return_void() {}
+    };
+
+    Tarea(Tarea&& otra) noexcept : corrutina(std::exchange(otra.corrutina, nullptr)) {}
+    Tarea& operator=(Tarea&& otra) noexcept {
+        if (this != &otra) {
+            if (corrutina) corrutina.destroy();
+            corrutina = std::exchange(otra.corrutina, nullptr);
+        }
+        return *this;
+    }
+    ~Tarea() {
+        if (corrutina) corrutina.destroy();
+    }
+
+    bool await_ready() const noexcept { return !corrutina || corrutina.done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> quien) noexcept {
+        corrutina.promise().continuacion = quien;
+        return corrutina;
+    }
+    void await_resume() {
+        if (corrutina.promise().excepcion) std::rethrow_exception(corrutina.promise().excepcion);
+    }
+
+private:
+    explicit Tarea(std::coroutine_handle<promise_type> corrutina) : corrutina(corrutina) {}
+    std::coroutine_handle<promise_type> corrutina;
+};
+
+// Corrutina que nadie espera: se libera sola al terminar.
+struct TareaSuelta {
+    struct promise_type {
+        TareaSuelta get_return_object() { return TareaSuelta{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+    std::coroutine_handle<promise_type> corrutina;
+};
+
+inline TareaSuelta correrSuelta(Tarea<> tarea) {
+    co_await tarea;
+}
+
+// Programa la tarea en el ejecutor sin esperarla. Una excepcin sin capturar termina el programa.
+inline void lanzar(Ejecutor& ejecutor, Tarea<> tarea) {
+    ejecutor.programar(correrSuelta(std::move(tarea)).corrutina);
+}
+
+// Envoltorio asncrono de un sistema de gestin.
+// Los consumidores que esperan forman una cola FIFO enlazada a travs de sus propios
+// marcos (sin reservar memoria). Registrar un cliente o una solicitud despierta al
+// consumidor que lleva ms tiempo esperando, que recibe el primero de la cola.
+//
+// Los mensajes son los del men ("Cliente registrado: ...", "Atendiendo cliente: ...").
+// Los productores deben registrar a travs de este envoltorio: lo que entra directo al
+// sistema no despierta a nadie. Registrar, consultar y eliminar productos tambin tienen
+// versin con co_await; no esperan nada, as que terminan sin suspenderse, en el hilo
+// de quien las espera. El resto de operaciones se hace con sistema().
+template <class Sistema = SistemaGestion>
+class SistemaAsincrono {
+    template <class Valor>
+    struct Esperador {
+        Esperador* siguiente;
+        std::coroutine_handle<> corrutina;
+        Ejecutor* ejecutor;
+        Valor valor;
+    };
+
+    template <class Valor>
+    struct ColaEsperadores {
+        ColaEsperadores() : primero(nullptr), ultimo(nullptr), cantidad(0) {}
+        void agregar(Esperador<Valor>* esperador) {
+            esperador->siguiente = nullptr;
+            if (ultimo) {
+                ultimo->siguiente = esperador;
+            } else {
+                primero = esperador;
+            }
+            ultimo = esperador;
+            ++cantidad;
+        }
+        Esperador<Valor>* sacar() {
+            Esperador<Valor>* esperador = primero;
+            if (esperador) {
+                primero = esperador->siguiente;
+                if (!primero) ultimo = nullptr;
+                --cantidad;
+            }
+            return esperador;
+        }
+        Esperador<Valor>* primero;
+        Esperador<Valor>* ultimo;
+        std::size_t cantidad;
+    };
+
+public:
+    // Resultado de co_await: el cliente o la solicitud que toc.
+    template <class Valor>
+    class Espera {
+    public:
+        explicit Espera(SistemaAsincrono& asincrono) : asincrono(asincrono) {}
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> corrutina) {
+            std::lock_guard<std::mutex> guardia(asincrono.cerrojo);
+            if (asincrono.tomar(nodo.valor)) {
+                return false; // Haba uno: sigue sin suspenderse.
+            }
+            nodo.corrutina = corrutina;
+            nodo.ejecutor = Ejecutor::actual();
+            asincrono.esperadores(nodo.valor).agregar(&nodo);
+            return true;
+        }
+        Valor await_resume() { return std::move(nodo.valor); }
+
+    private:
+        SistemaAsincrono& asincrono;
+        Esperador<Valor> nodo;
+    };
+
+    explicit SistemaAsincrono(std::ostream* salida = &std::cout) : base(salida) {}
+
+    Sistema& sistema() { return base; }
+
+    void registrarSolicitud(const Solicitud& solicitud) {
+        Esperador<Solicitud>* despertado;
+        {
+            std::lock_guard<std::mutex> guardia(cerrojo);
+            base.registrarSolicitud(solicitud);
+            despertado = entregar(solicitudesEsperadas);
+        }
+        if (despertado) reanudarEn(despertado->ejecutor, despertado->corrutina);
+    }
+
+    void registrarClienteEnEspera(const Cliente& cliente) {
+        Esperador<Cliente>* despertado;
+        {
+            std::lock_guard<std::mutex> guardia(cerrojo);
+            base.registrarClienteEnEspera(cliente);
+            despertado = entregar(clientesEsperados);
+        }
+        if (despertado) reanudarEn(despertado->ejecutor, despertado->corrutina);
+    }
+
+    // Operaciones del inventario para corrutinas. Los argumentos se copian al marco.
+    // GCC 12 destruye dos veces un agregado temporal armado dentro de la expresin del
+    // co_await (co_await registrarProductoAsync(Producto{...})): armarlo antes, en una variable.
+    Tarea<> registrarProductoAsync(Producto producto) {
+        base.registrarProducto(producto);
+        co_return;
+    }
+
+    // El producto si existe (con el mensaje "Producto: ..." del men); si no, nullopt.
+    Tarea<std::optional<Producto> > consultarProductoAsync(std::string nombre) {
+        std::optional<Producto> encontrado;
+        base.consultarProducto(vistaDe(nombre), [&encontrado](const VistaProducto& producto) {
+            encontrado = Producto{std::string(producto.nombre.datos, producto.nombre.longitud), producto.precio,
+                                  producto.cantidad};
+        });
+        co_return encontrado;
+    }
+
+    // Devuelve si el producto exista.
+    Tarea<bool> eliminarProductoAsync(std::string nombre) { co_return base.eliminarProducto(nombre); }
+
+    // co_await atenderClienteAsync() devuelve el primer cliente en espera, suspendiendo
+    // hasta que haya uno.
+    Espera<Cliente> atenderClienteAsync() { return Espera<Cliente>(*this); }
+
+    // co_await procesarSolicitudAsync() devuelve la primera solicitud pendiente.
+    Espera<Solicitud> procesarSolicitudAsync() { return Espera<Solicitud>(*this); }
+
+    // Corrutinas suspendidas esperando un cliente o una solicitud.
+    std::size_t esperandoClientes() {
+        std::lock_guard<std::mutex> guardia(cerrojo);
+        return clientesEsperados.cantidad;
+    }
+    std::size_t esperandoSolicitudes() {
+        std::lock_guard<std::mutex> guardia(cerrojo);
+        return solicitudesEsperadas.cantidad;
+    }
+
+private:
+    // Con el cerrojo tomado.
+    bool tomar(Cliente& cliente) {
+        if (!base.tomarCliente(cliente)) return false;
+        base.anunciar(MensajeAtendiendoCliente, vistaDe(cliente.nombre));
+        return true;
+    }
+    bool tomar(Solicitud& solicitud) {
+        if (!base.tomarSolicitud(solicitud)) return false;
+        base.anunciar(MensajeProcesandoSolicitud, vistaDe(solicitud.descripcion));
+        return true;
+    }
+    ColaEsperadores<Cliente>& esperadores(const Cliente&) { return clientesEsperados; }
+    ColaEsperadores<Solicitud>& esperadores(const Solicitud&) { return solicitudesEsperadas; }
+
+    // Le da el primero de la cola al consumidor que ms esper, si hay alguno.
+    template <class Valor>
+    Esperador<Valor>* entregar(ColaEsperadores<Valor>& cola) {
+        Esperador<Valor>* esperador = cola.sacar();
+        if (esperador) tomar(esperador->valor);
+        return esperador;
+    }
+
+    std::mutex cerrojo;
+    Sistema base;
+    ColaEsperadores<Cliente> clientesEsperados;
+    ColaEsperadores<Solicitud> solicitudesEsperadas;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,1178 @@
+#ifndef SISTEMA_GESTION_H
+#define SISTEMA_GESTION_H
+
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <cstdio>
+
+#include "estructuras.h"
+#include "politicas.h"
+#include "catalogo_congelado.h"
+#include "replica_compartida.h"
+#include "histograma_latencia.h"
+#include "registro_mensajes.h"
+#include "auditoria.h"
+#include "autocompletado.h"
+#include "busqueda_aproximada.h"
+#include "indice_solicitudes.h"
+#include "filtro_ausentes.h"
+#include "nombres_normalizados.h"
+
+// Bfer de flujo que agrega lo escrito al final de una cadena; con l los mensajes de
+// SistemaGestion van directo a un bfer (el de una conexin del servidor, la respuesta
+// de una particin, ...).
+class BufferSalida : public std::streambuf {
+public:
+    BufferSalida() : destino(nullptr) {}
+
+    void redirigir(std::string* nuevoDestino) { destino = nuevoDestino; }
+
+protected:
+    int_type overflow(int_type c) override {
+        if (c != traits_type::eof() && destino) {
+            destino->push_back(static_cast<char>(c));
+        }
+        return c;
+    }
+
+    std::streamsize xsputn(const char* datos, std::streamsize n) override {
+        if (destino) {
+            destino->append(datos, static_cast<std::size_t>(n));
+        }
+        return n;
+    }
+
+private:
+    std::string* destino;
+};
+
+// Tamao de cada estructura, para leerlo desde otro hilo (mtricas) sin tomar cerrojos.
+// Lo actualiza quien modifica la estructura, con su cerrojo tomado: un solo escritor.
+struct TamanosSistema {
+    TamanosSistema() : productos(0), solicitudes(0), clientes(0), historial(0) {}
+    std::atomic<std::size_t> productos;
+    std::atomic<std::size_t> solicitudes;
+    std::atomic<std::size_t> clientes;
+    std::atomic<std::size_t> historial;
+};
+
+// Clase para la gestin del sistema
+// Contiene las estructuras para manejar inventario, solicitudes, clientes en espera, y el historial de cambios.
+// Cada estructura, y la forma de sincronizarlas, se elige en tiempo de compilacin con
+// polticas (ver politicas.h); SistemaGestion usa las listas originales sin bloqueo.
+template <class PoliticaAlmacen = AlmacenLista,
+          class PoliticaCola = ColaLista,
+          class PoliticaHistorial = HistorialLista,
+          class PoliticaBloqueo = SinBloqueo>
+class SistemaGestionT {
+private:
+    typedef typename PoliticaBloqueo::Cerrojo Cerrojo;
+    typedef std::lock_guard<Cerrojo> Guardia;
+
+    // Estructuras que almacenan la informacin principal del sistema.
+    PoliticaAlmacen inventario;                                      // Almacena los productos registrados.
+    typename PoliticaCola::template Cola<Solicitud> solicitudes;     // Almacena las solicitudes pendientes.
+    typename PoliticaCola::template Cola<Cliente> clientesEnEspera;  // Lista de clientes en espera.
+    PoliticaHistorial historialCambios;                              // Registro de los cambios realizados en el inventario.
+    CatalogoCongelado catalogo;                                      // Imagen inmutable del inventario mientras est congelado.
+    bool catalogoSinMaterializar;                                    // El catlogo se carg de un archivo y el inventario est vaco.
+    PublicadorReplica replica;                                       // Copia del inventario en memoria compartida, si se public.
+    RegistroAuditoria* auditoria;                                    // Registro de auditora compartido; nullptr si no se audita.
+    std::string almacenAuditoria;                                    // Nombre con el que este sistema aparece en la auditora.
+    IndiceAutocompletado autocompletado;                             // Prefijos de los nombres del inventario, si est activo.
+    bool autocompletar;                                              // Se mantiene el ndice de autocompletado.
+    IndiceAproximado sugerencias;                                    // Trigramas de los nombres del inventario, si est activo.
+    bool sugerir;                                                    // Se sugieren nombres cercanos a los que no estn.
+    IndiceSolicitudes indiceSolicitudes;                             // Palabras de las solicitudes pendientes, si est activo.
+    bool indexarSolicitudes;                                         // Se mantiene el ndice de solicitudes.
+    FiltroAusentes filtroAusentes;                                   // Filtro de Bloom de los nombres del inventario, si est activo.
+    bool filtrar;                                                    // Las bsquedas pasan primero por el filtro.
+    IndiceNormalizado nombresNormalizados;                           // Claves sin maysculas ni acentos, si est activo.
+    bool normalizar;                                                 // Un nombre que no est se busca por su clave.
+
+    // Cerrojos; el inventario y el historial comparten uno porque deshacer modifica ambos.
+    Cerrojo cerrojoInventario;
+    Cerrojo cerrojoSolicitudes;
+    Cerrojo cerrojoClientes;
+
+    std::ostream* salida; // Flujo donde se escriben los mensajes; nullptr los silencia.
+    bool mensajesAsincronos; // Los mensajes los escribe el hilo de registro_mensajes.h.
+    LatenciasSistema latenciasOperaciones; // Histograma de latencia de cada mtodo pblico.
+    TamanosSistema tamanosEstructuras;     // Copia atmica de los tamaos, para las mtricas.
+    std::atomic<int64_t> umbralMemoria;    // Bytes a partir de los cuales se avisa; 0 no avisa.
+    std::atomic<int64_t> picoMemoria;      // Mayor total de las estructuras visto hasta ahora.
+    std::atomic<bool> memoriaSobreUmbral;  // Ya se avis y el total no volvi a bajar del umbral.
+
+    // Vuelve al almacenamiento mutable; si el catlogo vino de un archivo, antes
+    // copia sus productos al inventario.
+    void descongelar() {
+        if (catalogoSinMaterializar) {
+            catalogo.recorrerOrdenado([this](const VistaProducto& vista) {
+                Producto producto;
+                producto.nombre.assign(vista.nombre.datos, vista.nombre.longitud);
+                producto.precio = vista.precio;
+                producto.cantidad = vista.cantidad;
+                inventario.insertar(producto);
+            });
+            catalogoSinMaterializar = false;
+        }
+        catalogo.liberar();
+    }
+
+    // Recorre el inventario vigente, ordenado por nombre: el catlogo si est congelado.
+    template <class F>
+    void recorrerInventario(F f) {
+        if (catalogo.vacio()) {
+            inventario.recorrerOrdenado(f);
+        } else {
+            catalogo.recorrerOrdenado(f); // Ya est ordenado: recorrido lineal.
+        }
+    }
+
+    // Anotan los tamaos despus de modificar cada estructura (con su cerrojo tomado).
+    void anotarInventario() {
+        tamanosEstructuras.productos.store(catalogoSinMaterializar ? catalogo.tamano() : inventario.tamano(),
+                                           std::memory_order_relaxed);
+        tamanosEstructuras.historial.store(historialCambios.tamano(), std::memory_order_relaxed);
+        vigilarMemoria();
+    }
+    void anotarSolicitudes() {
+        tamanosEstructuras.solicitudes.store(solicitudes.tamano(), std::memory_order_relaxed);
+        vigilarMemoria();
+    }
+    void anotarClientes() {
+        tamanosEstructuras.clientes.store(clientesEnEspera.tamano(), std::memory_order_relaxed);
+        vigilarMemoria();
+    }
+
+    // Actualiza el pico de memoria y avisa una vez cada vez que el total cruza el umbral.
+    void vigilarMemoria();
+
+    // Mantienen los ndices de nombres activos cuando un nombre entra o sale del inventario.
+    // indexarNombre se llama con el nombre ya en el inventario; consultas es la
+    // popularidad con la que vuelve un nombre que se haba eliminado.
+    void indexarNombre(const VistaNombre& nombre, uint32_t consultas = 0) {
+        if (autocompletar) {
+            autocompletado.agregar(nombre, consultas);
+        }
+        if (sugerir) {
+            sugerencias.agregar(nombre);
+        }
+        if (filtrar && !filtroAusentes.agregar(nombre)) {
+            reconstruirFiltro(); // Lleno: el nuevo entra con los dems.
+        }
+        if (normalizar) {
+            nombresNormalizados.agregar(nombre);
+        }
+    }
+    void desindexarNombre(const VistaNombre& nombre) {
+        if (autocompletar) {
+            autocompletado.quitar(nombre);
+        }
+        if (sugerir) {
+            sugerencias.quitar(nombre);
+        }
+        if (filtrar) {
+            filtroAusentes.quitar(nombre);
+        }
+        if (normalizar) {
+            nombresNormalizados.quitar(nombre);
+        }
+    }
+
+    // Busca el nombre exacto en el inventario vigente, pasando antes por el filtro.
+    bool buscarExacto(const VistaNombre& nombre, VistaProducto& producto) {
+        if (filtrar && !filtroAusentes.puedeEstar(nombre)) {
+            return false;
+        }
+        bool encontrado;
+        {
+            EVENTO_TRAZA("sondeoIndice");
+            encontrado = catalogo.vacio() ? inventario.buscar(nombre, producto)
+                                          : catalogo.buscar(nombre, producto);
+        }
+        if (filtrar && !encontrado) {
+            filtroAusentes.anotarFalsoPositivo();
+        }
+        return encontrado;
+    }
+
+    // Saca el nombre exacto del inventario (ya descongelado), pasando antes por el filtro.
+    bool extraerExacto(const VistaNombre& nombre, Producto& producto) {
+        if (filtrar && !filtroAusentes.puedeEstar(nombre)) {
+            return false;
+        }
+        bool existia;
+        {
+            EVENTO_TRAZA("sondeoIndice");
+            existia = inventario.extraer(nombre, producto);
+        }
+        if (filtrar && !existia) {
+            filtroAusentes.anotarFalsoPositivo();
+        }
+        return existia;
+    }
+
+    // Prueba el nombre tal cual y, si falla y el ndice normalizado lo conoce con otra
+    // grafa, la registrada.
+    template <class F>
+    bool probarNombre(const VistaNombre& nombre, F probar) {
+        if (probar(nombre)) {
+            return true;
+        }
+        std::string registrado;
+        return normalizar && nombresNormalizados.resolver(nombre, registrado) && probar(vistaDe(registrado));
+    }
+
+    // Rehace el filtro de ausentes con los nombres vigentes y lugar para otros tantos.
+    void reconstruirFiltro() {
+        auto agregar = [this](const VistaProducto& producto) { filtroAusentes.agregar(producto.nombre); };
+        if (catalogo.vacio()) {
+            filtroAusentes.dimensionar(inventario.tamano() * 2);
+            inventario.recorrer(agregar);
+        } else {
+            filtroAusentes.dimensionar(catalogo.tamano() * 2);
+            catalogo.recorrerOrdenado(agregar);
+        }
+    }
+
+    // Escribe un mensaje en la salida, o lo encola si los mensajes son asncronos.
+    void mensaje(MensajeSistema codigo, const VistaNombre& texto = VistaNombre(), double real = 0, int entero = 0) {
+        if (!salida) {
+            return;
+        }
+        if (mensajesAsincronos) {
+            RegistroMensajes::global().encolar(salida, codigo, texto.datos, texto.longitud, real, entero);
+        } else {
+            escribirMensaje(*salida, codigo, texto.datos, texto.longitud, real, entero);
+            salida->flush();
+        }
+    }
+
+    // Publica un producto nuevo en la rplica compartida; avisa una vez si se llena.
+    void publicarInsercion(const Producto& producto) {
+        if (replica.activa()) {
+            EVENTO_TRAZA("escrituraReplica");
+            if (!replica.insertar(producto)) {
+                MensajeLibre(salida, mensajesAsincronos) << "Rplica compartida llena: se deja de publicar hasta que el inventario baje a la mitad." << std::endl;
+            }
+        }
+    }
+
+    // Una rplica desbordada perdi cambios: cuando el inventario vuelve a ocupar la
+    // mitad de su capacidad se republica entera, lo que tambin quita la marca.
+    void publicarEliminacion(const VistaNombre& nombreProducto) {
+        if (replica.activa()) {
+            EVENTO_TRAZA("escrituraReplica");
+            replica.eliminar(nombreProducto);
+        } else if (replica.desbordada() &&
+                   (catalogo.vacio() ? inventario.tamano() : catalogo.tamano()) * 2 <= replica.capacidad()) {
+            EVENTO_TRAZA("escrituraReplica");
+            if (replica.reemplazar([this](const std::function<void(const VistaProducto&)>& f) { recorrerInventario(f); })) {
+                MensajeLibre(salida, mensajesAsincronos) << "Rplica compartida: se retoma la publicacin." << std::endl;
+            }
+        }
+    }
+
+public:
+    explicit SistemaGestionT(std::ostream* salida = &std::cout)
+        : catalogoSinMaterializar(false), auditoria(nullptr), autocompletar(false), sugerir(false), indexarSolicitudes(false),
+          filtrar(false), normalizar(false), salida(salida), mensajesAsincronos(false), umbralMemoria(0), picoMemoria(0),
+          memoriaSobreUmbral(false) {}
+    ~SistemaGestionT() {
+        if (mensajesAsincronos) RegistroMensajes::global().vaciar(); // La salida puede morir despus.
+    }
+
+    // Cambia el flujo de salida de los mensajes (nullptr para no escribir nada).
+    void fijarSalida(std::ostream* nuevaSalida) {
+        if (mensajesAsincronos) RegistroMensajes::global().vaciar();
+        salida = nuevaSalida;
+    }
+    std::ostream* salidaActual() const { return salida; }
+
+    // Escribe un mensaje del sistema por el mismo camino que los de las operaciones, as
+    // queda en orden con ellos aunque sean asncronos. Para quien saca elementos con
+    // tomarSolicitud o tomarCliente y los anuncia como el men.
+    void anunciar(MensajeSistema codigo, const VistaNombre& texto) { mensaje(codigo, texto); }
+
+    // Saca la escritura de los mensajes del camino de las operaciones (registro_mensajes.h).
+    // Solo para salidas que nadie ms escribe mientras tanto, como la terminal o un
+    // archivo; el servidor y la tubera ya escriben fuera de la operacin con sus bferes.
+    void fijarMensajesAsincronos(bool activar) {
+        if (activar) {
+            RegistroMensajes::global().iniciar();
+        } else if (mensajesAsincronos) {
+            RegistroMensajes::global().vaciar();
+        }
+        mensajesAsincronos = activar;
+    }
+
+    // Anota cada modificacin en registro (auditoria.h) como hecha en el almacn indicado;
+    // nullptr deja de auditar. El registro debe vivir ms que el sistema.
+    void fijarAuditoria(RegistroAuditoria* registro, const std::string& almacen) {
+        Guardia inventarioTomado(cerrojoInventario);
+        Guardia solicitudesTomadas(cerrojoSolicitudes);
+        Guardia clientesTomados(cerrojoClientes);
+        auditoria = registro;
+        almacenAuditoria = almacen;
+    }
+
+    // Empieza a mantener el ndice de autocompletado (autocompletado.h) con los nombres
+    // del inventario; desde entonces se actualiza con cada alta, baja y consulta.
+    void activarAutocompletado() {
+        Guardia guardia(cerrojoInventario);
+        if (!autocompletar) {
+            recorrerInventario([this](const VistaProducto& producto) { autocompletado.agregar(producto.nombre); });
+            autocompletar = true;
+        }
+    }
+
+    // Empieza a mantener el ndice de bsqueda aproximada (busqueda_aproximada.h): desde
+    // entonces consultarProducto sugiere nombres cercanos cuando no encuentra el pedido.
+    void activarSugerencias() {
+        Guardia guardia(cerrojoInventario);
+        if (!sugerir) {
+            recorrerInventario([this](const VistaProducto& producto) { sugerencias.agregar(producto.nombre); });
+            sugerir = true;
+        }
+    }
+
+    // Pone el filtro de ausentes (filtro_ausentes.h) delante del inventario: desde entonces
+    // consultar o eliminar un nombre que no est casi nunca llega al almacn.
+    void activarFiltroAusentes() {
+        Guardia guardia(cerrojoInventario);
+        if (!filtrar) {
+            reconstruirFiltro();
+            filtrar = true;
+        }
+    }
+
+    // Empieza a mantener el ndice de nombres normalizados (nombres_normalizados.h): desde
+    // entonces consultar o eliminar un nombre que no est encuentra el registrado que
+    // solo difiere en maysculas o acentos ("cafe" encuentra "Caf").
+    void activarNombresNormalizados() {
+        Guardia guardia(cerrojoInventario);
+        if (!normalizar) {
+            recorrerInventario([this](const VistaProducto& producto) { nombresNormalizados.agregar(producto.nombre); });
+            normalizar = true;
+        }
+    }
+
+    // Empieza a mantener el ndice invertido de las solicitudes pendientes
+    // (indice_solicitudes.h); buscarSolicitudes lo usa en lugar de leer toda la cola.
+    void activarIndiceSolicitudes() {
+        Guardia guardia(cerrojoSolicitudes);
+        if (!indexarSolicitudes) {
+            solicitudes.recorrer([this](const Solicitud& solicitud) { indiceSolicitudes.agregar(vistaDe(solicitud.descripcion)); });
+            indexarSolicitudes = true;
+        }
+    }
+
+    // Activa todos los ndices de arriba, como los usan el men, el servidor, los guiones
+    // y la reproduccin de trazas; un ndice nuevo se agrega aqu.
+    void activarIndices() {
+        activarAutocompletado();
+        activarSugerencias();
+        activarIndiceSolicitudes();
+        activarFiltroAusentes();
+        activarNombresNormalizados();
+    }
+
+    // Mtodos para la gestin de inventario
+    void registrarProducto(const Producto& producto);
+    bool eliminarProducto(const std::string& nombreProducto); // Devuelve si exista.
+    void consultarProducto(const std::string& nombreProducto);
+    // Igual, y adems f recibe la vista del producto encontrado (con el cerrojo tomado).
+    template <class F> bool consultarProducto(const VistaNombre& nombre, F f);
+    void listarProductos();
+    void autocompletarProducto(const std::string& prefijo);
+
+    // Mtodos para la gestin de solicitudes
+    void registrarSolicitud(const Solicitud& solicitud);
+    void procesarSolicitud();
+    void consultarSolicitudEnProceso();
+    void listarSolicitudesPendientes();
+    void buscarSolicitudesPendientes(const std::string& consulta);
+
+    // Mtodos para la gestin de clientes en espera
+    void registrarClienteEnEspera(const Cliente& cliente);
+    void atenderCliente();
+    void consultarListaDeEspera();
+
+    // Mtodos para la gestin del historial de cambios
+    void deshacerUltimaAccion();
+
+    // Operaciones con resultado y sin mensajes; las usa el protocolo binario.
+    // Las funciones f se llaman con el cerrojo tomado y reciben vistas que apuntan al
+    // almacenamiento: solo son vlidas hasta la siguiente modificacin del sistema.
+    template <class F> bool buscarProducto(const VistaNombre& nombre, F f);
+    // Como buscarProducto pero sin anotar la consulta en el autocompletado: para reportes
+    // que leen el inventario sin que cuenten como pedidos del nombre.
+    template <class F> bool verProducto(const VistaNombre& nombre, F f);
+    // Si se pasa registrado, recibe el nombre tal como estaba guardado (puede diferir
+    // del pedido en maysculas o acentos).
+    bool quitarProducto(const VistaNombre& nombre, std::string* registrado = nullptr);
+    template <class F> void recorrerProductos(F f);
+    template <class F> std::size_t completarProducto(const VistaNombre& prefijo, std::size_t limite, F f);
+    template <class F> std::size_t sugerirProducto(const VistaNombre& nombre, std::size_t limite, F f);
+    bool tomarSolicitud(Solicitud& solicitud);
+    template <class F> bool verSolicitudEnProceso(F f);
+    template <class F> void recorrerSolicitudes(F f);
+    template <class F> std::size_t buscarSolicitudes(const VistaNombre& consulta, F f);
+    bool tomarCliente(Cliente& cliente);
+    template <class F> void recorrerClientes(F f);
+    ResultadoDeshacer revertirUltimoCambio(Cambio& cambio);
+
+    // Mtodos para el catlogo congelado (solo lectura)
+    // Cualquier modificacin del inventario lo descongela automticamente.
+    // Guardar y cargar devuelven false si fall el archivo.
+    void congelarCatalogo();
+    void descongelarCatalogo();
+    bool guardarCatalogo(const std::string& ruta);
+    bool cargarCatalogo(const std::string& ruta);
+
+    // Mtodos para la rplica en memoria compartida (POSIX)
+    // capacidad es el nmero mximo de productos; 0 la calcula a partir del inventario.
+    // Devuelve false si no se pudo crear la regin.
+    bool publicarReplica(const std::string& nombreRegion, std::size_t capacidad = 0);
+    bool catalogoCongelado() const { return !catalogo.vacio(); }
+
+    // Latencia de los mtodos anteriores (ver histograma_latencia.h)
+    LatenciasSistema& latencias() { return latenciasOperaciones; }
+    const TamanosSistema& tamanos() const { return tamanosEstructuras; }
+    void imprimirLatencias();
+    void reiniciarLatencias();
+
+    // Memoria de cada estructura (ver memoria_estructuras.h); se puede leer desde otro hilo.
+    MemoriaSistema memoria() const;
+    int64_t memoriaPico() const { return picoMemoria.load(std::memory_order_relaxed); }
+    EstadoFiltroAusentes estadoFiltroAusentes(); // Todo en cero si el filtro no est activo.
+    void imprimirMemoria();
+    void fijarAlertaMemoria(int64_t bytes); // 0 desactiva la alerta.
+};
+
+// Configuracin original: listas en un solo hilo.
+typedef SistemaGestionT<> SistemaGestion;
+
+// Implementacin de los mtodos del SistemaGestion
+
+// Mtodo para agregar un producto al inventario.
+template <class A, class C, class H, class B>
+void SistemaGestionT<A, C, H, B>::registrarProducto(const Producto& producto) {
+    MedicionLatencia medicion(latenciasOperaciones, SistemaRegistrarProducto);
+    Guardia guardia(cerrojoInventario);
+    descongelar(); // El inventario cambia: vuelve al almacenamiento mutable.
+    {
+        EVENTO_TRAZA("sondeoIndice");
+        inventario.insertar(producto); // Agrega el producto al inventario.
+    }
+    indexarNombre(vistaDe(producto.nombre));
+    if (auditoria) {
+        auditoria->producto(AuditoriaProductoRegistrado, vistaDe(almacenAuditoria), vistaDe(producto.nombre), producto.precio,
+                            producto.cantidad);
+    }
+    {
+        EVENTO_TRAZA("agregarHistorial");
+        historialCambios.agregar({"agregar", producto, 0}); // Registra el cambio en el historial.
+    }
+    anotarInventario();
+    publicarInsercion(producto);
+    if (salida) {
+        EVENTO_TRAZA("formatoSalida");
+        mensaje(MensajeProductoAgregado, vistaDe(producto.nombre));
+    }
+}
+
+// Mtodo para quitar un producto del inventario sin mensajes; devuelve si exista.
+template <class A, class C, class H, class B>
+bool SistemaGestionT<A, C, H, B>::quitarProducto(const VistaNombre& nombre, std::string* registrado) {
+    Guardia guardia(cerrojoInventario);
+    Cambio cambio;
+    cambio.tipo = "eliminar";
+    cambio.consultas = 0;
+    bool existia;
+    if (catalogo.vacio()) {
+        existia = probarNombre(nombre, [this, &cambio](const VistaNombre& v) { return extraerExacto(v, cambio.producto); });
+    } else {
+        // Solo se descongela si el nombre est: una baja que no encuentra nada no copia
+        // el catlogo al inventario, y el filtro de ausentes la contesta solo.
+        VistaProducto encontrado;
+        existia = probarNombre(nombre, [this, &encontrado](const VistaNombre& v) { return buscarExacto(v, encontrado); });
+        if (existia) {
+            std::string exacto(encontrado.nombre.datos, encontrado.nombre.longitud); // descongelar() libera el catlogo.
+            descongelar();
+            EVENTO_TRAZA("sondeoIndice");
+            existia = inventario.extraer(vistaDe(exacto), cambio.producto);
+        }
+    }
+    if (!existia) {
+        return false;
+    }
+    // Desde aqu, el nombre tal como estaba registrado.
+    VistaNombre eliminado = vistaDe(cambio.producto.nombre);
+    if (autocompletar) {
+        cambio.consultas = autocompletado.consultas(eliminado); // Deshacer la restaura.
+    }
+    desindexarNombre(eliminado);
+    if (auditoria) {
+        auditoria->producto(AuditoriaProductoEliminado, vistaDe(almacenAuditoria), eliminado, cambio.producto.precio,
+                            cambio.producto.cantidad);
+    }
+    publicarEliminacion(eliminado);
+    if (registrado) {
+        *registrado = cambio.producto.nombre;
+    }
+    EVENTO_TRAZA("agregarHistorial");
+    historialCambios.agregar(std::move(cambio)); // Registra el cambio en el historial.
+    anotarInventario();
+    return true;
+}
+
+// Mtodo para eliminar un producto del inventario.
+template <class A, class C, class H, class B>
+bool SistemaGestionT<A, C, H, B>::eliminarProducto(const std::string& nombreProducto) {
+    MedicionLatencia medicion(latenciasOperaciones, SistemaEliminarProducto);
+    std::string eliminado;
+    if (quitarProducto(vistaDe(nombreProducto), &eliminado)) {
+        // Si el producto existe, se elimina y se registra el cambio. El mensaje lleva el
+        // nombre registrado, que puede diferir del escrito.
+        EVENTO_TRAZA("formatoSalida");
+        mensaje(MensajeProductoEliminado, vistaDe(eliminado));
+        return true;
+    }
+    mensaje(MensajeProductoNoEncontrado);
+    return false;
+}
+
+// Mtodo para buscar un producto; f recibe su vista si se encuentra.
+template <class A, class C, class H, class B>
+template <class F>
+bool SistemaGestionT<A, C, H, B>::buscarProducto(const VistaNombre& nombre, F f) {
+    return verProducto(nombre, [this, &f](const VistaProducto& producto) {
+        if (autocompletar) {
+            autocompletado.anotarConsulta(producto.nombre);
+        }
+        f(producto);
+    });
+}
+
+// Mtodo para ver un producto sin anotar la consulta; f recibe su vista si se encuentra.
+template <class A, class C, class H, class B>
+template <class F>
+bool SistemaGestionT<A, C, H, B>::verProducto(const VistaNombre& nombre, F f) {
+    Guardia guardia(cerrojoInventario);
+    VistaProducto producto;
+    bool encontrado = probarNombre(nombre, [this, &producto](const VistaNombre& v) { return buscarExacto(v, producto); });
+    if (encontrado) {
+        f(producto);
+    }
+    return encontrado;
+}
+
+// Mtodo para consultar informacin de un producto especfico.
+template <class A, class C, class H, class B>
+void SistemaGestionT<A, C, H, B>::consultarProducto(const std::string& nombreProducto) {
+    consultarProducto(vistaDe(nombreProducto), [](const VistaProducto&) {});
+}
+
+template <class A, class C, class H, class B>
+template <class F>
+bool SistemaGestionT<A, C, H, B>::consultarProducto(const VistaNombre& nombre, F f) {
+    MedicionLatencia medicion(latenciasOperaciones, SistemaConsultarProducto);
+    bool encontrado = buscarProducto(nombre, [this, &f](const VistaProducto& producto) {
+        // Si se encuentra, muestra su informacin.
+        EVENTO_TRAZA("formatoSalida");
+        mensaje(MensajeProducto, producto.nombre, producto.precio, producto.cantidad);
+        f(producto);
+    });
+
+    if (!encontrado) {
+        mensaje(MensajeProductoNoEncontrado);
+        if (salida) {
+            // Con las sugerencias activas, los nombres ms parecidos al pedido.
+            MensajeLibre respuesta(salida, mensajesAsincronos);
+            sugerirProducto(nombre, SUGERENCIAS_APROXIMADAS, [&respuesta](const VistaNombre& parecido, std::size_t) {
+                respuesta << "Quiso decir " << parecido << "?" << std::endl;
+            });
+        }
+    }
+    return encontrado;
+}
+
+// Mtodo para recorrer los productos ordenados por nombre.
+template <class A, class C, class H, class B>
+template <class F>
+void SistemaGestionT<A, C, H, B>::recorrerProductos(F f) {
+    Guardia guardia(cerrojoInventario);
+    recorrerInventario(f);
+}
+
+// Mtodo para listar todos los productos en el inventario, ordenados por nombre.
+template <class A, class C, class H, class B>
+void SistemaGestionT<A, C, H, B>::listarProductos() {
+    MedicionLatencia medicion(latenciasOperaciones, SistemaListarProductos);
+    EVENTO_TRAZA("formatoSalida");
+    recorrerProductos([this](const VistaProducto& producto) {
+        // Muestra cada producto en el inventario.
+        mensaje(MensajeProducto, producto.nombre, producto.precio, producto.cantidad);
+    });
+}
+
+// Mtodo para completar un prefijo con los nombres ms consultados; f(nombre, consultas)
+// recibe cada uno. Sin el autocompletado activo no hay sugerencias.
+template <class A, class C, class H, class B>
+template <class F>
+std::size_t SistemaGestionT<A, C, H, B>::completarProducto(const VistaNombre& prefijo, std::size_t limite, F f) {
+    Guardia guardia(cerrojoInventario);
+    return autocompletar ? autocompletado.completar(prefijo, limite, f) : 0;
+}
+
+// Mtodo para buscar los nombres ms cercanos a uno que no est; f(nombre, distancia)
+// recibe cada uno. Sin las sugerencias activas no hay ninguno.
+template <class A, class C, class H, class B>
+template <class F>
+std::size_t SistemaGestionT<A, C, H, B>::sugerirProducto(const VistaNombre& nombre, std::size_t limite, F f) {
+    Guardia guardia(cerrojoInventario);
+    return sugerir ? sugerencias.sugerir(nombre, limite, f) : 0;
+}
+
+// Mtodo para mostrar los productos que empiezan con un prefijo, de ms a menos consultados.
+template <class A, class C, class H, class B>
+void SistemaGestionT<A, C, H, B>::autocompletarProducto(const std::string& prefijo) {
+    MedicionLatencia medicion(latenciasOperaciones, SistemaAutocompletarProducto);
+    MensajeLibre respuesta(salida, mensajesAsincronos);
+    std::size_t sugerencias = completarProducto(vistaDe(prefijo), SUGERENCIAS_AUTOCOMPLETADO,
+                                                [&respuesta](const VistaNombre& nombre, uint32_t consultas) {
+        respuesta << "Sugerencia: " << nombre << ", Consultas: " << consultas << std::endl;
+    });
+    if (sugerencias == 0) {
+        respuesta << "No hay productos que empiecen con " << prefijo << "." << std::endl;
+    }
+}
+
+// Mtodo para registrar una nueva solicitud.
+template <class A, class C, class H, class B>
+void SistemaGestionT<A, C, H, B>::registrarSolicitud(const Solicitud& solicitud) {
+    MedicionLatencia medicion(latenciasOperaciones, SistemaRegistrarSolicitud);
+    Guardia guardia(cerrojoSolicitudes);
+    solicitudes.encolar(solicitud); // Agrega la solicitud al final de la cola.
+    if (indexarSolicitudes) {
+        indiceSolicitudes.agregar(vistaDe(solicitud.descripcion));
+    }
+    anotarSolicitudes();
+    if (auditoria) {
+        auditoria->solicitud(AuditoriaSolicitudRegistrada, vistaDe(almacenAuditoria), solicitud.id,
+                             vistaDe(solicitud.descripcion));
+    }
+    if (salida) {
+        EVENTO_TRAZA("formatoSalida");
+        mensaje(MensajeSolicitudRegistrada, vistaDe(solicitud.descripcion));
+    }
+}
+
+// Mtodo para sacar la primera solicitud de la cola sin mensajes.
+template <class A, class C, class H, class B>
+bool SistemaGestionT<A, C, H, B>::tomarSolicitud(Solicitud& solicitud) {
+    Guardia guardia(cerrojoSolicitudes);
+    bool hay = solicitudes.desencolar(solicitud);
+    if (hay && indexarSolicitudes) {
+        indiceSolicitudes.quitarPrimera(vistaDe(solicitud.descripcion));
+    }
+    anotarSolicitudes();
+    if (hay && auditoria) {
+        auditoria->solicitud(AuditoriaSolicitudProcesada, vistaDe(almacenAuditoria), solicitud.id, VistaNombre());
+    }
+    return hay;
+}
+
+// Mtodo para procesar la primera solicitud de la cola.
+template <class A, class C, class H, class B>
+void SistemaGestionT<A, C, H, B>::procesarSolicitud() {
+    MedicionLatencia medicion(latenciasOperaciones, SistemaProcesarSolicitud);
+    Solicitud solicitud;
+
+    if (tomarSolicitud(solicitud)) { // Obtiene y elimina la primera solicitud.
+        EVENTO_TRAZA("formatoSalida");
+        mensaje(MensajeProcesandoSolicitud, vistaDe(solicitud.descripcion));
+    } else {
+        mensaje(MensajeSinSolicitudesPendientes);
+    }
+}
+
+// Mtodo para ver la solicitud en proceso; f la recibe si la hay.
+template <class A, class C, class H, class B>
+template <class F>
+bool SistemaGestionT<A, C, H, B>::verSolicitudEnProceso(F f) {
+    Guardia guardia(cerrojoSolicitudes);
+    const Solicitud* solicitud = solicitudes.frente();
+    if (solicitud) {
+        f(*solicitud);
+    }
+    return solicitud != nullptr;
+}
+
+// Mtodo para consultar la solicitud en proceso (la primera de la cola).
+template <class A, class C, class H, class B>
+void SistemaGestionT<A, C, H, B>::consultarSolicitudEnProceso() {
+    MedicionLatencia medicion(latenciasOperaciones, SistemaConsultarSolicitudEnProceso);
+    bool hay = verSolicitudEnProceso([this](const Solicitud& solicitud) {
+        mensaje(MensajeSolicitudEnProceso, vistaDe(solicitud.descripcion));
+    });
+
+    if (!hay) {
+        mensaje(MensajeSinSolicitudEnProceso);
+    }
+}
+
+// Mtodo para recorrer las solicitudes pendientes en orden de llegada.
+template <class A, class C, class H, class B>
+template <class F>
+void SistemaGestionT<A, C, H, B>::recorrerSolicitudes(F f) {
+    Guardia guardia(cerrojoSolicitudes);
+    solicitudes.recorrer(f);
+}
+
+// Mtodo para listar todas las solicitudes pendientes.
+template <class A, class C, class H, class B>
+void SistemaGestionT<A, C, H, B>::listarSolicitudesPendientes() {
+    MedicionLatencia medicion(latenciasOperaciones, SistemaListarSolicitudesPendientes);
+    EVENTO_TRAZA("formatoSalida");
+    recorrerSolicitudes([this](const Solicitud& solicitud) {
+        mensaje(MensajeSolicitudPendiente, vistaDe(solicitud.descripcion));
+    });
+}
+
+// Mtodo para recorrer, en orden de llegada, las solicitudes pendientes cuya descripcin
+// tiene todas las palabras de la consulta. Con el ndice activo solo se comparan las
+// candidatas de la palabra menos frecuente; si no, se lee cada descripcin.
+template <class A, class C, class H, class B>
+template <class F>
+std::size_t SistemaGestionT<A, C, H, B>::buscarSolicitudes(const VistaNombre& consulta, F f) {
+    ConsultaSolicitudes palabras(consulta);
+    if (palabras.vacia()) {
+        return 0;
+    }
+    Guardia guardia(cerrojoSolicitudes);
+    std::size_t encontradas = 0;
+    if (!indexarSolicitudes) {
+        solicitudes.recorrer([&](const Solicitud& solicitud) {
+            if (palabras.coincide(vistaDe(solicitud.descripcion))) {
+                f(solicitud);
+                ++encontradas;
+            }
+        });
+        return encontradas;
+    }
+    std::vector<uint64_t> posiciones;
+    if (!indiceSolicitudes.candidatas(palabras, posiciones) || posiciones.empty()) {
+        return 0;
+    }
+    // La cola no tiene acceso por posicin: se recorre desde el frente y se corta en la
+    // ltima candidata. Lo que queda detrs de ella no se lee.
+    bool verificar = palabras.lista().size() > 1;
+    std::size_t siguiente = 0;
+    uint64_t posicion = 0;
+    solicitudes.recorrerMientras([&](const Solicitud& solicitud) {
+        if (posiciones[siguiente] == posicion++) {
+            ++siguiente;
+            if (!verificar || palabras.coincide(vistaDe(solicitud.descripcion))) {
+                f(solicitud);
+                ++encontradas;
+            }
+        }
+        return siguiente < posiciones.size();
+    });
+    return encontradas;
+}
+
+// Mtodo para listar las solicitudes pendientes que mencionan todas las palabras dadas.
+template <class A, class C, class H, class B>
+void SistemaGestionT<A, C, H, B>::buscarSolicitudesPendientes(const std::string& consulta) {
+    MedicionLatencia medicion(latenciasOperaciones, SistemaBuscarSolicitudes);
+    EVENTO_TRAZA("formatoSalida");
+    std::size_t encontradas = buscarSolicitudes(vistaDe(consulta), [this](const Solicitud& solicitud) {
+        mensaje(MensajeSolicitudPendiente, vistaDe(solicitud.descripcion));
+    });
+    if (encontradas == 0) {
+        MensajeLibre(salida, mensajesAsincronos) << "No hay solicitudes pendientes que mencionen " << consulta << "." << std::endl;
+    }
+}
+
+// Mtodo para registrar un cliente en espera.
+template <class A, class C, class H, class B>
+void SistemaGestionT<A, C, H, B>::registrarClienteEnEspera(const Cliente& cliente) {
+    MedicionLatencia medicion(latenciasOperaciones, SistemaRegistrarCliente);
+    Guardia guardia(cerrojoClientes);
+    clientesEnEspera.encolar(cliente); // Agrega el cliente al final de la cola.
+    anotarClientes();
+    if (auditoria) {
+        auditoria->cliente(AuditoriaClienteRegistrado, vistaDe(almacenAuditoria), cliente.id, vistaDe(cliente.nombre));
+    }
+    if (salida) {
+        EVENTO_TRAZA("formatoSalida");
+        mensaje(MensajeClienteRegistrado, vistaDe(cliente.nombre));
+    }
+}
+
+// Mtodo para sacar al primer cliente en espera sin mensajes.
+template <class A, class C, class H, class B>
+bool SistemaGestionT<A, C, H, B>::tomarCliente(Cliente& cliente) {
+    Guardia guardia(cerrojoClientes);
+    bool hay = clientesEnEspera.desencolar(cliente);
+    anotarClientes();
+    if (hay && auditoria) {
+        auditoria->cliente(AuditoriaClienteAtendido, vistaDe(almacenAuditoria), cliente.id, VistaNombre());
+    }
+    return hay;
+}
+
+// Mtodo para atender al primer cliente en espera.
+template <class A, class C, class H, class B>
+void SistemaGestionT<A, C, H, B>::atenderCliente() {
+    MedicionLatencia medicion(latenciasOperaciones, SistemaAtenderCliente);
+    Cliente cliente;
+
+    if (tomarCliente(cliente)) { // Obtiene y elimina el primer cliente.
+        EVENTO_TRAZA("formatoSalida");
+        mensaje(MensajeAtendiendoCliente, vistaDe(cliente.nombre));
+    } else {
+        mensaje(MensajeSinClientesEnEspera);
+    }
+}
+
+// Mtodo para recorrer los clientes en espera en orden de llegada.
+template <class A, class C, class H, class B>
+template <class F>
+void SistemaGestionT<A, C, H, B>::recorrerClientes(F f) {
+    Guardia guardia(cerrojoClientes);
+    clientesEnEspera.recorrer(f);
+}
+
+// Mtodo para consultar todos los clientes en espera.
+template <class A, class C, class H, class B>
+void SistemaGestionT<A, C, H, B>::consultarListaDeEspera() {
+    MedicionLatencia medicion(latenciasOperaciones, SistemaConsultarListaDeEspera);
+    EVENTO_TRAZA("formatoSalida");
+    recorrerClientes([this](const Cliente& cliente) {
+        mensaje(MensajeClienteEnEspera, vistaDe(cliente.nombre));
+    });
+}
+
+// Mtodo para revertir el ltimo cambio del historial sin mensajes.
+// cambio recibe el cambio revertido.
+template <class A, class C, class H, class B>
+ResultadoDeshacer SistemaGestionT<A, C, H, B>::revertirUltimoCambio(Cambio& cambio) {
+    Guardia guardia(cerrojoInventario);
+
+    bool hayCambio;
+    {
+        EVENTO_TRAZA("extraerHistorial");
+        hayCambio = historialCambios.extraerUltimo(cambio); // Obtiene y elimina el ltimo cambio del historial.
+    }
+    if (!hayCambio) {
+        return NadaQueDeshacer;
+    }
+    descongelar();
+    EVENTO_TRAZA("sondeoIndice");
+    if (cambio.tipo == "agregar") {
+        // Si fue un agregado, elimina el producto del inventario.
+        Producto eliminado;
+        bool estaba = inventario.extraer(vistaDe(cambio.producto.nombre), eliminado);
+        anotarInventario(); // El historial cambi aunque el producto ya no estuviera.
+        if (!estaba) {
+            return AgregadoAusente;
+        }
+        desindexarNombre(vistaDe(eliminado.nombre));
+        if (auditoria) {
+            auditoria->producto(AuditoriaAgregadoDeshecho, vistaDe(almacenAuditoria), vistaDe(eliminado.nombre),
+                                eliminado.precio, eliminado.cantidad);
+        }
+        publicarEliminacion(vistaDe(cambio.producto.nombre));
+        return AgregadoEliminado;
+    }
+    // Si fue una eliminacin, restaura el producto en el inventario.
+    inventario.insertar(cambio.producto);
+    anotarInventario();
+    indexarNombre(vistaDe(cambio.producto.nombre), cambio.consultas);
+    if (auditoria) {
+        auditoria->producto(AuditoriaEliminacionDeshecha, vistaDe(almacenAuditoria), vistaDe(cambio.producto.nombre),
+                            cambio.producto.precio, cambio.producto.cantidad);
+    }
+    publicarInsercion(cambio.producto);
+    return EliminadoRestaurado;
+}
+
+// Mtodo para deshacer la ltima accin registrada en el historial.
+template <class A, class C, class H, class B>
+void SistemaGestionT<A, C, H, B>::deshacerUltimaAccion() {
+    MedicionLatencia medicion(latenciasOperaciones, SistemaDeshacer);
+    Cambio cambio;
+
+    switch (revertirUltimoCambio(cambio)) {
+    case AgregadoEliminado:
+        mensaje(MensajeDeshacerAgregado, vistaDe(cambio.producto.nombre));
+        break;
+    case EliminadoRestaurado:
+        mensaje(MensajeDeshacerEliminado, vistaDe(cambio.producto.nombre));
+        break;
+    case AgregadoAusente:
+        break;
+    case NadaQueDeshacer:
+        mensaje(MensajeSinCambios);
+        break;
+    }
+}
+
+// Mtodo para congelar el catlogo: compila el inventario actual en una imagen inmutable.
+template <class A, class C, class H, class B>
+void SistemaGestionT<A, C, H, B>::congelarCatalogo() {
+    MedicionLatencia medicion(latenciasOperaciones, SistemaCongelarCatalogo);
+    Guardia guardia(cerrojoInventario);
+    std::vector<VistaProducto> productos;
+    productos.reserve(inventario.tamano());
+    inventario.recorrerOrdenado([&productos](const VistaProducto& producto) {
+        productos.push_back(producto);
+    });
+
+    if (catalogo.construir(productos)) {
+        MensajeLibre(salida, mensajesAsincronos) << "Catlogo congelado: " << catalogo.tamano() << " productos, "
+                                                 << catalogo.unidadesTotales() << " unidades, valor total: "
+                                                 << catalogo.valorTotal() << std::endl;
+    } else {
+        MensajeLibre(salida, mensajesAsincronos) << "No se pudo congelar el catlogo." << std::endl;
+    }
+}
+
+// Mtodo para descongelar el catlogo y volver al almacenamiento mutable.
+template <class A, class C, class H, class B>
+void SistemaGestionT<A, C, H, B>::descongelarCatalogo() {
+    MedicionLatencia medicion(latenciasOperaciones, SistemaDescongelarCatalogo);
+    Guardia guardia(cerrojoInventario);
+
+    if (!catalogo.vacio()) {
+        descongelar();
+        MensajeLibre(salida, mensajesAsincronos) << "Catlogo descongelado." << std::endl;
+    } else {
+        MensajeLibre(salida, mensajesAsincronos) << "El catlogo no est congelado." << std::endl;
+    }
+}
+
+// Mtodo para guardar el catlogo en un archivo que otros procesos pueden proyectar con mmap.
+// Si el catlogo no est congelado, se congela primero.
+template <class A, class C, class H, class B>
+bool SistemaGestionT<A, C, H, B>::guardarCatalogo(const std::string& ruta) {
+    MedicionLatencia medicion(latenciasOperaciones, SistemaGuardarCatalogo);
+    if (!catalogoCongelado()) {
+        congelarCatalogo();
+    }
+    Guardia guardia(cerrojoInventario);
+    EVENTO_TRAZA("escrituraArchivo");
+
+    if (catalogo.guardar(ruta)) {
+        MensajeLibre(salida, mensajesAsincronos) << "Catlogo guardado en " << ruta << " (" << catalogo.bytes() << " bytes)"
+                                                 << std::endl;
+        return true;
+    }
+    MensajeLibre(salida, mensajesAsincronos) << "No se pudo guardar el catlogo en " << ruta << std::endl;
+    return false;
+}
+
+// Mtodo para cargar un catlogo guardado. Reemplaza el inventario y vaca el historial;
+// el archivo se consulta en el lugar y solo se copia al inventario si se modifica.
+template <class A, class C, class H, class B>
+bool SistemaGestionT<A, C, H, B>::cargarCatalogo(const std::string& ruta) {
+    MedicionLatencia medicion(latenciasOperaciones, SistemaCargarCatalogo);
+    Guardia guardia(cerrojoInventario);
+    CatalogoCongelado cargado;
+
+    if (cargado.abrir(ruta)) {
+        catalogo.intercambiar(cargado);
+        inventario = A();
+        historialCambios = H();
+        catalogoSinMaterializar = true;
+        anotarInventario();
+        if (autocompletar) {
+            // Los nombres que siguen en el inventario conservan sus consultas.
+            IndiceAutocompletado nuevo;
+            catalogo.recorrerOrdenado([this, &nuevo](const VistaProducto& producto) {
+                nuevo.agregar(producto.nombre, autocompletado.consultas(producto.nombre));
+            });
+            std::swap(autocompletado, nuevo);
+        }
+        if (sugerir) {
+            IndiceAproximado nuevo;
+            catalogo.recorrerOrdenado([&nuevo](const VistaProducto& producto) { nuevo.agregar(producto.nombre); });
+            std::swap(sugerencias, nuevo);
+        }
+        if (filtrar) {
+            reconstruirFiltro();
+        }
+        if (normalizar) {
+            IndiceNormalizado nuevo;
+            catalogo.recorrerOrdenado([&nuevo](const VistaProducto& producto) { nuevo.agregar(producto.nombre); });
+            std::swap(nombresNormalizados, nuevo);
+        }
+        if (auditoria) {
+            auditoria->catalogoCargado(vistaDe(almacenAuditoria), vistaDe(ruta), catalogo.tamano());
+        }
+        if (replica.activa()) {
+            replica.reemplazar([this](const std::function<void(const VistaProducto&)>& f) { catalogo.recorrerOrdenado(f); });
+        }
+        MensajeLibre(salida, mensajesAsincronos) << "Catlogo cargado: " << catalogo.tamano() << " productos, "
+                                                 << catalogo.unidadesTotales() << " unidades, valor total: "
+                                                 << catalogo.valorTotal() << std::endl;
+        return true;
+    }
+    MensajeLibre(salida, mensajesAsincronos) << "No se pudo cargar el catlogo de " << ruta << std::endl;
+    return false;
+}
+
+// Mtodo para publicar el inventario en una regin de memoria compartida.
+// Desde ese momento cada cambio del inventario se refleja en la regin.
+template <class A, class C, class H, class B>
+bool SistemaGestionT<A, C, H, B>::publicarReplica(const std::string& nombreRegion, std::size_t capacidad) {
+    MedicionLatencia medicion(latenciasOperaciones, SistemaPublicarReplica);
+    Guardia guardia(cerrojoInventario);
+    std::size_t productos = catalogo.vacio() ? inventario.tamano() : catalogo.tamano();
+    if (capacidad == 0) {
+        capacidad = std::max<std::size_t>(65536, productos * 4);
+    }
+
+    bool publicada = replica.crear(nombreRegion, capacidad) &&
+                     replica.reemplazar([this](const std::function<void(const VistaProducto&)>& f) { recorrerInventario(f); });
+    if (publicada) {
+        MensajeLibre(salida, mensajesAsincronos) << "Inventario publicado en memoria compartida: " << nombreRegion << " ("
+                                                 << productos << " productos, capacidad " << capacidad << ")" << std::endl;
+        return true;
+    }
+    replica.cerrar();
+    MensajeLibre(salida, mensajesAsincronos) << "No se pudo publicar el inventario en memoria compartida: " << nombreRegion
+                                             << std::endl;
+    return false;
+}
+
+// Mtodo para mostrar la latencia de cada operacin desde el ltimo reinicio.
+template <class A, class C, class H, class B>
+void SistemaGestionT<A, C, H, B>::imprimirLatencias() {
+    if (salida) {
+        MensajeLibre tabla(salida, mensajesAsincronos);
+        latenciasOperaciones.imprimir(tabla.flujo());
+    }
+}
+
+// Mtodo para vaciar los histogramas de latencia.
+template <class A, class C, class H, class B>
+void SistemaGestionT<A, C, H, B>::reiniciarLatencias() {
+    latenciasOperaciones.reiniciar();
+    MensajeLibre(salida, mensajesAsincronos) << "Latencias reiniciadas." << std::endl;
+}
+
+// Mtodo para obtener la memoria de cada estructura; cada poltica la lleva al da.
+template <class A, class C, class H, class B>
+MemoriaSistema SistemaGestionT<A, C, H, B>::memoria() const {
+    MemoriaSistema memoria;
+    memoria.estructuras[EstructuraInventario] = inventario.memoria();
+    memoria.estructuras[EstructuraSolicitudes] = solicitudes.memoria();
+    memoria.estructuras[EstructuraClientes] = clientesEnEspera.memoria();
+    memoria.estructuras[EstructuraHistorial] = historialCambios.memoria();
+    return memoria;
+}
+
+template <class A, class C, class H, class B>
+void SistemaGestionT<A, C, H, B>::vigilarMemoria() {
+    int64_t total = memoria().total().total();
+    int64_t pico = picoMemoria.load(std::memory_order_relaxed);
+    while (total > pico && !picoMemoria.compare_exchange_weak(pico, total, std::memory_order_relaxed)) {
+    }
+    int64_t umbral = umbralMemoria.load(std::memory_order_relaxed);
+    if (umbral == 0) {
+        return;
+    }
+    bool sobre = total > umbral;
+    if (memoriaSobreUmbral.exchange(sobre, std::memory_order_relaxed) != sobre) {
+        if (sobre) {
+            MensajeLibre(salida, mensajesAsincronos) << "Alerta de memoria: las estructuras ocupan " << total
+                                                     << " bytes (umbral " << umbral << ")." << std::endl;
+        } else {
+            MensajeLibre(salida, mensajesAsincronos) << "Memoria de nuevo bajo el umbral: " << total << " bytes." << std::endl;
+        }
+    }
+}
+
+// Mtodo para mostrar la memoria de cada estructura, el catlogo congelado y el pico.
+template <class A, class C, class H, class B>
+void SistemaGestionT<A, C, H, B>::imprimirMemoria() {
+    if (!salida) return;
+    MensajeLibre reporte(salida, mensajesAsincronos);
+    imprimirMemoriaSistema(reporte.flujo(), memoria());
+    {
+        Guardia guardia(cerrojoInventario);
+        if (!catalogo.vacio()) {
+            reporte << "Catlogo congelado: " << catalogo.tamano() << " productos en " << catalogo.bytes() << " bytes"
+                    << std::endl;
+        }
+        if (autocompletar) {
+            reporte << "Autocompletado: " << autocompletado.tamano() << " nombres en " << autocompletado.memoria().total()
+                    << " bytes" << std::endl;
+        }
+        if (sugerir) {
+            reporte << "Sugerencias: " << sugerencias.tamano() << " nombres en " << sugerencias.memoria().total()
+                    << " bytes" << std::endl;
+        }
+        if (filtrar) {
+            EstadoFiltroAusentes estado = filtroAusentes.estado();
+            char tasas[64];
+            std::snprintf(tasas, sizeof(tasas), "%.3f%% estimados, %.3f%% observados", estado.tasaEstimada * 100,
+                          estado.tasaObservada() * 100);
+            reporte << "Filtro de ausentes: " << estado.nombres << " nombres en " << estado.bytes
+                    << " bytes; falsos positivos " << tasas << " (" << estado.falsosPositivos << " de "
+                    << estado.descartadas + estado.falsosPositivos << " ausentes)" << std::endl;
+        }
+        if (normalizar) {
+            reporte << "Nombres normalizados: " << nombresNormalizados.tamano() << " claves en "
+                    << nombresNormalizados.memoria().total() << " bytes" << std::endl;
+        }
+    }
+    {
+        Guardia guardia(cerrojoSolicitudes);
+        if (indexarSolicitudes) {
+            reporte << "ndice de solicitudes: " << indiceSolicitudes.cantidadTerminos() << " palabras, "
+                    << indiceSolicitudes.cantidadPosteos() << " posteos en " << indiceSolicitudes.memoria().total()
+                    << " bytes" << std::endl;
+        }
+    }
+    reporte << "Pico: " << picoMemoria.load(std::memory_order_relaxed) << " bytes";
+    int64_t umbral = umbralMemoria.load(std::memory_order_relaxed);
+    if (umbral > 0) {
+        reporte << "; alerta a partir de " << umbral << " bytes";
+    }
+    reporte << std::endl;
+}
+
+// Mtodo para obtener el estado del filtro de ausentes, con sus tasas de falsos positivos.
+template <class A, class C, class H, class B>
+EstadoFiltroAusentes SistemaGestionT<A, C, H, B>::estadoFiltroAusentes() {
+    Guardia guardia(cerrojoInventario);
+    return filtrar ? filtroAusentes.estado() : EstadoFiltroAusentes();
+}
+
+// Mtodo para fijar el umbral de la alerta de memoria.
+template <class A, class C, class H, class B>
+void SistemaGestionT<A, C, H, B>::fijarAlertaMemoria(int64_t bytes) {
+    umbralMemoria.store(bytes > 0 ? bytes : 0, std::memory_order_relaxed);
+    memoriaSobreUmbral.store(false, std::memory_order_relaxed);
+    if (bytes > 0) {
+        MensajeLibre(salida, mensajesAsincronos) << "Alerta de memoria fijada en " << bytes << " bytes." << std::endl;
+    } else {
+        MensajeLibre(salida, mensajesAsincronos) << "Alerta de memoria desactivada." << std::endl;
+    }
+    vigilarMemoria(); // Avisa enseguida si ya se super.
+}
+
+#endif
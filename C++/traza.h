@@ -0,0 +1,395 @@
+#ifndef TRAZA_H
+#define TRAZA_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+
+#include "protocolo_texto.h"
+#include "protocolo_binario.h"
+
+// Trazas de comandos
+// Secuencia de comandos del protocolo de texto con el instante de cada uno, en un
+// formato binario compacto que se puede volver a ejecutar: generador_carga las produce
+// y bench_operaciones --traza las ejecuta; proyecto_final --grabar graba la sesin del
+// men y reproducir_traza la vuelve a ejecutar. escribirComandoTexto da la misma traza como
+// guion de texto para proyecto_final --guion.
+//
+//   cabecera:  "SGT1"
+//   registro:  varint  microsegundos desde el registro anterior
+//              u8      opcin (con el bit 0x80 si al comando le faltaban argumentos)
+//              argumentos segn la opcin:
+//                1        nombre, precio (f64 LE), cantidad (varint zigzag)
+//                2, 3, 9  nombre
+//                26       prefijo
+//                5        descripcin
+//                27       palabras buscadas
+//                16..18   ruta o regin
+//                25       umbral de la alerta de memoria, en decimal
+//                19, 20   almacn o producto de las opciones del men que no estn
+//                         en el protocolo de texto
+//              donde un texto es varint longitud + bytes.
+//
+// Un comando tpico ocupa entre 2 y 20 bytes.
+
+static const char MAGICO_TRAZA[4] = {'S', 'G', 'T', '1'};
+static const uint8_t TRAZA_INCOMPLETO = 0x80;
+
+// Un comando con su instante, en microsegundos desde el comienzo de la traza.
+struct EventoTraza {
+    uint64_t instante;
+    ComandoTexto comando;
+};
+
+inline void agregarVarint(std::string& destino, uint64_t valor) {
+    while (valor >= 0x80) {
+        destino.push_back(static_cast<char>((valor & 0x7F) | 0x80));
+        valor >>= 7;
+    }
+    destino.push_back(static_cast<char>(valor));
+}
+
+// Lee un varint de [p, fin); devuelve false si est truncado o es demasiado largo.
+inline bool leerVarint(const char*& p, const char* fin, uint64_t& valor) {
+    valor = 0;
+    for (unsigned desplazamiento = 0; p < fin && desplazamiento < 64; desplazamiento += 7) {
+        uint8_t byte = static_cast<uint8_t>(*p++);
+        valor |= static_cast<uint64_t>(byte & 0x7F) << desplazamiento;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline uint64_t zigzag(int64_t valor) { return (static_cast<uint64_t>(valor) << 1) ^ static_cast<uint64_t>(valor >> 63); }
+inline int64_t desdeZigzag(uint64_t valor) { return static_cast<int64_t>(valor >> 1) ^ -static_cast<int64_t>(valor & 1); }
+
+// Codifica el registro de un comando al final de destino.
+inline void codificarEventoTraza(std::string& destino, uint64_t delta, const ComandoTexto& comando) {
+    agregarVarint(destino, delta);
+    int opcion = comando.opcion >= 0 && comando.opcion < 0x80 ? comando.opcion : 0;
+    if (comando.incompleto) {
+        destino.push_back(static_cast<char>(opcion | TRAZA_INCOMPLETO));
+        return;
+    }
+    destino.push_back(static_cast<char>(opcion));
+    switch (opcion) {
+        case 1: {
+            agregarVarint(destino, comando.producto.nombre.size());
+            destino += comando.producto.nombre;
+            uint64_t bits;
+            std::memcpy(&bits, &comando.producto.precio, sizeof(bits));
+            char precio[8];
+            escribirU64(precio, bits);
+            destino.append(precio, sizeof(precio));
+            agregarVarint(destino, zigzag(comando.producto.cantidad));
+            break;
+        }
+        case 2:
+        case 3:
+        case 26:
+            agregarVarint(destino, comando.producto.nombre.size());
+            destino += comando.producto.nombre;
+            break;
+        case 5:
+        case 9:
+        case 27:
+        case 16:
+        case 17:
+        case 18:
+        case 19:
+        case 20:
+        case 25:
+            agregarVarint(destino, comando.texto.size());
+            destino += comando.texto;
+            break;
+        default:
+            break;
+    }
+}
+
+// Escribe una traza en un archivo. Los registros se acumulan y se escriben en bloques.
+class EscritorTraza {
+public:
+    EscritorTraza() : ultimo(0), registros(0) {}
+    ~EscritorTraza() { cerrar(); }
+
+    bool abrir(const std::string& ruta) {
+        archivo.open(ruta.c_str(), std::ios::binary | std::ios::trunc);
+        if (!archivo) {
+            return false;
+        }
+        archivo.write(MAGICO_TRAZA, sizeof(MAGICO_TRAZA));
+        return static_cast<bool>(archivo);
+    }
+
+    bool abierto() const { return archivo.is_open(); }
+
+    // Los instantes no pueden retroceder; si lo hacen se registra un delta de 0.
+    void escribir(uint64_t instante, const ComandoTexto& comando) {
+        codificarEventoTraza(pendiente, instante > ultimo ? instante - ultimo : 0, comando);
+        if (instante > ultimo) {
+            ultimo = instante;
+        }
+        ++registros;
+        if (pendiente.size() >= TAMANO_BLOQUE) {
+            volcar();
+        }
+    }
+
+    void volcar() {
+        if (!pendiente.empty() && archivo.is_open()) {
+            archivo.write(pendiente.data(), static_cast<std::streamsize>(pendiente.size()));
+            archivo.flush();
+        }
+        pendiente.clear();
+    }
+
+    void cerrar() {
+        if (archivo.is_open()) {
+            volcar();
+            archivo.close();
+        }
+    }
+
+    unsigned long long cantidad() const { return registros; }
+
+private:
+    static const std::size_t TAMANO_BLOQUE = 64 * 1024;
+
+    std::ofstream archivo;
+    std::string pendiente;
+    uint64_t ultimo;
+    unsigned long long registros;
+};
+
+// Graba los comandos de una sesin interactiva con el instante en que se ejecutan.
+// Cada comando se escribe enseguida: una sesin que termina mal conserva lo grabado.
+class GrabadorSesion {
+public:
+    GrabadorSesion() : inicio(std::chrono::steady_clock::now()) { comando.incompleto = false; }
+
+    bool abrir(const std::string& ruta) { return escritor.abrir(ruta); }
+    bool activo() const { return escritor.abierto(); }
+
+    void grabar(int opcion) {
+        comando.opcion = opcion;
+        escribir();
+    }
+    void grabar(int opcion, const std::string& texto) {
+        comando.opcion = opcion;
+        if (opcion == 2 || opcion == 3 || opcion == 26) {
+            comando.producto.nombre = texto;
+        } else {
+            comando.texto = texto;
+        }
+        escribir();
+    }
+    void grabar(const Producto& producto) {
+        comando.opcion = 1;
+        comando.producto = producto;
+        escribir();
+    }
+
+private:
+    void escribir() {
+        if (!escritor.abierto()) {
+            return;
+        }
+        std::chrono::microseconds transcurrido =
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - inicio);
+        escritor.escribir(static_cast<uint64_t>(transcurrido.count()), comando);
+        escritor.volcar();
+    }
+
+    EscritorTraza escritor;
+    std::chrono::steady_clock::time_point inicio;
+    ComandoTexto comando;
+};
+
+// Traza cargada en memoria.
+class LectorTraza {
+public:
+    LectorTraza() : posicion(0), instante(0) {}
+
+    bool cargar(const std::string& ruta) {
+        std::ifstream archivo(ruta.c_str(), std::ios::binary);
+        if (!archivo) {
+            return false;
+        }
+        datos.assign(std::istreambuf_iterator<char>(archivo), std::istreambuf_iterator<char>());
+        return abrirDatos();
+    }
+
+    // Usa una traza ya en memoria.
+    bool abrirDatos(const std::string& contenido) {
+        datos = contenido;
+        return abrirDatos();
+    }
+
+    // Lee el siguiente evento; devuelve false al final o si el registro est daado
+    // (en ese caso daada() es true).
+    bool siguiente(EventoTraza& evento) {
+        const char* p = datos.data() + posicion;
+        const char* fin = datos.data() + datos.size();
+        if (p == fin) {
+            return false;
+        }
+        uint64_t delta;
+        if (!leerVarint(p, fin, delta) || p == fin) {
+            return marcarDanada();
+        }
+        uint8_t opcion = static_cast<uint8_t>(*p++);
+        ComandoTexto& comando = evento.comando;
+        comando.opcion = opcion & ~TRAZA_INCOMPLETO;
+        comando.incompleto = (opcion & TRAZA_INCOMPLETO) != 0;
+        if (!comando.incompleto) {
+            switch (comando.opcion) {
+                case 1: {
+                    uint64_t cantidad;
+                    if (!leerTexto(p, fin, comando.producto.nombre) || fin - p < 8) {
+                        return marcarDanada();
+                    }
+                    uint64_t bits = leerU64(p);
+                    p += 8;
+                    std::memcpy(&comando.producto.precio, &bits, sizeof(bits));
+                    if (!leerVarint(p, fin, cantidad)) {
+                        return marcarDanada();
+                    }
+                    comando.producto.cantidad = static_cast<int>(desdeZigzag(cantidad));
+                    break;
+                }
+                case 2:
+                case 3:
+                case 26:
+                    if (!leerTexto(p, fin, comando.producto.nombre)) {
+                        return marcarDanada();
+                    }
+                    break;
+                case 5:
+                case 9:
+                case 27:
+                case 16:
+                case 17:
+                case 18:
+                case 19:
+                case 20:
+                case 25:
+                    if (!leerTexto(p, fin, comando.texto)) {
+                        return marcarDanada();
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+        instante += delta;
+        evento.instante = instante;
+        posicion = static_cast<std::size_t>(p - datos.data());
+        return true;
+    }
+
+    // Vuelve al primer evento.
+    void rebobinar() {
+        posicion = sizeof(MAGICO_TRAZA);
+        instante = 0;
+    }
+
+    bool danada() const { return posicion > datos.size(); }
+    std::size_t bytes() const { return datos.size(); }
+
+private:
+    bool abrirDatos() {
+        if (datos.size() < sizeof(MAGICO_TRAZA) || std::memcmp(datos.data(), MAGICO_TRAZA, sizeof(MAGICO_TRAZA)) != 0) {
+            datos.clear();
+            posicion = 0;
+            return false;
+        }
+        rebobinar();
+        return true;
+    }
+
+    static bool leerTexto(const char*& p, const char* fin, std::string& texto) {
+        uint64_t longitud;
+        if (!leerVarint(p, fin, longitud) || longitud > static_cast<uint64_t>(fin - p)) {
+            return false;
+        }
+        texto.assign(p, static_cast<std::size_t>(longitud));
+        p += longitud;
+        return true;
+    }
+
+    // Deja la lectura al final y marca la traza como daada.
+    bool marcarDanada() {
+        posicion = datos.size() + 1;
+        return false;
+    }
+
+    std::string datos;
+    std::size_t posicion;
+    uint64_t instante;
+};
+
+// Nombre de la operacin de cada opcin del men, para los informes.
+inline const char* nombreOperacionTraza(int opcion) {
+    static const char* const nombres[] = {"opcionNoValida", "registrarProducto", "eliminarProducto", "consultarProducto",
+                                          "listarProductos", "registrarSolicitud", "procesarSolicitud",
+                                          "consultarSolicitudEnProceso", "listarSolicitudesPendientes",
+                                          "registrarClienteEnEspera", "atenderCliente", "consultarListaDeEspera",
+                                          "deshacerUltimaAccion", "salir", "congelarCatalogo", "descongelarCatalogo",
+                                          "guardarCatalogo", "cargarCatalogo", "publicarReplica", "cambiarAlmacen",
+                                          "buscarEnAlmacenes", "valoracionGlobal", "latencias", "reiniciarLatencias",
+                                          "memoria", "alertaMemoria", "autocompletarProducto",
+                                          "buscarSolicitudes"};
+    return opcion > 0 && opcion < 28 ? nombres[opcion] : nombres[0];
+}
+
+// Escribe el comando como una lnea del protocolo de texto (la forma que lee --guion).
+inline void escribirComandoTexto(std::ostream& salida, const ComandoTexto& comando) {
+    salida << comando.opcion;
+    if (comando.incompleto) {
+        salida << '\n';
+        return;
+    }
+    switch (comando.opcion) {
+        case 1: {
+            // El precio con los dgitos justos para leerlo de vuelta igual.
+            char precio[32];
+            std::snprintf(precio, sizeof(precio), "%.15g", comando.producto.precio);
+            if (std::strtod(precio, nullptr) != comando.producto.precio) {
+                std::snprintf(precio, sizeof(precio), "%.17g", comando.producto.precio);
+            }
+            salida << ' ' << comando.producto.nombre << ' ' << precio << ' ' << comando.producto.cantidad;
+            break;
+        }
+        case 2:
+        case 3:
+        case 26:
+            salida << ' ' << comando.producto.nombre;
+            break;
+        case 5:
+        case 9:
+        case 27:
+        case 16:
+        case 17:
+        case 18:
+        case 19:
+        case 20:
+        case 25:
+            salida << ' ' << comando.texto;
+            break;
+        default:
+            break;
+    }
+    salida << '\n';
+}
+
+#endif
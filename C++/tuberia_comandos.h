@@ -0,0 +1,281 @@
+#ifndef TUBERIA_COMANDOS_H
+#define TUBERIA_COMANDOS_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+
+#include "sistema_gestion.h"
+#include "protocolo_texto.h"
+#include "anillo_spsc.h"
+
+// Tubera de comandos
+// Ejecuta un guion de peticiones del protocolo de texto (un archivo, una tubera o la
+// entrada estndar) en tres etapas, cada una en su hilo y unidas por anillos SPSC:
+//
+//   lectura y anlisis -> ejecucin -> armado y escritura de la salida
+//
+// Solo la etapa de ejecucin toca el sistema, as que no necesita bloqueos. Mientras
+// ejecuta, la primera etapa ya lee y analiza las lneas siguientes y la ltima escribe
+// las respuestas anteriores. La salida es la misma, y en el mismo orden, que con
+// ejecutarGuionSecuencial.
+//
+// Los mensajes los sigue produciendo el sistema (son los del men), capturados con un
+// BufferSalida en bloques de hasta TAMANO_BLOQUE_SALIDA bytes. Un bloque se entrega
+// antes de llenarse si no hay ms comandos listos, para que un guion que llega de a
+// poco por una tubera reciba sus respuestas sin esperar.
+//
+// Al terminar se informa cunto tiempo estuvo ocupada cada etapa; el resto lo pas
+// esperando a la anterior (anillo vaco) o a la siguiente (anillo lleno). La etapa ms
+// ocupada es el cuello de botella. Esperar la entrada cuenta como ocupacin de la
+// lectura y esperar al destino cuenta como ocupacin de la escritura.
+
+static const std::size_t CAPACIDAD_COMANDOS = 4096;
+static const std::size_t CAPACIDAD_BLOQUES = 64;
+static const std::size_t TAMANO_BLOQUE_SALIDA = 64 * 1024;
+
+// Ocupacin de una etapa durante la ejecucin de un guion.
+struct EtapaGuion {
+    const char* nombre;
+    unsigned long long elementos; // Lneas, comandos o bloques que pasaron por la etapa.
+    double ocupada;               // Segundos trabajando (no esperando a otra etapa).
+};
+
+struct InformeGuion {
+    double segundos;
+    unsigned long long comandos;
+    std::vector<EtapaGuion> etapas;
+};
+
+inline void imprimirInformeGuion(const InformeGuion& informe, std::ostream& salida) {
+    char linea[128];
+    std::snprintf(linea, sizeof(linea), "%llu comandos en %.3f s (%.0f comandos/s)", informe.comandos, informe.segundos,
+                  informe.segundos > 0 ? informe.comandos / informe.segundos : 0.0);
+    salida << linea << '\n';
+    for (const auto& etapa : informe.etapas) {
+        double ocupacion = informe.segundos > 0 ? 100.0 * etapa.ocupada / informe.segundos : 0.0;
+        std::snprintf(linea, sizeof(linea), "  %-10s %12llu elementos  ocupada %6.1f%%", etapa.nombre, etapa.elementos,
+                      ocupacion > 100.0 ? 100.0 : ocupacion);
+        salida << linea << '\n';
+    }
+    salida.flush();
+}
+
+// Espera entre intentos sobre un anillo vaco o lleno: gira, cede el procesador y, si la
+// espera se alarga (la entrada llega lenta), duerme para no consumir un ncleo entero.
+inline void esperarEtapa(unsigned intentos) {
+    if (intentos >= 4096) {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    } else if (intentos >= 64) {
+        std::this_thread::yield();
+    }
+}
+
+// Reloj de una etapa: acumula el tiempo de espera; la ocupacin es el resto de la vida
+// del hilo. Solo se consulta el reloj cuando hay que esperar.
+class RelojEtapa {
+public:
+    RelojEtapa() : inicio(std::chrono::steady_clock::now()), espera(0), intentos(0) {}
+
+    void esperar() {
+        if (intentos == 0) {
+            inicioEspera = std::chrono::steady_clock::now();
+        }
+        esperarEtapa(intentos++);
+    }
+
+    // El anillo volvi a estar disponible.
+    void continuar() {
+        if (intentos > 0) {
+            espera += std::chrono::steady_clock::now() - inicioEspera;
+            intentos = 0;
+        }
+    }
+
+    double ocupada() const {
+        std::chrono::duration<double> total = std::chrono::steady_clock::now() - inicio - espera;
+        return total.count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point inicio;
+    std::chrono::steady_clock::time_point inicioEspera;
+    std::chrono::steady_clock::duration espera;
+    unsigned intentos;
+};
+
+// Ejecuta el guion con las tres etapas. El sistema debe usarse solo desde aqu mientras
+// dura la llamada; su salida se restaura al terminar.
+template <class Sistema>
+InformeGuion ejecutarGuionEnTuberia(Sistema& sistema, std::istream& entrada, std::ostream& salida) {
+    // Un comando con opcion < 0 marca el fin de la entrada (analizarPeticionTexto nunca
+    // las produce: una lnea "-1" es una opcin no vlida); un bloque vaco, el de la salida.
+    AnilloSPSC<ComandoTexto> comandos(CAPACIDAD_COMANDOS);
+    AnilloSPSC<std::string> bloques(CAPACIDAD_BLOQUES);
+    InformeGuion informe;
+    informe.etapas.resize(3);
+    EtapaGuion& lectura = informe.etapas[0];
+    EtapaGuion& ejecucion = informe.etapas[1];
+    EtapaGuion& escritura = informe.etapas[2];
+    lectura = EtapaGuion{"lectura", 0, 0.0};
+    ejecucion = EtapaGuion{"ejecucion", 0, 0.0};
+    escritura = EtapaGuion{"escritura", 0, 0.0};
+    auto inicio = std::chrono::steady_clock::now();
+
+    std::thread lector([&] {
+        RelojEtapa reloj;
+        std::string linea;
+        ComandoTexto comando;
+        for (;;) {
+            if (std::getline(entrada, linea)) {
+                analizarPeticionTexto(linea.data(), linea.size(), comando);
+                ++lectura.elementos;
+            } else {
+                comando.opcion = -1;
+            }
+            bool fin = comando.opcion < 0;
+            while (!comandos.intentarEncolar(comando)) {
+                reloj.esperar();
+            }
+            reloj.continuar();
+            if (fin) {
+                break;
+            }
+        }
+        lectura.ocupada = reloj.ocupada();
+    });
+
+    std::thread escritor([&] {
+        RelojEtapa reloj;
+        std::string bloque;
+        for (;;) {
+            while (!bloques.intentarDesencolar(bloque)) {
+                reloj.esperar();
+            }
+            reloj.continuar();
+            if (bloque.empty()) {
+                break;
+            }
+            salida.write(bloque.data(), static_cast<std::streamsize>(bloque.size()));
+            salida.flush();
+            ++escritura.elementos;
+        }
+        escritura.ocupada = reloj.ocupada();
+    });
+
+    // La ejecucin corre en el hilo que llama.
+    {
+        RelojEtapa reloj;
+        BufferSalida buffer;
+        std::ostream flujo(&buffer);
+        std::string bloque;
+        buffer.redirigir(&bloque);
+        std::ostream* salidaAnterior = sistema.salidaActual();
+        sistema.fijarSalida(&flujo);
+        int siguienteId = 1;
+        ComandoTexto comando;
+
+        auto entregar = [&](std::string& texto) {
+            while (!bloques.intentarEncolar(texto)) {
+                reloj.esperar();
+            }
+            reloj.continuar();
+        };
+
+        for (;;) {
+            if (!comandos.intentarDesencolar(comando)) {
+                // No hay ms comandos listos: lo acumulado sale ya.
+                if (!bloque.empty()) {
+                    entregar(bloque);
+                    bloque.clear();
+                }
+                reloj.esperar();
+                continue;
+            }
+            reloj.continuar();
+            if (comando.opcion < 0) {
+                break;
+            }
+            ejecutarComandoTexto(sistema, comando, flujo, siguienteId);
+            ++ejecucion.elementos;
+            if (bloque.size() >= TAMANO_BLOQUE_SALIDA) {
+                entregar(bloque);
+                bloque.clear();
+            }
+        }
+        if (!bloque.empty()) {
+            entregar(bloque);
+        }
+        std::string fin;
+        entregar(fin);
+        sistema.fijarSalida(salidaAnterior);
+        ejecucion.ocupada = reloj.ocupada();
+    }
+
+    lector.join();
+    escritor.join();
+    informe.segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    informe.comandos = ejecucion.elementos;
+    return informe;
+}
+
+// Mismo guion en un solo hilo, para comparar con la tubera.
+template <class Sistema>
+InformeGuion ejecutarGuionSecuencial(Sistema& sistema, std::istream& entrada, std::ostream& salida) {
+    InformeGuion informe;
+    informe.comandos = 0;
+    auto inicio = std::chrono::steady_clock::now();
+    std::ostream* salidaAnterior = sistema.salidaActual();
+    sistema.fijarSalida(&salida);
+    int siguienteId = 1;
+    std::string linea;
+    while (std::getline(entrada, linea)) {
+        ejecutarPeticionTexto(sistema, linea.data(), linea.size(), salida, siguienteId);
+        ++informe.comandos;
+    }
+    salida.flush();
+    sistema.fijarSalida(salidaAnterior);
+    informe.segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    informe.etapas.push_back(EtapaGuion{"secuencial", informe.comandos, informe.segundos});
+    return informe;
+}
+
+// Arranca el modo guion con los argumentos de la lnea de comandos:
+//   --guion [archivo] [--secuencial]
+// Sin archivo (o con "-") lee la entrada estndar. Las respuestas van a la salida
+// estndar y el informe de ocupacin a la de errores.
+template <class Sistema>
+int ejecutarModoGuion(Sistema& sistema, int argc, char** argv) {
+    std::string ruta = "-";
+    bool secuencial = false;
+    for (int i = 2; i < argc; ++i) {
+        std::string argumento = argv[i];
+        if (argumento == "--secuencial") {
+            secuencial = true;
+        } else {
+            ruta = argumento;
+        }
+    }
+    std::ifstream archivo;
+    if (ruta != "-") {
+        archivo.open(ruta.c_str(), std::ios::binary);
+        if (!archivo) {
+            std::cerr << "No se pudo abrir el guion " << ruta << std::endl;
+            return 1;
+        }
+    }
+    std::istream& entrada = ruta != "-" ? static_cast<std::istream&>(archivo) : std::cin;
+    std::ios::sync_with_stdio(false);
+
+    InformeGuion informe = secuencial ? ejecutarGuionSecuencial(sistema, entrada, std::cout)
+                                      : ejecutarGuionEnTuberia(sistema, entrada, std::cout);
+    imprimirInformeGuion(informe, std::cerr);
+    return 0;
+}
+
+#endif